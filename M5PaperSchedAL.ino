@@ -33,6 +33,7 @@
  ******************************************************************************/
 
 #include "globals.h"
+#include "sleep_sched.h"
 #include <SD.h>
 #include <time.h>
 #include <esp_system.h>
@@ -42,9 +43,13 @@
 //    デフォルト8KBでは doFetch() → parseICSStream() → stream->read() のコールチェーンで溢れる
 SET_LOOP_TASK_STACK_SIZE(16 * 1024);
 
+static void startLoopTimers();
+
 // ダブルバッファ実体定義（PSRAM上に確保、setup()でps_calloc）
 EventItem* events_buf_a = nullptr;
 EventItem* events_buf_b = nullptr;
+TextPool text_pool_a = {};
+TextPool text_pool_b = {};
 
 //==============================================================================
 // セットアップ
@@ -84,18 +89,25 @@ void setup() {
                   ESP.getFreeHeap(), ESP.getMaxAllocHeap());
     events_buf_a = (EventItem*)ps_calloc(MAX_EVENTS, sizeof(EventItem));
     events_buf_b = (EventItem*)ps_calloc(MAX_EVENTS, sizeof(EventItem));
-    events = events_buf_a;
+    publishEvents(events_buf_a, 0);     // 空の版を公開（以降の公開は fetch / 日付ロール）
+    // 本文プール（バッファ面ごと）— ヘッダーは固定長、本文は実サイズ分だけ消費
+    text_pool_a.base = (char*)ps_malloc(TEXT_POOL_SIZE);
+    text_pool_b.base = (char*)ps_malloc(TEXT_POOL_SIZE);
+    text_pool_a.size = text_pool_a.base ? TEXT_POOL_SIZE : 0;
+    text_pool_b.size = text_pool_b.base ? TEXT_POOL_SIZE : 0;
+    text_pool_a.intern = (InternSlot*)ps_calloc(INTERN_SLOTS, sizeof(InternSlot));
+    text_pool_b.intern = (InternSlot*)ps_calloc(INTERN_SLOTS, sizeof(InternSlot));
     int bufKB = (int)(MAX_EVENTS * sizeof(EventItem) / 1024);
-    Serial.printf("Events double buffer: %d x %d = %dKB x2 = %dKB in PSRAM (%s)\n",
-                  MAX_EVENTS, (int)sizeof(EventItem), bufKB, bufKB * 2,
-                  (events_buf_a && events_buf_b) ? "OK" : "FAILED");
+    Serial.printf("Events double buffer: %d x %d = %dKB x2 + text pool %dKB x2 in PSRAM (%s)\n",
+                  MAX_EVENTS, (int)sizeof(EventItem), bufKB, TEXT_POOL_SIZE / 1024,
+                  (events_buf_a && events_buf_b && text_pool_a.base && text_pool_b.base) ? "OK" : "FAILED");
     // PSRAM検証: アドレスが0x3F800000以降ならPSRAM、0x3FF00000以降ならDRAM
     Serial.printf("  buf_a @ %p, buf_b @ %p (%s)\n",
                   events_buf_a, events_buf_b,
                   ((uintptr_t)events_buf_a >= 0x3F800000 && (uintptr_t)events_buf_a < 0x3FF00000) ? "PSRAM OK" : "DRAM!!");
     Serial.printf("[MEM] After ps_calloc: heap:%d maxBlock:%d psram:%dKB\n",
                   ESP.getFreeHeap(), ESP.getMaxAllocHeap(), ESP.getFreePsram() / 1024);
-    if (!events_buf_a || !events_buf_b) {
+    if (!events_buf_a || !events_buf_b || !text_pool_a.base || !text_pool_b.base) {
         Serial.println("FATAL: PSRAM allocation failed!");
         while(1) delay(1000);
     }
@@ -140,11 +152,16 @@ void setup() {
 
     // 設定読み込み
     loadConfig();
+    // アラーム発火済みジャーナル（再起動前に鳴らしたアラームの再鳴動防止）
+    replayAlarmJournal();
+    // 発火タイミングのヒストグラム（再起動をまたいで累積）
+    loadAlarmTiming();
 
     // MIDI UART初期化
     Serial2.begin(config.midi_baud, SERIAL_8N1, -1, port_tx_pins[config.port_select]);
     Serial.printf("MIDI UART on GPIO %d @ %d baud\n",
                   port_tx_pins[config.port_select], config.midi_baud);
+    startMidiOutTask();
 
     // キャンバス作成
     canvas.createCanvas(540, 960);
@@ -172,8 +189,13 @@ void setup() {
         Serial.println("Font not found, using default");
     }
 
+    // ★ 高速起動: RTC の時刻で SD のイベントスナップショットを復元できれば、
+    //    WiFi/NTP/初回fetch を待たずに一覧を表示してアラームを有効化する。
+    //    取得は loop の定期更新（全ソース期限切れ扱い）で行い、差分だけ画面に反映
+    bool fast_boot = restoreTimeFromRTC() && loadEventSnapshot(time(nullptr));
+
     // 起動画面（コールドブート時のみ）
-    if (!silent_mode) {
+    if (!silent_mode && !fast_boot) {
         canvas.fillCanvas(0);
         canvas.setTextColor(15);
         canvas.setTextDatum(MC_DATUM);
@@ -191,10 +213,10 @@ void setup() {
     Serial.printf("Pre-WiFi memory: heap:%d maxBlock:%d\n",
                   ESP.getFreeHeap(), ESP.getMaxAllocHeap());
 
-    // WiFi + NTP + 初回fetch
-    if (connectWiFi()) {
-        configTzTime(TZ_JST, "pool.ntp.org", "time.google.com", "ntp.nict.jp");
-
+    // WiFi + NTP + 初回fetch（SNTP は connectWiFi 内で開始）
+    if (fast_boot) {
+        Serial.printf("FAST BOOT: %d events from snapshot - network deferred to loop\n", event_count);
+    } else if (connectWiFi()) {
         if (!silent_mode) {
             canvas.drawString("WiFi OK!", 270, 360);
             canvas.pushCanvas(0, 0, UPDATE_MODE_GC16);
@@ -218,12 +240,13 @@ void setup() {
             delay(1000);
         } else {
             Serial.printf("NTP sync OK: %ld (retry: %d)\n", now, retry);
+            saveTimeToRTC();
 
             if (!silent_mode) {
                 canvas.drawString("Fetching calendar...", 270, 420);
                 canvas.pushCanvas(0, 0, UPDATE_MODE_GC16);
             }
-            fetchAndUpdate();
+            fetchAndUpdate(true);       // 起動時は全ソース取得
             last_fetch = time(nullptr);
             Serial.printf("Initial fetch complete: %d events loaded\n", event_count);
         }
@@ -245,8 +268,7 @@ void setup() {
     ui_state = UI_LIST;
     selected_event = 0;
     page_start = 0;
-    last_interaction_ms = millis();
-    last_sd_check_ms = millis();
+    noteInteraction();
     scrollToToday();
     Serial.printf("[DRAW] drawList: events=%d page_start=%d selected=%d silent=%s\n",
                   event_count, page_start, selected_event,
@@ -262,6 +284,15 @@ void setup() {
     esp_task_wdt_init(120, true);   // 120秒タイムアウト、パニック→リブート
     esp_task_wdt_add(NULL);         // 現在のタスク(loopTask)を監視対象に追加
     Serial.println("Task WDT enabled (120s timeout)");
+
+    // ★ アラーム監視タスク（どの画面にいても期限到来を検知）
+    startAlarmTask();
+
+    // ★ ntfy 送信ワーカー（発火側は積むだけ）
+    startNtfyWorker();
+
+    // ★ loop() の定期処理をタイマーホイールに登録
+    startLoopTimers();
 }
 
 //==============================================================================
@@ -275,18 +306,14 @@ void safeReboot() {
         return;
     }
     time_t now = time(nullptr);
-    for (int i = 0; i < event_count; i++) {
-        if (!events[i].has_alarm) continue;
-        for (int k = 0; k < events[i].alarm_count; k++) {
-            if (events[i].triggered[k]) continue;
-            long remain = (long)(events[i].alarm_time[k] - now);
-            if (remain > 0 && remain < 300) {  // 5分以内
-                Serial.printf("REBOOT DEFERRED: alarm '%s' in %ld sec\n",
-                              events[i].summary(), remain);
-                reboot_pending = true;  // アラーム後にリブート
-                return;
-            }
-        }
+    int next_ev = -1;
+    time_t next_al = nextPendingAlarm(now, &next_ev);
+    long remain = next_al ? (long)(next_al - now) : 0;
+    if (next_ev >= 0 && remain > 0 && remain < 300) {  // 5分以内
+        Serial.printf("REBOOT DEFERRED: alarm '%s' in %ld sec\n",
+                      events[next_ev].summary(), remain);
+        reboot_pending = true;  // アラーム後にリブート
+        return;
     }
     Serial.println("=== Silent reboot ===");
     Serial.flush();
@@ -294,6 +321,197 @@ void safeReboot() {
     ESP.restart();
 }
 
+//==============================================================================
+// loop() の定期処理（timers.cpp のホイールから呼ぶ。false = 今はできない → 後で再試行）
+//==============================================================================
+static int timer_fetch = -1;
+static int timer_browse = -1;
+static int timer_dayroll = -1;
+
+// 操作があった（タッチ・ボタン）: 無操作の起点を更新し、自動復帰を BROWSE_TIMEOUT_MS 後に張り直す
+void noteInteraction() {
+    last_interaction_ms = millis();
+    if (timer_browse >= 0) timerRunIn(timer_browse, BROWSE_TIMEOUT_MS);
+}
+
+// スイッチチェック（50ms間隔。押下は GPIO でも起きるので眠りの締め切りにはしない）
+static bool jobSwitches() {
+    checkSwitches();
+    return true;
+}
+
+// SDカード健全性チェック（5分ごと、UI_LIST時のみ — 他画面ではCheckAFSRブロック回避）
+static bool jobSdCheck() {
+    if (ui_state != UI_LIST) return false;
+    if (!checkSDHealth()) {
+        Serial.println("SD_CHECK: Health check failed, attempting reinit");
+        sd_healthy = false;
+        reinitSD();
+        if (sd_healthy && ui_state == UI_LIST) drawList();
+    } else {
+        sd_healthy = true;
+        Serial.printf("SD_CHECK: OK (heap: %d)\n", ESP.getFreeHeap());
+    }
+    return true;
+}
+
+// 操作なし3分以上 かつ UI_LIST の場合、毎分自動リフレッシュ（操作中の分は飛ばす）
+static bool jobAutoRefresh() {
+    time_t now_t = time(nullptr);
+    bool idle = (millis() - last_interaction_ms) > 180000;
+    if (!idle || ui_state != UI_LIST || now_t == (time_t)-1) return true;
+    int old_page = page_start;
+    scrollToToday();
+    if (page_start != old_page) {
+        Serial.printf("AUTO-REFRESH: page %d->%d (full redraw)\n", old_page, page_start);
+        partial_refresh_count = 0;
+        drawList();
+    } else {
+        // ★ 毎時0分にGC16フルリフレッシュで灰色ゴースト除去（時報代わり）
+        struct tm tmNow;
+        localtime_r(&now_t, &tmNow);
+        if (tmNow.tm_min == 0 && partial_refresh_count == 0) {
+            partial_refresh_count = 1;  // 同じ0分内で再実行しないフラグ
+            Serial.printf("AUTO-REFRESH: hourly GC16 cleanup (%02d:00)\n", tmNow.tm_hour);
+            drawList();  // GC16 full refresh
+        } else {
+            if (tmNow.tm_min != 0) partial_refresh_count = 0;  // 0分が過ぎたらリセット
+            // ページ同じ → ヘッダー時刻 + 次イベントアンダーラインの部分更新のみ
+            partialRefreshHeader();
+            partialRefreshNextLine();
+        }
+    }
+    return true;
+}
+
+// 毎分デバッグ出力（サウンドテスト中は MIDI を乱さないよう見送る）
+static bool jobAlarmCheck() {
+    if (midi_playing) return false;
+    reportAlarmCheck();
+    return true;
+}
+
+// 定期ICS更新（UI_LIST時のみ — 詳細/設定画面ではCheckAFSRブロック回避）
+//   一度きりのジョブを、終わるたびに次の取得時刻（nextFetchTime）で張り直す。
+//   設定変更・時刻合わせを拾うため、張り直しは最長1分先まで
+static bool jobFetch() {
+    if (ui_state != UI_LIST) return false;
+    time_t now = time(nullptr);
+    // ソースごとの更新間隔（ics_poll_each）のどれかに達したら fetch — 対象ソースのみ再取得
+    // WiFi再接続・TLS接続は途中で割り込めないので、直前にアラームがあれば見送る
+    if (fetchDue(now) && alarmAllowsBlocking(FETCH_BLOCK_MS, "Periodic fetch")) {
+        if (!sd_healthy) {
+            Serial.println("ICS fetch skipped - SD unhealthy");
+            deferFetch(now);
+        } else {
+            // ヒープ断片化 → リブート（String排除後は閾値を大幅引き下げ）
+            if ((int)ESP.getMaxAllocHeap() < 10000) {
+                Serial.printf("*** REBOOT: heap fragmented, maxBlock:%d ***\n",
+                              ESP.getMaxAllocHeap());
+                safeReboot();
+            }
+
+            // WiFi未接続なら再接続
+            if (WiFi.status() != WL_CONNECTED) {
+                if (!connectWiFi()) {
+                    // ★ WiFi再接続失敗 → 次回更新周期までスキップ（連続リトライ防止）
+                    Serial.println("WiFi reconnect failed, deferring next fetch");
+                    deferFetch(now);
+                }
+            }
+
+            // フェッチ（ダブルバッファ: 失敗しても旧データ保持）
+            if (WiFi.status() == WL_CONNECTED) {
+                int before = event_count;
+                WiFi.setSleep(false);       // 取得中はモデムスリープを外す（TLS・受信を速く）
+                bool changed = fetchAndUpdate();
+                WiFi.setSleep(true);
+                Serial.printf("Periodic fetch: %d -> %d events\n", before, event_count);
+                if (changed && ui_state == UI_LIST) refreshListAfterFetch();
+            }
+        }
+    }
+    now = time(nullptr);
+    int64_t in_ms = ((int64_t)nextFetchTime(now) - now) * 1000;
+    if (in_ms < 1000) in_ms = 1000;
+    if (in_ms > 60000) in_ms = 60000;
+    timerRunIn(timer_fetch, (uint32_t)in_ms);
+    return true;
+}
+
+// 詳細・月表示・検索: 無操作で一覧に自動復帰（置きっぱなしでも今日の一覧を見せる）
+//   一度きりのジョブ。操作のたびに noteInteraction() が張り直す
+static bool jobBrowseTimeout() {
+    if (!browsingScreen()) return true;
+    unsigned long idle = millis() - last_interaction_ms;
+    if (idle < BROWSE_TIMEOUT_MS) {
+        timerRunIn(timer_browse, BROWSE_TIMEOUT_MS - idle);
+        return true;
+    }
+    Serial.printf("[AUTO] %s timeout %ds -> back to list\n",
+                  ui_state == UI_DETAIL ? "Detail" : ui_state == UI_MONTH ? "Month" : "Search",
+                  BROWSE_TIMEOUT_MS / 1000);
+    ui_state = UI_LIST;
+    partial_refresh_count = 0;
+    waitEPDReady();
+    drawList(false, false, false, true);
+    return true;
+}
+
+// 日付の切り替わり: 過去ウィンドウから外れた日バケットを切り離す（再fetch・再ソートなし。UI_LIST時のみ）
+//   index がずれるが、鳴動中のイベントは playing_ref（uid_hash + 開始時刻）で追える。
+//   一度きりのジョブを次の0時（+1秒）で張り直す。時刻合わせを拾うため最長1時間先まで
+static bool jobDayRoll() {
+    if (ui_state != UI_LIST) return false;
+    static uint16_t last_day = 0;
+    time_t now = time(nullptr);
+    if (now < 1700000000) {
+        timerRunIn(timer_dayroll, 60000);
+        return true;
+    }
+    uint16_t today = dayKeyOf(now);
+    if (today != last_day) {
+        last_day = today;
+        int cut = rollEventWindow(now);
+        if (cut > 0) refreshListAfterRoll(cut);
+    }
+    struct tm t;
+    localtime_r(&now, &t);
+    t.tm_mday += 1;
+    t.tm_hour = 0; t.tm_min = 0; t.tm_sec = 1;
+    t.tm_isdst = -1;
+    int64_t in_ms = ((int64_t)mktime(&t) - now) * 1000;
+    if (in_ms < 1000) in_ms = 1000;
+    if (in_ms > 3600000) in_ms = 3600000;
+    timerRunIn(timer_dayroll, (uint32_t)in_ms);
+    return true;
+}
+
+// ハートビート ● 明滅（UI_LIST時のみ、5秒ごと）
+static bool jobHeartbeat() {
+    if (ui_state != UI_LIST) return false;
+    heartbeat_visible = !heartbeat_visible;
+    heartbeat_canvas.fillCanvas(0);
+    if (heartbeat_visible) {
+        heartbeat_canvas.fillCircle(7, 7, 5, 15);
+    }
+    heartbeat_canvas.pushCanvas(522, 4, UPDATE_MODE_DU);
+    return true;
+}
+
+static void startLoopTimers() {
+    initTimers();
+    timerAdd("switch", jobSwitches, 50, 50, WAKE_MAX, false);
+    timerAdd("alarmchk", jobAlarmCheck, 60000, 0, WAKE_MINUTE);
+    timerAdd("refresh", jobAutoRefresh, 60000, 60000, WAKE_MINUTE);
+    timerAdd("sdcheck", jobSdCheck, SD_CHECK_INTERVAL_MS, SD_CHECK_INTERVAL_MS, WAKE_SD_CHECK);
+    timer_fetch = timerAdd("fetch", jobFetch, 0, 1000, WAKE_FETCH);
+    int hb = timerAdd("heartbeat", jobHeartbeat, 5000, 5000, WAKE_HEARTBEAT);
+    timerSetRetry(hb, 500);     // 一覧に戻ったらすぐ明滅を再開
+    timer_browse = timerAdd("browse", jobBrowseTimeout, 0, BROWSE_TIMEOUT_MS, WAKE_BROWSE);
+    timer_dayroll = timerAdd("dayroll", jobDayRoll, 0, 1000, WAKE_MINUTE);
+}
+
 //==============================================================================
 // メインループ
 //==============================================================================
@@ -303,12 +521,6 @@ void loop() {
     // MIDI再生更新
     updateMidiPlayback();
 
-    // スイッチチェック（50ms間隔）
-    if (millis() - last_switch_check > 50) {
-        last_switch_check = millis();
-        checkSwitches();
-    }
-
     // タッチ処理
     static bool was_touched = false;
     if (M5.TP.available()) {
@@ -326,116 +538,25 @@ void loop() {
         M5.TP.flush();
     }
 
-    // アラームチェック（UI_LIST時のみ — 他画面ではCheckAFSRブロック回避）
-    if (ui_state == UI_LIST) {
-        checkAlarms();
-    }
+    // アラームチェック（全画面 — 判定はヒープ先頭を見るだけ。期限到来は監視タスクも見張る）
+    checkAlarms();
 
-    // SDカード健全性チェック（5分ごと、UI_LIST時のみ — 他画面ではCheckAFSRブロック回避）
-    if (ui_state == UI_LIST && (millis() - last_sd_check_ms) > SD_CHECK_INTERVAL_MS) {
-        last_sd_check_ms = millis();
-        if (!checkSDHealth()) {
-            Serial.println("SD_CHECK: Health check failed, attempting reinit");
-            sd_healthy = false;
-            reinitSD();
-            if (sd_healthy && ui_state == UI_LIST) drawList();
-        } else {
-            sd_healthy = true;
-            Serial.printf("SD_CHECK: OK (heap: %d)\n", ESP.getFreeHeap());
-        }
-    }
+    // 次のアラームの MIDI を先読み（MIDI_PREARM_SEC 前から。発火時は時計を始めるだけ）
+    preArmMidi();
 
-    // 詳細画面: 30秒無操作で一覧に自動復帰
-    if (ui_state == UI_DETAIL && (millis() - last_interaction_ms) > 30000) {
-        Serial.println("[AUTO] Detail timeout 30s -> back to list");
-        ui_state = UI_LIST;
-        partial_refresh_count = 0;
-        waitEPDReady();
-        drawList(false, false, false, true);
-    }
+    // 省電力で切った WiFi を、fetch・先読みの前に繋ぎ直す
+    powerService();
 
-    // 操作なし3分以上 かつ UI_LIST の場合、毎分自動リフレッシュ
-    {
-        time_t now_t = time(nullptr);
-        bool idle = (millis() - last_interaction_ms) > 180000;
-        if (idle && ui_state == UI_LIST && now_t != (time_t)-1 &&
-            (now_t - last_auto_refresh) >= 60) {
-            last_auto_refresh = now_t;
-            int old_page = page_start;
-            scrollToToday();
-            if (page_start != old_page) {
-                Serial.printf("AUTO-REFRESH: page %d->%d (full redraw)\n", old_page, page_start);
-                partial_refresh_count = 0;
-                drawList();
-            } else {
-                // ★ 毎時0分にGC16フルリフレッシュで灰色ゴースト除去（時報代わり）
-                struct tm tmNow;
-                localtime_r(&now_t, &tmNow);
-                if (tmNow.tm_min == 0 && partial_refresh_count == 0) {
-                    partial_refresh_count = 1;  // 同じ0分内で再実行しないフラグ
-                    Serial.printf("AUTO-REFRESH: hourly GC16 cleanup (%02d:00)\n", tmNow.tm_hour);
-                    drawList();  // GC16 full refresh
-                } else {
-                    if (tmNow.tm_min != 0) partial_refresh_count = 0;  // 0分が過ぎたらリセット
-                    // ページ同じ → ヘッダー時刻 + 次イベントアンダーラインの部分更新のみ
-                    partialRefreshHeader();
-                    partialRefreshNextLine();
-                }
-            }
-        }
-    }
-
-    // 定期ICS更新（UI_LIST時のみ — 詳細/設定画面ではCheckAFSRブロック回避）
-    if (ui_state == UI_LIST) {
-        time_t now = time(nullptr);
-        int poll_interval = debug_fetch ? 30 : ((event_count == 0) ? 30 : (config.ics_poll_min * 60));
-        if (now != (time_t)-1 && (now - last_fetch) >= poll_interval) {
-            if (!sd_healthy) {
-                Serial.println("ICS fetch skipped - SD unhealthy");
-                last_fetch = now;
-            } else {
-                // ヒープ断片化 → リブート（String排除後は閾値を大幅引き下げ）
-                if ((int)ESP.getMaxAllocHeap() < 10000) {
-                    Serial.printf("*** REBOOT: heap fragmented, maxBlock:%d ***\n",
-                                  ESP.getMaxAllocHeap());
-                    safeReboot();
-                }
-
-                // WiFi未接続なら再接続
-                if (WiFi.status() != WL_CONNECTED) {
-                    if (!connectWiFi()) {
-                        // ★ WiFi再接続失敗 → 次回poll_intervalまでスキップ（連続リトライ防止）
-                        Serial.println("WiFi reconnect failed, deferring next fetch");
-                        last_fetch = now;
-                    }
-                }
-
-                // フェッチ（ダブルバッファ: 失敗しても旧データ保持）
-                if (WiFi.status() == WL_CONNECTED) {
-                    int before = event_count;
-                    bool changed = fetchAndUpdate();
-                    Serial.printf("Periodic fetch: %d -> %d events\n", before, event_count);
-                    if (changed && ui_state == UI_LIST) { scrollToToday(); partial_refresh_count = 0; drawList(false, false, false, true); }
-                }
-            }
-        }
-    }
-
-    // ハートビート ● 明滅（UI_LIST時のみ、5秒ごと）
-    if (ui_state == UI_LIST && (millis() - last_heartbeat_ms) >= 5000) {
-        last_heartbeat_ms = millis();
-        heartbeat_visible = !heartbeat_visible;
-        heartbeat_canvas.fillCanvas(0);
-        if (heartbeat_visible) {
-            heartbeat_canvas.fillCircle(7, 7, 5, 15);
-        }
-        heartbeat_canvas.pushCanvas(522, 4, UPDATE_MODE_DU);
-    }
+    // 定期処理（スイッチ・SDチェック・自動リフレッシュ・ALARM CHECK・ICS更新・ハートビート・
+    //   自動復帰・日付の切り替わり）
+    dispatchTimers();
 
     // Task WDT フィード（ここに到達 = loop正常動作中）
     esp_task_wdt_reset();
 
     unsigned long loop_dur = millis() - loop_start;
     if (loop_dur > 100) Serial.printf("[LOOP] slow iteration: %lu ms\n", loop_dur);
-    delay(1);
+
+    // 次の締め切りまで眠る（MIDI 再生中・操作直後は従来どおり 1ms）
+    powerIdle();
 }
@@ -3,6 +3,7 @@
  * 
  * Standard SD library compatible MIDI file player
  * Supports: Format 0/1, SysEx, all standard MIDI messages
+ * Source: SD file (streamed) or a caller-owned RAM image (loadFromMemory)
  ******************************************************************************/
 
 #ifndef SIMPLE_MIDI_PLAYER_H
@@ -21,6 +22,8 @@ public:
     ~SimpleMIDIPlayer();
 
     bool load(const char* filename);
+    // Play from a RAM image (e.g. PSRAM). The buffer must outlive playback.
+    bool loadFromMemory(const uint8_t* data, uint32_t len);
     void close();
     void play();
     void stop();
@@ -35,8 +38,17 @@ public:
     // Call this in loop() - returns true if still playing
     bool update();
 
+    // Render-ahead mode (instead of update()): hand out the next event if it falls
+    // at or before until_us of song time (microseconds since play(), following tempo
+    // changes). The callbacks read its time from eventTimeUs(). Returns false when the
+    // next event is later or the song has ended (then isEOF() is true).
+    bool renderNext(uint32_t until_us);
+    uint32_t eventTimeUs() const { return _eventUs; }
+
 private:
     File _file;
+    const uint8_t* _mem;    // RAM image (nullptr = read from _file)
+    uint32_t _memLen;
     bool _playing;
     bool _paused;
     bool _eof;
@@ -64,6 +76,9 @@ private:
     uint32_t _currentTick;
     unsigned long _lastUpdateMicros;
     float _tickDurationMicros;
+    uint32_t _tempoTick;      // tick of the last tempo change
+    double _tempoUs;          // song time at _tempoTick
+    uint32_t _eventUs;        // song time of the event being handed out
     
     // Callbacks
     MidiCallback _midiCb;
@@ -74,6 +89,8 @@ private:
     uint8_t _sysExBuf[SYSEX_BUF_SIZE];
     
     // Internal methods
+    bool parseAll();
+    size_t readAt(uint32_t offset, uint8_t* dst, size_t n);
     bool parseHeader();
     bool parseTrackHeader(int trackIdx);
     uint32_t readVarLen(uint32_t& offset);
@@ -82,6 +99,7 @@ private:
     uint32_t readDWord(uint32_t offset);
     void processTrackEvent(int trackIdx);
     void updateTickDuration();
+    double tickTimeUs(uint32_t tick) const;
     int findNextTrack();
 };
 
@@ -100,6 +118,8 @@ inline SimpleMIDIPlayer::SimpleMIDIPlayer() {
     _ticksPerQuarter = 480;
     _tempo = 500000;  // Default 120 BPM
     _activeTrackCount = 0;
+    _mem = nullptr;
+    _memLen = 0;
 }
 
 inline SimpleMIDIPlayer::~SimpleMIDIPlayer() {
@@ -114,7 +134,18 @@ inline bool SimpleMIDIPlayer::load(const char* filename) {
         Serial.printf("MIDI: Failed to open %s\n", filename);
         return false;
     }
-    
+    return parseAll();
+}
+
+inline bool SimpleMIDIPlayer::loadFromMemory(const uint8_t* data, uint32_t len) {
+    close();
+    if (!data || len < 14) return false;
+    _mem = data;
+    _memLen = len;
+    return parseAll();
+}
+
+inline bool SimpleMIDIPlayer::parseAll() {
     if (!parseHeader()) {
         Serial.println("MIDI: Invalid header");
         close();
@@ -137,18 +168,35 @@ inline bool SimpleMIDIPlayer::load(const char* filename) {
     
     _eof = false;
     _currentTick = 0;
+    _tempo = 500000;
+    _tempoTick = 0;
+    _tempoUs = 0;
+    _eventUs = 0;
     updateTickDuration();
     
-    Serial.printf("MIDI: Loaded - Format %d, %d tracks, %d ticks/quarter\n",
-                  _format, _activeTrackCount, _ticksPerQuarter);
+    Serial.printf("MIDI: Loaded - Format %d, %d tracks, %d ticks/quarter%s\n",
+                  _format, _activeTrackCount, _ticksPerQuarter, _mem ? " (RAM)" : "");
     
     return true;
 }
 
+inline size_t SimpleMIDIPlayer::readAt(uint32_t offset, uint8_t* dst, size_t n) {
+    if (_mem) {
+        if (offset >= _memLen) return 0;
+        if (n > _memLen - offset) n = _memLen - offset;
+        memcpy(dst, _mem + offset, n);
+        return n;
+    }
+    _file.seek(offset);
+    return _file.read(dst, n);
+}
+
 inline void SimpleMIDIPlayer::close() {
     if (_file) {
         _file.close();
     }
+    _mem = nullptr;
+    _memLen = 0;
     _playing = false;
     _paused = false;
     _eof = true;
@@ -194,11 +242,12 @@ inline bool SimpleMIDIPlayer::update() {
     
     unsigned long now = micros();
     unsigned long elapsed = now - _lastUpdateMicros;
-    _lastUpdateMicros = now;
     
-    // Calculate ticks elapsed
-    float ticksElapsed = elapsed / _tickDurationMicros;
-    _currentTick += (uint32_t)ticksElapsed;
+    // Calculate ticks elapsed (keep the fractional tick for the next call,
+    // otherwise frequent updates shorter than one tick never advance)
+    uint32_t ticksElapsed = (uint32_t)(elapsed / _tickDurationMicros);
+    _currentTick += ticksElapsed;
+    _lastUpdateMicros += (unsigned long)(ticksElapsed * _tickDurationMicros);
     
     // Process events from all tracks
     bool anyActive = false;
@@ -235,11 +284,33 @@ inline bool SimpleMIDIPlayer::update() {
     return _playing;
 }
 
+inline bool SimpleMIDIPlayer::renderNext(uint32_t until_us) {
+    if (!_playing || _paused || _eof) {
+        return false;
+    }
+
+    int nextTrack = findNextTrack();
+    if (nextTrack < 0) {
+        _eof = true;
+        _playing = false;
+        Serial.println("MIDI: Playback complete");
+        return false;
+    }
+
+    double at = tickTimeUs(_tracks[nextTrack].nextTick);
+    if (at > until_us) {
+        return false;
+    }
+    _currentTick = _tracks[nextTrack].nextTick;
+    _eventUs = (uint32_t)at;
+    processTrackEvent(nextTrack);
+    return true;
+}
+
 inline bool SimpleMIDIPlayer::parseHeader() {
     uint8_t buf[14];
     
-    _file.seek(0);
-    if (_file.read(buf, 14) != 14) {
+    if (readAt(0, buf, 14) != 14) {
         return false;
     }
     
@@ -283,9 +354,8 @@ inline bool SimpleMIDIPlayer::parseTrackHeader(int trackIdx) {
     uint32_t pos = 14;  // After header
     
     for (int i = 0; i < trackIdx; i++) {
-        _file.seek(pos);
         uint8_t buf[8];
-        if (_file.read(buf, 8) != 8) return false;
+        if (readAt(pos, buf, 8) != 8) return false;
         
         // Skip "MTrk" + length
         if (buf[0] != 'M' || buf[1] != 'T' || buf[2] != 'r' || buf[3] != 'k') {
@@ -298,9 +368,8 @@ inline bool SimpleMIDIPlayer::parseTrackHeader(int trackIdx) {
     }
     
     // Parse this track's header
-    _file.seek(pos);
     uint8_t buf[8];
-    if (_file.read(buf, 8) != 8) return false;
+    if (readAt(pos, buf, 8) != 8) return false;
     
     if (buf[0] != 'M' || buf[1] != 'T' || buf[2] != 'r' || buf[3] != 'k') {
         return false;
@@ -324,9 +393,8 @@ inline uint32_t SimpleMIDIPlayer::readVarLen(uint32_t& offset) {
     uint32_t value = 0;
     uint8_t b;
     
-    _file.seek(offset);
     do {
-        if (_file.read(&b, 1) != 1) {
+        if (readAt(offset, &b, 1) != 1) {
             return 0;
         }
         offset++;
@@ -338,8 +406,7 @@ inline uint32_t SimpleMIDIPlayer::readVarLen(uint32_t& offset) {
 
 inline uint8_t SimpleMIDIPlayer::readByte(uint32_t& offset) {
     uint8_t b = 0;
-    _file.seek(offset);
-    _file.read(&b, 1);
+    readAt(offset, &b, 1);
     offset++;
     return b;
 }
@@ -349,6 +416,10 @@ inline void SimpleMIDIPlayer::updateTickDuration() {
     _tickDurationMicros = (float)_tempo / (float)_ticksPerQuarter;
 }
 
+inline double SimpleMIDIPlayer::tickTimeUs(uint32_t tick) const {
+    return _tempoUs + (double)(tick - _tempoTick) * _tickDurationMicros;
+}
+
 inline int SimpleMIDIPlayer::findNextTrack() {
     int next = -1;
     uint32_t minTick = 0xFFFFFFFF;
@@ -410,8 +481,7 @@ inline void SimpleMIDIPlayer::processTrackEvent(int trackIdx) {
         uint32_t len = readVarLen(track.offset);
         if (len < SYSEX_BUF_SIZE - 1) {
             _sysExBuf[0] = 0xF0;
-            _file.seek(track.offset);
-            _file.read(_sysExBuf + 1, len);
+            readAt(track.offset, _sysExBuf + 1, len);
             track.offset += len;
             
             if (_sysExCb) {
@@ -436,8 +506,9 @@ inline void SimpleMIDIPlayer::processTrackEvent(int trackIdx) {
         if (metaType == 0x51 && len == 3) {
             // Tempo change
             uint8_t t[3];
-            _file.seek(track.offset);
-            _file.read(t, 3);
+            readAt(track.offset, t, 3);
+            _tempoUs = tickTimeUs(track.nextTick);
+            _tempoTick = track.nextTick;
             _tempo = ((uint32_t)t[0] << 16) | ((uint32_t)t[1] << 8) | t[2];
             updateTickDuration();
             // Serial.printf("MIDI: Tempo change -> %d us/quarter\n", _tempo);
@@ -0,0 +1,155 @@
+#include "globals.h"
+#include <SD.h>
+#include <time.h>
+
+//==============================================================================
+// アラーム発火済みジャーナル（SD 追記専用）
+//   setAlarmTriggered のたびに (uid_hash, alarm_time) の 8byte を追記し、
+//   起動時に全件を読み戻してハッシュ集合に入れる。safeReboot・ヒープ起因の再起動を
+//   またいでも「鳴らしたアラーム」を正確に判定でき、再鳴動を防げる。
+//
+//   集合が「鳴ったかどうか」を知っているので、起動時グレース（未記録のアラームを
+//   発火済み扱いにする閾値）は JOURNAL_BOOT_GRACE_SEC まで広げ、再起動中に
+//   時刻を迎えたアラームも遅れて鳴らす。
+//
+//   ファイルは表示ウィンドウより古い記録を捨てて定期的に詰め直す（fetch 成功時）。
+//   末尾の書きかけレコード（8byte 未満）は読み飛ばす。
+//==============================================================================
+
+#define JOURNAL_FILE            "/alarm_ack.log"
+#define JOURNAL_TMP_FILE        "/alarm_ack.tmp"
+#define JOURNAL_SET_SIZE        2048    // ハッシュ集合の容量（2の冪、使用率 3/4 まで）
+#define JOURNAL_COMPACT_RECORDS 256     // ファイル上のレコード数がこれを超えたら詰め直し
+#define JOURNAL_KEEP_SEC        (8 * 86400)     // 過去ウィンドウ(7日) + 1日
+#define JOURNAL_BOOT_GRACE_SEC  1800    // ジャーナル有効時の起動グレース（従来 600s）
+#define LEGACY_BOOT_GRACE_SEC   600     // ジャーナルが使えない場合（SD不調）
+
+struct AckRecord {
+    uint32_t uid_hash;
+    uint32_t alarm_time;
+};
+
+static AckRecord* ack_set = nullptr;    // PSRAM。alarm_time==0 は空き
+static int  ack_count = 0;
+static int  file_records = 0;           // ファイル上のレコード数（詰め直し判定用）
+static bool journal_ready = false;
+
+static inline uint32_t ackSlot(uint32_t uid, uint32_t at) {
+    return (uid ^ (at * 2654435761u)) & (JOURNAL_SET_SIZE - 1);
+}
+
+// 戻り値: 1=追加, 0=既知, -1=満杯（次の詰め直しまで集合に入らない）
+static int setInsert(uint32_t uid, uint32_t at) {
+    if (at == 0) return 0;
+    uint32_t s = ackSlot(uid, at);
+    while (ack_set[s].alarm_time != 0) {
+        if (ack_set[s].uid_hash == uid && ack_set[s].alarm_time == at) return 0;
+        s = (s + 1) & (JOURNAL_SET_SIZE - 1);
+    }
+    if (ack_count >= JOURNAL_SET_SIZE * 3 / 4) return -1;
+    ack_set[s] = { uid, at };
+    ack_count++;
+    return 1;
+}
+
+static bool setContains(uint32_t uid, uint32_t at) {
+    uint32_t s = ackSlot(uid, at);
+    while (ack_set[s].alarm_time != 0) {
+        if (ack_set[s].uid_hash == uid && ack_set[s].alarm_time == at) return true;
+        s = (s + 1) & (JOURNAL_SET_SIZE - 1);
+    }
+    return false;
+}
+
+// 起動時: ファイル全件を集合へ（O(n)、重複は1件に畳む）
+void replayAlarmJournal() {
+    unsigned long t0 = millis();
+    if (!ack_set) ack_set = (AckRecord*)ps_malloc(JOURNAL_SET_SIZE * sizeof(AckRecord));
+    if (!ack_set) {
+        Serial.println("JOURNAL: PSRAM alloc failed - disabled");
+        return;
+    }
+    memset(ack_set, 0, JOURNAL_SET_SIZE * sizeof(AckRecord));
+    ack_count = 0;
+    file_records = 0;
+    journal_ready = sd_healthy;
+    if (!sd_healthy) return;
+
+    waitEPDReady();
+    File f = SD.open(JOURNAL_FILE, FILE_READ);
+    if (f) {
+        AckRecord buf[64];
+        int n;
+        while ((n = f.read((uint8_t*)buf, sizeof(buf))) > 0) {
+            int recs = n / (int)sizeof(AckRecord);      // 書きかけの端数は捨てる
+            for (int i = 0; i < recs; i++) setInsert(buf[i].uid_hash, buf[i].alarm_time);
+            file_records += recs;
+            if (n < (int)sizeof(buf)) break;
+        }
+        f.close();
+    }
+    Serial.printf("JOURNAL: replayed %d records -> %d acks (%lums)\n",
+                  file_records, ack_count, millis() - t0);
+}
+
+// 発火済みを1件追記（8byte。ファイル全体の書き直しはしない）
+void journalAlarmAck(uint32_t uid_hash, time_t alarm_time) {
+    if (!journal_ready || !ack_set) return;
+    if (setInsert(uid_hash, (uint32_t)alarm_time) == 0) return;    // 既知
+    if (!sd_healthy) return;
+    AckRecord r = { uid_hash, (uint32_t)alarm_time };
+    waitEPDReady();
+    File f = SD.open(JOURNAL_FILE, FILE_APPEND);
+    if (!f) {
+        Serial.println("JOURNAL: append open failed");
+        return;
+    }
+    f.write((const uint8_t*)&r, sizeof(r));
+    f.close();
+    file_records++;
+}
+
+bool alarmAcked(uint32_t uid_hash, time_t alarm_time) {
+    return journal_ready && ack_set && setContains(uid_hash, (uint32_t)alarm_time);
+}
+
+// 起動時（初回 fetch・スナップショット復元）に、未記録のアラームを鳴らさず発火済みとするか
+//   ジャーナルに記録あり → 鳴らした。記録なし → グレース内なら遅れてでも鳴らす
+bool alarmBootSuppressed(uint32_t uid_hash, time_t alarm_time, time_t now) {
+    if (alarmAcked(uid_hash, alarm_time)) return true;
+    time_t grace = journal_ready ? JOURNAL_BOOT_GRACE_SEC : LEGACY_BOOT_GRACE_SEC;
+    return alarm_time < now - grace;
+}
+
+// 古い記録を捨ててファイルを詰め直す（fetch 成功時に呼ぶ。閾値未満なら何もしない）
+void compactAlarmJournal(time_t now) {
+    if (!journal_ready || !ack_set || !sd_healthy) return;
+    bool set_full = ack_count >= JOURNAL_SET_SIZE * 3 / 4 - 16;
+    if (file_records <= JOURNAL_COMPACT_RECORDS && !set_full) return;
+    unsigned long t0 = millis();
+
+    // 保持期間内の記録だけを抜き出して集合を作り直す
+    AckRecord* live = (AckRecord*)ps_malloc(JOURNAL_SET_SIZE * sizeof(AckRecord));
+    if (!live) return;
+    uint32_t cutoff = (uint32_t)(now - JOURNAL_KEEP_SEC);
+    int keep = 0;
+    for (int s = 0; s < JOURNAL_SET_SIZE; s++) {
+        if (ack_set[s].alarm_time != 0 && ack_set[s].alarm_time >= cutoff) live[keep++] = ack_set[s];
+    }
+    memset(ack_set, 0, JOURNAL_SET_SIZE * sizeof(AckRecord));
+    ack_count = 0;
+    for (int i = 0; i < keep; i++) setInsert(live[i].uid_hash, live[i].alarm_time);
+
+    waitEPDReady();
+    File f = SD.open(JOURNAL_TMP_FILE, FILE_WRITE);
+    bool ok = f && f.write((const uint8_t*)live, keep * sizeof(AckRecord)) == keep * sizeof(AckRecord);
+    if (f) f.close();
+    free(live);
+    if (ok) {
+        SD.remove(JOURNAL_FILE);
+        ok = SD.rename(JOURNAL_TMP_FILE, JOURNAL_FILE);
+    }
+    Serial.printf("JOURNAL: compacted %d -> %d records%s (%lums)\n",
+                  file_records, keep, ok ? "" : " [WRITE FAILED]", millis() - t0);
+    if (ok) file_records = keep;
+}
@@ -0,0 +1,113 @@
+#ifndef ALARM_SCHED_H
+#define ALARM_SCHED_H
+
+//==============================================================================
+// アラーム発火の方針（プラットフォーム非依存・ヘッダオンリー）
+//   - 発火判定は画面（UiState）に依存しない。メインループ先頭と、長い処理の
+//     途中に置いた割り込み点（alarmPreemptPoint）の両方で alarmActionFor() に従う
+//   - 割り込み点を置けない処理（WiFi接続・TLSハンドシェイクなど）は、見込み時間内に
+//     アラームが来るなら始めない（alarmGuardAllows）
+//   - 画面ごとに処理が重くても、割り込み点の間隔 + 1ループ分が予算
+//     ALARM_LATENCY_BUDGET_MS に収まっていれば遅延は予算内
+//
+//   ホスト側シミュレーション tools/alarmsim からも同じコードを使う。
+//==============================================================================
+#include <stdint.h>
+#include <math.h>
+
+#define ALARM_LATENCY_BUDGET_MS  1000    // 期限到来 → 鳴動開始までの上限
+#define ALARM_GUARD_MARGIN_MS    2000    // ブロック処理の見込み時間に足す余裕
+
+enum AlarmAction {
+    ALARM_NONE,             // 期限到来の未発火なし
+    ALARM_FIRE,             // すぐ鳴らす（どの画面でも）
+    ALARM_PREEMPT_TEST,     // サウンドテストを止めて鳴らす
+    ALARM_QUEUE             // 別のアラームが鳴動中 → 鳴り終わってから
+};
+
+// due: 期限到来の未発火あり / playing: MIDI 再生中 / alarm_playing: 再生中なのがアラーム
+inline AlarmAction alarmActionFor(bool due, bool playing, bool alarm_playing) {
+    if (!due) return ALARM_NONE;
+    if (!playing) return ALARM_FIRE;
+    return alarm_playing ? ALARM_QUEUE : ALARM_PREEMPT_TEST;
+}
+
+// 見込み block_ms の割り込めない処理を now_ms から始めてよいか
+//   next_due_ms: 最早の未発火アラーム時刻（0 = なし。期限到来済みなら常に不可）
+inline bool alarmGuardAllows(uint64_t now_ms, uint64_t next_due_ms, uint32_t block_ms) {
+    if (next_due_ms == 0) return true;
+    return now_ms + block_ms + ALARM_GUARD_MARGIN_MS < next_due_ms;
+}
+
+// 発火遅延の集計（ALARM CHECK ログ・シミュレーション共通）
+struct AlarmLatencyStats {
+    uint32_t count;
+    uint32_t total_ms;
+    uint32_t worst_ms;
+    uint32_t over_budget;   // ALARM_LATENCY_BUDGET_MS 超過回数
+
+    void add(uint32_t ms) {
+        count++;
+        total_ms += ms;
+        if (ms > worst_ms) worst_ms = ms;
+        if (ms >= ALARM_LATENCY_BUDGET_MS) over_budget++;
+    }
+    uint32_t avg() const { return count ? total_ms / count : 0; }
+};
+
+// 発火タイミングの区間（alarm_timing.cpp が1発火ごとに記録し、SD に保存して再起動をまたぐ）
+enum AlarmStage {
+    AST_DETECT,     // 予定時刻 → 監視タスクが検知
+    AST_SERVICE,    // 検知 → checkAlarms が発火
+    AST_LOAD,       // 発火 → MIDI 再生開始（先読みイメージ / SD 読み込み）
+    AST_UART,       // 再生開始 → 最初の UART 送信バイト
+    AST_TOTAL,      // 予定時刻 → 最初の UART 送信バイト（予算の判定対象）
+    AST_COUNT
+};
+
+// 固定バケットのヒストグラム。バケット i は [edge[i-1], edge[i]) ms、最後は上限なし
+#define ALARM_HIST_BUCKETS  12
+static const uint16_t alarm_hist_edges_ms[ALARM_HIST_BUCKETS - 1] = {
+    5, 10, 20, 50, 100, 200, 500, 1000, 2000, 5000, 10000
+};
+
+struct AlarmHistogram {
+    uint32_t bucket[ALARM_HIST_BUCKETS];
+    uint32_t count;
+    uint32_t worst_ms;
+    uint32_t over_budget;   // ALARM_LATENCY_BUDGET_MS 以上
+    uint32_t reserved;
+    uint64_t total_ms;
+    uint64_t total_sq;      // 二乗和（ばらつき = 標準偏差）
+
+    void add(uint32_t ms) {
+        int b = 0;
+        while (b < ALARM_HIST_BUCKETS - 1 && ms >= alarm_hist_edges_ms[b]) b++;
+        bucket[b]++;
+        count++;
+        total_ms += ms;
+        total_sq += (uint64_t)ms * ms;
+        if (ms > worst_ms) worst_ms = ms;
+        if (ms >= ALARM_LATENCY_BUDGET_MS) over_budget++;
+    }
+    uint32_t avg() const { return count ? (uint32_t)(total_ms / count) : 0; }
+    uint32_t stddev() const {
+        if (count < 2) return 0;
+        double m = (double)total_ms / count;
+        double v = (double)total_sq / count - m * m;
+        return v > 0 ? (uint32_t)(sqrt(v) + 0.5) : 0;
+    }
+    // p パーセンタイルが入るバケットの上端（ms）。最後のバケットなら worst_ms
+    uint32_t percentile(int p) const {
+        if (count == 0) return 0;
+        uint64_t need = ((uint64_t)count * p + 99) / 100;
+        uint64_t acc = 0;
+        for (int b = 0; b < ALARM_HIST_BUCKETS - 1; b++) {
+            acc += bucket[b];
+            if (acc >= need) return alarm_hist_edges_ms[b] < worst_ms ? alarm_hist_edges_ms[b] : worst_ms;
+        }
+        return worst_ms;
+    }
+};
+
+#endif // ALARM_SCHED_H
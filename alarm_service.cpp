@@ -0,0 +1,312 @@
+#include "globals.h"
+#include "alarm_sched.h"
+#include <time.h>
+
+//==============================================================================
+// 画面に依存しないアラーム発火
+//   以前は checkAlarms() を UI_LIST のときだけ呼んでいたため、設定・キーボード・
+//   MIDI選択などの画面に置いたままだとアラームが黙って遅れていた。
+//
+//   監視タスク（優先度 loopTask より上、100ms 周期）
+//     - event_index が公開する最早の未発火時刻 alarmHeadTime() と時計を比べ、
+//       期限が来たら alarm_due を立てて検知時刻を記録するだけ
+//     - 鳴動そのものはメインループ側で行う（MIDI は SD から読み、SD と EPD は
+//       同じ SPI バスを共有するため、別タスクからは安全に触れない）
+//     - 予算 ALARM_LATENCY_BUDGET_MS を過ぎても鳴っていなければ ALARM LATE をログ
+//   メインループ側
+//     - checkAlarms() は毎ループ全画面で呼ぶ（判定はヒープ先頭を見るだけ）
+//     - fetch のストリーム受信・設定画面のメッセージ待ちなど長い処理の途中には
+//       alarmPreemptPoint() を置き、そこで発火・MIDI 更新を行う
+//     - 割り込めない処理（WiFi接続・TLS接続）は alarmAllowsBlocking() で
+//       直前のアラームと重なるなら始めない
+//   鳴動前の画面は alarm_return_state に覚え、鳴り終わったら描き直して戻る
+//==============================================================================
+
+#define ALARM_TASK_PERIOD_MS    100
+#define ALARM_TASK_STACK        2048
+#define ALARM_TASK_PRIORITY     3       // loopTask(1) より上
+
+static volatile bool     alarm_due = false;     // 監視タスク → メインループ
+static volatile uint32_t alarm_due_ms = 0;      // 期限到来を検知した millis()
+static volatile uint32_t alarm_due_at = 0;      // 検知したアラーム時刻（UNIX秒）
+static TaskHandle_t      alarm_task = nullptr;
+static UiState           alarm_return_state = UI_LIST;
+static AlarmLatencyStats alarm_latency = {};
+static bool              in_preempt = false;
+
+static void alarmTaskMain(void*) {
+    bool late_logged = false;
+    for (;;) {
+        uint32_t head = alarmHeadTime();
+        uint32_t now = (uint32_t)time(nullptr);
+        if (head != 0 && now >= head) {
+            if (!alarm_due || alarm_due_at != head) {
+                alarm_due_at = head;
+                alarm_due_ms = millis();
+                alarm_due = true;
+                late_logged = false;
+            } else if (!late_logged && millis() - alarm_due_ms > ALARM_LATENCY_BUDGET_MS && !midi_playing) {
+                // 鳴動中のアラーム待ち（ALARM_QUEUE）は除く
+                late_logged = true;
+                Serial.printf("ALARM LATE: due %lus ago, not serviced (ui_state=%d)\n",
+                              (unsigned long)(now - head), (int)ui_state);
+            }
+        } else {
+            alarm_due = false;
+        }
+        vTaskDelay(pdMS_TO_TICKS(ALARM_TASK_PERIOD_MS));
+    }
+}
+
+void startAlarmTask() {
+    if (alarm_task) return;
+    BaseType_t ok = xTaskCreatePinnedToCore(alarmTaskMain, "alarm", ALARM_TASK_STACK, nullptr,
+                                            ALARM_TASK_PRIORITY, &alarm_task, 1);
+    Serial.printf("Alarm watch task %s (period %dms, budget %dms)\n",
+                  ok == pdPASS ? "started" : "FAILED", ALARM_TASK_PERIOD_MS, ALARM_LATENCY_BUDGET_MS);
+}
+
+// 長い処理の途中で呼ぶ: 再生中の MIDI を進め、期限が来ていれば発火する
+void alarmPreemptPoint() {
+    if (in_preempt) return;
+    in_preempt = true;
+    if (midi_playing) updateMidiPlayback();
+    if (alarm_due) checkAlarms();
+    in_preempt = false;
+}
+
+// 割り込み点の中（fetch の受信中など）か。ここからはネットワーク・長い SD 処理を始めない
+bool alarmInPreempt() {
+    return in_preempt;
+}
+
+// 割り込み点つきの待ち。アラームで鳴動画面に切り替わったら打ち切る
+//   呼び出し側は戻った後 ui_state を確認してから自分の画面を描き直すこと
+void alarmAwareDelay(uint32_t ms) {
+    unsigned long t0 = millis();
+    while (millis() - t0 < ms && ui_state != UI_PLAYING) {
+        alarmPreemptPoint();
+        delay(20);
+    }
+}
+
+// 見込み block_ms の割り込めない処理を今始めてよいか
+bool alarmAllowsBlocking(uint32_t block_ms, const char* what) {
+    uint32_t head = alarmHeadTime();
+    uint64_t now_ms = (uint64_t)time(nullptr) * 1000;
+    if (alarmGuardAllows(now_ms, (uint64_t)head * 1000, block_ms)) return true;
+    static uint32_t logged_head = 0;
+    if (logged_head != head) {
+        logged_head = head;
+        Serial.printf("%s held: alarm due in %lds (needs %lums + %dms margin)\n",
+                      what, (long)head - (long)(now_ms / 1000), (unsigned long)block_ms, ALARM_GUARD_MARGIN_MS);
+    }
+    return false;
+}
+
+// checkAlarms から: 発火直前の判定。false なら今は鳴らさない（別のアラームが鳴動中）
+bool beginAlarmFire(time_t scheduled) {
+    AlarmAction act = alarmActionFor(true, midi_playing, playing_event >= 0);
+    if (act == ALARM_QUEUE) return false;
+    if (act == ALARM_PREEMPT_TEST) {
+        Serial.println("  Sound test preempted by alarm");
+        stopMidiPlayback();
+        alarm_return_state = UI_SETTINGS;   // サウンドテストは設定画面から
+    } else {
+        alarm_return_state = ui_state;
+    }
+    uint32_t lat = alarm_due ? millis() - alarm_due_ms : 0;
+    alarm_latency.add(lat);
+    Serial.printf("  Latency: %lums from ui_state=%d (worst %lums, over budget %lu/%lu)\n",
+                  (unsigned long)lat, (int)alarm_return_state, (unsigned long)alarm_latency.worst_ms,
+                  (unsigned long)alarm_latency.over_budget, (unsigned long)alarm_latency.count);
+    alarm_due = false;
+    alarmTimingFire(scheduled, lat);
+    return true;
+}
+
+// finishAlarm から: 鳴動前の画面に戻る（一覧なら今日へスクロール）
+//   redraw=false は鳴らせなかったとき — 覚えた画面を捨てるだけ
+void returnFromAlarm(bool redraw) {
+    UiState back = alarm_return_state;
+    alarm_return_state = UI_LIST;
+    alarmTimingEnd();       // 区間ヒストグラムを SD へ（描き直しの前に）
+    if (!redraw) return;
+    if (back == UI_DETAIL && (selected_event < 0 || selected_event >= event_count)) back = UI_LIST;
+    if (back == UI_PLAYING) back = UI_LIST;
+    ui_state = back;
+    if (back != UI_LIST) Serial.printf("ALARM: returning to ui_state=%d\n", (int)back);
+    switch (back) {
+        case UI_DETAIL:      drawDetail(selected_event); break;
+        case UI_SETTINGS:    drawSettings(); break;
+        case UI_KEYBOARD:    drawKeyboard(); break;
+        case UI_MIDI_SELECT: drawMidiSelect(); break;
+        case UI_BAUD_SELECT: drawBaudSelect(); break;
+        case UI_PORT_SELECT: drawPortSelect(); break;
+        case UI_MONTH:       drawMonth(); break;
+        case UI_SEARCH:      drawSearch(); break;
+        default:
+            scrollToToday();
+            drawList();
+            break;
+    }
+}
+
+void reportAlarmLatency() {
+    if (alarm_latency.count == 0) return;
+    Serial.printf("  alarm latency: avg %lums worst %lums (n=%lu, over %dms: %lu)\n",
+                  (unsigned long)alarm_latency.avg(), (unsigned long)alarm_latency.worst_ms,
+                  (unsigned long)alarm_latency.count, ALARM_LATENCY_BUDGET_MS,
+                  (unsigned long)alarm_latency.over_budget);
+}
+
+//==============================================================================
+// 鳴動グループ（同時刻・重なったアラーム）
+//   以前は同時刻の2件目が1件目の鳴り終わり → 一覧の描き直しの後に改めて鳴り、
+//   鳴動中に期限が来たアラームは鳴り終わるまで見られもしなかった。
+//   発火時に期限到来済みの未発火をまとめて1グループにし、鳴動中に期限が来た
+//   アラームも checkAlarms → ringGroupJoin() でグループに加える。
+//     config.alarm_merge = true  … まとめて鳴らす: 先頭のアラームの MIDI を1回鳴らし、
+//                                  鳴動画面に全件を並べる。鳴り終わりで全件を発火済みに
+//     config.alarm_merge = false … 順番に鳴らす: 鳴り終わったら一覧へ戻らずに次を鳴らす
+//   2件以上のグループは鳴動時間の合計を ALARM_GROUP_MAX_MS までに抑え、
+//   使い切ったら残りは鳴らさずに発火済みにする。
+//   ntfy は発火時にまとめて積む（同時に積んだ分はワーカーが1リクエストにまとめる）。
+//   メンバーは版をまたぐ参照で持つ（鳴動中の fetch で index が変わっても追える）
+//==============================================================================
+struct RingMember {
+    EventRef ref;
+    uint32_t at;            // アラーム時刻
+    uint8_t  slot;
+    bool     taken;         // 鳴らした / 鳴らさないと決めた
+};
+static RingMember group[ALARM_GROUP_MAX];
+static int        group_n = 0;
+static int        group_cur = -1;       // 鳴動中のメンバー
+static uint32_t   group_start_ms = 0;
+
+static int memberIndex(int evt, int slot) {
+    for (int k = 0; k < group_n; k++) {
+        if (group[k].slot == slot && group[k].at == (uint32_t)events[evt].alarm_time[slot] &&
+            group[k].ref.uid_hash == events[evt].uid_hash && group[k].ref.start == events[evt].start) return k;
+    }
+    return -1;
+}
+
+static void addMember(int evt, int slot) {
+    RingMember& m = group[group_n++];
+    m.ref = makeEventRef(evt);
+    m.at = (uint32_t)events[evt].alarm_time[slot];
+    m.slot = (uint8_t)slot;
+    m.taken = false;
+}
+
+// 現在の版での index（消えた・アラームが変わったら -1）
+static int resolveMember(RingMember& m) {
+    int evt = resolveEventRef(m.ref);
+    if (evt < 0 || m.slot >= events[evt].alarm_count || (uint32_t)events[evt].alarm_time[m.slot] != m.at) return -1;
+    return evt;
+}
+
+static uint32_t groupLeftMs() {
+    uint32_t used = millis() - group_start_ms;
+    return used < ALARM_GROUP_MAX_MS ? ALARM_GROUP_MAX_MS - used : 0;
+}
+
+// 2件以上になったら、鳴動中のアラームをグループの残り時間で打ち切る
+static void capCurrentRing() {
+    if (group_n < 2) return;
+    uint32_t cap = (millis() - play_start_ms) + groupLeftMs();
+    if (play_duration_ms == 0 || (uint32_t)play_duration_ms > cap) play_duration_ms = cap;
+}
+
+// checkAlarms から: evts[0] を鳴らす直前。同時刻の分をまとめて登録
+void ringGroupBegin(const int* evts, const uint8_t* slots, int n) {
+    group_n = 0;
+    for (int k = 0; k < n && k < ALARM_GROUP_MAX; k++) addMember(evts[k], slots[k]);
+    group_cur = 0;
+    group[0].taken = true;
+    group_start_ms = millis();
+    if (group_n > 1) {
+        Serial.printf("ALARM GROUP: %d alarms at the same time (%s)\n",
+                      group_n, config.alarm_merge ? "merged" : "back to back");
+    }
+}
+
+// 先頭の鳴動時間の上限（0 = 単独なので制限なし）
+uint32_t ringGroupBudgetMs() {
+    return group_n > 1 ? groupLeftMs() : 0;
+}
+
+// 鳴動中に期限が来たアラームをグループに加える
+void ringGroupJoin(time_t now) {
+    if (group_n == 0) return;
+    int evts[ALARM_GROUP_MAX];
+    uint8_t slots[ALARM_GROUP_MAX];
+    int n = findDueAlarms(now, evts, slots, ALARM_GROUP_MAX);
+    int joined = 0;
+    for (int k = 0; k < n && group_n < ALARM_GROUP_MAX; k++) {
+        if (memberIndex(evts[k], slots[k]) >= 0) continue;
+        addMember(evts[k], slots[k]);
+        joined++;
+        Serial.printf("ALARM GROUP: joined %s (%d in group)\n", events[evts[k]].summary(), group_n);
+        char msg[200];
+        formatAlarmNotice(evts[k], slots[k], msg, sizeof(msg));
+        enqueueNtfy("M5Paper Alarm", msg);
+    }
+    alarm_due = false;
+    if (joined == 0) return;
+
+    if (config.alarm_merge && play_duration_ms > 0) {
+        // 鳴り終わり間際に加わったら少し延ばす（合計の上限まで）
+        uint32_t elapsed = millis() - play_start_ms;
+        if ((uint32_t)play_duration_ms < elapsed + ALARM_JOIN_MIN_MS) play_duration_ms = elapsed + ALARM_JOIN_MIN_MS;
+    }
+    capCurrentRing();
+    if (ui_state == UI_PLAYING && playing_event >= 0) drawPlaying(playing_event);
+}
+
+// finishAlarm から（まとめモード）: 一緒に鳴らした残りのメンバーを発火済みに
+void ringGroupAckAll() {
+    for (int k = 0; k < group_n; k++) {
+        if (k == group_cur || group[k].taken) continue;
+        group[k].taken = true;
+        int evt = resolveMember(group[k]);
+        if (evt >= 0) setAlarmTriggered(evt, group[k].slot);
+    }
+}
+
+// 次のメンバーを鳴らす（順番モードの鳴り終わり・先頭が鳴らせなかったとき）
+//   false ならグループは終わり（呼び出し側で鳴動前の画面へ戻る）
+bool ringGroupAdvance() {
+    for (int k = 0; k < group_n; k++) {
+        if (group[k].taken) continue;
+        group[k].taken = true;
+        int evt = resolveMember(group[k]);
+        if (evt < 0 || events[evt].triggered[group[k].slot]) continue;     // fetch で消えた・変わった
+        uint32_t left = groupLeftMs();
+        if (left < 1000) {
+            Serial.printf("ALARM GROUP: %s skipped (group ring time %ds used up)\n",
+                          events[evt].summary(), ALARM_GROUP_MAX_MS / 1000);
+            setAlarmTriggered(evt, group[k].slot);
+            continue;
+        }
+        group_cur = k;
+        Serial.printf("ALARM GROUP: next %d/%d, %lus left\n", k + 1, group_n, (unsigned long)(left / 1000));
+        if (startAlarmRing(evt, group[k].slot, group_n > 1 ? left : 0)) return true;
+    }
+    group_n = 0;
+    group_cur = -1;
+    return false;
+}
+
+// 鳴動画面用: 鳴動中以外のメンバー（まとめモードは一緒に鳴っている分、順番モードはこの後の分）
+int ringGroupOthers(int* evts, int max) {
+    int n = 0;
+    for (int k = 0; k < group_n && n < max; k++) {
+        if (k == group_cur || group[k].taken) continue;
+        int evt = resolveMember(group[k]);
+        if (evt >= 0) evts[n++] = evt;
+    }
+    return n;
+}
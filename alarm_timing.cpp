@@ -0,0 +1,192 @@
+#include "globals.h"
+#include "alarm_sched.h"
+#include <SD.h>
+#include <sys/time.h>
+
+//==============================================================================
+// 発火タイミングの計測（区間別ヒストグラム、SD に保存）
+//   1発火ごとに4つの時刻を取り、区間ごとの固定バケットヒストグラムに加える。
+//     予定時刻   アラーム時刻（UNIX秒）
+//     検知       監視タスクが期限到来を見つけた時刻（checkAlarms が先なら発火と同時）
+//     読み込み   MIDI 再生開始（先読みイメージへの張り直し / SD からの読み込み完了）
+//     UART       最初のバイトを Serial2 に書いた時刻（MIDI 出力タスクが記録）
+//   区間は alarm_sched.h の AlarmStage。AST_TOTAL（予定 → UART）が予算の判定対象。
+//   予定と検知は壁時計（gettimeofday, ms）、それ以降は micros() で測る。
+//
+//   鳴り終わり（returnFromAlarm）で SD に書き出し、起動時に読み戻すので、
+//   再起動をまたいで累積する。UART まで届かなかった発火（再生失敗・無音ファイル）は
+//   incomplete として数える。毎分の ALARM CHECK に区間ごとの分位点とバケットを出す。
+//   形式を変えたら TIMING_VERSION を上げる（合わないファイルは読まずに捨てる）。
+//==============================================================================
+
+#define TIMING_FILE         "/alarm_timing.bin"
+#define TIMING_TMP_FILE     "/alarm_timing.tmp"
+#define TIMING_MAGIC        "M5AT"
+#define TIMING_VERSION      1
+
+struct TimingHeader {
+    char     magic[4];
+    uint16_t version;
+    uint16_t header_size;
+    uint16_t stage_count;       // AST_COUNT
+    uint16_t bucket_count;      // ALARM_HIST_BUCKETS
+    uint32_t incomplete;
+    int64_t  since;             // 集計開始（最初の発火）
+    uint32_t checksum;          // ヒストグラム部の icsHash32
+    uint32_t reserved;
+};
+
+static AlarmHistogram hist[AST_COUNT];
+static uint32_t incomplete = 0;
+static int64_t  since = 0;
+static bool     dirty = false;
+
+// 計測中の1発火（UART バイトは MIDI コールバックから記録する）
+static bool     pending = false;
+static bool     loaded = false;
+static uint32_t detect_ms = 0;          // 予定 → 検知
+static uint32_t service_ms = 0;         // 検知 → 発火
+static uint32_t fire_us = 0, load_us = 0;
+
+static const char* stage_names[AST_COUNT] = {
+    "sched->detect", "detect->fire", "fire->loaded", "loaded->uart", "sched->uart"
+};
+
+static int64_t wallMs() {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return (int64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+}
+
+// beginAlarmFire から: 発火の瞬間。since_detect_ms は監視タスクの検知からの経過
+void alarmTimingFire(time_t scheduled, uint32_t since_detect_ms) {
+    fire_us = micros();
+    int64_t lag = wallMs() - since_detect_ms - (int64_t)scheduled * 1000;
+    detect_ms = lag > 0 ? (uint32_t)lag : 0;
+    service_ms = since_detect_ms;
+    loaded = false;
+    pending = true;
+    if (since == 0) since = (int64_t)scheduled;
+}
+
+// MIDI 再生開始（startArmedPlayback / startMidiPlayback）
+void alarmTimingLoaded() {
+    if (!pending || loaded) return;
+    load_us = micros();
+    loaded = true;
+}
+
+// MIDI 再生から: 出力タスクが最初のバイトを書いた時刻（micros()）で1発火分を確定
+void alarmTimingUartByte(uint32_t uart_us) {
+    if (!pending || !loaded) return;
+    pending = false;
+    uint32_t load_ms = (load_us - fire_us) / 1000;
+    uint32_t uart_ms = (uart_us - load_us) / 1000;
+    uint32_t total = detect_ms + service_ms + (uart_us - fire_us) / 1000;
+    hist[AST_DETECT].add(detect_ms);
+    hist[AST_SERVICE].add(service_ms);
+    hist[AST_LOAD].add(load_ms);
+    hist[AST_UART].add(uart_ms);
+    hist[AST_TOTAL].add(total);
+    dirty = true;
+    Serial.printf("ALARM TIMING: detect %lums + fire %lums + load %lums + uart %lums = %lums%s\n",
+                  (unsigned long)detect_ms, (unsigned long)service_ms, (unsigned long)load_ms,
+                  (unsigned long)uart_ms, (unsigned long)total,
+                  total >= ALARM_LATENCY_BUDGET_MS ? " (OVER BUDGET)" : "");
+}
+
+static void saveAlarmTiming() {
+    if (!sd_healthy) return;
+    TimingHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, TIMING_MAGIC, 4);
+    h.version = TIMING_VERSION;
+    h.header_size = sizeof(TimingHeader);
+    h.stage_count = AST_COUNT;
+    h.bucket_count = ALARM_HIST_BUCKETS;
+    h.incomplete = incomplete;
+    h.since = since;
+    h.checksum = icsHash32(hist, sizeof(hist));
+
+    waitEPDReady();
+    File f = SD.open(TIMING_TMP_FILE, FILE_WRITE);
+    if (!f) {
+        Serial.println("TIMING: cannot open " TIMING_TMP_FILE);
+        return;
+    }
+    bool ok = f.write((const uint8_t*)&h, sizeof(h)) == sizeof(h) &&
+              f.write((const uint8_t*)hist, sizeof(hist)) == sizeof(hist);
+    f.close();
+    if (!ok) {
+        Serial.println("TIMING: write failed");
+        SD.remove(TIMING_TMP_FILE);
+        return;
+    }
+    SD.remove(TIMING_FILE);
+    if (!SD.rename(TIMING_TMP_FILE, TIMING_FILE)) {
+        Serial.println("TIMING: rename failed");
+        return;
+    }
+    dirty = false;
+}
+
+// returnFromAlarm から: 鳴り終わり（または鳴らせなかった）。確定分を SD へ
+void alarmTimingEnd() {
+    if (pending) {
+        pending = false;
+        incomplete++;
+        dirty = true;
+        Serial.println("ALARM TIMING: no UART byte before the alarm ended (incomplete)");
+    }
+    if (dirty) saveAlarmTiming();
+}
+
+// 起動時（SD 初期化後）
+void loadAlarmTiming() {
+    waitEPDReady();
+    File f = SD.open(TIMING_FILE, FILE_READ);
+    if (!f) {
+        Serial.println("TIMING: none");
+        return;
+    }
+    TimingHeader h;
+    static AlarmHistogram tmp[AST_COUNT];
+    bool ok = f.read((uint8_t*)&h, sizeof(h)) == (int)sizeof(h) &&
+              memcmp(h.magic, TIMING_MAGIC, 4) == 0 &&
+              h.version == TIMING_VERSION &&
+              h.header_size == sizeof(TimingHeader) &&
+              h.stage_count == AST_COUNT &&
+              h.bucket_count == ALARM_HIST_BUCKETS &&
+              f.read((uint8_t*)tmp, sizeof(tmp)) == (int)sizeof(tmp) &&
+              h.checksum == icsHash32(tmp, sizeof(tmp));
+    f.close();
+    if (!ok) {
+        Serial.println("TIMING: header/checksum mismatch - starting fresh");
+        return;
+    }
+    memcpy(hist, tmp, sizeof(hist));
+    incomplete = h.incomplete;
+    since = h.since;
+    Serial.printf("TIMING: restored %lu fires (worst %lums)\n",
+                  (unsigned long)hist[AST_TOTAL].count, (unsigned long)hist[AST_TOTAL].worst_ms);
+}
+
+// 毎分の ALARM CHECK から
+void reportAlarmTiming() {
+    if (hist[AST_TOTAL].count == 0 && incomplete == 0) return;
+    struct tm st; time_t t0 = (time_t)since; localtime_r(&t0, &st);
+    Serial.printf("  fire timing since %02d/%02d %02d:%02d: n=%lu incomplete=%lu, over %dms: %lu\n",
+                  st.tm_mon + 1, st.tm_mday, st.tm_hour, st.tm_min,
+                  (unsigned long)hist[AST_TOTAL].count, (unsigned long)incomplete,
+                  ALARM_LATENCY_BUDGET_MS, (unsigned long)hist[AST_TOTAL].over_budget);
+    Serial.print("    buckets(ms) <5 <10 <20 <50 <100 <200 <500 <1k <2k <5k <10k 10k+\n");
+    for (int s = 0; s < AST_COUNT; s++) {
+        const AlarmHistogram& h = hist[s];
+        Serial.printf("    %-13s p50<=%lu p95<=%lu p99<=%lu max %lu avg %lu sd %lu |",
+                      stage_names[s], (unsigned long)h.percentile(50), (unsigned long)h.percentile(95),
+                      (unsigned long)h.percentile(99), (unsigned long)h.worst_ms,
+                      (unsigned long)h.avg(), (unsigned long)h.stddev());
+        for (int b = 0; b < ALARM_HIST_BUCKETS; b++) Serial.printf(" %lu", (unsigned long)h.bucket[b]);
+        Serial.println();
+    }
+}
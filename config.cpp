@@ -19,8 +19,13 @@ void loadConfig() {
     config.time_24h = true;
     config.text_wrap = false;
     config.ics_poll_min = 30;
+    for (int i = 0; i < MAX_FETCH_URLS; i++) config.ics_poll_each[i] = 0;  // 0=ics_poll_min に従う
+    config.ics_poll_adaptive = true;
+    config.poll_budget_fetches = 0;     // 0=無制限
+    config.poll_budget_kb = 0;
     config.play_duration = 0;  // 0=1曲
     config.play_repeat = 1;
+    config.alarm_merge = true;
     config.max_events = 299;
     config.max_desc_bytes = 3500;
     config.min_free_heap = 40;
@@ -33,7 +38,7 @@ void loadConfig() {
     File f = SD.open(CONFIG_FILE, FILE_READ);
     if (!f) return;
 
-    StaticJsonDocument<1280> doc;
+    StaticJsonDocument<2048> doc;
     DeserializationError err = deserializeJson(doc, f);
     f.close();
 
@@ -55,12 +60,32 @@ void loadConfig() {
     if (doc["port_select"]) config.port_select = doc["port_select"];
     if (doc.containsKey("time_24h")) config.time_24h = doc["time_24h"];
     if (doc.containsKey("text_wrap")) config.text_wrap = doc["text_wrap"];
+    if (doc.containsKey("alarm_merge")) config.alarm_merge = doc["alarm_merge"];
     if (doc["ics_poll_min"]) config.ics_poll_min = doc["ics_poll_min"];
 
     if (config.ics_poll_min < 5) {
         Serial.printf("Config: ics_poll_min=%d is too small, setting to 5\n", config.ics_poll_min);
         config.ics_poll_min = 5;
     }
+    // ソース(URL)ごとの更新間隔 [分]。ics_url のカンマ区切り順に対応、0/省略=ics_poll_min
+    if (doc.containsKey("ics_poll_each")) {
+        JsonArrayConst arr = doc["ics_poll_each"];
+        int n = 0;
+        for (JsonVariantConst v : arr) {
+            if (n >= MAX_FETCH_URLS) break;
+            int m = v;
+            if (m > 0 && m < 5) {
+                Serial.printf("Config: ics_poll_each[%d]=%d is too small, setting to 5\n", n, m);
+                m = 5;
+            }
+            config.ics_poll_each[n++] = (m > 0) ? m : 0;
+        }
+    }
+    if (doc.containsKey("ics_poll_adaptive")) config.ics_poll_adaptive = doc["ics_poll_adaptive"];
+    if (doc.containsKey("poll_budget_fetches")) config.poll_budget_fetches = doc["poll_budget_fetches"];
+    if (doc.containsKey("poll_budget_kb")) config.poll_budget_kb = doc["poll_budget_kb"];
+    if (config.poll_budget_fetches < 0) config.poll_budget_fetches = 0;
+    if (config.poll_budget_kb < 0) config.poll_budget_kb = 0;
     if (doc.containsKey("play_duration")) config.play_duration = doc["play_duration"];
     if (doc["play_repeat"]) config.play_repeat = doc["play_repeat"];
     if (doc["max_events"]) config.max_events = doc["max_events"];
@@ -70,6 +95,7 @@ void loadConfig() {
     if (config.max_events < 10) config.max_events = 10;
     if (config.max_events > MAX_EVENTS - 1) config.max_events = MAX_EVENTS - 1;
     if (config.max_desc_bytes < 100) config.max_desc_bytes = 100;
+    if (config.max_desc_bytes > DESC_MAX_BYTES) config.max_desc_bytes = DESC_MAX_BYTES;   // 説明文の上限（本文プール消費の暴走防止）
     if (config.min_free_heap < 20) config.min_free_heap = 20;
 
     Serial.println("Config loaded");
@@ -90,8 +116,14 @@ void loadConfig() {
     Serial.printf("  time_24h: %s\n", config.time_24h ? "true" : "false");
     Serial.printf("  text_wrap: %s\n", config.text_wrap ? "true" : "false");
     Serial.printf("  ics_poll_min: %d\n", config.ics_poll_min);
+    Serial.print("  ics_poll_each:");
+    for (int i = 0; i < MAX_FETCH_URLS; i++) Serial.printf(" %d", config.ics_poll_each[i]);
+    Serial.println();
+    Serial.printf("  ics_poll_adaptive: %s\n", config.ics_poll_adaptive ? "true" : "false");
+    Serial.printf("  poll_budget: %d fetches, %d KB / day\n", config.poll_budget_fetches, config.poll_budget_kb);
     Serial.printf("  play_duration: %d\n", config.play_duration);
     Serial.printf("  play_repeat: %d\n", config.play_repeat);
+    Serial.printf("  alarm_merge: %s\n", config.alarm_merge ? "true" : "false");
     Serial.printf("  max_events: %d\n", config.max_events);
     Serial.printf("  max_desc_bytes: %d\n", config.max_desc_bytes);
     Serial.printf("  min_free_heap: %d\n", config.min_free_heap);
@@ -100,7 +132,7 @@ void loadConfig() {
 
 void saveConfig() {
     waitEPDReady();
-    StaticJsonDocument<1280> doc;
+    StaticJsonDocument<2048> doc;
     doc["wifi_ssid"] = config.wifi_ssid;
     doc["wifi_pass"] = config.wifi_pass;
     doc["ics_url"] = config.ics_url;
@@ -115,8 +147,21 @@ void saveConfig() {
     doc["time_24h"] = config.time_24h;
     doc["text_wrap"] = config.text_wrap;
     doc["ics_poll_min"] = config.ics_poll_min;
+    {
+        // 末尾の0（既定値）は省略して保存
+        int n = MAX_FETCH_URLS;
+        while (n > 0 && config.ics_poll_each[n - 1] == 0) n--;
+        if (n > 0) {
+            JsonArray arr = doc.createNestedArray("ics_poll_each");
+            for (int i = 0; i < n; i++) arr.add(config.ics_poll_each[i]);
+        }
+    }
+    doc["ics_poll_adaptive"] = config.ics_poll_adaptive;
+    doc["poll_budget_fetches"] = config.poll_budget_fetches;
+    doc["poll_budget_kb"] = config.poll_budget_kb;
     doc["play_duration"] = config.play_duration;
     doc["play_repeat"] = config.play_repeat;
+    doc["alarm_merge"] = config.alarm_merge;
     doc["max_events"] = config.max_events;
     doc["max_desc_bytes"] = config.max_desc_bytes;
     doc["min_free_heap"] = config.min_free_heap;
@@ -0,0 +1,182 @@
+#include "globals.h"
+#include <time.h>
+#include <algorithm>
+
+//==============================================================================
+// fetch 差分エンジン
+//   公開直前の新バッファと旧バッファを uid_hash（ソース+UID）で突き合わせ、
+//   追加 / 削除 / 移動（開始時刻変更）/ 内容変更 を求める。
+//   同一UIDが複数ある場合（RECURRENCE-ID の上書き等）は開始時刻順に k 番目同士を対応付け。
+//
+//   UI はこの結果で「何もしない / 変更行のみ部分更新 / 全面再描画」を選ぶ
+//   （refreshListAfterFetch）。旧バッファは次の fetch まで不変なので、
+//   旧 index → 新 index の対応表でカーソル・ページ位置を引き継げる。
+//==============================================================================
+
+struct DiffKey {
+    uint32_t uid;
+    uint32_t start;
+    uint16_t idx;
+};
+
+static bool diffKeyLess(const DiffKey& a, const DiffKey& b) {
+    if (a.uid != b.uid) return a.uid < b.uid;
+    if (a.start != b.start) return a.start < b.start;
+    return a.idx < b.idx;
+}
+
+FetchDiff fetch_diff = {};
+
+// 作業域・結果（PSRAM、同時実行なし）
+static DiffKey* dk_old = nullptr;
+static DiffKey* dk_new = nullptr;
+static int16_t* old_to_new = nullptr;   // 旧index → 新index (-1=削除)
+static uint8_t* new_flags = nullptr;    // 新index → DIFF_*
+static uint32_t* gone_start = nullptr;  // 削除・移動した旧イベントの開始時刻
+static int gone_count = 0;
+static const EventItem* diff_old_buf = nullptr;   // 旧バッファ（次の fetch まで内容不変）
+static int diff_old_count = 0;
+static int diff_new_count = 0;
+
+static bool ensureBuffers() {
+    if (dk_old) return true;
+    dk_old     = (DiffKey*)ps_malloc(MAX_EVENTS * sizeof(DiffKey));
+    dk_new     = (DiffKey*)ps_malloc(MAX_EVENTS * sizeof(DiffKey));
+    old_to_new = (int16_t*)ps_malloc(MAX_EVENTS * sizeof(int16_t));
+    new_flags  = (uint8_t*)ps_malloc(MAX_EVENTS);
+    gone_start = (uint32_t*)ps_malloc(MAX_EVENTS * sizeof(uint32_t));
+    if (!dk_old || !dk_new || !old_to_new || !new_flags || !gone_start) {
+        Serial.println("DIFF: PSRAM alloc failed");
+        dk_old = nullptr;
+        return false;
+    }
+    return true;
+}
+
+// 1行ログ（種類ごとに最大 DIFF_LOG_MAX 件）
+#define DIFF_LOG_MAX 6
+static void logDiffEvent(char tag, const EventItem& e, time_t old_start) {
+    struct tm st; localtime_r(&e.start, &st);
+    char sum[41];
+    substrCopy(sum, e.summary(), 0, 40, sizeof(sum));
+    if (old_start) {
+        struct tm ot; localtime_r(&old_start, &ot);
+        Serial.printf("  %c %02d/%02d %02d:%02d <- %02d/%02d %02d:%02d '%s'%s\n", tag,
+                      st.tm_mon + 1, st.tm_mday, st.tm_hour, st.tm_min,
+                      ot.tm_mon + 1, ot.tm_mday, ot.tm_hour, ot.tm_min,
+                      sum, e.has_alarm ? " [AL]" : "");
+    } else {
+        Serial.printf("  %c %02d/%02d %02d:%02d '%s'%s\n", tag,
+                      st.tm_mon + 1, st.tm_mday, st.tm_hour, st.tm_min,
+                      sum, e.has_alarm ? " [AL]" : "");
+    }
+}
+
+void diffEvents(const EventItem* old_buf, int old_n, const EventItem* new_buf, int new_n) {
+    fetch_diff = {};
+    gone_count = 0;
+    diff_old_count = old_n;
+    diff_new_count = new_n;
+    diff_old_buf = old_buf;
+    if (!ensureBuffers()) return;
+
+    uint32_t t0 = micros();
+    for (int i = 0; i < old_n; i++) {
+        dk_old[i] = { old_buf[i].uid_hash, (uint32_t)old_buf[i].start, (uint16_t)i };
+        old_to_new[i] = -1;
+    }
+    for (int i = 0; i < new_n; i++) {
+        dk_new[i] = { new_buf[i].uid_hash, (uint32_t)new_buf[i].start, (uint16_t)i };
+        new_flags[i] = DIFF_ADDED;
+    }
+    std::sort(dk_old, dk_old + old_n, diffKeyLess);
+    std::sort(dk_new, dk_new + new_n, diffKeyLess);
+
+    // uid 昇順のマージ走査。同一uidグループ内は開始時刻順に先頭から対応付け
+    int i = 0, j = 0;
+    while (i < old_n && j < new_n) {
+        if (dk_old[i].uid < dk_new[j].uid) { i++; continue; }
+        if (dk_new[j].uid < dk_old[i].uid) { j++; continue; }
+        uint32_t uid = dk_old[i].uid;
+        while (i < old_n && j < new_n && dk_old[i].uid == uid && dk_new[j].uid == uid) {
+            int oi = dk_old[i].idx, ni = dk_new[j].idx;
+            old_to_new[oi] = (int16_t)ni;
+            uint8_t f = 0;
+            if (old_buf[oi].start != new_buf[ni].start) f |= DIFF_MOVED;
+            if (old_buf[oi].text_hash != new_buf[ni].text_hash) f |= DIFF_CHANGED;
+            new_flags[ni] = f;
+            i++; j++;
+        }
+        while (i < old_n && dk_old[i].uid == uid) i++;
+        while (j < new_n && dk_new[j].uid == uid) j++;
+    }
+
+    for (int n = 0; n < new_n; n++) {
+        if (new_flags[n] & DIFF_ADDED)   fetch_diff.added++;
+        if (new_flags[n] & DIFF_MOVED)   fetch_diff.moved++;
+        if (new_flags[n] & DIFF_CHANGED) fetch_diff.changed++;
+    }
+    for (int o = 0; o < old_n; o++) {
+        int ni = old_to_new[o];
+        if (ni < 0) fetch_diff.removed++;
+        if (ni < 0 || (new_flags[ni] & DIFF_MOVED)) gone_start[gone_count++] = (uint32_t)old_buf[o].start;
+    }
+    fetch_diff.valid = true;
+    uint32_t us = micros() - t0;
+
+    // ── コンパクトなログ（従来の全アラームダンプの代わり） ──
+    Serial.printf("DIFF: %d -> %d events  +%d -%d >%d ~%d (%luus)\n",
+                  old_n, new_n, fetch_diff.added, fetch_diff.removed,
+                  fetch_diff.moved, fetch_diff.changed, (unsigned long)us);
+    int logged_add = 0, logged_mv = 0, logged_chg = 0, logged_rm = 0;
+    for (int n = 0; n < new_n; n++) {
+        uint8_t f = new_flags[n];
+        if ((f & DIFF_ADDED) && logged_add++ < DIFF_LOG_MAX) logDiffEvent('+', new_buf[n], 0);
+    }
+    for (int o = 0; o < old_n; o++) {
+        int ni = old_to_new[o];
+        if (ni < 0) {
+            if (logged_rm++ < DIFF_LOG_MAX) logDiffEvent('-', old_buf[o], 0);
+            continue;
+        }
+        if ((new_flags[ni] & DIFF_MOVED) && logged_mv++ < DIFF_LOG_MAX) {
+            logDiffEvent('>', new_buf[ni], old_buf[o].start);
+        } else if ((new_flags[ni] & DIFF_CHANGED) && logged_chg++ < DIFF_LOG_MAX) {
+            logDiffEvent('~', new_buf[ni], 0);
+        }
+    }
+}
+
+bool diffIsEmpty() {
+    return fetch_diff.valid && fetch_diff.added == 0 && fetch_diff.removed == 0 &&
+           fetch_diff.moved == 0 && fetch_diff.changed == 0;
+}
+
+int diffMapOldIndex(int old_idx) {
+    if (!fetch_diff.valid || old_idx < 0 || old_idx >= diff_old_count) return -1;
+    return old_to_new[old_idx];
+}
+
+// 旧バッファの開始時刻（画面に残っている旧 index の位置を時刻で知るため）
+time_t diffOldStart(int old_idx) {
+    if (!fetch_diff.valid || !diff_old_buf || old_idx < 0 || old_idx >= diff_old_count) return 0;
+    return diff_old_buf[old_idx].start;
+}
+
+uint8_t diffFlags(int new_idx) {
+    if (!fetch_diff.valid || new_idx < 0 || new_idx >= diff_new_count) return 0;
+    return new_flags[new_idx];
+}
+
+// [from, to] の時間帯に「並びが変わる」差分（追加・削除・移動）があるか
+bool diffStructuralInRange(time_t from, time_t to) {
+    if (!fetch_diff.valid) return true;
+    for (int n = 0; n < diff_new_count; n++) {
+        if (!(new_flags[n] & (DIFF_ADDED | DIFF_MOVED))) continue;
+        if (events[n].start >= from && events[n].start <= to) return true;
+    }
+    for (int g = 0; g < gone_count; g++) {
+        if ((time_t)gone_start[g] >= from && (time_t)gone_start[g] <= to) return true;
+    }
+    return false;
+}
@@ -0,0 +1,476 @@
+#include "globals.h"
+#include <time.h>
+
+//==============================================================================
+// イベントのホット/コールド分割
+//   events[]（PSRAM, 1件 ~110byte）は本文ポインタ等のコールド情報込みで、
+//   毎ループの走査（アラーム発火判定・次イベント検索）では SPI PSRAM の
+//   キャッシュミスが支配的になる。走査に必要なフィールドだけを内部DRAMの
+//   SoA（構造体の配列ではなく配列の構造体）に抜き出し、公開バッファに対して
+//   1組だけ保持する。fetch でバッファを公開するたびに rebuildEventIndex() で再構築。
+//
+//   アラームは「未発火スロット」だけを詰めたテーブルに持ち、発火済みは
+//   ビットマスクで管理する（events[].triggered[] と setAlarmTriggered で同期）。
+//   テーブルの上に alarm_time の最小ヒープを置き、毎ループの発火判定と
+//   「次のアラーム」はヒープ先頭を見るだけにする。発火済みスロットはヒープから
+//   すぐには消さず、先頭に来た時点で捨てる（遅延削除）。ヒープは公開時に O(n) で構築。
+//
+//   日付ごとの範囲は「日番号 mod DAY_RING_SIZE」で引くリング（日バケット）に持つ。
+//   events[] は start 昇順なので1日のイベントは連続区間 [first, first+count) になり、
+//   前日/翌日/今日への移動はソートも全件走査も不要。日付が変わったら
+//   rollEventWindow() で過去ウィンドウから外れた最古のバケットを切り離す
+//   （events の先頭を進めるだけで、PSRAM 上のイベントは移動しない）。
+//==============================================================================
+
+#define HOT_ALLDAY      0x01
+#define HOT_ALARM       0x02
+#define HOT_PENDING     0x04    // 未発火のアラームスロットあり
+
+#define MAX_HOT_ALARMS  512     // 未発火アラームスロット数の上限（超過時はPSRAM走査にフォールバック）
+#define DAY_RING_SIZE   64      // 日バケット数（2の冪。表示ウィンドウ 7+30+1 日を収容）
+#define PAST_WINDOW_DAYS 7      // commitEvent の過去ウィンドウ（これより古い日は再fetchで消える）
+
+static uint32_t hot_start[MAX_EVENTS];      // 開始時刻 (UNIX秒)
+static uint16_t hot_day[MAX_EVENTS];        // ローカル日付キー（dayKeyOf）
+static uint8_t  hot_flags[MAX_EVENTS];      // HOT_*
+static int      hot_count = 0;
+
+static uint32_t hot_alarm_time[MAX_HOT_ALARMS];     // アラーム絶対時刻
+static uint16_t hot_alarm_ev[MAX_HOT_ALARMS];       // 所属イベント index
+static uint8_t  hot_alarm_slot[MAX_HOT_ALARMS];     // events[].alarm_time[] 内のスロット
+static uint32_t hot_alarm_fired[(MAX_HOT_ALARMS + 31) / 32];  // 発火済みビットマスク
+static int      hot_alarm_count = 0;
+static bool     hot_alarm_overflow = false;
+static uint16_t alarm_heap[MAX_HOT_ALARMS];     // hot_alarm_* の添字の最小ヒープ（alarm_time 順）
+static int      alarm_heap_n = 0;
+static uint32_t alarm_head_at = 0;      // 最早の未発火アラーム時刻（0=なし）— アラーム監視タスクが読む
+
+struct DayBucket {
+    uint16_t day;       // 日番号（dayKeyOf）。0=空き
+    uint16_t first;     // 先頭イベント index
+    uint16_t count;
+};
+static DayBucket day_ring[DAY_RING_SIZE];
+static uint16_t  ring_first_day = 0;    // リングが覆う日の範囲 [first, last]
+static uint16_t  ring_last_day = 0;
+static bool      ring_overflow = false; // 範囲が DAY_RING_SIZE 日を超えた（二分探索にフォールバック）
+
+// 走査時間の計測（ALARM CHECK で1分ごとに出力・リセット）
+struct ScanStat {
+    uint32_t total_us;
+    uint32_t max_us;
+    uint32_t n;
+};
+static ScanStat stat_alarm = {};
+static ScanStat stat_next = {};
+
+static void addStat(ScanStat& s, uint32_t us) {
+    s.total_us += us;
+    if (us > s.max_us) s.max_us = us;
+    s.n++;
+}
+
+static inline bool alarmFired(int a) {
+    return hot_alarm_fired[a >> 5] & (1u << (a & 31));
+}
+
+//==============================================================================
+// アラームの最小ヒープ
+//==============================================================================
+static inline bool heapLess(uint16_t a, uint16_t b) {
+    if (hot_alarm_time[a] != hot_alarm_time[b]) return hot_alarm_time[a] < hot_alarm_time[b];
+    return a < b;       // 同時刻は events 順
+}
+
+static void heapSiftDown(int i) {
+    uint16_t v = alarm_heap[i];
+    for (;;) {
+        int c = 2 * i + 1;
+        if (c >= alarm_heap_n) break;
+        if (c + 1 < alarm_heap_n && heapLess(alarm_heap[c + 1], alarm_heap[c])) c++;
+        if (!heapLess(alarm_heap[c], v)) break;
+        alarm_heap[i] = alarm_heap[c];
+        i = c;
+    }
+    alarm_heap[i] = v;
+}
+
+static void buildAlarmHeap() {
+    alarm_heap_n = hot_alarm_count;
+    for (int a = 0; a < hot_alarm_count; a++) alarm_heap[a] = (uint16_t)a;
+    for (int i = alarm_heap_n / 2 - 1; i >= 0; i--) heapSiftDown(i);
+}
+
+// 最早の未発火スロット（なければ -1）。先頭に来た発火済みはここで捨てる
+static int heapTop() {
+    while (alarm_heap_n > 0 && alarmFired(alarm_heap[0])) {
+        alarm_heap[0] = alarm_heap[--alarm_heap_n];
+        if (alarm_heap_n > 0) heapSiftDown(0);
+    }
+    return alarm_heap_n > 0 ? alarm_heap[0] : -1;
+}
+
+// 最早の未発火アラーム時刻を監視タスク向けに公開（メインループ側で索引が変わるたびに）
+//   ヒープはメインループ専用なので、タスクはこの値だけを読む
+static void publishAlarmHead() {
+    uint32_t head = 0;
+    if (hot_alarm_overflow) {
+        for (int i = 0; i < event_count; i++) {
+            for (int k = 0; k < events[i].alarm_count; k++) {
+                uint32_t at = (uint32_t)events[i].alarm_time[k];
+                if (!events[i].triggered[k] && (head == 0 || at < head)) head = at;
+            }
+        }
+    } else {
+        int a = heapTop();
+        if (a >= 0) head = hot_alarm_time[a];
+    }
+    __atomic_store_n(&alarm_head_at, head, __ATOMIC_RELEASE);
+}
+
+uint32_t alarmHeadTime() {
+    return __atomic_load_n(&alarm_head_at, __ATOMIC_ACQUIRE);
+}
+
+// 通算日（グレゴリオ暦、3月始まりで閏日を年末に回す days_from_civil）
+static int daysFromCivil(int y, int m, int d) {
+    if (m <= 2) y--;
+    int era = y / 400;
+    int yoe = y - era * 400;
+    int doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    return era * 146097 + yoe * 365 + yoe / 4 - yoe / 100 + doy;
+}
+
+// ローカル日番号: 1999-12-31 を 0 とする通算日（連続した日は連続した値、uint16 に収まる）
+uint16_t dayKeyOf(time_t t) {
+    struct tm tm;
+    localtime_r(&t, &tm);
+    if (tm.tm_year < 100) return 0;
+    return (uint16_t)(daysFromCivil(tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday)
+                      - daysFromCivil(1999, 12, 31));
+}
+
+static inline DayBucket& ringSlot(uint16_t day) {
+    return day_ring[day & (DAY_RING_SIZE - 1)];
+}
+
+// hot_day[]（昇順）から日バケットを作る。O(n)
+static void rebuildDayRing() {
+    memset(day_ring, 0, sizeof(day_ring));
+    ring_overflow = false;
+    ring_first_day = hot_count > 0 ? hot_day[0] : 0;
+    ring_last_day = hot_count > 0 ? hot_day[hot_count - 1] : 0;
+    if (hot_count > 0 && ring_last_day - ring_first_day >= DAY_RING_SIZE) {
+        ring_overflow = true;
+        return;
+    }
+    for (int i = 0; i < hot_count; i++) {
+        DayBucket& b = ringSlot(hot_day[i]);
+        if (b.day != hot_day[i]) b = { hot_day[i], (uint16_t)i, 0 };
+        b.count++;
+    }
+}
+
+static inline bool ringCovers(uint16_t day) {
+    return !ring_overflow && hot_count > 0 && day >= ring_first_day && day <= ring_last_day;
+}
+
+void rebuildEventIndex() {
+    uint32_t t0 = micros();
+    hot_count = event_count;
+    hot_alarm_count = 0;
+    hot_alarm_overflow = false;
+    memset(hot_alarm_fired, 0, sizeof(hot_alarm_fired));
+
+    for (int i = 0; i < event_count; i++) {
+        const EventItem& e = events[i];
+        hot_start[i] = (uint32_t)e.start;
+        hot_day[i] = dayKeyOf(e.start);
+        uint8_t f = 0;
+        if (e.is_allday) f |= HOT_ALLDAY;
+        if (e.has_alarm) f |= HOT_ALARM;
+        for (int k = 0; k < e.alarm_count; k++) {
+            if (e.triggered[k]) continue;
+            f |= HOT_PENDING;
+            if (hot_alarm_count >= MAX_HOT_ALARMS) { hot_alarm_overflow = true; continue; }
+            hot_alarm_time[hot_alarm_count] = (uint32_t)e.alarm_time[k];
+            hot_alarm_ev[hot_alarm_count]   = (uint16_t)i;
+            hot_alarm_slot[hot_alarm_count] = (uint8_t)k;
+            hot_alarm_count++;
+        }
+        hot_flags[i] = f;
+    }
+    buildAlarmHeap();
+    publishAlarmHead();
+    rebuildDayRing();
+    Serial.printf("EVENT INDEX: %d events, %d days, %d pending alarm slots%s%s (%luus)\n",
+                  hot_count, hot_count > 0 ? ring_last_day - ring_first_day + 1 : 0, hot_alarm_count,
+                  hot_alarm_overflow ? " [OVERFLOW - PSRAM scan]" : "",
+                  ring_overflow ? " [DAY RING OVERFLOW]" : "",
+                  (unsigned long)(micros() - t0));
+}
+
+// 発火済みにする（コールド側 triggered[] とホット側ビットマスクの両方 + SD ジャーナル）
+void setAlarmTriggered(int evt, int slot) {
+    if (evt < 0 || evt >= event_count) return;
+    if (slot < 0 || slot >= events[evt].alarm_count) return;
+    if (!events[evt].triggered[slot]) journalAlarmAck(events[evt].uid_hash, events[evt].alarm_time[slot]);
+    events[evt].triggered[slot] = true;
+    if (evt >= hot_count) return;
+
+    // テーブルはイベント順に詰めてあるので、このイベントのスロットは二分探索で引ける
+    int lo = 0, hi = hot_alarm_count;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (hot_alarm_ev[mid] < evt) lo = mid + 1; else hi = mid;
+    }
+    bool pending = false;
+    for (int a = lo; a < hot_alarm_count && hot_alarm_ev[a] == evt; a++) {
+        if (hot_alarm_slot[a] == slot) hot_alarm_fired[a >> 5] |= (1u << (a & 31));
+        if (!alarmFired(a)) pending = true;
+    }
+    if (hot_alarm_overflow) {
+        // テーブル外スロットが残っている可能性 → コールド側で判定
+        pending = false;
+        for (int k = 0; k < events[evt].alarm_count; k++) {
+            if (!events[evt].triggered[k]) { pending = true; break; }
+        }
+    }
+    if (!pending) hot_flags[evt] &= ~HOT_PENDING;
+    publishAlarmHead();
+}
+
+bool eventHasPendingAlarm(int evt) {
+    if (evt < 0 || evt >= hot_count) return false;
+    return hot_flags[evt] & HOT_PENDING;
+}
+
+// PSRAM 上の events[] を直接走査する従来版（オーバーフロー時・比較計測用）
+static int coldFindDueAlarm(time_t now, int& slot) {
+    for (int i = 0; i < event_count; i++) {
+        if (!events[i].has_alarm) continue;
+        for (int k = 0; k < events[i].alarm_count; k++) {
+            if (!events[i].triggered[k] && events[i].alarm_time[k] <= now) {
+                slot = k;
+                return i;
+            }
+        }
+    }
+    return -1;
+}
+
+// 発火すべきアラーム（未発火 かつ alarm_time <= now）のうち最も早いもの1件を返す
+//   ヒープ先頭を見るだけ（発火済みの捨て分を除いて O(1)）
+int findDueAlarm(time_t now, int& slot) {
+    uint32_t t0 = micros();
+    int found = -1;
+    if (hot_alarm_overflow) {
+        found = coldFindDueAlarm(now, slot);
+    } else {
+        int a = heapTop();
+        if (a >= 0 && hot_alarm_time[a] <= (uint32_t)now) {
+            found = hot_alarm_ev[a];
+            slot = hot_alarm_slot[a];
+        }
+    }
+    addStat(stat_alarm, micros() - t0);
+    return found;
+}
+
+// 期限到来済みの未発火アラームを時刻順に最大 max 件（同時刻・鳴動中に来たアラームのまとめ用）
+//   ヒープを先頭から辿り、alarm_time > now の部分木には降りない（発火済みの節も子は見る）
+int findDueAlarms(time_t now, int* evts, uint8_t* slots, int max) {
+    uint32_t at[ALARM_GROUP_MAX];
+    int n = 0;
+    if (max > ALARM_GROUP_MAX) max = ALARM_GROUP_MAX;
+    auto add = [&](uint32_t t, int ev, int slot) {
+        int pos = n < max ? n++ : max;
+        while (pos > 0 && (at[pos - 1] > t || (at[pos - 1] == t && evts[pos - 1] > ev))) {
+            if (pos < max) { at[pos] = at[pos - 1]; evts[pos] = evts[pos - 1]; slots[pos] = slots[pos - 1]; }
+            pos--;
+        }
+        if (pos < max) { at[pos] = t; evts[pos] = ev; slots[pos] = (uint8_t)slot; }
+    };
+    if (hot_alarm_overflow) {
+        for (int i = 0; i < event_count; i++) {
+            if (!events[i].has_alarm) continue;
+            for (int k = 0; k < events[i].alarm_count; k++) {
+                if (!events[i].triggered[k] && events[i].alarm_time[k] <= now) add((uint32_t)events[i].alarm_time[k], i, k);
+            }
+        }
+        return n;
+    }
+    heapTop();
+    int stack[48];
+    int sp = 0;
+    if (alarm_heap_n > 0) stack[sp++] = 0;
+    while (sp > 0) {
+        int h = stack[--sp];
+        int a = alarm_heap[h];
+        if (hot_alarm_time[a] > (uint32_t)now) continue;
+        if (!alarmFired(a)) add(hot_alarm_time[a], hot_alarm_ev[a], hot_alarm_slot[a]);
+        for (int c = 2 * h + 1; c <= 2 * h + 2; c++) {
+            if (c < alarm_heap_n && sp < (int)(sizeof(stack) / sizeof(stack[0]))) stack[sp++] = c;
+        }
+    }
+    return n;
+}
+
+// now より後で最早の未発火アラーム時刻（なければ 0）。evt に所属イベントを返す
+time_t nextPendingAlarm(time_t now, int* evt) {
+    time_t best = 0;
+    int best_ev = -1;
+    if (hot_alarm_overflow) {
+        for (int i = 0; i < event_count; i++) {
+            if (!events[i].has_alarm) continue;
+            for (int k = 0; k < events[i].alarm_count; k++) {
+                if (events[i].triggered[k]) continue;
+                time_t at = events[i].alarm_time[k];
+                if (at <= now) continue;
+                if (best_ev < 0 || at < best) { best = at; best_ev = i; }
+            }
+        }
+    } else {
+        int top = heapTop();
+        if (top >= 0 && (time_t)hot_alarm_time[top] > now) {
+            // 期限到来済みの未発火がない通常時はヒープ先頭がそのまま答え
+            best = (time_t)hot_alarm_time[top];
+            best_ev = hot_alarm_ev[top];
+        } else if (top >= 0) {
+            // 鳴らす前のスロット（別のアラームの鳴動中など）が先頭を塞いでいる → 表を走査
+            for (int a = 0; a < hot_alarm_count; a++) {
+                if (alarmFired(a)) continue;
+                time_t at = (time_t)hot_alarm_time[a];
+                if (at <= now) continue;
+                if (best_ev < 0 || at < best) { best = at; best_ev = hot_alarm_ev[a]; }
+            }
+        }
+    }
+    if (evt) *evt = best_ev;
+    return best;
+}
+
+// 「次の予定」: now より後に始まる最初の時刻指定イベント（events は start 昇順）
+int findNextEventIdx(time_t now) {
+    uint32_t t0 = micros();
+    uint32_t n = (uint32_t)now;
+    int lo = 0, hi = hot_count;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (hot_start[mid] <= n) lo = mid + 1; else hi = mid;
+    }
+    int found = -1;
+    for (int i = lo; i < hot_count; i++) {
+        if (!(hot_flags[i] & HOT_ALLDAY)) { found = i; break; }
+    }
+    addStat(stat_next, micros() - t0);
+    return found;
+}
+
+// day 以降の日付に属する最初のイベント（なければ hot_count）
+int firstEventOnOrAfterDay(uint16_t day) {
+    if (hot_count > 0 && !ring_overflow) {
+        if (day <= ring_first_day) return 0;
+        if (day > ring_last_day) return hot_count;
+        for (uint16_t d = day; d <= ring_last_day; d++) {
+            const DayBucket& b = ringSlot(d);
+            if (b.day == d) return b.first;
+        }
+        return hot_count;
+    }
+    int lo = 0, hi = hot_count;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (hot_day[mid] < day) lo = mid + 1; else hi = mid;
+    }
+    return lo;
+}
+
+uint16_t eventDayKey(int evt) {
+    return (evt >= 0 && evt < hot_count) ? hot_day[evt] : 0;
+}
+
+// day のイベント数を返し、first に先頭 index を入れる（なければ 0）
+int eventsOnDay(uint16_t day, int* first) {
+    int f = firstEventOnOrAfterDay(day);
+    if (first) *first = f;
+    if (f >= hot_count || hot_day[f] != day) return 0;
+    if (ringCovers(day)) return ringSlot(day).count;
+    int n = 0;
+    while (f + n < hot_count && hot_day[f + n] == day) n++;
+    return n;
+}
+
+// 月表示用: day のイベント数と DAY_ALARM / DAY_PENDING（本文には触れない）
+int dayStats(uint16_t day, uint8_t* flags) {
+    int first = 0;
+    int n = eventsOnDay(day, &first);
+    uint8_t f = 0;
+    for (int i = first; i < first + n; i++) {
+        if (hot_flags[i] & HOT_ALARM)   f |= DAY_ALARM;
+        if (hot_flags[i] & HOT_PENDING) f |= DAY_PENDING;
+    }
+    if (flags) *flags = f;
+    return n;
+}
+
+// evt の日より前でイベントのある最後の日の先頭 index（なければ -1）
+int firstEventOfPrevDay(int evt) {
+    if (evt <= 0 || evt > hot_count) return -1;
+    int day_first = (evt < hot_count) ? firstEventOnOrAfterDay(hot_day[evt]) : evt;
+    if (day_first <= 0) return -1;
+    return firstEventOnOrAfterDay(hot_day[day_first - 1]);
+}
+
+// evt の日より後でイベントのある最初の日の先頭 index（なければ -1）
+int firstEventOfNextDay(int evt) {
+    if (evt < 0 || evt >= hot_count) return -1;
+    int f = firstEventOnOrAfterDay(hot_day[evt] + 1);
+    return f < hot_count ? f : -1;
+}
+
+// 日付が変わったとき: 過去ウィンドウ（PAST_WINDOW_DAYS）より古い日のバケットを切り離す。
+//   events の先頭を進めるだけ（EventItem の移動・再ソートなし）で、ホット索引は O(n) で作り直す。
+//   同じ面の途中から始まる新しい版として公開する（index が変わるため epoch +1）。
+//   切り離した件数を返す（呼び出し側で画面上の index をずらす）
+int rollEventWindow(time_t now) {
+    if (event_count == 0) return 0;
+    uint16_t oldest = dayKeyOf(now) - PAST_WINDOW_DAYS;
+    int cut = firstEventOnOrAfterDay(oldest);
+    if (cut <= 0) return 0;
+    uint32_t t0 = micros();
+    publishEvents(events + cut, event_count - cut);
+    rebuildEventIndex();
+    Serial.printf("ROLL: retired %d events before day %u (%d left, %luus)\n",
+                  cut, oldest, event_count, (unsigned long)(micros() - t0));
+    return cut;
+}
+
+// ALARM CHECK 用: 直近1分の走査時間と、同じ判定を PSRAM 走査で行った参考値
+void reportEventIndexTiming(time_t now) {
+    int dummy = 0;
+    uint32_t t0 = micros();
+    coldFindDueAlarm(now, dummy);
+    uint32_t cold_alarm_us = micros() - t0;
+
+    t0 = micros();
+    time_t nextTime = 0x7FFFFFFF;
+    for (int i = 0; i < event_count; i++) {
+        if (!events[i].is_allday && events[i].start > now && events[i].start < nextTime) {
+            nextTime = events[i].start;
+        }
+    }
+    uint32_t cold_next_us = micros() - t0;
+
+    Serial.printf("  SCAN alarm: avg %luus max %luus (n=%lu, cold ref %luus) | "
+                  "next: avg %luus max %luus (n=%lu, cold ref %luus) | slots:%d heap:%d%s\n",
+                  (unsigned long)(stat_alarm.n ? stat_alarm.total_us / stat_alarm.n : 0),
+                  (unsigned long)stat_alarm.max_us, (unsigned long)stat_alarm.n,
+                  (unsigned long)cold_alarm_us,
+                  (unsigned long)(stat_next.n ? stat_next.total_us / stat_next.n : 0),
+                  (unsigned long)stat_next.max_us, (unsigned long)stat_next.n,
+                  (unsigned long)cold_next_us,
+                  hot_alarm_count, alarm_heap_n, hot_alarm_overflow ? " OVERFLOW" : "");
+    stat_alarm = {};
+    stat_next = {};
+}
@@ -0,0 +1,119 @@
+#include "globals.h"
+
+//==============================================================================
+// イベント列の版管理（RCU 風スナップショット）
+//   公開中のイベント列は「面（events_buf_a/b）・先頭・件数・版番号(epoch)」を持つ
+//   不変の EventSnapshot として、1本のポインタ（snap_current）で公開する。
+//
+//   書き手（fetchAndUpdate / rollEventWindow / SD スナップショット復元）
+//     - acquireWriteFace() で非公開面を得て書き込み、publishEvents() で
+//       ポインタを1回書き換えて公開する。途中状態は読み手から見えない
+//     - 非公開面を読み手がピンしている間はその面を再利用しない（本文プール・
+//       検索索引のリセットもピンが外れてから）
+//   読み手
+//     - pinEvents() で現在の版を取り出し、その面のピン数を上げてから読む。
+//       ピン後にポインタを読み直し、公開と競合していたらやり直す（ロックなし）
+//     - 版をまたいで持つ参照は index ではなく EventRef（uid_hash + 開始時刻）で持ち、
+//       resolveEventRef() で現在の版の index に引き直す
+//
+//   メインループの既存コードは従来どおり events / event_count を読む
+//   （publishEvents がスナップショットと同時に更新する、ループ内での別名）
+//==============================================================================
+
+#define SNAPSHOT_SLOTS  4       // 版の記述子リング（ピン操作中に3回以上公開されない限り安全）
+
+static EventSnapshot  snap_slots[SNAPSHOT_SLOTS];
+static int            snap_next = 0;
+static EventSnapshot* snap_current = nullptr;
+static uint32_t       face_pins[2] = { 0, 0 };
+static uint32_t       snap_epoch = 0;
+
+static uint8_t faceOf(const EventItem* p) {
+    return inEventsBufB(p) ? 1 : 0;
+}
+
+// 書き手: 新しい版を公開（events / event_count も同時に差し替え）
+void publishEvents(EventItem* base, int count) {
+    EventSnapshot& s = snap_slots[snap_next];
+    snap_next = (snap_next + 1) % SNAPSHOT_SLOTS;
+    s.events = base;
+    s.count = count;
+    s.epoch = ++snap_epoch;
+    s.face = faceOf(base);
+    __atomic_store_n(&snap_current, &s, __ATOMIC_RELEASE);
+    events = base;
+    event_count = count;
+    Serial.printf("RCU: epoch %lu published (buffer %s +%d, %d events, pins A:%lu B:%lu)\n",
+                  (unsigned long)s.epoch, s.face ? "B" : "A",
+                  (int)(base - (s.face ? events_buf_b : events_buf_a)), count,
+                  (unsigned long)face_pins[0], (unsigned long)face_pins[1]);
+}
+
+// 書き手: fetch の書き込み先（非公開面）。読み手がピン中なら nullptr
+EventItem* acquireWriteFace() {
+    EventSnapshot* cur = __atomic_load_n(&snap_current, __ATOMIC_ACQUIRE);
+    uint8_t w = (cur ? cur->face : faceOf(events)) ^ 1;
+    uint32_t pins = __atomic_load_n(&face_pins[w], __ATOMIC_ACQUIRE);
+    if (pins > 0) {
+        Serial.printf("RCU: buffer %s pinned by %lu reader(s)\n", w ? "B" : "A", (unsigned long)pins);
+        return nullptr;
+    }
+    return w ? events_buf_b : events_buf_a;
+}
+
+// 読み手: 現在の版をピンして取り出す（未公開なら events=nullptr）
+EventSnapshot pinEvents() {
+    for (;;) {
+        EventSnapshot* s = __atomic_load_n(&snap_current, __ATOMIC_ACQUIRE);
+        if (!s) return EventSnapshot{ nullptr, 0, 0, 0 };
+        EventSnapshot v = *s;
+        __atomic_fetch_add(&face_pins[v.face], 1, __ATOMIC_ACQ_REL);
+        // ピンより前に公開が入っていれば、その面は書き手が確保済みかもしれない → やり直し
+        if (__atomic_load_n(&snap_current, __ATOMIC_ACQUIRE) == s && s->epoch == v.epoch) return v;
+        __atomic_fetch_sub(&face_pins[v.face], 1, __ATOMIC_ACQ_REL);
+    }
+}
+
+void unpinEvents(EventSnapshot& v) {
+    if (!v.events) return;
+    __atomic_fetch_sub(&face_pins[v.face], 1, __ATOMIC_ACQ_REL);
+    v.events = nullptr;
+}
+
+uint32_t eventEpoch() {
+    return snap_epoch;
+}
+
+//==============================================================================
+// 版をまたぐ参照
+//==============================================================================
+EventRef makeEventRef(int idx) {
+    if (idx < 0 || idx >= event_count) return EventRef{ 0, 0, 0, -1 };
+    return EventRef{ events[idx].uid_hash, events[idx].start, snap_epoch, idx };
+}
+
+// 現在の版での index（同じ uid_hash + 開始時刻のイベントが無ければ -1）
+//   events[] は start 昇順なので開始時刻で二分探索し、同時刻の中から uid_hash で選ぶ
+int resolveEventRef(EventRef& r) {
+    if (r.epoch == 0) return -1;
+    if (r.epoch == snap_epoch) return r.idx;
+    int lo = 0, hi = event_count;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (events[mid].start < r.start) lo = mid + 1;
+        else hi = mid;
+    }
+    int found = -1;
+    for (int i = lo; i < event_count && events[i].start == r.start; i++) {
+        if (events[i].uid_hash == r.uid_hash) { found = i; break; }
+    }
+    Serial.printf("RCU: ref epoch %lu->%lu idx %d->%d\n",
+                  (unsigned long)r.epoch, (unsigned long)snap_epoch, r.idx, found);
+    if (found < 0) {
+        r.epoch = 0;
+        return -1;
+    }
+    r.epoch = snap_epoch;
+    r.idx = found;
+    return found;
+}
@@ -0,0 +1,225 @@
+#include "globals.h"
+#include <SD.h>
+#include <time.h>
+
+//==============================================================================
+// イベントストアの SD スナップショット
+//   fetch 成功ごとに公開バッファ（EventItem ヘッダー + 本文プール + ソース状態）を
+//   SD に書き出し、起動時はネットワークより先に読み戻して即座に一覧表示・アラーム有効化する。
+//
+//   形式: SnapshotHeader | EventItem × count | 本文プール pool_size byte
+//     EventItem の summary_text / desc_text / midi_file / row_text はプール先頭からのオフセットに置き換えて保存
+//     （一覧の行表示フィールド time_text / row_* も保存され、復元後の再計算は不要）
+//     （インターンで共有された文字列は同じオフセットになり、復元後も共有が保たれる）。
+//     圧縮された説明文（desc_packed>0）はブロックのまま保存し、復元後も必要時に展開する。
+//     レコードは EventItem の生レイアウトなので、構造体を変えたら SNAPSHOT_VERSION を上げる
+//     （record_size / header_size 不一致でも読み込まない）。
+//     checksum はレコード（オフセット化後）+ プールの icsHash32。
+//     ヘッダーには取得予算（poll_budget_*）のその日の使用量も入れ、再起動で使い切った予算が戻らないようにする。
+//   書き込みは一時ファイル → rename で置き換え、途中で電源が落ちても旧ファイルが残る。
+//==============================================================================
+
+#define SNAPSHOT_FILE       "/events.bin"
+#define SNAPSHOT_TMP_FILE   "/events.tmp"
+#define SNAPSHOT_MAGIC      "M5SN"
+#define SNAPSHOT_VERSION    7
+#define SNAPSHOT_CHUNK      16      // オフセット化してから書くレコード数（スタック上）
+
+struct SnapshotHeader {
+    char     magic[4];
+    uint16_t version;
+    uint16_t header_size;
+    uint16_t record_size;           // sizeof(EventItem)
+    uint16_t count;
+    uint16_t source_count;          // fetch_url_count
+    uint16_t budget_day;            // 取得予算の日付（dayKeyOf）
+    uint32_t pool_size;
+    uint32_t url_hash;              // config.ics_url（URL 設定が変わったら破棄）
+    uint32_t checksum;
+    int64_t  saved_at;
+    int64_t  last_fetch;
+    uint64_t budget_bytes;          // その日の取得バイト数
+    uint32_t budget_fetches;        // その日の取得回数
+    uint32_t reserved;
+    SourceState sources[MAX_FETCH_URLS];
+};
+
+// ポインタ → プール先頭からのオフセット（レコード単位）
+//   パディングも含めて元のバイト列を写す（hash パスと書き込みパスで同一バイトにするため）
+static void toDiskRecord(EventItem& r, const EventItem& e, const char* base) {
+    memcpy(&r, &e, sizeof(EventItem));
+    r.summary_text = (const char*)(uintptr_t)(e.summary_text - base);
+    r.desc_text = (const char*)(uintptr_t)(e.desc_text - base);
+    r.midi_file = (const char*)(uintptr_t)(e.midi_file - base);
+    r.row_text = (const char*)(uintptr_t)(e.row_text - base);
+}
+
+// レコード列をオフセット化しながら hash（fp==nullptr）または書き込み
+static bool emitRecords(File* fp, const char* base, uint32_t& hash) {
+    EventItem chunk[SNAPSHOT_CHUNK];
+    for (int i = 0; i < event_count; i += SNAPSHOT_CHUNK) {
+        int n = min(SNAPSHOT_CHUNK, event_count - i);
+        for (int k = 0; k < n; k++) toDiskRecord(chunk[k], events[i + k], base);
+        size_t bytes = n * sizeof(EventItem);
+        hash = icsHash32(chunk, bytes, hash);
+        if (fp && fp->write((const uint8_t*)chunk, bytes) != bytes) return false;
+    }
+    return true;
+}
+
+void saveEventSnapshot() {
+    if (!sd_healthy || event_count <= 0) return;
+    const TextPool* pool = textPoolFor(events);
+    if (!pool->base) return;
+    unsigned long t0 = millis();
+
+    uint32_t pool_size = pool->used;
+
+    SnapshotHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, SNAPSHOT_MAGIC, 4);
+    h.version = SNAPSHOT_VERSION;
+    h.header_size = sizeof(SnapshotHeader);
+    h.record_size = sizeof(EventItem);
+    h.count = (uint16_t)event_count;
+    h.source_count = (uint16_t)fetch_url_count;
+    h.pool_size = pool_size;
+    h.url_hash = icsHashStr(config.ics_url);
+    h.saved_at = (int64_t)time(nullptr);
+    h.last_fetch = (int64_t)last_fetch;
+    pollBudgetUsage(&h.budget_fetches, &h.budget_bytes, &h.budget_day);
+    memcpy(h.sources, source_state, sizeof(h.sources));
+
+    uint32_t hash = ICS_HASH_SEED;
+    emitRecords(nullptr, pool->base, hash);
+    h.checksum = icsHash32(pool->base, pool_size, hash);
+
+    waitEPDReady();
+    File f = SD.open(SNAPSHOT_TMP_FILE, FILE_WRITE);
+    if (!f) {
+        Serial.println("SNAPSHOT: cannot open " SNAPSHOT_TMP_FILE);
+        return;
+    }
+    bool ok = f.write((const uint8_t*)&h, sizeof(h)) == sizeof(h);
+    uint32_t dummy = ICS_HASH_SEED;
+    ok = ok && emitRecords(&f, pool->base, dummy);
+    ok = ok && f.write((const uint8_t*)pool->base, pool_size) == pool_size;
+    f.close();
+    if (!ok) {
+        Serial.println("SNAPSHOT: write failed");
+        SD.remove(SNAPSHOT_TMP_FILE);
+        return;
+    }
+    SD.remove(SNAPSHOT_FILE);
+    if (!SD.rename(SNAPSHOT_TMP_FILE, SNAPSHOT_FILE)) {
+        Serial.println("SNAPSHOT: rename failed");
+        return;
+    }
+    Serial.printf("SNAPSHOT: saved %d events + %uKB text (%lums)\n",
+                  event_count, (unsigned)(pool_size / 1024), millis() - t0);
+}
+
+// 起動時に events（バッファA）へ復元。now は RTC 由来の現在時刻
+//   スナップショット保存後に鳴らしたアラームはジャーナルで、電源OFF中に過ぎたものは
+//   初回 fetch と同じ起動グレース（alarmBootSuppressed）で発火済み扱いにする
+bool loadEventSnapshot(time_t now) {
+    unsigned long t0 = millis();
+    waitEPDReady();
+    File f = SD.open(SNAPSHOT_FILE, FILE_READ);
+    if (!f) {
+        Serial.println("SNAPSHOT: none");
+        return false;
+    }
+
+    SnapshotHeader h;
+    bool ok = f.read((uint8_t*)&h, sizeof(h)) == (int)sizeof(h) &&
+              memcmp(h.magic, SNAPSHOT_MAGIC, 4) == 0 &&
+              h.version == SNAPSHOT_VERSION &&
+              h.header_size == sizeof(SnapshotHeader) &&
+              h.record_size == sizeof(EventItem) &&
+              h.count <= MAX_EVENTS &&
+              h.source_count <= MAX_FETCH_URLS;
+    if (!ok) {
+        Serial.println("SNAPSHOT: header mismatch (format changed?) - ignored");
+        f.close();
+        return false;
+    }
+    if (h.url_hash != icsHashStr(config.ics_url)) {
+        Serial.println("SNAPSHOT: ICS URL changed - ignored");
+        f.close();
+        return false;
+    }
+
+    TextPool* pool = textPoolFor(events);
+    if (!pool->base || h.pool_size > pool->size) {
+        Serial.printf("SNAPSHOT: pool %u > %u - ignored\n",
+                      (unsigned)h.pool_size, (unsigned)pool->size);
+        f.close();
+        return false;
+    }
+    size_t rec_bytes = (size_t)h.count * sizeof(EventItem);
+    ok = f.read((uint8_t*)events, rec_bytes) == (int)rec_bytes &&
+         f.read((uint8_t*)pool->base, h.pool_size) == (int)h.pool_size;
+    f.close();
+
+    uint32_t hash = icsHash32(events, rec_bytes);
+    hash = icsHash32(pool->base, h.pool_size, hash);
+    if (!ok || hash != h.checksum) {
+        Serial.printf("SNAPSHOT: %s - ignored\n", ok ? "checksum mismatch" : "short read");
+        event_count = 0;
+        return false;
+    }
+
+    // オフセット → ポインタ（範囲外・終端なしのレコードがあれば全体を破棄）
+    for (int i = 0; i < h.count; i++) {
+        EventItem& e = events[i];
+        const char** fields[4] = { &e.summary_text, &e.desc_text, &e.midi_file, &e.row_text };
+        for (int k = 0; k < 4; k++) {
+            uint32_t off = (uint32_t)(uintptr_t)*fields[k];
+            bool packed = (k == 1 && e.desc_packed > 0);
+            bool bad = packed ? (off + e.desc_packed > h.pool_size)
+                              : (off >= h.pool_size || !memchr(pool->base + off, '\0', h.pool_size - off));
+            if (bad) {
+                Serial.printf("SNAPSHOT: record %d out of range - ignored\n", i);
+                event_count = 0;
+                return false;
+            }
+            *fields[k] = pool->base + off;
+        }
+        // 行表示の切り詰め位置は row_text の範囲内（描画時に境界チェックしないため）
+        if (e.row_len != strlen(e.row_text) || e.row_l1 > e.row_len || e.row_w1 > e.row_w2 ||
+            e.row_w2 > e.row_len || !memchr(e.time_text, '\0', sizeof(e.time_text))) {
+            Serial.printf("SNAPSHOT: record %d bad row layout - ignored\n", i);
+            event_count = 0;
+            return false;
+        }
+    }
+    pool->used = h.pool_size;
+
+    // 発火済みの印は公開前に付ける（公開した版は書き換えない。監視タスクが先に見て鳴らさないよう）
+    int expired = 0;
+    for (int i = 0; i < h.count; i++) {
+        for (int k = 0; k < events[i].alarm_count; k++) {
+            if (!events[i].triggered[k] &&
+                alarmBootSuppressed(events[i].uid_hash, events[i].alarm_time[k], now)) {
+                events[i].triggered[k] = true;
+                expired++;
+            }
+        }
+    }
+    publishEvents(events, h.count);
+
+    // ソース状態はヘッダー表示用に復元。取得時刻は 0 にして、起動後の最初の loop で全ソースを更新
+    fetch_url_count = h.source_count;
+    memcpy(source_state, h.sources, sizeof(h.sources));
+    for (int i = 0; i < MAX_FETCH_URLS; i++) source_state[i].last_attempt = 0;
+    last_fetch = (time_t)h.last_fetch;
+    restorePollBudget(h.budget_fetches, h.budget_bytes, h.budget_day);
+
+    rebuildEventIndex();
+    searchIndexRebuild();
+    long age = (long)(now - (time_t)h.saved_at);
+    Serial.printf("SNAPSHOT: loaded %d events + %uKB text, age %ldmin, %d alarms acked/expired (%lums)\n",
+                  event_count, (unsigned)(h.pool_size / 1024), age / 60, expired, millis() - t0);
+    return true;
+}
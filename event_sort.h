@@ -0,0 +1,128 @@
+#ifndef EVENT_SORT_H
+#define EVENT_SORT_H
+
+//==============================================================================
+// イベント並べ替え（プラットフォーム非依存・ヘッダオンリー）
+//   EventItem 本体は動かさず、(start, index) のキー配列をソートしてから
+//   置換（permutation）を1回だけ適用する。
+//
+//   fetch 後のバッファはソース(URL)ごとのセグメントが連なった形で、
+//   引き継ぎセグメント・M5EV フィードは既に start 昇順になっている。
+//   各ランを「整列済みならそのまま / 未整列なら std::sort」で整えてから
+//   k-way マージするため、通常は O(n·k)（k ≤ MAX_FETCH_URLS）で済む。
+//
+//   表示ウィンドウ（過去7日〜未来30日）に収まるキーは、先に1日幅のバケットへ
+//   振り分けて（計数ソート）バケット内だけを挿入ソートする。取り込み順・ラン数に
+//   よらず O(n + 日内の逆転数) で、ウィンドウ外にはみ出す場合だけランマージに回す。
+//
+//   ホスト側ベンチマーク tools/sortbench からも同じコードを使う。
+//==============================================================================
+#include <stdint.h>
+#include <algorithm>
+
+struct SortKey {
+    uint32_t start;     // 開始時刻 (UNIX秒)
+    uint16_t idx;       // 元の events[] index
+    uint16_t run;       // 所属ラン（マージ用）
+};
+
+inline bool sortKeyLess(const SortKey& a, const SortKey& b) {
+    return (a.start != b.start) ? (a.start < b.start) : (a.idx < b.idx);
+}
+
+#define SORT_MAX_RUNS   16      // これを超えるランは全体ソートにフォールバック
+
+// keys[0..n) を (start, idx) 昇順に並べる。
+//   run_start[0..run_count) は各ランの先頭位置（昇順、run_start[0]==0）。
+//   tmp は n 要素の作業域。結果は keys に入る
+inline void sortKeysByRuns(SortKey* keys, SortKey* tmp, int n,
+                           const int* run_start, int run_count) {
+    if (n <= 1) return;
+    if (run_count <= 1 || run_count > SORT_MAX_RUNS) {
+        if (!std::is_sorted(keys, keys + n, sortKeyLess)) std::sort(keys, keys + n, sortKeyLess);
+        return;
+    }
+
+    // 1) 各ランを個別に整列（整列済みなら何もしない）
+    int head[SORT_MAX_RUNS], end[SORT_MAX_RUNS];
+    for (int r = 0; r < run_count; r++) {
+        head[r] = run_start[r];
+        end[r] = (r + 1 < run_count) ? run_start[r + 1] : n;
+        if (!std::is_sorted(keys + head[r], keys + end[r], sortKeyLess)) {
+            std::sort(keys + head[r], keys + end[r], sortKeyLess);
+        }
+    }
+
+    // 2) k-way マージ（k は高々 SORT_MAX_RUNS なので先頭の線形比較で十分）
+    for (int out = 0; out < n; out++) {
+        int best = -1;
+        for (int r = 0; r < run_count; r++) {
+            if (head[r] >= end[r]) continue;
+            if (best < 0 || sortKeyLess(keys[head[r]], keys[head[best]])) best = r;
+        }
+        tmp[out] = keys[head[best]++];
+    }
+    std::copy(tmp, tmp + n, keys);
+}
+
+#define SORT_DAY_SEC      86400
+#define SORT_DAY_BUCKETS  64    // 日バケット数（ウィンドウ 7+30+1 日を収容）
+
+// keys[0..n) を1日幅バケット経由で (start, idx) 昇順に並べる。tmp は n 要素の作業域。
+//   最小 start から SORT_DAY_BUCKETS 日を超えるキーがあれば何もせず false
+inline bool sortKeysByDay(SortKey* keys, SortKey* tmp, int n) {
+    if (n <= 1) return true;
+    uint32_t lo = keys[0].start, hi = keys[0].start;
+    for (int i = 1; i < n; i++) {
+        if (keys[i].start < lo) lo = keys[i].start;
+        if (keys[i].start > hi) hi = keys[i].start;
+    }
+    if ((hi - lo) / SORT_DAY_SEC >= SORT_DAY_BUCKETS) return false;
+
+    // 1) 計数ソートでバケットへ（keys は idx 順に生成済みなのでバケット内も idx 順を保つ）
+    int pos[SORT_DAY_BUCKETS + 1] = {};
+    for (int i = 0; i < n; i++) pos[(keys[i].start - lo) / SORT_DAY_SEC + 1]++;
+    for (int b = 0; b < SORT_DAY_BUCKETS; b++) pos[b + 1] += pos[b];
+    for (int i = 0; i < n; i++) tmp[pos[(keys[i].start - lo) / SORT_DAY_SEC]++] = keys[i];
+
+    // 2) 挿入ソート（バケット間は整列済みなので要素はバケット内でしか動かない）
+    for (int i = 1; i < n; i++) {
+        SortKey k = tmp[i];
+        int j = i;
+        while (j > 0 && sortKeyLess(k, tmp[j - 1])) { tmp[j] = tmp[j - 1]; j--; }
+        tmp[j] = k;
+    }
+    std::copy(tmp, tmp + n, keys);
+    return true;
+}
+
+// items を置換 src に従って並べ替える（items'[j] = items[src[j]]）。
+//   src は全単射であること。巡回置換を辿るため要素移動は n+巡回数 回、作業域は1要素のみ。
+//   src は作業中に破壊される（終了時 src[j]==j）
+template <typename T>
+inline void applyPermutation(T* items, uint16_t* src, int n) {
+    for (int j = 0; j < n; j++) {
+        if (src[j] == j) continue;
+        T tmp = items[j];
+        int k = j;
+        while (true) {
+            int s = src[k];
+            src[k] = (uint16_t)k;
+            if (s == j) { items[k] = tmp; break; }
+            items[k] = items[s];
+            k = s;
+        }
+    }
+}
+
+// trim 用: ソート済みキーで「now-1日」以降の最初の位置を二分探索
+inline int lowerBoundStart(const SortKey* keys, int n, uint32_t t) {
+    int lo = 0, hi = n;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (keys[mid].start < t) lo = mid + 1; else hi = mid;
+    }
+    return lo;
+}
+
+#endif // EVENT_SORT_H
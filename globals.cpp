@@ -14,13 +14,15 @@ UiState ui_state = UI_LIST;
 int selected_event = -1;
 int page_start = 0;
 int displayed_count = 0;
-int row_event_idx[MAX_EVENTS];
+int row_event_idx[MAX_DISPLAY_ROWS];
 int detail_scroll = 0;
+int month_offset = 0;             // 月表示: 今月からの月数
 
 ButtonArea btn_prev, btn_next, btn_today, btn_detail;
 int settings_cursor = 0;
 
 int playing_event = -1;
+EventRef playing_ref = { 0, 0, 0, -1 };
 int playing_alarm_idx = -1;     // 発火中アラームのslot index
 int play_repeat_remaining = 0;
 
@@ -46,8 +48,8 @@ extern const char* port_names[] = {"PORT A (G25)", "PORT B (G26)", "PORT C (G18)
 extern const int port_tx_pins[] = {25, 26, 18};
 int port_select_cursor = 0;
 
-int row_y0[MAX_EVENTS];
-int row_y1[MAX_EVENTS];
+int row_y0[MAX_DISPLAY_ROWS];
+int row_y1[MAX_DISPLAY_ROWS];
 
 int date_header_y0[10];
 int date_header_y1[10];
@@ -60,11 +62,7 @@ bool reboot_pending = false;
 DisplayRow last_pushed[MAX_DISPLAY_ROWS];
 int last_pushed_count = 0;
 bool row_changed[MAX_DISPLAY_ROWS];
-unsigned long last_switch_check = 0;
 unsigned long last_interaction_ms = 0;
-time_t last_alarm_debug = 0;
-time_t last_auto_refresh = 0;
-unsigned long last_sd_check_ms = 0;
 
 SimpleMIDIPlayer midi;
 bool midi_playing = false;
@@ -73,7 +71,6 @@ bool sd_healthy = true;
 
 M5EPD_Canvas heartbeat_canvas(&M5.EPD);
 bool heartbeat_visible = false;
-unsigned long last_heartbeat_ms = 0;
 
 int displayed_next_event_idx = -1;
 
@@ -81,7 +78,7 @@ int partial_refresh_count = 0;
 int heap_skip_count = 0;
 
 int fetch_url_count = 0;
-uint8_t fetch_url_status[MAX_FETCH_URLS] = {0};
+SourceState source_state[MAX_FETCH_URLS] = {};
 
 bool sw_l_prev = true;
 bool sw_r_prev = true;
@@ -89,48 +86,28 @@ bool sw_p_prev = true;
 
 //==============================================================================
 // 表示内容スナップショット（画面イメージベース比較）
-//   drawEventRow()と同じロジックで「画面に表示される文字列」を生成し保存
-//   生データ(text[4000])ではなく、utf8Substringで切り詰めた表示文字列で比較
+//   drawEventRow()と同じ切り出し（取り込み時に決めた row_* の範囲）で
+//   「画面に表示される文字列」を組み立てて保存
+//   生データ(text[4000])ではなく、切り詰めた表示文字列で比較
 //   → len=153 vs len=120 でも画面上同一なら変更なしと判定
 //==============================================================================
-String computeRowDisplayText(int evtIdx) {
-    if (evtIdx >= event_count) return "";
-
-    struct tm st;
-    localtime_r(&events[evtIdx].start, &st);
-
-    // drawEventRow()と完全に同じフォーマット
-    String timeStr = events[evtIdx].is_allday ? "[終日]" : formatTime(st.tm_hour, st.tm_min);
-    String mark = "";
-    if (events[evtIdx].has_alarm) {
-        bool anyPending = false;
-        for (int k = 0; k < events[evtIdx].alarm_count; k++) {
-            if (!events[evtIdx].triggered[k]) { anyPending = true; break; }
-        }
-        mark = anyPending ? "♪" : "*";
-    }
-
-    String summary = removeUnsupportedChars(events[evtIdx].summary());
-    int maxWidth = config.text_wrap ? 26 : 30;
-    String dispSummary = utf8Substring(summary, maxWidth);
-
-    String result = timeStr + "|" + mark + "|" + dispSummary;
-
-    if (config.text_wrap && summary.length() > dispSummary.length()) {
-        String rest = summary.substring(dispSummary.length());
-        String line2 = utf8Substring(rest, 34);
-        result += "|" + line2;
+int computeRowDisplayText(int evtIdx, char* out, int size) {
+    if (evtIdx < 0 || evtIdx >= event_count) { out[0] = '\0'; return 0; }
+    const EventItem& e = events[evtIdx];
+    const char* mark = !e.has_alarm ? "" : eventHasPendingAlarm(evtIdx) ? "♪" : "*";
+    bool wrap = config.text_wrap && e.row_len > e.row_w1;
+    int l1 = config.text_wrap ? e.row_w1 : e.row_l1;
+    int n = snprintf(out, size, "%s|%s|%.*s", e.time_text, mark, l1, e.row_text);
+    if (wrap && n < size) {
+        n += snprintf(out + n, size - n, "|%.*s", e.row_w2 - e.row_w1, e.row_text + e.row_w1);
     }
-    return result;
+    return n;
 }
 
 void saveDisplaySnapshot() {
     last_pushed_count = min(displayed_count, MAX_DISPLAY_ROWS);
     for (int d = 0; d < last_pushed_count; d++) {
-        int idx = row_event_idx[d];
-        String txt = computeRowDisplayText(idx);
-        strncpy(last_pushed[d].display_text, txt.c_str(), DISPLAY_TEXT_LEN - 1);
-        last_pushed[d].display_text[DISPLAY_TEXT_LEN - 1] = '\0';
+        computeRowDisplayText(row_event_idx[d], last_pushed[d].display_text, DISPLAY_TEXT_LEN);
     }
 }
 
@@ -147,9 +124,10 @@ bool displayContentChanged() {
     bool any_changed = false;
     for (int d = 0; d < count; d++) {
         int idx = row_event_idx[d];
-        String newText = computeRowDisplayText(idx);
+        char newText[DISPLAY_TEXT_LEN];
+        computeRowDisplayText(idx, newText, sizeof(newText));
 
-        if (strcmp(last_pushed[d].display_text, newText.c_str()) != 0) {
+        if (strcmp(last_pushed[d].display_text, newText) != 0) {
             row_changed[d] = true;
             any_changed = true;
             Serial.printf("Row %d (event[%d]) display differs: '%s'\n",
@@ -6,6 +6,7 @@
 #include <WiFi.h>
 #include "SimpleMIDIPlayer.h"
 #include "types.h"
+#include "ics_core.h"
 
 //==============================================================================
 // グローバル変数 (extern宣言 — 実体は globals.cpp)
@@ -19,6 +20,8 @@ extern Config config;
 extern EventItem* events;
 extern EventItem* events_buf_a;
 extern EventItem* events_buf_b;
+extern TextPool text_pool_a;        // events_buf_a の本文プール
+extern TextPool text_pool_b;        // events_buf_b の本文プール
 extern int event_count;
 
 // UI状態
@@ -26,8 +29,9 @@ extern UiState ui_state;
 extern int selected_event;
 extern int page_start;
 extern int displayed_count;
-extern int row_event_idx[MAX_EVENTS];
+extern int row_event_idx[MAX_DISPLAY_ROWS];
 extern int detail_scroll;
+extern int month_offset;
 
 // ボタン領域
 extern ButtonArea btn_prev, btn_next, btn_today, btn_detail;
@@ -37,6 +41,7 @@ extern int settings_cursor;
 
 // 再生状態
 extern int playing_event;
+extern EventRef playing_ref;        // 鳴動中イベントの版をまたぐ参照（fetch/日付ロールを挟んでも追える）
 extern int playing_alarm_idx;
 extern int play_repeat_remaining;
 extern bool initial_fetch_done;
@@ -61,8 +66,8 @@ extern const int port_tx_pins[];
 extern int port_select_cursor;
 
 // タッチ行判定
-extern int row_y0[MAX_EVENTS];
-extern int row_y1[MAX_EVENTS];
+extern int row_y0[MAX_DISPLAY_ROWS];
+extern int row_y1[MAX_DISPLAY_ROWS];
 
 // 日付ヘッダー
 extern int date_header_y0[10];
@@ -70,8 +75,7 @@ extern int date_header_y1[10];
 extern int date_header_count;
 
 // 表示内容スナップショット（最後にpushCanvasした時の「画面表示テキスト」をPSRAMに保持）
-// 生データではなく、描画時にutf8Substringで切り詰めた実際の表示文字列を保存
-#define MAX_DISPLAY_ROWS 20
+// 生データではなく、取り込み時に切り詰め位置を決めた実際の表示文字列を保存
 #define DISPLAY_TEXT_LEN 256  // 表示文字列バッファ（time|mark|line1|line2）
 struct DisplayRow {
     char display_text[DISPLAY_TEXT_LEN];
@@ -80,7 +84,7 @@ extern DisplayRow last_pushed[MAX_DISPLAY_ROWS];
 extern int last_pushed_count;
 extern bool row_changed[MAX_DISPLAY_ROWS];  // displayContentChangedが設定
 
-String computeRowDisplayText(int evtIdx);
+int  computeRowDisplayText(int evtIdx, char* out, int size);
 void saveDisplaySnapshot();
 bool displayContentChanged();  // row_changed[]も設定する
 
@@ -89,11 +93,7 @@ extern time_t last_fetch;
 extern int fetch_fail_count;
 extern bool debug_fetch;
 extern bool reboot_pending;
-extern unsigned long last_switch_check;
 extern unsigned long last_interaction_ms;
-extern time_t last_alarm_debug;
-extern time_t last_auto_refresh;
-extern unsigned long last_sd_check_ms;
 
 // MIDI
 extern SimpleMIDIPlayer midi;
@@ -105,7 +105,6 @@ extern bool sd_healthy;
 // ハートビート（生存確認インジケーター）
 extern M5EPD_Canvas heartbeat_canvas;
 extern bool heartbeat_visible;
-extern unsigned long last_heartbeat_ms;
 
 // 部分更新用：表示中の「次のイベント」インデックス
 extern int displayed_next_event_idx;
@@ -116,11 +115,12 @@ extern int partial_refresh_count;
 // ヒープ不足スキップ連続回数
 extern int heap_skip_count;
 
-// URLごとのfetch結果 (ヘッダー表示用)
-//   status: 0=unknown/未試行, 1=OK, 2=FAIL
-#define MAX_FETCH_URLS 8
+// URL(ソース)ごとの取得状態 (ヘッダー表示・ソース別更新スケジュール用)
 extern int fetch_url_count;
-extern uint8_t fetch_url_status[MAX_FETCH_URLS];
+extern SourceState source_state[MAX_FETCH_URLS];
+
+// 直近 fetch の差分集計 (event_diff.cpp)
+extern FetchDiff fetch_diff;
 
 // スイッチ状態
 extern bool sw_l_prev, sw_r_prev, sw_p_prev;
@@ -137,9 +137,12 @@ void saveConfig();
 bool isUtf8LeadByte(uint8_t c);
 int  utf8CharBytes(uint8_t c);
 String utf8Substring(const String& s, int maxWidth);
+int  utf8FitBytes(const char* s, int len, int maxWidth);
+int  sanitizeDisplayText(const char* s, int len, char* out);
 String normalizeFullWidth(const String& s);
 String removeUnsupportedChars(const String& s);
 String simplifyHtml(const String& s);
+String displayText(const EventItem& e, const char* s);
 
 // sd_utils.cpp
 void waitEPDReady();   // EPD描画完了を待つ（SD操作前に必須）
@@ -150,7 +153,13 @@ void scanMidiFiles();
 
 // network.cpp
 bool connectWiFi();
-void sendNtfyNotification(const String& title, const String& message);
+bool restoreTimeFromRTC();
+void saveTimeToRTC();
+void startNtfyWorker();
+void enqueueNtfy(const char* title, const char* message);
+int  ntfyFlush(uint32_t timeout_ms);
+bool ntfyIdle();
+void reportNtfy();
 bool downloadMidi(const String& filename, String& localPath);
 
 // midi_player.cpp
@@ -159,38 +168,171 @@ bool startMidiPlayback(const char* filename);
 void stopMidiPlayback();
 void updateMidiPlayback();
 void finishAlarm();
-String getMidiPath(int eventIdx);
+void holdPlayingEvent(int evt, int slot);
+void preArmMidi();
+bool startArmedPlayback(int evt);
+void markAlarmFire();
+void reportMidiPrearm();
+String getMidiPath(int eventIdx, bool allow_download = true);
+
+// midi_out.cpp
+void startMidiOutTask();
+void midiOutStart(uint32_t start_us);
+bool midiOutPush(uint32_t at_us, const uint8_t* data, uint16_t len);
+bool midiOutRoom();
+bool midiOutIdle();
+void midiOutReset();
+bool midiOutTakeFirstByte(uint32_t* us);
+bool midiOutTakeFirstNote(uint32_t* us);
+void reportMidiOut();
+
+// event_index.cpp
+void     rebuildEventIndex();
+void     setAlarmTriggered(int evt, int slot);
+bool     eventHasPendingAlarm(int evt);
+int      findDueAlarm(time_t now, int& slot);
+int      findDueAlarms(time_t now, int* evts, uint8_t* slots, int max);
+time_t   nextPendingAlarm(time_t now, int* evt = nullptr);
+int      findNextEventIdx(time_t now);
+int      firstEventOnOrAfterDay(uint16_t day);
+uint16_t dayKeyOf(time_t t);
+uint16_t eventDayKey(int evt);
+int      eventsOnDay(uint16_t day, int* first);
+int      firstEventOfPrevDay(int evt);
+int      firstEventOfNextDay(int evt);
+int      rollEventWindow(time_t now);
+int      dayStats(uint16_t day, uint8_t* flags);
+void     reportEventIndexTiming(time_t now);
+uint32_t alarmHeadTime();
+
+// event_rcu.cpp
+void          publishEvents(EventItem* base, int count);
+EventItem*    acquireWriteFace();
+EventSnapshot pinEvents();
+void          unpinEvents(EventSnapshot& v);
+uint32_t      eventEpoch();
+EventRef      makeEventRef(int idx);
+int           resolveEventRef(EventRef& r);
+
+// search_index.cpp
+void searchIndexBegin(const EventItem* buf);
+void searchIndexAdd(int idx, const char* sum, int sumLen, const char* desc, int descLen);
+bool searchIndexCarry(const EventItem* from, const uint16_t* map, int n);
+void searchIndexTruncate(int n);
+void searchIndexRemap(const uint16_t* pos);
+void searchIndexFinalize();
+void searchIndexRebuild();
+int  searchEvents(const char* query, int* out, int max_out);
+
+// event_diff.cpp
+void    diffEvents(const EventItem* old_buf, int old_n, const EventItem* new_buf, int new_n);
+bool    diffIsEmpty();
+int     diffMapOldIndex(int old_idx);
+time_t  diffOldStart(int old_idx);
+uint8_t diffFlags(int new_idx);
+bool    diffStructuralInRange(time_t from, time_t to);
+
+// alarm_journal.cpp
+void replayAlarmJournal();
+void journalAlarmAck(uint32_t uid_hash, time_t alarm_time);
+bool alarmAcked(uint32_t uid_hash, time_t alarm_time);
+bool alarmBootSuppressed(uint32_t uid_hash, time_t alarm_time, time_t now);
+void compactAlarmJournal(time_t now);
+
+// alarm_service.cpp
+void startAlarmTask();
+void alarmPreemptPoint();
+bool alarmInPreempt();
+void alarmAwareDelay(uint32_t ms);
+bool alarmAllowsBlocking(uint32_t block_ms, const char* what);
+bool beginAlarmFire(time_t scheduled);
+void returnFromAlarm(bool redraw = true);
+void reportAlarmLatency();
+void ringGroupBegin(const int* evts, const uint8_t* slots, int n);
+uint32_t ringGroupBudgetMs();
+void ringGroupJoin(time_t now);
+void ringGroupAckAll();
+bool ringGroupAdvance();
+int  ringGroupOthers(int* evts, int max);
+
+// alarm_timing.cpp
+void alarmTimingFire(time_t scheduled, uint32_t since_detect_ms);
+void alarmTimingLoaded();
+void alarmTimingUartByte(uint32_t uart_us);
+void alarmTimingEnd();
+void loadAlarmTiming();
+void reportAlarmTiming();
+
+// power.cpp
+void powerIdle();
+void powerService();
+void reportPower();
+bool powerWifiOff();
+
+// timers.cpp
+void    initTimers();
+int     timerAdd(const char* name, bool (*fn)(), uint32_t period_ms, uint32_t first_in_ms,
+                 uint8_t wake_reason, bool wake = true);
+void    timerRunIn(int id, uint32_t in_ms);
+void    timerSetRetry(int id, uint32_t retry_ms);
+void    dispatchTimers();
+int64_t timerNextIn(uint8_t* wake_reason);
+void    reportTimers();
+
+// event_snapshot.cpp
+void saveEventSnapshot();
+bool loadEventSnapshot(time_t now);
 
 // ics_parser.cpp
-bool parseDT(const char* raw, time_t& out, bool& is_allday);
-bool parseAlarmMarker(const char* s_raw, bool is_summary,
-                      int* offsets, int& offset_count, int max_offsets,
-                      bool& found,
-                      char* midi_file, int midi_file_size, bool& midi_is_url,
-                      int& duration_sec, int& repeat_count);
-void sortEvents();
-void trimEventsAroundToday(int maxEvents);
+bool      inEventsBufB(const EventItem* p);
+TextPool* textPoolFor(const EventItem* buf);
+void sortAndTrimEvents(int maxEvents);
 void installMbedTLSPsramAllocator();
-bool fetchAndUpdate();
+int  sourcePollSec(int src);
+bool fetchDue(time_t now);
+void deferFetch(time_t now);
+time_t nextFetchTime(time_t now);
+void reportPoll();
+void pollBudgetUsage(uint32_t* fetches, uint64_t* bytes, uint16_t* day);
+void restorePollBudget(uint32_t fetches, uint64_t bytes, uint16_t day);
+bool fetchAndUpdate(bool force_all = false);
 void safeReboot();
+void noteInteraction();
 
 // ui_common.cpp
 void drawText(const String& s, int x, int y);
 void drawTextBold(const String& s, int x, int y, int level = 2);
 void saveScreenshot();
 String formatTime(int hour, int minute);
+bool browsingScreen();
+void formatHeaderStatus(char* statusBuf, int size);
 void partialRefreshHeader();
 void partialRefreshNextLine();
 
 // ui_list.cpp
+void prepareRowText(EventItem& e);
+void prepareAllRowText();
 void scrollToToday();
 void drawList(bool fast = false, bool skip_push = false, bool highlight_changes = false, bool clean_refresh = false);
 void updateListCursor(int old_sel, int new_sel);
+void refreshListAfterFetch();
+void refreshListAfterRoll(int cut);
 
 // ui_detail.cpp
 void drawDetail(int idx, bool fast = false);
 void drawPlaying(int idx);
 
+// ui_month.cpp
+void     drawMonth(bool fast = false);
+uint16_t monthDayAt(int tx, int ty);
+
+// ui_search.cpp
+void openSearch();
+void runSearch(const String& q);
+void drawSearch(bool fast = false);
+void scrollSearch(int dir);
+int  searchHitAt(int tx, int ty);
+
 // ui_settings.cpp
 void drawSettings(bool fast = false);
 void handleSettingsSelect();
@@ -208,5 +350,8 @@ void checkSwitches();
 void handleSwitch(char sw);
 void handleTouch(int tx, int ty);
 void checkAlarms();
+void reportAlarmCheck();
+bool startAlarmRing(int i, int slot, uint32_t limit_ms);
+void formatAlarmNotice(int i, int slot, char* out, int size);
 
 #endif // GLOBALS_H
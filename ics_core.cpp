@@ -0,0 +1,441 @@
+#include "ics_core.h"
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <strings.h>
+
+// ★ ics_parser.cpp から Arduino 非依存部分を分離（ホスト側 tools/ics2bin と共用）
+//    作業バッファは ESP32 では PSRAM、ホストでは通常ヒープに確保する
+#ifdef ARDUINO
+#include <Arduino.h>
+#define ICS_CORE_ALLOC(n)   ps_malloc(n)
+#else
+#define ICS_CORE_ALLOC(n)   malloc(n)
+#endif
+
+static const int CONTENT_BUF   = 256;   // アラームマーカー内容
+static const int NORM_BUF      = 512;   // 全角正規化用
+
+//==============================================================================
+// char ユーティリティ
+//==============================================================================
+
+// 先頭・末尾の空白を除去（in-place）
+void trimBuf(char* s) {
+    int start = 0;
+    while (s[start] && (s[start] == ' ' || s[start] == '\t' || s[start] == '\r' || s[start] == '\n')) start++;
+    if (start > 0) {
+        int i = 0;
+        while (s[start + i]) { s[i] = s[start + i]; i++; }
+        s[i] = '\0';
+    }
+    int len = strlen(s);
+    while (len > 0 && (s[len-1] == ' ' || s[len-1] == '\t' || s[len-1] == '\r' || s[len-1] == '\n')) {
+        s[--len] = '\0';
+    }
+}
+
+// 全角ASCII→半角変換 (char版 normalizeFullWidth)
+void normalizeFullWidthBuf(const char* src, char* dst, int dstSize) {
+    int di = 0;
+    int i = 0;
+    int srcLen = strlen(src);
+    while (i < srcLen && di < dstSize - 1) {
+        uint8_t b0 = (uint8_t)src[i];
+        if (b0 == 0xEF && i + 2 < srcLen) {
+            uint8_t b1 = (uint8_t)src[i + 1];
+            uint8_t b2 = (uint8_t)src[i + 2];
+            if (b1 == 0xBC && b2 >= 0x81 && b2 <= 0xBF) {
+                dst[di++] = (char)(b2 - 0x60);
+                i += 3; continue;
+            }
+            if (b1 == 0xBD && b2 >= 0x80 && b2 <= 0x9E) {
+                dst[di++] = (char)(b2 - 0x20);
+                i += 3; continue;
+            }
+        }
+        dst[di++] = src[i++];
+    }
+    dst[di] = '\0';
+}
+
+// strncpyの安全版（常にNUL終端）
+void safeCopy(char* dst, const char* src, int dstSize) {
+    if (dstSize <= 0) return;
+    size_t n = strlen(src);
+    if (n >= (size_t)dstSize) n = dstSize - 1;
+    memcpy(dst, src, n);
+    dst[n] = '\0';
+}
+
+// 部分文字列コピー（src[from..to-1]をdstへ）
+void substrCopy(char* dst, const char* src, int from, int to, int dstSize) {
+    int srcLen = strlen(src);
+    if (from < 0) from = 0;
+    if (to > srcLen) to = srcLen;
+    int copyLen = to - from;
+    if (copyLen <= 0) { dst[0] = '\0'; return; }
+    if (copyLen >= dstSize) copyLen = dstSize - 1;
+    memcpy(dst, src + from, copyLen);
+    dst[copyLen] = '\0';
+}
+
+// HTML簡易デコード（char 版。端末の simplifyHtml と ics2bin で共通）
+// - ブロック要素(<br>, <p>, <div>, <li>, <h1>-<h6>, <tr>) → "\n"リテラル改行
+// - 他のタグ(<b>, <span>, <a>...) → 除去（中身の文字列は残す）
+// - 主要エンティティ(&nbsp; &amp; &lt; &gt; &quot; &apos; &#NNN; &#xHH;) → 対応
+// - 未対応のエンティティは除去（表示を汚さないため）
+//   out は len+1 バイト以上（置換で長くなることはない）。書き込んだバイト数を返す
+int icsSimplifyHtml(const char* s, int len, char* out) {
+    int n = 0;
+    int i = 0;
+    while (i < len) {
+        char c = s[i];
+        if (c == '<') {
+            const char* gt = (const char*)memchr(s + i + 1, '>', len - i - 1);
+            if (!gt) { memcpy(out + n, s + i, len - i); n += len - i; break; }
+            int end = (int)(gt - s);
+            int p = i + 1, q = end;
+            while (p < q && isspace((uint8_t)s[p])) p++;
+            while (q > p && isspace((uint8_t)s[q - 1])) q--;
+            bool isClosing = false;
+            if (p < q && s[p] == '/') {
+                isClosing = true;
+                p++;
+                while (p < q && isspace((uint8_t)s[p])) p++;
+            }
+            char name[4];
+            int nl = 0;
+            bool longName = false;
+            for (int k = p; k < q; k++) {
+                char ch = s[k];
+                if (ch == ' ' || ch == '/' || ch == '\t') break;
+                if (nl == 3) { longName = true; break; }
+                name[nl++] = (char)tolower((uint8_t)ch);
+            }
+            name[nl] = '\0';
+            bool open_nl = !longName && (strcmp(name, "br") == 0 || strcmp(name, "p") == 0 ||
+                                         strcmp(name, "div") == 0);
+            bool isBlock = open_nl || (!longName && (strcmp(name, "li") == 0 || strcmp(name, "tr") == 0 ||
+                                       (nl == 2 && name[0] == 'h' && name[1] >= '1' && name[1] <= '6')));
+            if (isBlock && (open_nl || isClosing)) {
+                out[n++] = '\\';
+                out[n++] = 'n';
+            }
+            i = end + 1;
+            continue;
+        }
+        if (c == '&') {
+            int span = len - i - 1 < 10 ? len - i - 1 : 10;
+            const char* semi = (const char*)memchr(s + i + 1, ';', span);
+            if (semi) {
+                const char* ent = s + i + 1;
+                int el = (int)(semi - ent);
+                auto is = [&](const char* name) {
+                    return el == (int)strlen(name) && strncasecmp(ent, name, el) == 0;
+                };
+                if      (is("nbsp")) out[n++] = ' ';
+                else if (is("amp"))  out[n++] = '&';
+                else if (is("lt"))   out[n++] = '<';
+                else if (is("gt"))   out[n++] = '>';
+                else if (is("quot")) out[n++] = '"';
+                else if (is("apos")) out[n++] = '\'';
+                else if (el > 1 && ent[0] == '#') {
+                    uint32_t code = 0;
+                    bool valid = true;
+                    if (ent[1] == 'x' || ent[1] == 'X') {
+                        if (el < 3) valid = false;
+                        for (int k = 2; k < el && valid; k++) {
+                            char ch = ent[k]; int d = -1;
+                            if (ch >= '0' && ch <= '9') d = ch - '0';
+                            else if (ch >= 'a' && ch <= 'f') d = ch - 'a' + 10;
+                            else if (ch >= 'A' && ch <= 'F') d = ch - 'A' + 10;
+                            else valid = false;
+                            if (valid) code = code * 16 + d;
+                        }
+                    } else {
+                        for (int k = 1; k < el && valid; k++) {
+                            char ch = ent[k];
+                            if (ch < '0' || ch > '9') { valid = false; break; }
+                            code = code * 10 + (ch - '0');
+                        }
+                    }
+                    if (valid && code >= 0x20 && code < 0x7F) out[n++] = (char)code;
+                    // 非ASCII/未対応はスキップ
+                }
+                // 未知のエンティティはまるごと除去
+                i = (int)(semi - s) + 1;
+                continue;
+            }
+        }
+        out[n++] = c;
+        i++;
+    }
+    out[n] = '\0';
+    return n;
+}
+
+// atoi相当の安全版（空白トリム込み）
+static int safeAtoi(const char* s) {
+    while (*s == ' ') s++;
+    return atoi(s);
+}
+
+//==============================================================================
+// 日時パース
+//==============================================================================
+bool parseDT(const char* raw, time_t& out, bool& is_allday) {
+    char s[ICS_DTSTART_BUF];
+    safeCopy(s, raw, ICS_DTSTART_BUF);
+    trimBuf(s);
+
+    int slen = strlen(s);
+    bool utc = (slen > 0 && s[slen - 1] == 'Z');
+    if (utc) s[slen - 1] = '\0';
+    slen = strlen(s);
+
+    int y = 0, mo = 0, d = 0, h = 0, mi = 0, se = 0;
+    is_allday = false;
+
+    // 数字部分を直接抽出（substring不要）
+    auto dig2 = [](const char* p) -> int { return (p[0] - '0') * 10 + (p[1] - '0'); };
+    auto dig4 = [](const char* p) -> int { return (p[0]-'0')*1000 + (p[1]-'0')*100 + (p[2]-'0')*10 + (p[3]-'0'); };
+
+    if (slen == 8) {
+        y  = dig4(s);
+        mo = dig2(s + 4);
+        d  = dig2(s + 6);
+        is_allday = true;
+    } else if (slen >= 15 && s[8] == 'T') {
+        y  = dig4(s);
+        mo = dig2(s + 4);
+        d  = dig2(s + 6);
+        h  = dig2(s + 9);
+        mi = dig2(s + 11);
+        se = dig2(s + 13);
+    } else {
+        return false;
+    }
+
+    struct tm t = {};
+    t.tm_year = y - 1900;
+    t.tm_mon  = mo - 1;
+    t.tm_mday = d;
+    t.tm_hour = h;
+    t.tm_min  = mi;
+    t.tm_sec  = se;
+
+    if (!utc) {
+        out = mktime(&t);
+        return out != (time_t)-1;
+    }
+
+    setenv("TZ", "UTC0", 1);
+    tzset();
+    time_t u = mktime(&t);
+    setenv("TZ", TZ_JST, 1);
+    tzset();
+    out = u;
+    return out != (time_t)-1;
+}
+
+//==============================================================================
+// アラームマーカーパーサー
+//==============================================================================
+bool parseAlarmMarker(const char* s_raw, bool is_summary,
+                      int* offsets, int& offset_count, int max_offsets,
+                      bool& found,
+                      char* midi_file, int midi_file_size, bool& midi_is_url,
+                      int& duration_sec, int& repeat_count,
+                      int default_offset) {
+    static char* norm = nullptr;  // PSRAM上に配置
+    if (!norm) norm = (char*)ICS_CORE_ALLOC(NORM_BUF);
+    normalizeFullWidthBuf(s_raw, norm, NORM_BUF);
+    const char* s = norm;
+    int sLen = strlen(s);
+
+    found = false;
+    offset_count = 0;
+    midi_file[0] = '\0';
+    midi_is_url = false;
+    duration_sec = -1;
+    repeat_count = -1;
+
+    // 重複オフセット排除のためのローカルlambda風ヘルパ
+    auto pushOffset = [&](int v) {
+        if (offset_count >= max_offsets) return;
+        for (int k = 0; k < offset_count; k++) if (offsets[k] == v) return;
+        offsets[offset_count++] = v;
+    };
+
+    // ── 統一ロジック: summary/description 問わず同じ判定 ──
+    // 1) !...! ペアがあれば詳細パラメータを解析
+    //    オフセットはカンマ区切りで複数指定可: !-25,-15,-5!
+    // 2) 閉じペアのない単独 ! があればデフォルトオフセットでアラームON
+
+    int searchStart = 0;
+    while (searchStart < sLen) {
+        const char* pPtr = strchr(s + searchStart, '!');
+        if (!pPtr) break;
+        int p = pPtr - s;
+
+        const char* ePtr = strchr(s + p + 1, '!');
+        if (!ePtr) {
+            // 閉じ ! なし → 単独 ! → デフォルトオフセットでアラームON
+            found = true;
+            if (offset_count == 0) pushOffset(default_offset);
+            return true;
+        }
+        int endExcl = ePtr - s;
+
+        found = true;
+
+        static char* content = nullptr;
+        if (!content) content = (char*)ICS_CORE_ALLOC(CONTENT_BUF);
+        substrCopy(content, s, p + 1, endExcl, CONTENT_BUF);
+
+        bool blockHasOffset = false;
+        bool thisIsUrl = false;
+        char thisFile[ICS_MIDI_FILE_BUF];
+        thisFile[0] = '\0';
+
+        int cLen = strlen(content);
+        int i = 0;
+        while (i < cLen) {
+            char c = content[i];
+            if (c == '-' || c == '+') {
+                int numStart = i + 1, numEnd = numStart;
+                while (numEnd < cLen && (isdigit(content[numEnd]) || content[numEnd] == ' ')) numEnd++;
+                if (numEnd > numStart) {
+                    char numBuf[16];
+                    substrCopy(numBuf, content, numStart, numEnd, sizeof(numBuf));
+                    int val = safeAtoi(numBuf);
+                    if (val >= 0 && val <= 24 * 60) {
+                        int signedVal = (c == '-') ? val : -val;
+                        pushOffset(signedVal);
+                        blockHasOffset = true;
+                    }
+                }
+                i = numEnd;
+            } else if (c == ',' || c == ' ') {
+                // カンマ・空白はオフセット区切りとして読み飛ばし
+                i++;
+            } else if (c == '>' || c == '<') {
+                thisIsUrl = (c == '>');
+                int fileStart = i + 1, fileEnd = fileStart;
+                while (fileEnd < cLen &&
+                       content[fileEnd] != '-' && content[fileEnd] != '+' &&
+                       content[fileEnd] != '@' && content[fileEnd] != '*' &&
+                       content[fileEnd] != '>' && content[fileEnd] != '<') fileEnd++;
+                if (fileEnd > fileStart) {
+                    substrCopy(thisFile, content, fileStart, fileEnd, ICS_MIDI_FILE_BUF);
+                    trimBuf(thisFile);
+                }
+                i = fileEnd;
+            } else if (c == '@') {
+                int numStart = i + 1, numEnd = numStart;
+                while (numEnd < cLen && (isdigit(content[numEnd]) || content[numEnd] == ' ')) numEnd++;
+                if (numEnd > numStart) {
+                    char numBuf[16];
+                    substrCopy(numBuf, content, numStart, numEnd, sizeof(numBuf));
+                    duration_sec = safeAtoi(numBuf);
+                } else {
+                    duration_sec = 0;
+                }
+                i = numEnd;
+            } else if (c == '*') {
+                int numStart = i + 1, numEnd = numStart;
+                while (numEnd < cLen && (isdigit(content[numEnd]) || content[numEnd] == ' ')) numEnd++;
+                if (numEnd > numStart) {
+                    char numBuf[16];
+                    substrCopy(numBuf, content, numStart, numEnd, sizeof(numBuf));
+                    repeat_count = safeAtoi(numBuf);
+                }
+                i = numEnd;
+            } else {
+                i++;
+            }
+        }
+
+        // !...! ブロック内に明示オフセットが無ければデフォルトを1つ
+        if (!blockHasOffset) pushOffset(default_offset);
+
+        if (thisFile[0] != '\0') {
+            safeCopy(midi_file, thisFile, midi_file_size);
+            midi_is_url = thisIsUrl;
+        }
+        searchStart = endExcl + 1;
+    }
+
+    if (found && offset_count == 0) pushOffset(default_offset);
+    return found;
+}
+
+uint32_t icsHash32(const void* data, size_t len, uint32_t seed) {
+    const uint8_t* p = (const uint8_t*)data;
+    uint32_t h = seed;
+    for (size_t i = 0; i < len; i++) { h ^= p[i]; h *= 16777619u; }
+    return h;
+}
+
+uint32_t icsHashStr(const char* s, uint32_t seed) {
+    return icsHash32(s, strlen(s), seed);
+}
+
+//==============================================================================
+// VEVENT 行パーサー
+//==============================================================================
+void icsVEventInit(IcsVEvent& ev, char* summary, int summary_size, char* desc, int desc_size) {
+    ev.in_event = false;
+    ev.uid_hash = 0;
+    ev.dtstart_raw[0] = '\0';
+    ev.summary = summary; ev.summary_size = summary_size;
+    ev.desc = desc;       ev.desc_size = desc_size;
+    ev.summary[0] = '\0';
+    ev.desc[0] = '\0';
+}
+
+IcsLineResult icsFeedLine(IcsVEvent& ev, char* line) {
+    trimBuf(line);
+    if (line[0] == '\0') return ICS_LINE_NONE;
+
+    if (strcmp(line, "BEGIN:VEVENT") == 0) {
+        ev.in_event = true;
+        ev.uid_hash = 0;
+        ev.dtstart_raw[0] = '\0';
+        ev.summary[0] = '\0';
+        ev.desc[0] = '\0';
+        return ICS_LINE_NONE;
+    }
+
+    if (strcmp(line, "END:VEVENT") == 0) {
+        // in_event でない END は親の呼び出し側で件数だけ数える（従来互換）
+        bool was_in = ev.in_event;
+        ev.in_event = false;
+        return was_in ? ICS_LINE_END_EVENT : ICS_LINE_NONE;
+    }
+
+    if (!ev.in_event) return ICS_LINE_NONE;
+
+    // プロパティ解析: "KEY;PARAMS:VALUE" または "KEY:VALUE"
+    const char* colon = strchr(line, ':');
+    if (!colon) return ICS_LINE_NONE;
+
+    if (strncmp(line, "DTSTART", 7) == 0 && (line[7] == ':' || line[7] == ';')) {
+        safeCopy(ev.dtstart_raw, colon + 1, ICS_DTSTART_BUF);
+    } else if (strncmp(line, "UID", 3) == 0 && (line[3] == ':' || line[3] == ';')) {
+        ev.uid_hash = icsHashStr(colon + 1);
+    } else if (strncmp(line, "SUMMARY", 7) == 0 && (line[7] == ':' || line[7] == ';')) {
+        safeCopy(ev.summary, colon + 1, ev.summary_size);
+    } else if (strncmp(line, "DESCRIPTION", 11) == 0 && (line[11] == ':' || line[11] == ';')) {
+        const char* val = colon + 1;
+        int valLen = strlen(val);
+        if (valLen > ICS_DESC_PARSE_MAX && ICS_DESC_PARSE_MAX < ev.desc_size) {
+            memcpy(ev.desc, val, ICS_DESC_PARSE_MAX);
+            ev.desc[ICS_DESC_PARSE_MAX] = '\0';
+        } else {
+            safeCopy(ev.desc, val, ev.desc_size);
+        }
+    }
+    return ICS_LINE_NONE;
+}
@@ -0,0 +1,130 @@
+#ifndef ICS_CORE_H
+#define ICS_CORE_H
+
+//==============================================================================
+// ICS解析コア（プラットフォーム非依存）
+//   Arduino API を使わない部分を ics_parser.cpp から切り出したもの。
+//   ESP32 本体と Linux 側の ICS→バイナリ変換ツール (tools/ics2bin) の両方で
+//   同じ行パーサー・日時パース・アラームマーカー解析を使う。
+//==============================================================================
+#include <stdint.h>
+#include <stddef.h>
+#include <time.h>
+
+#ifndef TZ_JST
+#define TZ_JST                  "JST-9"     // types.h と同値（ホストツール用）
+#endif
+
+//==============================================================================
+// パーサー用バッファサイズ定数
+//==============================================================================
+#define ICS_LINE_BUF        4096    // ICS 1行 (unfold後)
+#define ICS_DTSTART_BUF     32      // "20250214T120000Z" 程度
+#define ICS_SUMMARY_BUF     512     // タイトル
+#define ICS_DESC_BUF        2048    // 説明文
+#define ICS_DESC_PARSE_MAX  2000    // DESCRIPTION 取り込み上限
+#define ICS_MIDI_FILE_BUF   128     // MIDIファイル名
+
+//==============================================================================
+// 文字列ユーティリティ
+//==============================================================================
+void trimBuf(char* s);
+void normalizeFullWidthBuf(const char* src, char* dst, int dstSize);
+void safeCopy(char* dst, const char* src, int dstSize);
+void substrCopy(char* dst, const char* src, int from, int to, int dstSize);
+int  icsSimplifyHtml(const char* s, int len, char* out);     // out は len+1 バイト以上
+#define ICS_HASH_SEED   2166136261u     // FNV-1a offset basis
+uint32_t icsHash32(const void* data, size_t len, uint32_t seed = ICS_HASH_SEED);   // FNV-1a
+uint32_t icsHashStr(const char* s, uint32_t seed = ICS_HASH_SEED);
+
+//==============================================================================
+// 日時・アラームマーカー
+//==============================================================================
+bool parseDT(const char* raw, time_t& out, bool& is_allday);
+
+// default_offset: オフセット未指定の !...! / 単独 ! に使う値（分）
+bool parseAlarmMarker(const char* s_raw, bool is_summary,
+                      int* offsets, int& offset_count, int max_offsets,
+                      bool& found,
+                      char* midi_file, int midi_file_size, bool& midi_is_url,
+                      int& duration_sec, int& repeat_count,
+                      int default_offset);
+
+//==============================================================================
+// VEVENT 行パーサー（unfold 済みの論理行を1行ずつ渡す）
+//   summary/desc の格納先は呼び出し側が用意する（ESP32 では PSRAM）
+//==============================================================================
+struct IcsVEvent {
+    bool  in_event;
+    uint32_t uid_hash;                  // UID のハッシュ（UIDなし=0）
+    char  dtstart_raw[ICS_DTSTART_BUF];
+    char* summary;  int summary_size;
+    char* desc;     int desc_size;
+};
+
+enum IcsLineResult {
+    ICS_LINE_NONE = 0,      // 何もしない / プロパティ取り込み
+    ICS_LINE_END_EVENT      // END:VEVENT — ev の内容で1件確定
+};
+
+void icsVEventInit(IcsVEvent& ev, char* summary, int summary_size, char* desc, int desc_size);
+IcsLineResult icsFeedLine(IcsVEvent& ev, char* line);
+
+//==============================================================================
+// バイナリイベントフィード (Content-Type: application/x-m5ev)
+//   ホスト側で ICS を解析・ウィンドウ化し、端末はほぼ memcpy で取り込む形式。
+//   すべてリトルエンディアン（ESP32 / x86 / ARM Linux 共通）。
+//
+//   [M5evHeader 32B][M5evRecord 64B × count][string pool pool_size B]
+//
+//   文字列は pool 先頭からのオフセット＋長さで参照（NUL終端なし）。
+//   offset_min は解析済みアラームオフセット（分）。M5EV_OFFSET_DEFAULT は
+//   「マーカーにオフセット指定なし」を意味し、端末側の alarm_offset に置換される。
+//==============================================================================
+#define M5EV_MAGIC              "M5EV"
+#define M5EV_VERSION            1
+#define M5EV_CONTENT_TYPE       "application/x-m5ev"
+#define M5EV_OFFSET_DEFAULT     (-32768)
+#define M5EV_MAX_ALARMS         6
+#define M5EV_MAX_BODY           (512 * 1024)    // 端末が受け付ける records+pool の上限
+
+#define M5EV_FLAG_ALLDAY        0x01
+#define M5EV_FLAG_ALARM         0x02
+#define M5EV_FLAG_MIDI_URL      0x04
+#define M5EV_FLAG_PLAIN_TEXT    0x08    // summary/desc は HTML 整形済み（端末は simplifyHtml しない）
+
+#pragma pack(push, 1)
+struct M5evHeader {
+    char     magic[4];          // "M5EV"
+    uint16_t version;           // M5EV_VERSION
+    uint16_t header_size;       // sizeof(M5evHeader)
+    uint16_t record_size;       // sizeof(M5evRecord)
+    uint16_t count;             // レコード数（start 昇順）
+    uint32_t pool_size;         // 文字列プールのバイト数
+    int64_t  generated;         // 生成時刻 (UNIX秒)
+    uint8_t  reserved[8];
+};
+
+struct M5evRecord {
+    int64_t  start;             // 開始時刻 (UNIX秒)
+    uint32_t summary_off;
+    uint32_t desc_off;
+    uint32_t midi_off;
+    uint16_t summary_len;
+    uint16_t desc_len;
+    uint8_t  midi_len;
+    uint8_t  flags;             // M5EV_FLAG_*
+    uint8_t  alarm_count;       // 0..M5EV_MAX_ALARMS
+    uint8_t  reserved0;
+    int16_t  play_duration_sec; // -1=設定値使用
+    int16_t  play_repeat;       // -1=設定値使用
+    int16_t  offset_min[M5EV_MAX_ALARMS];
+    uint32_t uid_hash;          // icsHashStr(UID)。0=UIDなし（端末側で summary から生成）
+    uint8_t  reserved[16];
+};
+#pragma pack(pop)
+
+static_assert(sizeof(M5evHeader) == 32, "M5evHeader must be 32 bytes");
+static_assert(sizeof(M5evRecord) == 64, "M5evRecord must be 64 bytes");
+
+#endif // ICS_CORE_H
@@ -4,7 +4,9 @@
 #include <mbedtls/platform.h>
 #include <esp_heap_caps.h>
 #include <time.h>
-#include <ctype.h>
+#include "event_sort.h"
+#include "text_codec.h"
+#include "poll_policy.h"
 
 // ★ v029: ics_parser内のString完全排除 — char[]固定バッファのみ使用
 //    DRAM断片化の最大原因だった動的String確保/解放を根絶
@@ -17,6 +19,128 @@
 //==============================================================================
 static EventItem* fetch_prev_buf = nullptr;
 static int        fetch_prev_count = 0;
+// 書き込み面（非公開）。fetch 中の追記・ソートはここに対して行い、完走したら
+// publishEvents() で1回だけ公開する（読み手は途中状態の events を見ない）
+static EventItem* fetch_buf = nullptr;
+static int        fetch_count = 0;
+static uint8_t    fetch_cur_source = 0;     // 取得中のソース番号（registerEvent がタグ付け）
+static uint32_t   fetch_io_bytes = 0;       // 今のソースで送受信したバイト数（1日の予算の計上用）
+
+//==============================================================================
+// 本文プール（TextPool）
+//   events_buf_a/b それぞれに専用プールがあり、fetch で書き込み面を切り替える際に
+//   その面のプールをリセットする。旧面のプールは次の切り替えまで不変なので、
+//   旧バッファの text ポインタ（triggered 引き継ぎ・失敗時の復帰）は有効なまま
+//==============================================================================
+static TextPool* fetch_pool = &text_pool_a;  // 現在書き込み中の本文プール
+static bool      pool_full_logged = false;
+
+// events は日付の切り替わり（rollEventWindow）で面の途中を指すことがあるため、範囲で判定する
+bool inEventsBufB(const EventItem* p) {
+    return events_buf_b && p >= events_buf_b && p < events_buf_b + MAX_EVENTS;
+}
+
+TextPool* textPoolFor(const EventItem* buf) {
+    return inEventsBufB(buf) ? &text_pool_b : &text_pool_a;
+}
+
+static char* poolAlloc(TextPool* pool, int len) {
+    if (!pool->base || pool->used + (uint32_t)len > pool->size) {
+        if (!pool_full_logged) {
+            Serial.printf("TEXT POOL full (%u/%u bytes) - event dropped\n",
+                          (unsigned)pool->used, (unsigned)pool->size);
+            pool_full_logged = true;
+        }
+        return nullptr;
+    }
+    char* p = pool->base + pool->used;
+    pool->used += len;
+    return p;
+}
+
+//==============================================================================
+// 説明文の圧縮（取り込み時）と展開（詳細・再生画面で必要になった時だけ）
+//   展開先は1本の共有スクラッチ。直前に展開したブロックなら再展開しない
+//==============================================================================
+static uint8_t*    desc_pack_buf = nullptr;     // 圧縮出力の作業域（PSRAM）
+static uint16_t*   desc_pack_table = nullptr;   // 圧縮用ハッシュ表（PSRAM）
+static char*       desc_scratch = nullptr;      // 展開先（PSRAM, DESC_MAX_BYTES+1）
+static const char* desc_cache_src = nullptr;    // desc_scratch に展開済みのブロック
+static int         desc_packed_count = 0;       // 今回の fetch で圧縮した説明文数
+static uint32_t    desc_packed_saved = 0;       // 圧縮で減ったバイト数
+
+// desc[0..len) を圧縮して [元の長さ u16][LZ] を desc_pack_buf に作る。
+//   効果が 1/8 未満なら 0（平文のまま格納）
+static int packDescription(const char* desc, int len) {
+    if (len < DESC_PACK_MIN || len > DESC_MAX_BYTES) return 0;
+    if (!desc_pack_buf) {
+        desc_pack_buf = (uint8_t*)ps_malloc(DESC_MAX_BYTES + 2);
+        desc_pack_table = (uint16_t*)ps_malloc(LZ_HASH_SIZE * sizeof(uint16_t));
+        if (!desc_pack_buf || !desc_pack_table) return 0;
+    }
+    size_t cap = (size_t)len - len / 8;
+    size_t n = lzCompress((const uint8_t*)desc, len, desc_pack_buf + 2, cap - 2, desc_pack_table);
+    if (n == 0) return 0;
+    desc_pack_buf[0] = (uint8_t)(len & 0xFF);
+    desc_pack_buf[1] = (uint8_t)(len >> 8);
+    return (int)n + 2;
+}
+
+const char* unpackDescription(const EventItem& e) {
+    if (e.desc_text == desc_cache_src && desc_scratch) return desc_scratch;
+    if (!desc_scratch) desc_scratch = (char*)ps_malloc(DESC_MAX_BYTES + 1);
+    if (!desc_scratch || e.desc_packed < 2) return "";
+    const uint8_t* blob = (const uint8_t*)e.desc_text;
+    size_t raw_len = blob[0] | (blob[1] << 8);
+    size_t n = lzDecompress(blob + 2, e.desc_packed - 2, (uint8_t*)desc_scratch, DESC_MAX_BYTES);
+    if (n != raw_len) {
+        Serial.printf("DESC: unpack failed (%u != %u)\n", (unsigned)n, (unsigned)raw_len);
+        desc_cache_src = nullptr;
+        return "";
+    }
+    desc_scratch[n] = '\0';
+    desc_cache_src = e.desc_text;
+    return desc_scratch;
+}
+
+// 面の再利用時: 本文とインターン表を空にする
+static void poolReset(TextPool* pool) {
+    pool->used = 0;
+    pool->intern_count = 0;
+    pool->intern_saved = 0;
+    if (pool->intern) memset(pool->intern, 0, INTERN_SLOTS * sizeof(InternSlot));
+    if (desc_cache_src >= pool->base && desc_cache_src < pool->base + pool->size) desc_cache_src = nullptr;
+}
+
+// s[0..len) を NUL終端でプールに置く（圧縮ブロックも可）。同じ内容が既にあればそのポインタを返す
+//   hash_out には内容ハッシュ（text_hash の材料）を返す
+static const char* poolIntern(TextPool* pool, const char* s, int len, uint32_t* hash_out) {
+    uint32_t h = icsHash32(s, len);
+    if (hash_out) *hash_out = h;
+    bool table_ok = pool->intern && pool->intern_count < INTERN_SLOTS * 3 / 4;
+    uint32_t slot = h & (INTERN_SLOTS - 1);
+    if (pool->intern) {
+        while (pool->intern[slot].str) {
+            const InternSlot& e = pool->intern[slot];
+            if (e.hash == h && e.len == (uint32_t)len && memcmp(e.str, s, len) == 0) {
+                pool->intern_saved += len + 1;
+                return e.str;
+            }
+            slot = (slot + 1) & (INTERN_SLOTS - 1);
+        }
+    }
+    char* p = poolAlloc(pool, len + 1);
+    if (!p) return nullptr;
+    memcpy(p, s, len);
+    p[len] = '\0';
+    if (table_ok) {
+        pool->intern[slot].hash = h;
+        pool->intern[slot].len = (uint32_t)len;
+        pool->intern[slot].str = p;
+        pool->intern_count++;
+    }
+    return p;
+}
 
 //==============================================================================
 // ★ mbedTLS PSRAM アロケータ
@@ -77,316 +201,81 @@ void installMbedTLSPsramAllocator() {
 }
 
 //==============================================================================
-// パーサー用バッファサイズ定数
+// パーサー用バッファサイズ定数（共通分は ics_core.h）
 //==============================================================================
-static const int LINE_BUF      = 4096;  // ICS 1行 (unfold後)
-static const int PUSHBACK_BUF  = 4096;  // unfold pushback用
-static const int DTSTART_BUF   = 32;    // "20250214T120000Z" 程度
-static const int SUMMARY_BUF   = 512;   // タイトル
-static const int DESC_BUF      = 2048;  // 説明文
-static const int MIDI_FILE_BUF = 128;   // MIDIファイル名
-static const int CONTENT_BUF   = 256;   // アラームマーカー内容
-static const int NORM_BUF      = 512;   // 全角正規化用
+static const int LINE_BUF      = ICS_LINE_BUF;
+static const int PUSHBACK_BUF  = ICS_LINE_BUF;  // unfold pushback用
 
 //==============================================================================
-// char ユーティリティ
-//==============================================================================
-
-// 先頭・末尾の空白を除去（in-place）
-static void trimBuf(char* s) {
-    int start = 0;
-    while (s[start] && (s[start] == ' ' || s[start] == '\t' || s[start] == '\r' || s[start] == '\n')) start++;
-    if (start > 0) {
-        int i = 0;
-        while (s[start + i]) { s[i] = s[start + i]; i++; }
-        s[i] = '\0';
-    }
-    int len = strlen(s);
-    while (len > 0 && (s[len-1] == ' ' || s[len-1] == '\t' || s[len-1] == '\r' || s[len-1] == '\n')) {
-        s[--len] = '\0';
-    }
-}
-
-// 全角ASCII→半角変換 (char版 normalizeFullWidth)
-static void normalizeFullWidthBuf(const char* src, char* dst, int dstSize) {
-    int di = 0;
-    int i = 0;
-    int srcLen = strlen(src);
-    while (i < srcLen && di < dstSize - 1) {
-        uint8_t b0 = (uint8_t)src[i];
-        if (b0 == 0xEF && i + 2 < srcLen) {
-            uint8_t b1 = (uint8_t)src[i + 1];
-            uint8_t b2 = (uint8_t)src[i + 2];
-            if (b1 == 0xBC && b2 >= 0x81 && b2 <= 0xBF) {
-                dst[di++] = (char)(b2 - 0x60);
-                i += 3; continue;
-            }
-            if (b1 == 0xBD && b2 >= 0x80 && b2 <= 0x9E) {
-                dst[di++] = (char)(b2 - 0x20);
-                i += 3; continue;
-            }
-        }
-        dst[di++] = src[i++];
-    }
-    dst[di] = '\0';
-}
-
-// strncpyの安全版（常にNUL終端）
-static void safeCopy(char* dst, const char* src, int dstSize) {
-    strlcpy(dst, src, dstSize);
-}
-
-// 部分文字列コピー（src[from..to-1]をdstへ）
-static void substrCopy(char* dst, const char* src, int from, int to, int dstSize) {
-    int srcLen = strlen(src);
-    if (from < 0) from = 0;
-    if (to > srcLen) to = srcLen;
-    int copyLen = to - from;
-    if (copyLen <= 0) { dst[0] = '\0'; return; }
-    if (copyLen >= dstSize) copyLen = dstSize - 1;
-    memcpy(dst, src + from, copyLen);
-    dst[copyLen] = '\0';
-}
-
-// atoi相当の安全版（空白トリム込み）
-static int safeAtoi(const char* s) {
-    while (*s == ' ') s++;
-    return atoi(s);
-}
-
-//==============================================================================
-// 日時パース
-//==============================================================================
-bool parseDT(const char* raw, time_t& out, bool& is_allday) {
-    char s[DTSTART_BUF];
-    safeCopy(s, raw, DTSTART_BUF);
-    trimBuf(s);
-
-    int slen = strlen(s);
-    bool utc = (slen > 0 && s[slen - 1] == 'Z');
-    if (utc) s[slen - 1] = '\0';
-    slen = strlen(s);
-
-    int y = 0, mo = 0, d = 0, h = 0, mi = 0, se = 0;
-    is_allday = false;
-
-    // 数字部分を直接抽出（substring不要）
-    auto dig2 = [](const char* p) -> int { return (p[0] - '0') * 10 + (p[1] - '0'); };
-    auto dig4 = [](const char* p) -> int { return (p[0]-'0')*1000 + (p[1]-'0')*100 + (p[2]-'0')*10 + (p[3]-'0'); };
-
-    if (slen == 8) {
-        y  = dig4(s);
-        mo = dig2(s + 4);
-        d  = dig2(s + 6);
-        is_allday = true;
-    } else if (slen >= 15 && s[8] == 'T') {
-        y  = dig4(s);
-        mo = dig2(s + 4);
-        d  = dig2(s + 6);
-        h  = dig2(s + 9);
-        mi = dig2(s + 11);
-        se = dig2(s + 13);
-    } else {
-        return false;
-    }
-
-    struct tm t = {};
-    t.tm_year = y - 1900;
-    t.tm_mon  = mo - 1;
-    t.tm_mday = d;
-    t.tm_hour = h;
-    t.tm_min  = mi;
-    t.tm_sec  = se;
-
-    if (!utc) {
-        out = mktime(&t);
-        return out != (time_t)-1;
-    }
-
-    setenv("TZ", "UTC0", 1);
-    tzset();
-    time_t u = mktime(&t);
-    setenv("TZ", TZ_JST, 1);
-    tzset();
-    out = u;
-    return out != (time_t)-1;
-}
-
-//==============================================================================
-// アラームマーカーパーサー
+// ソート・切り詰め
 //==============================================================================
-bool parseAlarmMarker(const char* s_raw, bool is_summary,
-                      int* offsets, int& offset_count, int max_offsets,
-                      bool& found,
-                      char* midi_file, int midi_file_size, bool& midi_is_url,
-                      int& duration_sec, int& repeat_count) {
-    static char* norm = nullptr;  // PSRAM上に配置
-    if (!norm) norm = (char*)ps_malloc(NORM_BUF);
-    normalizeFullWidthBuf(s_raw, norm, NORM_BUF);
-    const char* s = norm;
-    int sLen = strlen(s);
-
-    found = false;
-    offset_count = 0;
-    midi_file[0] = '\0';
-    midi_is_url = false;
-    duration_sec = -1;
-    repeat_count = -1;
-
-    // 重複オフセット排除のためのローカルlambda風ヘルパ
-    auto pushOffset = [&](int v) {
-        if (offset_count >= max_offsets) return;
-        for (int k = 0; k < offset_count; k++) if (offsets[k] == v) return;
-        offsets[offset_count++] = v;
-    };
-
-    // ── 統一ロジック: summary/description 問わず同じ判定 ──
-    // 1) !...! ペアがあれば詳細パラメータを解析
-    //    オフセットはカンマ区切りで複数指定可: !-25,-15,-5!
-    // 2) 閉じペアのない単独 ! があればデフォルトオフセットでアラームON
-
-    int searchStart = 0;
-    while (searchStart < sLen) {
-        const char* pPtr = strchr(s + searchStart, '!');
-        if (!pPtr) break;
-        int p = pPtr - s;
-
-        const char* ePtr = strchr(s + p + 1, '!');
-        if (!ePtr) {
-            // 閉じ ! なし → 単独 ! → デフォルトオフセットでアラームON
-            found = true;
-            if (offset_count == 0) pushOffset(config.alarm_offset_default);
-            return true;
+// ★ EventItem を直接スワップせず、(start, index) キーをソートしてから置換を1回適用
+//   ウィンドウ内のキーは日バケットへ振り分けて日内だけ整列、はみ出す場合は
+//   ソースごとのラン（引き継ぎセグメント・M5EVは整列済み）を k-way マージ
+//   トリムはソート済みキー上の開始位置（base）をずらすだけで、置換適用時に一緒に行う
+static SortKey*  sort_keys = nullptr;   // PSRAM上に配置（同時実行なし）
+static SortKey*  sort_tmp  = nullptr;
+static uint16_t* sort_src  = nullptr;
+static uint16_t* sort_pos  = nullptr;   // 旧index → 新index（検索索引の付け替え用）
+
+void sortAndTrimEvents(int maxEvents) {
+    int n = fetch_count;
+    if (n <= 1) return;
+    if (!sort_keys) {
+        sort_keys = (SortKey*)ps_malloc(MAX_EVENTS * sizeof(SortKey));
+        sort_tmp  = (SortKey*)ps_malloc(MAX_EVENTS * sizeof(SortKey));
+        sort_src  = (uint16_t*)ps_malloc(MAX_EVENTS * sizeof(uint16_t));
+        sort_pos  = (uint16_t*)ps_malloc(MAX_EVENTS * sizeof(uint16_t));
+        if (!sort_keys || !sort_tmp || !sort_src || !sort_pos) {
+            Serial.println("SORT: PSRAM alloc failed - events left unsorted");
+            return;
         }
-        int endExcl = ePtr - s;
-
-        found = true;
-
-        static char* content = nullptr;
-        if (!content) content = (char*)ps_malloc(CONTENT_BUF);
-        substrCopy(content, s, p + 1, endExcl, CONTENT_BUF);
-
-        bool blockHasOffset = false;
-        bool thisIsUrl = false;
-        char thisFile[MIDI_FILE_BUF];
-        thisFile[0] = '\0';
-
-        int cLen = strlen(content);
-        int i = 0;
-        while (i < cLen) {
-            char c = content[i];
-            if (c == '-' || c == '+') {
-                int numStart = i + 1, numEnd = numStart;
-                while (numEnd < cLen && (isdigit(content[numEnd]) || content[numEnd] == ' ')) numEnd++;
-                if (numEnd > numStart) {
-                    char numBuf[16];
-                    substrCopy(numBuf, content, numStart, numEnd, sizeof(numBuf));
-                    int val = safeAtoi(numBuf);
-                    if (val >= 0 && val <= 24 * 60) {
-                        int signedVal = (c == '-') ? val : -val;
-                        pushOffset(signedVal);
-                        blockHasOffset = true;
-                    }
-                }
-                i = numEnd;
-            } else if (c == ',' || c == ' ') {
-                // カンマ・空白はオフセット区切りとして読み飛ばし
-                i++;
-            } else if (c == '>' || c == '<') {
-                thisIsUrl = (c == '>');
-                int fileStart = i + 1, fileEnd = fileStart;
-                while (fileEnd < cLen &&
-                       content[fileEnd] != '-' && content[fileEnd] != '+' &&
-                       content[fileEnd] != '@' && content[fileEnd] != '*' &&
-                       content[fileEnd] != '>' && content[fileEnd] != '<') fileEnd++;
-                if (fileEnd > fileStart) {
-                    substrCopy(thisFile, content, fileStart, fileEnd, MIDI_FILE_BUF);
-                    trimBuf(thisFile);
-                }
-                i = fileEnd;
-            } else if (c == '@') {
-                int numStart = i + 1, numEnd = numStart;
-                while (numEnd < cLen && (isdigit(content[numEnd]) || content[numEnd] == ' ')) numEnd++;
-                if (numEnd > numStart) {
-                    char numBuf[16];
-                    substrCopy(numBuf, content, numStart, numEnd, sizeof(numBuf));
-                    duration_sec = safeAtoi(numBuf);
-                } else {
-                    duration_sec = 0;
-                }
-                i = numEnd;
-            } else if (c == '*') {
-                int numStart = i + 1, numEnd = numStart;
-                while (numEnd < cLen && (isdigit(content[numEnd]) || content[numEnd] == ' ')) numEnd++;
-                if (numEnd > numStart) {
-                    char numBuf[16];
-                    substrCopy(numBuf, content, numStart, numEnd, sizeof(numBuf));
-                    repeat_count = safeAtoi(numBuf);
-                }
-                i = numEnd;
-            } else {
-                i++;
-            }
-        }
-
-        // !...! ブロック内に明示オフセットが無ければデフォルトを1つ
-        if (!blockHasOffset) pushOffset(config.alarm_offset_default);
-
-        if (thisFile[0] != '\0') {
-            safeCopy(midi_file, thisFile, midi_file_size);
-            midi_is_url = thisIsUrl;
-        }
-        searchStart = endExcl + 1;
     }
-
-    if (found && offset_count == 0) pushOffset(config.alarm_offset_default);
-    return found;
-}
-
-//==============================================================================
-// ソート・切り詰め
-//==============================================================================
-void sortEvents() {
-    for (int i = 0; i < event_count; i++) {
-        for (int j = i + 1; j < event_count; j++) {
-            if (events[j].start < events[i].start) {
-                EventItem tmp = events[i];
-                events[i] = events[j];
-                events[j] = tmp;
-            }
+    uint32_t t0 = micros();
+
+    // キー生成 + ソース境界でラン分割
+    int run_start[SORT_MAX_RUNS + 1];
+    int run_count = 0;
+    for (int i = 0; i < n; i++) {
+        if (i == 0 || fetch_buf[i].source != fetch_buf[i - 1].source) {
+            if (run_count <= SORT_MAX_RUNS) run_start[run_count] = i;
+            run_count++;
         }
+        sort_keys[i].start = (uint32_t)fetch_buf[i].start;
+        sort_keys[i].idx   = (uint16_t)i;
+        sort_keys[i].run   = (uint16_t)(run_count - 1);
     }
-}
-
-void trimEventsAroundToday(int maxEvents) {
-    if (event_count <= maxEvents) return;
-
-    time_t now = time(nullptr);
-    int today_idx = event_count;
-    for (int i = 0; i < event_count; i++) {
-        if (events[i].start >= now - 86400) { today_idx = i; break; }
+    bool by_day = sortKeysByDay(sort_keys, sort_tmp, n);
+    if (!by_day) sortKeysByRuns(sort_keys, sort_tmp, n, run_start, run_count);
+
+    // トリム: 今日(now-1日)以降を優先し、過去は最大10件まで残す
+    int base = 0;
+    int keep = n;
+    if (n > maxEvents) {
+        time_t now = time(nullptr);
+        int today_idx = lowerBoundStart(sort_keys, n, (uint32_t)(now - 86400));
+        int future_count = n - today_idx;
+        int keep_past = min(today_idx, min(10, maxEvents - future_count));
+        if (keep_past < 0) keep_past = 0;
+        base = today_idx - keep_past;
+        if (base < 0) base = 0;
+        keep = min(n - base, maxEvents);
+        Serial.printf("TRIM: total=%d, today=%d, future=%d, keep_past=%d, start=%d\n",
+                      n, today_idx, future_count, keep_past, base);
     }
 
-    int future_count = event_count - today_idx;
-    int keep_past = min(today_idx, min(10, maxEvents - future_count));
-    if (keep_past < 0) keep_past = 0;
-    int start_idx = today_idx - keep_past;
-    if (start_idx < 0) start_idx = 0;
-
-    Serial.printf("TRIM: total=%d, today=%d, future=%d, keep_past=%d, start=%d\n",
-                  event_count, today_idx, future_count, keep_past, start_idx);
-
-    if (start_idx > 0) {
-        for (int i = 0; i < event_count - start_idx; i++) {
-            events[i] = events[i + start_idx];
-        }
-        event_count -= start_idx;
+    // 置換: 先頭から base 以降のキー順、捨てる分（base より前）は末尾へ回す
+    for (int j = 0; j < n; j++) {
+        sort_src[j] = sort_keys[(base + j) % n].idx;
+        sort_pos[sort_src[j]] = (j < keep) ? (uint16_t)j : 0xFFFF;
     }
+    searchIndexRemap(sort_pos);
+    applyPermutation(fetch_buf, sort_src, n);
+    fetch_count = keep;
 
-    if (event_count > maxEvents) {
-        event_count = maxEvents;
-    }
-    Serial.printf("TRIM: result=%d events\n", event_count);
+    Serial.printf("SORT: %d events, %s -> %d kept (%luus)\n",
+                  n, by_day ? "day buckets" : (run_count > SORT_MAX_RUNS ? "full sort" : "run merge"),
+                  keep, (unsigned long)(micros() - t0));
 }
 
 //==============================================================================
@@ -405,9 +294,10 @@ static bool readRawLine(WiFiClient* stream, char* buf, int bufSize) {
             buf[len] = '\0';
             return len > 0;
         }
-        if (!stream->available()) { delay(1); continue; }
+        if (!stream->available()) { alarmPreemptPoint(); delay(1); continue; }
 
         char c = stream->read();
+        fetch_io_bytes++;
         if (c == '\r') continue;
         if (c == '\n') { buf[len] = '\0'; return true; }
         if (len < bufSize - 1) buf[len++] = c;
@@ -451,134 +341,204 @@ static bool readUnfoldedLine(WiFiClient* stream, char* line, int lineSize,
     return true;
 }
 
-// 1つのVEVENTをevents[]に登録
-static void registerEvent(const char* dtstart_raw, const char* summary, const char* desc) {
-    if (event_count >= MAX_EVENTS) return;
+// 公開済みの版（start 昇順）から (start, uid_hash) が同じイベントを探す
+//   resolveEventRef と同じく start で二分探索し、同時刻の中から uid_hash を照合
+static const EventItem* findEventIn(const EventItem* buf, int count, time_t st, uint32_t uid_hash) {
+    if (!buf || count <= 0) return nullptr;
+    int lo = 0, hi = count;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (buf[mid].start < st) lo = mid + 1;
+        else hi = mid;
+    }
+    for (int p = lo; p < count && buf[p].start == st; p++) {
+        if (buf[p].uid_hash == uid_hash) return &buf[p];
+    }
+    return nullptr;
+}
+
+static const EventItem* findPrevEvent(time_t st, uint32_t uid_hash) {
+    return findEventIn(fetch_prev_buf, fetch_prev_count, st, uid_hash);
+}
+
+// 解析済みイベント1件を events[] に確定（ICSストリーム / バイナリフィード共通）
+//   offsets は解析済みアラームオフセット（分）。旧バッファからの triggered 引き継ぎもここで行う
+static void commitEvent(time_t st, bool is_allday,
+                        const char* summary, int sumLen,
+                        const char* desc, int descLen,
+                        bool hasAL, const int* offsets, int off_n,
+                        const char* midi_file, bool midi_is_url,
+                        int duration_sec, int repeat_count,
+                        uint32_t uid_hash, bool text_plain) {
+    if (fetch_count >= MAX_EVENTS) return;
 
     time_t now = time(nullptr);
-    time_t st = 0;
-    bool is_allday = false;
-    if (!parseDT(dtstart_raw, st, is_allday)) return;
     // 過去ウィンドウ: 7日前まで取り込む
-    //   trimEventsAroundToday() が過去最大10件まで表示保持するため、
+    //   sortAndTrimEvents() が過去最大10件まで表示保持するため、
     //   24h 固定だと「画面に残っているのに再fetchで取り込まれず、編集が反映されない」
     //   という状態が発生する。表示されうる過去イベントは必ず再パースする。
     if (st <= now - 7 * 86400 || st >= now + 30 * 86400) return;
 
-    int parsed_offsets[MAX_ALARMS_PER_EVENT];
-    int parsed_off_n = 0;
-    bool hasAL = false;
-    char midi_file_str[MIDI_FILE_BUF];
-    midi_file_str[0] = '\0';
-    bool midi_is_url_flag = false;
-    int ev_duration = -1, ev_repeat = -1;
-
-    parseAlarmMarker(summary, true, parsed_offsets, parsed_off_n, MAX_ALARMS_PER_EVENT,
-                     hasAL, midi_file_str, MIDI_FILE_BUF,
-                     midi_is_url_flag, ev_duration, ev_repeat);
-    if (!hasAL && desc[0] != '\0') {
-        parseAlarmMarker(desc, false, parsed_offsets, parsed_off_n, MAX_ALARMS_PER_EVENT,
-                         hasAL, midi_file_str, MIDI_FILE_BUF,
-                         midi_is_url_flag, ev_duration, ev_repeat);
-    }
-
-    if (hasAL) {
-        char logSum[41];
-        substrCopy(logSum, summary, 0, 40, sizeof(logSum));
-        char offBuf[64]; offBuf[0] = '\0';
-        int op = 0;
-        for (int k = 0; k < parsed_off_n && op < (int)sizeof(offBuf) - 8; k++) {
-            op += snprintf(offBuf + op, sizeof(offBuf) - op,
-                           k == 0 ? "%d" : ",%d", parsed_offsets[k]);
-        }
-        Serial.printf("ICS_STREAM: [%d] ALARM '%s' offsets=[%s]\n",
-                      event_count, logSum, offBuf);
-    }
-
-    int idx = event_count;
-    events[idx].start = st;
-
-    // text[] に summary \0 description \0 を格納
-    int bufSize = sizeof(events[idx].text);
-    int sumLen = strlen(summary);
-    if (sumLen >= bufSize - 2) sumLen = bufSize - 2;
-    memcpy(events[idx].text, summary, sumLen);
-    events[idx].text[sumLen] = '\0';
-
-    int descPos = sumLen + 1;
-    int descSpace = bufSize - descPos - 1;
-    int maxDesc = min(descSpace, config.max_desc_bytes);
-    int descLen = strlen(desc);
-    if (descLen <= maxDesc) {
-        memcpy(events[idx].text + descPos, desc, descLen);
-        events[idx].text[descPos + descLen] = '\0';
-    } else {
-        // UTF-8境界で切り詰め
+    // 本文サイズ確定（summary / description は UTF-8境界で切り詰め）
+    if (sumLen > ICS_SUMMARY_BUF - 1) sumLen = ICS_SUMMARY_BUF - 1;
+    int maxDesc = config.max_desc_bytes;
+    if (descLen > maxDesc) {
         int cutAt = maxDesc;
         while (cutAt > 0 && ((uint8_t)desc[cutAt] & 0xC0) == 0x80) cutAt--;
-        memcpy(events[idx].text + descPos, desc, cutAt);
-        events[idx].text[descPos + cutAt] = '\0';
+        descLen = cutAt;
+    }
+    int midiLen = strlen(midi_file);
+    if (midiLen > ICS_MIDI_FILE_BUF - 1) midiLen = ICS_MIDI_FILE_BUF - 1;
+
+    // summary / description / midi_file を本文プールへ（同一内容は共有）
+    //   長い説明文は圧縮ブロックとして格納（同じ説明文の繰り返し予定は圧縮後のブロックを共有）
+    uint32_t h_sum, h_desc, h_midi;
+    int packed = packDescription(desc, descLen);
+    const char* sumP = poolIntern(fetch_pool, summary, sumLen, &h_sum);
+    const char* descP = !sumP ? nullptr
+                      : packed ? poolIntern(fetch_pool, (const char*)desc_pack_buf, packed, &h_desc)
+                               : poolIntern(fetch_pool, desc, descLen, &h_desc);
+    const char* midiP = descP ? poolIntern(fetch_pool, midi_file, midiLen, &h_midi) : nullptr;
+    // 一覧表示用 summary（絵文字→'?'・制御文字除去）。変換不要なら summary と同じ文字列を共有
+    static char rowBuf[ICS_SUMMARY_BUF];
+    int rowLen = sanitizeDisplayText(summary, sumLen, rowBuf);
+    const char* rowP = midiP ? poolIntern(fetch_pool, rowBuf, rowLen, nullptr) : nullptr;
+    if (!rowP) return;
+
+    int idx = fetch_count;
+    fetch_buf[idx].start = st;
+    fetch_buf[idx].source = fetch_cur_source;
+    fetch_buf[idx].summary_text = sumP;
+    fetch_buf[idx].desc_text = descP;
+    fetch_buf[idx].desc_packed = (uint16_t)packed;
+    fetch_buf[idx].midi_file = midiP;
+    fetch_buf[idx].row_text = rowP;
+    if (packed) {
+        desc_packed_count++;
+        desc_packed_saved += descLen - packed;
     }
 
-    events[idx].has_alarm = hasAL;
-    events[idx].is_allday = is_allday;
-    strlcpy(events[idx].midi_file, midi_file_str, sizeof(events[idx].midi_file));
-    events[idx].midi_is_url = midi_is_url_flag;
-    events[idx].play_duration_sec = ev_duration;
-    events[idx].play_repeat = ev_repeat;
-
-    events[idx].alarm_count = 0;
+    // 同一性キー: UID が無いフィードは summary で代用。別ソースの同一UIDは別イベント扱い
+    if (uid_hash == 0) uid_hash = h_sum;
+    fetch_buf[idx].uid_hash = icsHash32(&fetch_cur_source, 1, uid_hash);
+    // 内容ハッシュ: 本文3文字列 + 表示/鳴動に効く属性（差分で「変更」判定に使う）
+    uint32_t th = icsHash32(&h_desc, sizeof(h_desc), h_sum);
+    th = icsHash32(&h_midi, sizeof(h_midi), th);
+    int16_t attr[4 + MAX_ALARMS_PER_EVENT];
+    int an = 0;
+    attr[an++] = is_allday ? 1 : 0;
+    attr[an++] = hasAL ? 1 : 0;
+    attr[an++] = (int16_t)duration_sec;
+    attr[an++] = (int16_t)repeat_count;
+    for (int k = 0; k < off_n && k < MAX_ALARMS_PER_EVENT; k++) attr[an++] = (int16_t)offsets[k];
+    th = icsHash32(attr, an * sizeof(int16_t), th);
+    fetch_buf[idx].text_hash = icsHash32(&midi_is_url, 1, th);
+
+    fetch_buf[idx].has_alarm = hasAL;
+    fetch_buf[idx].is_allday = is_allday;
+    fetch_buf[idx].text_plain = text_plain;
+    fetch_buf[idx].midi_is_url = midi_is_url;
+    fetch_buf[idx].play_duration_sec = duration_sec;
+    fetch_buf[idx].play_repeat = repeat_count;
+    prepareRowText(fetch_buf[idx]);
+
+    fetch_buf[idx].alarm_count = 0;
     if (hasAL) {
-        const time_t ALARM_GRACE_SEC = 600;       // 起動直後の再生防止グレース
         const time_t LATE_ADD_GRACE  = 86400;     // 通常fetch時: 開始翌日まで遅延発火を許容
 
-        // 旧バッファに同 (start, summary) のイベントが居れば triggered を引き継ぐための検索
-        const EventItem* prev_match = nullptr;
-        if (fetch_prev_buf && fetch_prev_count > 0) {
-            for (int p = 0; p < fetch_prev_count; p++) {
-                if (fetch_prev_buf[p].start != st) continue;
-                if (strcmp(fetch_prev_buf[p].summary(), events[idx].summary()) != 0) continue;
-                prev_match = &fetch_prev_buf[p];
-                break;
-            }
-        }
+        // 旧バッファに同 (start, uid_hash) のイベントが居れば triggered を引き継ぐための検索
+        //   uid_hash は UID なしなら summary の内容ハッシュなので、従来の summary 一致を包含する
+        const EventItem* prev_match = findPrevEvent(st, fetch_buf[idx].uid_hash);
 
-        for (int k = 0; k < parsed_off_n; k++) {
-            int slot = events[idx].alarm_count;
-            time_t at = st - (time_t)parsed_offsets[k] * 60;
-            events[idx].offset_min[slot] = parsed_offsets[k];
-            events[idx].alarm_time[slot] = at;
+        for (int k = 0; k < off_n && k < MAX_ALARMS_PER_EVENT; k++) {
+            int slot = fetch_buf[idx].alarm_count;
+            time_t at = st - (time_t)offsets[k] * 60;
+            fetch_buf[idx].offset_min[slot] = offsets[k];
+            fetch_buf[idx].alarm_time[slot] = at;
 
             // 1) 旧バッファに同じ alarm_time のスロットがあれば、その triggered を継承
             bool carried = false;
             if (prev_match) {
                 for (int j = 0; j < prev_match->alarm_count; j++) {
                     if (prev_match->alarm_time[j] == at) {
-                        events[idx].triggered[slot] = prev_match->triggered[j];
+                        fetch_buf[idx].triggered[slot] = prev_match->triggered[j];
                         carried = true;
                         break;
                     }
                 }
             }
 
-            // 2) 新規アラーム: 起動初回は従来グレース、通常fetch中は「開始翌日まで」許容
+            // 2) ジャーナルに発火記録あり（再起動前に鳴らした・summary 変更で 1) に掛からない）
+            if (!carried && alarmAcked(fetch_buf[idx].uid_hash, at)) {
+                fetch_buf[idx].triggered[slot] = true;
+                carried = true;
+            }
+
+            // 3) 新規アラーム: 起動初回は起動グレース、通常fetch中は「開始翌日まで」許容
             if (!carried) {
                 if (!initial_fetch_done) {
-                    events[idx].triggered[slot] = (at < now - ALARM_GRACE_SEC);
+                    fetch_buf[idx].triggered[slot] = alarmBootSuppressed(fetch_buf[idx].uid_hash, at, now);
                 } else {
                     // 後付け!でも開始時刻 + 24h までは鳴らす（既に終わった予定は抑止）
-                    events[idx].triggered[slot] = (st < now - LATE_ADD_GRACE);
+                    fetch_buf[idx].triggered[slot] = (st < now - LATE_ADD_GRACE);
                 }
             }
-            events[idx].alarm_count++;
+            fetch_buf[idx].alarm_count++;
         }
     }
-    event_count++;
+    searchIndexAdd(idx, summary, sumLen, desc, descLen);
+    fetch_count++;
+}
+
+// 1つのVEVENTをevents[]に登録（アラームマーカー解析 → commitEvent）
+static void registerEvent(const char* dtstart_raw, const char* summary, const char* desc,
+                          uint32_t uid_hash) {
+    if (fetch_count >= MAX_EVENTS) return;
+
+    time_t st = 0;
+    bool is_allday = false;
+    if (!parseDT(dtstart_raw, st, is_allday)) return;
+
+    int parsed_offsets[MAX_ALARMS_PER_EVENT];
+    int parsed_off_n = 0;
+    bool hasAL = false;
+    char midi_file_str[ICS_MIDI_FILE_BUF];
+    midi_file_str[0] = '\0';
+    bool midi_is_url_flag = false;
+    int ev_duration = -1, ev_repeat = -1;
+
+    parseAlarmMarker(summary, true, parsed_offsets, parsed_off_n, MAX_ALARMS_PER_EVENT,
+                     hasAL, midi_file_str, ICS_MIDI_FILE_BUF,
+                     midi_is_url_flag, ev_duration, ev_repeat,
+                     config.alarm_offset_default);
+    if (!hasAL && desc[0] != '\0') {
+        parseAlarmMarker(desc, false, parsed_offsets, parsed_off_n, MAX_ALARMS_PER_EVENT,
+                         hasAL, midi_file_str, ICS_MIDI_FILE_BUF,
+                         midi_is_url_flag, ev_duration, ev_repeat,
+                         config.alarm_offset_default);
+    }
+
+    if (hasAL) {
+        char logSum[41];
+        substrCopy(logSum, summary, 0, 40, sizeof(logSum));
+        char offBuf[64]; offBuf[0] = '\0';
+        int op = 0;
+        for (int k = 0; k < parsed_off_n && op < (int)sizeof(offBuf) - 8; k++) {
+            op += snprintf(offBuf + op, sizeof(offBuf) - op,
+                           k == 0 ? "%d" : ",%d", parsed_offsets[k]);
+        }
+        Serial.printf("ICS_STREAM: [%d] ALARM '%s' offsets=[%s]\n",
+                      fetch_count, logSum, offBuf);
+    }
+
+    commitEvent(st, is_allday, summary, strlen(summary), desc, strlen(desc),
+                hasAL, parsed_offsets, parsed_off_n,
+                midi_file_str, midi_is_url_flag, ev_duration, ev_repeat,
+                uid_hash, false);
 }
 
 // ストリーミングパーサー本体
 static int parseICSStream(WiFiClient* stream) {
-    bool inEvent = false;
     int parsed_events = 0;
 
     // ★ パーサーバッファをPSRAMに配置 → DRAM .bss を節約
@@ -589,77 +549,136 @@ static int parseICSStream(WiFiClient* stream) {
     if (!line) {
         line     = (char*)ps_malloc(LINE_BUF);
         pushback = (char*)ps_malloc(PUSHBACK_BUF);
-        desc     = (char*)ps_malloc(DESC_BUF);
+        desc     = (char*)ps_malloc(ICS_DESC_BUF);
     }
-    // スタック節約: summary も static (同時実行なし)
-    char dtstart_raw[DTSTART_BUF];
-    static char summary[SUMMARY_BUF];
+    // スタック節約: summary / VEVENT 状態も static (同時実行なし)
+    static char summary[ICS_SUMMARY_BUF];
+    static IcsVEvent ev;
+    icsVEventInit(ev, summary, ICS_SUMMARY_BUF, desc, ICS_DESC_BUF);
 
     line[0] = '\0';
     pushback[0] = '\0';
-    dtstart_raw[0] = '\0';
-    summary[0] = '\0';
-    desc[0] = '\0';
 
     Serial.printf("ICS_STREAM: Start parsing (heap: %d)\n", ESP.getFreeHeap());
 
     while (readUnfoldedLine(stream, line, LINE_BUF, pushback, PUSHBACK_BUF)) {
-        trimBuf(line);
-        if (line[0] == '\0') continue;
-
-        if (strcmp(line, "BEGIN:VEVENT") == 0) {
-            inEvent = true;
-            dtstart_raw[0] = '\0';
-            summary[0] = '\0';
-            desc[0] = '\0';
-            continue;
+        alarmPreemptPoint();    // 受信中もアラーム発火・MIDI 更新（公開中の events は fetch 中も不変）
+        if (icsFeedLine(ev, line) != ICS_LINE_END_EVENT) continue;
+
+        parsed_events++;
+        registerEvent(ev.dtstart_raw, ev.summary, ev.desc, ev.uid_hash);
+        if (fetch_count >= MAX_EVENTS) {
+            Serial.println("ICS_STREAM: MAX_EVENTS reached");
+            break;
         }
+    }
 
-        if (strcmp(line, "END:VEVENT") == 0) {
-            parsed_events++;
-            if (inEvent) {
-                registerEvent(dtstart_raw, summary, desc);
-                if (event_count >= MAX_EVENTS) {
-                    Serial.println("ICS_STREAM: MAX_EVENTS reached");
-                    break;
-                }
-            }
-            inEvent = false;
-            dtstart_raw[0] = '\0';
-            summary[0] = '\0';
-            desc[0] = '\0';
-            continue;
-        }
+    Serial.printf("ICS_STREAM: Complete - parsed %d VEVENTs, loaded %d (heap: %d)\n",
+                  parsed_events, fetch_count, ESP.getFreeHeap());
 
-        if (!inEvent) continue;
-
-        // プロパティ解析: "KEY;PARAMS:VALUE" または "KEY:VALUE"
-        const char* colon = strchr(line, ':');
-        if (!colon) continue;
-
-        if (strncmp(line, "DTSTART", 7) == 0 && (line[7] == ':' || line[7] == ';')) {
-            safeCopy(dtstart_raw, colon + 1, DTSTART_BUF);
-        } else if (strncmp(line, "SUMMARY", 7) == 0 && (line[7] == ':' || line[7] == ';')) {
-            safeCopy(summary, colon + 1, SUMMARY_BUF);
-        } else if (strncmp(line, "DESCRIPTION", 11) == 0 && (line[11] == ':' || line[11] == ';')) {
-            const char* val = colon + 1;
-            int valLen = strlen(val);
-            int maxParseLen = 2000;
-            if (valLen > maxParseLen) {
-                memcpy(desc, val, maxParseLen);
-                desc[maxParseLen] = '\0';
-            } else {
-                safeCopy(desc, val, DESC_BUF);
-            }
+    // ★ sortAndTrimEvents は呼ばない
+    //   複数URL対応: 全URL fetch後にfetchAndUpdate()側で実行
+    return fetch_count;
+}
+
+//==============================================================================
+// バイナリイベントフィード (application/x-m5ev) 取り込み
+//   ホスト側 tools/ics2bin で解析済み。ヘッダー検証後、records+pool を PSRAM に
+//   一括受信し、レコードごとに commitEvent（文字列は pool から直接コピー）
+//==============================================================================
+
+// ストリームから len バイト読み切る（タイムアウト時 false）
+static bool readExact(WiFiClient* stream, uint8_t* dst, size_t len) {
+    size_t got = 0;
+    unsigned long t0 = millis();
+    while (got < len) {
+        if (millis() - t0 > 15000) return false;
+        if (!stream->available()) {
+            if (!stream->connected()) return false;
+            alarmPreemptPoint();
+            delay(1);
+            continue;
         }
+        int n = stream->read(dst + got, len - got);
+        if (n > 0) { got += n; fetch_io_bytes += n; t0 = millis(); }
     }
+    return true;
+}
 
-    Serial.printf("ICS_STREAM: Complete - parsed %d VEVENTs, loaded %d (heap: %d)\n",
-                  parsed_events, event_count, ESP.getFreeHeap());
+static int parseBinaryFeed(WiFiClient* stream) {
+    M5evHeader hdr;
+    if (!readExact(stream, (uint8_t*)&hdr, sizeof(hdr))) {
+        Serial.println("M5EV: header read failed");
+        return -1;
+    }
+    if (memcmp(hdr.magic, M5EV_MAGIC, 4) != 0 || hdr.version != M5EV_VERSION ||
+        hdr.header_size != sizeof(M5evHeader) || hdr.record_size != sizeof(M5evRecord)) {
+        Serial.printf("M5EV: bad header (ver:%d hdr:%d rec:%d)\n",
+                      hdr.version, hdr.header_size, hdr.record_size);
+        return -1;
+    }
+    size_t rec_bytes = (size_t)hdr.count * sizeof(M5evRecord);
+    size_t body = rec_bytes + hdr.pool_size;
+    if (body > M5EV_MAX_BODY) {
+        Serial.printf("M5EV: body too large (%u bytes)\n", (unsigned)body);
+        return -1;
+    }
 
-    // ★ sortEvents/trimEventsAroundToday は呼ばない
-    //   複数URL対応: 全URL fetch後にfetchAndUpdate()側で実行
-    return event_count;
+    uint8_t* buf = (uint8_t*)ps_malloc(body > 0 ? body : 1);
+    if (!buf) {
+        Serial.printf("M5EV: ps_malloc(%u) failed\n", (unsigned)body);
+        return -1;
+    }
+    unsigned long t0 = millis();
+    if (!readExact(stream, buf, body)) {
+        Serial.println("M5EV: body read failed");
+        free(buf);
+        return -1;
+    }
+    const M5evRecord* recs = (const M5evRecord*)buf;
+    const char* pool = (const char*)(buf + rec_bytes);
+
+    int loaded_before = fetch_count;
+    for (int r = 0; r < hdr.count && fetch_count < MAX_EVENTS; r++) {
+        const M5evRecord& rec = recs[r];
+        // 文字列参照の範囲チェック（壊れたフィードで pool 外を読まない）
+        if ((uint64_t)rec.summary_off + rec.summary_len > hdr.pool_size ||
+            (uint64_t)rec.desc_off + rec.desc_len > hdr.pool_size ||
+            (uint64_t)rec.midi_off + rec.midi_len > hdr.pool_size) {
+            Serial.printf("M5EV: record %d out of range - skipped\n", r);
+            continue;
+        }
+        // summary() は NUL終端前提のため、一旦作業バッファで終端する
+        static char sum[ICS_SUMMARY_BUF];
+        int sumLen = min((int)rec.summary_len, ICS_SUMMARY_BUF - 1);
+        memcpy(sum, pool + rec.summary_off, sumLen);
+        sum[sumLen] = '\0';
+        char midi[ICS_MIDI_FILE_BUF];
+        int midiLen = min((int)rec.midi_len, ICS_MIDI_FILE_BUF - 1);
+        memcpy(midi, pool + rec.midi_off, midiLen);
+        midi[midiLen] = '\0';
+
+        int offsets[MAX_ALARMS_PER_EVENT];
+        int off_n = 0;
+        for (int k = 0; k < rec.alarm_count && k < M5EV_MAX_ALARMS && off_n < MAX_ALARMS_PER_EVENT; k++) {
+            int v = (rec.offset_min[k] == M5EV_OFFSET_DEFAULT) ? config.alarm_offset_default
+                                                                : rec.offset_min[k];
+            bool dup = false;
+            for (int j = 0; j < off_n; j++) if (offsets[j] == v) dup = true;
+            if (!dup) offsets[off_n++] = v;
+        }
+        commitEvent((time_t)rec.start, rec.flags & M5EV_FLAG_ALLDAY,
+                    sum, sumLen, pool + rec.desc_off, rec.desc_len,
+                    rec.flags & M5EV_FLAG_ALARM, offsets, off_n,
+                    midi, rec.flags & M5EV_FLAG_MIDI_URL,
+                    rec.play_duration_sec, rec.play_repeat,
+                    rec.uid_hash, rec.flags & M5EV_FLAG_PLAIN_TEXT);
+    }
+    free(buf);
+    Serial.printf("M5EV: %d records, pool %u bytes -> loaded %d (%lums)\n",
+                  hdr.count, (unsigned)hdr.pool_size, fetch_count - loaded_before,
+                  millis() - t0);
+    return fetch_count;
 }
 
 //==============================================================================
@@ -673,9 +692,10 @@ static int readHeaderLine(WiFiClient* c, char* buf, int maxLen) {
     unsigned long t0 = millis();
     while (millis() - t0 < 15000) {
         if (!c->connected() && !c->available()) return -1;
-        if (!c->available()) { delay(1); continue; }
+        if (!c->available()) { alarmPreemptPoint(); delay(1); continue; }
         int b = c->read();
         if (b < 0) continue;
+        fetch_io_bytes++;
         if (b == '\n') break;
         if (b != '\r' && i < maxLen - 1) buf[i++] = b;
     }
@@ -718,7 +738,7 @@ static int doFetchURL(const char* url_str) {
 
     Serial.printf("Raw HTTPS: host=%s port=%d path=%.40s...\n", host, port, path);
 
-    int count_before = event_count;  // このURL fetch前の件数
+    int count_before = fetch_count;  // このURL fetch前の件数
 
     // [LEAK] doFetchURL 入口の計装 — mbedTLSアロケータの累積カウンタ diff 用スナップショット
     uint32_t mbed_psram_b0  = mbed_alloc_psram_bytes;
@@ -780,6 +800,7 @@ static int doFetchURL(const char* url_str) {
         path_nocache, host, authLine);
 
     client.write((uint8_t*)request, reqLen);
+    fetch_io_bytes += reqLen;
     Serial.printf("HTTP request sent (%d bytes), waiting for response...\n", reqLen);
 
     // ── レスポンスステータス行読み取り ──
@@ -805,17 +826,22 @@ static int doFetchURL(const char* url_str) {
         return -1;
     }
 
-    // ── ヘッダースキップ (空行まで読み飛ばし) ──
+    // ── ヘッダースキップ (空行まで読み飛ばし) — Content-Type だけ確認 ──
     static char hdr[256];
+    bool binary_feed = false;
     while (true) {
         int hl = readHeaderLine(&client, hdr, sizeof(hdr));
         if (hl <= 0) break;
+        if (strncasecmp(hdr, "Content-Type:", 13) == 0 && strstr(hdr, M5EV_CONTENT_TYPE)) {
+            binary_feed = true;
+        }
     }
-    Serial.printf("HTTP OK, headers done (heap: %d)\n", ESP.getFreeHeap());
+    Serial.printf("HTTP OK, headers done (heap: %d)%s\n", ESP.getFreeHeap(),
+                  binary_feed ? " [M5EV binary]" : "");
     dumpHeapTag("parseICSStream:before");
 
-    // ── ICSボディをストリーミング解析（events[]にアペンド） ──
-    int result = parseICSStream(&client);
+    // ── ボディ解析（events[]にアペンド）: バイナリフィード or ICSストリーミング ──
+    int result = binary_feed ? parseBinaryFeed(&client) : parseICSStream(&client);
     dumpHeapTag("parseICSStream:after");
     client.stop();
     dumpHeapTag("client.stop:after");
@@ -834,7 +860,7 @@ static int doFetchURL(const char* url_str) {
                   (unsigned)(mbed_alloc_psram_count + mbed_alloc_internal_count),
                   (unsigned)mbed_free_count);
 
-    int added = event_count - count_before;
+    int added = fetch_count - count_before;
     if (added > 0) {
         return added;
     }
@@ -844,12 +870,259 @@ static int doFetchURL(const char* url_str) {
 }
 
 
-bool fetchAndUpdate() {
+//==============================================================================
+// ソース(URL)ごとの更新スケジュール
+//   イベントバッファは取得元URLごとのセグメントに分かれている。
+//   更新間隔に達したソースだけを再取得し、他ソースは旧バッファのセグメントを
+//   そのまま引き継いで再マージする（休日カレンダー等の低頻度ソースを毎回取りに行かない）
+//==============================================================================
+static time_t   fetch_backoff_until = 0;    // サーバ到達不可時のバックオフ期限
+static PollBudget poll_budget = {};         // 1日の取得回数・通信量（全ソース共通、SD スナップショットで再起動をまたぐ）
+static uint32_t fetch_url_hash      = 0;    // ics_url 構成の変化検出用
+
+// config.ics_url をカンマ区切りで分割（前後空白除去、上限 MAX_FETCH_URLS）
+static int splitIcsUrls(char* buf, int bufSize, char** urls) {
+    strlcpy(buf, config.ics_url, bufSize);
+    int n = 0;
+    char* saveptr = nullptr;
+    char* token = strtok_r(buf, ",", &saveptr);
+    while (token) {
+        while (*token == ' ') token++;
+        char* end = token + strlen(token) - 1;
+        while (end > token && *end == ' ') *end-- = '\0';
+        if (strlen(token) > 0) {
+            if (n < MAX_FETCH_URLS) {
+                urls[n++] = token;
+            } else {
+                Serial.printf("ICS URL ignored (max %d): %.60s\n", MAX_FETCH_URLS, token);
+            }
+        }
+        token = strtok_r(nullptr, ",", &saveptr);
+    }
+    return n;
+}
+
+static uint32_t hashStr(const char* s) {
+    uint32_t h = 2166136261u;   // FNV-1a
+    while (*s) { h ^= (uint8_t)*s++; h *= 16777619u; }
+    return h;
+}
+
+// 設定の間隔（適応制御の起点）
+static int sourceBasePollSec(int src) {
+    int min_each = (src >= 0 && src < MAX_FETCH_URLS) ? config.ics_poll_each[src] : 0;
+    return (min_each > 0 ? min_each : config.ics_poll_min) * 60;
+}
+
+// 次の取得までの間隔。取得のたびに planSourcePoll が決めたもの（未計画なら設定の間隔）
+int sourcePollSec(int src) {
+    if (debug_fetch) return 30;
+    const SourceState& s = source_state[src];
+    if (event_count == 0 && s.poll_reason != POLL_EXHAUSTED) return 30;
+    return s.poll_sec > 0 ? s.poll_sec : sourceBasePollSec(src);
+}
+
+// このソースの次の未発火アラームまでの秒数（なければ -1）
+static int64_t sourceAlarmIn(const EventItem* buf, int from, int to, int src, time_t now) {
+    int64_t best = -1;
+    for (int i = from; i < to; i++) {
+        const EventItem& e = buf[i];
+        if (e.source != src || !e.has_alarm) continue;
+        for (int k = 0; k < e.alarm_count; k++) {
+            if (e.triggered[k] || e.alarm_time[k] <= now) continue;
+            int64_t in = (int64_t)(e.alarm_time[k] - now);
+            if (best < 0 || in < best) best = in;
+        }
+    }
+    return best;
+}
+
+static int32_t secToMidnight(time_t now) {
+    struct tm lt;
+    localtime_r(&now, &lt);
+    return 86400 - (lt.tm_hour * 3600 + lt.tm_min * 60 + lt.tm_sec);
+}
+
+// 取得を試みた直後に、このソースの次の取得までの間隔を決める
+//   失敗時は変化の有無が分からないので quiet では伸ばさない
+static void planSourcePoll(int src, time_t now, int64_t alarm_in, bool ok) {
+    SourceState& s = source_state[src];
+    PollInputs in;
+    in.base_sec = sourceBasePollSec(src);
+    in.unchanged = ok ? s.unchanged : 0;
+    in.alarm_in_sec = alarm_in;
+    in.avg_bytes = s.avg_bytes;
+    in.sec_to_midnight = secToMidnight(now);
+    in.sources = fetch_url_count;
+    in.adaptive = config.ics_poll_adaptive;
+    PollDecision d = pollNext(in, poll_budget);
+    s.poll_sec = d.sec;
+    s.poll_reason = (uint8_t)d.reason;
+    Serial.printf("POLL: SRC%d next in %ldmin (%s) unchanged=%u alarm_in=%ldmin avg=%luB\n",
+                  src + 1, (long)(d.sec / 60), poll_reason_names[d.reason], s.unchanged,
+                  alarm_in >= 0 ? (long)(alarm_in / 60) : -1L, (unsigned long)s.avg_bytes);
+}
+
+// 1回の取得を予算に計上（成功・失敗とも。TLS ハンドシェイク等は概算で足す）
+static void spendPollBudget(int src, bool ok) {
+    uint32_t bytes = fetch_io_bytes + POLL_TLS_OVERHEAD_BYTES;
+    poll_budget.spend(bytes);
+    if (ok) source_state[src].avg_bytes = pollAvgBytes(source_state[src].avg_bytes, bytes);
+}
+
+// 取得したセグメントの署名を前回と比べ、変化なしの連続回数を更新
+static void noteSegmentChange(int src, int from, int to) {
+    uint32_t sig = 0x5EED0000u + (uint32_t)(to - from);
+    for (int i = from; i < to; i++) {
+        sig = pollSignatureAdd(sig, fetch_buf[i].uid_hash, (int64_t)fetch_buf[i].start, fetch_buf[i].text_hash);
+    }
+    SourceState& s = source_state[src];
+    if (s.content_sig != 0 && sig == s.content_sig) {
+        if (s.unchanged < 255) s.unchanged++;
+    } else {
+        s.unchanged = 0;
+    }
+    s.content_sig = sig;
+}
+
+// 予算の使用量（スナップショットに保存・起動時に復元）。上限は fetch のたびに設定から入れ直す
+void pollBudgetUsage(uint32_t* fetches, uint64_t* bytes, uint16_t* day) {
+    *fetches = poll_budget.fetches;
+    *bytes = poll_budget.bytes;
+    *day = poll_budget.day;
+}
+
+void restorePollBudget(uint32_t fetches, uint64_t bytes, uint16_t day) {
+    poll_budget.fetches = fetches;
+    poll_budget.bytes = bytes;
+    poll_budget.day = day;          // 日付が違えば次の roll() で0に戻る
+}
+
+// 毎分の ALARM CHECK から
+void reportPoll() {
+    time_t now = time(nullptr);
+    if (now >= 1700000000) poll_budget.roll(dayKeyOf(now));
+    Serial.printf("  poll: budget %lu/%d fetches %luKB/%dKB%s, next",
+                  (unsigned long)poll_budget.fetches, config.poll_budget_fetches,
+                  (unsigned long)(poll_budget.bytes / 1024), config.poll_budget_kb,
+                  poll_budget.exhausted() ? " (exhausted)" : "");
+    for (int i = 0; i < fetch_url_count; i++) {
+        long in = (long)(source_state[i].last_attempt + sourcePollSec(i) - now);
+        Serial.printf(" SRC%d %ldmin(%s)", i + 1, in > 0 ? in / 60 : 0L,
+                      poll_reason_names[source_state[i].poll_reason < POLL_REASON_COUNT ? source_state[i].poll_reason : 0]);
+    }
+    Serial.println();
+}
+
+bool fetchDue(time_t now) {
+    if (now == (time_t)-1) return false;
+    if (now < fetch_backoff_until) return false;
+    // 初回fetch前（ソース構成未確定）は従来どおり30秒間隔で試行
+    if (fetch_url_count == 0) return (now - last_fetch) >= 30;
+    for (int i = 0; i < fetch_url_count; i++) {
+        if ((now - source_state[i].last_attempt) >= sourcePollSec(i)) return true;
+    }
+    return false;
+}
+
+// 次に fetchDue が真になる時刻（省電力スリープの締め切り。fetchDue と同じ条件）
+time_t nextFetchTime(time_t now) {
+    time_t t;
+    if (fetch_url_count == 0) {
+        t = last_fetch + 30;
+    } else {
+        t = source_state[0].last_attempt + sourcePollSec(0);
+        for (int i = 1; i < fetch_url_count; i++) {
+            time_t ti = source_state[i].last_attempt + sourcePollSec(i);
+            if (ti < t) t = ti;
+        }
+    }
+    if (t < fetch_backoff_until) t = fetch_backoff_until;
+    return t < now ? now : t;
+}
+
+// SD不調・WiFi不通などで今回は取得しない → 全ソースを「今試行した」扱いにして次周期へ
+void deferFetch(time_t now) {
+    last_fetch = now;
+    for (int i = 0; i < fetch_url_count; i++) source_state[i].last_attempt = now;
+}
+
+static uint16_t* carry_map = nullptr;       // 旧面の位置 → 書き込み面の位置（検索索引の引き継ぎ、PSRAM）
+
+// 旧バッファから指定ソースのセグメントを新バッファへ引き継ぐ（ソート済み順を維持）
+static int carrySegment(const EventItem* prev_buf, int prev_count, int src) {
+    if (!carry_map) carry_map = (uint16_t*)ps_malloc(MAX_EVENTS * sizeof(uint16_t));
+    if (carry_map) memset(carry_map, 0xFF, prev_count * sizeof(uint16_t));
+    int carried = 0;
+    for (int p = 0; p < prev_count && fetch_count < MAX_EVENTS; p++) {
+        const EventItem& pe = prev_buf[p];
+        if (pe.source != src) continue;
+        // 本文は旧面のプールにあるため、書き込み面のプールへインターンし直して付け替える
+        const char* sumP = poolIntern(fetch_pool, pe.summary_text, strlen(pe.summary_text), nullptr);
+        int descLen = pe.desc_packed ? pe.desc_packed : (int)strlen(pe.desc_text);
+        const char* descP = sumP ? poolIntern(fetch_pool, pe.desc_text, descLen, nullptr) : nullptr;
+        const char* midiP = descP ? poolIntern(fetch_pool, pe.midi_file, strlen(pe.midi_file), nullptr) : nullptr;
+        const char* rowP = midiP ? poolIntern(fetch_pool, pe.row_text, pe.row_len, nullptr) : nullptr;
+        if (!rowP) break;
+        fetch_buf[fetch_count] = pe;        // 行表示フィールド（time_text / row_*）もそのまま引き継ぐ
+        fetch_buf[fetch_count].summary_text = sumP;
+        fetch_buf[fetch_count].desc_text = descP;
+        fetch_buf[fetch_count].midi_file = midiP;
+        fetch_buf[fetch_count].row_text = rowP;
+        if (carry_map) carry_map[p] = (uint16_t)fetch_count;
+        fetch_count++;
+        carried++;
+    }
+    // 検索索引は旧面の転置リストから写す（圧縮された説明文を展開し直さない）。
+    //   旧面の索引が無いときだけ本文から作る
+    if (carried > 0 && !(carry_map && searchIndexCarry(prev_buf, carry_map, prev_count))) {
+        for (int i = fetch_count - carried; i < fetch_count; i++) {
+            const char* sum = fetch_buf[i].summary();
+            const char* d = fetch_buf[i].description();
+            searchIndexAdd(i, sum, strlen(sum), d, strlen(d));
+        }
+    }
+    return carried;
+}
+
+// 公開直前に、取得中に鳴ったアラームを発火済みに戻す
+//   受信中の割り込み点（alarmPreemptPoint）で鳴ったアラームは公開中の旧面にだけ印が付く。
+//   新面は旧面の triggered を写した後なので、そのままだと公開後に期限切れの未発火に戻って
+//   二度鳴る。公開中の版（events / event_count。日付の切り替わりで先頭がずれていてもよい）から
+//   同じイベント・同じ alarm_time の印を写し直す。SD のジャーナルには頼らない
+//   （SD 不調・ジャーナル満杯でも二度鳴らさない）。発火は loopTask だけなので、
+//   ここから公開までの間に鳴ることはない
+static void reapplyFiredAlarms(time_t now) {
+    int reapplied = 0;
+    for (int i = 0; i < fetch_count; i++) {
+        EventItem& e = fetch_buf[i];
+        const EventItem* cur = nullptr;
+        bool looked = false;
+        for (int k = 0; k < e.alarm_count; k++) {
+            if (e.triggered[k] || e.alarm_time[k] > now) continue;
+            if (!looked) {
+                cur = findEventIn(events, event_count, e.start, e.uid_hash);
+                looked = true;
+            }
+            if (!cur) continue;
+            for (int j = 0; j < cur->alarm_count; j++) {
+                if (cur->alarm_time[j] == e.alarm_time[k] && cur->triggered[j]) {
+                    e.triggered[k] = true;
+                    reapplied++;
+                    break;
+                }
+            }
+        }
+    }
+    if (reapplied > 0) Serial.printf("Fetch: %d alarm slot(s) fired during fetch marked done\n", reapplied);
+}
+
+bool fetchAndUpdate(bool force_all) {
     // ★ mbedTLSのメモリ確保先をPSRAMに変更（初回のみ）
     installMbedTLSPsramAllocator();
 
-    Serial.printf("Fetching ICS...%s (heap:%d maxBlock:%d WiFi:%d RSSI:%d fails:%d events:%d)\n",
-                  debug_fetch ? " [DEBUG 30s]" : "",
+    Serial.printf("Fetching ICS...%s%s (heap:%d maxBlock:%d WiFi:%d RSSI:%d fails:%d events:%d)\n",
+                  debug_fetch ? " [DEBUG 30s]" : "", force_all ? " [ALL]" : "",
                   ESP.getFreeHeap(), ESP.getMaxAllocHeap(), WiFi.status(), WiFi.RSSI(),
                   fetch_fail_count, event_count);
 
@@ -859,147 +1132,200 @@ bool fetchAndUpdate() {
         return false;
     }
 
-    if (strlen(config.ics_url) == 0) {
+    // ── カンマ区切りURL → ソース一覧 ──
+    static char url_buf[512];
+    char* urls[MAX_FETCH_URLS];
+    int total_urls = splitIcsUrls(url_buf, sizeof(url_buf), urls);
+    if (total_urls == 0) {
         Serial.println("ICS URL not configured");
+        deferFetch(now_check);
         return false;
     }
     if (ESP.getFreeHeap() < MIN_HEAP_FOR_FETCH) {
         Serial.printf("SKIP ICS fetch - heap too low: %d < %d\n",
                       ESP.getFreeHeap(), MIN_HEAP_FOR_FETCH);
-        last_fetch = time(nullptr);
+        deferFetch(now_check);
         fetch_fail_count++;
         return false;
     }
     if (WiFi.status() != WL_CONNECTED) {
         Serial.println("WiFi not connected, skipping ICS fetch");
-        last_fetch = time(nullptr);
+        deferFetch(now_check);
         fetch_fail_count++;
         return false;
     }
 
-    // ── ダブルバッファ切り替え（1回だけ） ──
+    // URL構成が変わった（設定画面で編集等）→ ソース番号の意味が変わるため
+    // 旧セグメントは引き継がず、全ソースを取り直す
+    uint32_t url_hash = hashStr(config.ics_url);
+    bool url_changed = (url_hash != fetch_url_hash) || (total_urls != fetch_url_count);
+    if (url_changed) {
+        Serial.printf("ICS URLs configured: %d (source table reset)\n", total_urls);
+        memset(source_state, 0, sizeof(source_state));
+        fetch_url_hash  = url_hash;
+        fetch_url_count = total_urls;
+        force_all = true;
+    }
+
+    // ── 更新対象ソースの決定 ──
+    bool due[MAX_FETCH_URLS];
+    int due_count = 0;
+    for (int i = 0; i < total_urls; i++) {
+        long since = (long)(now_check - source_state[i].last_attempt);
+        due[i] = force_all || since >= sourcePollSec(i);
+        if (due[i]) due_count++;
+        Serial.printf("  SRC%d: %s poll=%dmin last_ok=%ld events=%d\n",
+                      i + 1, due[i] ? "DUE " : "skip", sourcePollSec(i) / 60,
+                      (long)source_state[i].last_success, source_state[i].event_count);
+    }
+    if (due_count == 0) {
+        Serial.println("No ICS source due");
+        return false;
+    }
+
+    // ── 書き込み面の確保（公開中の events はこの fetch の間そのまま） ──
+    //   非公開面を読み手がまだピンしていれば再利用できないので次周期へ
     EventItem* prev_buf = events;
     int prev_count = event_count;
-    EventItem* next_buf = (events == events_buf_a) ? events_buf_b : events_buf_a;
-    events = next_buf;
-    event_count = 0;
+    EventItem* next_buf = acquireWriteFace();
+    if (!next_buf) {
+        Serial.println("Fetch deferred: write face still pinned by a reader");
+        deferFetch(now_check);
+        return false;
+    }
+    fetch_buf = next_buf;
+    fetch_count = 0;
+    poll_budget.max_fetches = (uint32_t)config.poll_budget_fetches;
+    poll_budget.max_bytes = (uint32_t)config.poll_budget_kb * 1024;
+    poll_budget.roll(dayKeyOf(now_check));
+    fetch_pool = textPoolFor(next_buf);
+    poolReset(fetch_pool);
+    pool_full_logged = false;
+    desc_packed_count = 0;
+    desc_packed_saved = 0;
+    searchIndexBegin(next_buf);
     // registerEvent から旧バッファを参照できるよう公開
     fetch_prev_buf   = prev_buf;
     fetch_prev_count = prev_count;
-    Serial.printf("Fetch: switching to buffer %s (prev: %d events)\n",
-                  (next_buf == events_buf_a) ? "A" : "B", prev_count);
-
-    // ── カンマ区切りで複数URL順次フェッチ ──
-    static char url_buf[512];
-    strlcpy(url_buf, config.ics_url, sizeof(url_buf));
+    Serial.printf("Fetch: writing buffer %s (prev: %d events, due: %d/%d sources)\n",
+                  (next_buf == events_buf_a) ? "A" : "B", prev_count, due_count, total_urls);
 
+    // ── ソース順に「再取得」または「旧セグメント引き継ぎ」 ──
     int total_added = 0;
-    int url_count = 0;
+    int attempted = 0;
     int fail_count = 0;
     int skip_count = 0;
-    int total_urls = 0;
-
-    // まず総URL数をカウント
-    {
-        char count_buf[512];
-        strlcpy(count_buf, config.ics_url, sizeof(count_buf));
-        char* sp = nullptr;
-        char* tk = strtok_r(count_buf, ",", &sp);
-        while (tk) {
-            while (*tk == ' ') tk++;
-            if (strlen(tk) > 0) total_urls++;
-            tk = strtok_r(nullptr, ",", &sp);
-        }
-    }
-    Serial.printf("ICS URLs configured: %d\n", total_urls);
+    int held_count = 0;     // アラームのため見送ったソース（期限切れのまま → 鳴り終わってから取り直す）
+    bool wifi_lost = false;
 
-    // ── URLごとの状態テーブルを初期化 (ヘッダー表示用) ──
-    fetch_url_count = (total_urls > MAX_FETCH_URLS) ? MAX_FETCH_URLS : total_urls;
-    for (int i = 0; i < MAX_FETCH_URLS; i++) fetch_url_status[i] = 0;
+    for (int i = 0; i < total_urls; i++) {
+        int seg_start = fetch_count;
 
-    char* saveptr = nullptr;
-    char* token = strtok_r(url_buf, ",", &saveptr);
-    while (token) {
-        // 前後の空白をトリム
-        while (*token == ' ') token++;
-        char* end = token + strlen(token) - 1;
-        while (end > token && *end == ' ') *end-- = '\0';
+        if (!due[i]) {
+            int carried = url_changed ? 0 : carrySegment(prev_buf, prev_count, i);
+            Serial.printf("URL %d: not due, carried %d events\n", i + 1, carried);
+            continue;
+        }
 
-        if (strlen(token) > 0) {
-            url_count++;
-
-            // URL間ヒープチェック
-            // ★ PSRAMアロケータ有効時はSSLバッファがPSRAMに行くため閾値を大幅引き下げ
-            //    フォールバック: 内部ヒープ枯渇時のみWiFi再接続で回復を試みる
-            if (url_count > 1) {
-                size_t mb_between = ESP.getMaxAllocHeap();
-                size_t heap_between = ESP.getFreeHeap();
-                Serial.printf("URL %d: pre-check heap=%d maxBlock=%d psram=%dKB\n",
-                              url_count, heap_between, mb_between, ESP.getFreePsram() / 1024);
-                if (heap_between < 40000) {
-                    // 内部ヒープ自体が40KB未満 → WiFi再接続で回復試行
-                    Serial.printf("URL %d: heap %d < 40KB - WiFi restart to recover...\n",
-                                  url_count, heap_between);
-                    WiFi.disconnect(true);
-                    delay(200);
-                    if (!connectWiFi()) {
-                        Serial.println("WiFi reconnect failed");
-                        skip_count++;
-                        if (url_count - 1 < MAX_FETCH_URLS) fetch_url_status[url_count - 1] = 2;
-                        char* remaining = strtok_r(nullptr, ",", &saveptr);
-                        int skip_idx = url_count;
-                        while (remaining) {
-                            while (*remaining == ' ') remaining++;
-                            if (strlen(remaining) > 0) {
-                                skip_count++;
-                                if (skip_idx < MAX_FETCH_URLS) fetch_url_status[skip_idx] = 2;
-                                skip_idx++;
-                            }
-                            remaining = strtok_r(nullptr, ",", &saveptr);
-                        }
-                        break;
-                    }
+        // URL間ヒープチェック
+        // ★ PSRAMアロケータ有効時はSSLバッファがPSRAMに行くため閾値を大幅引き下げ
+        //    フォールバック: 内部ヒープ枯渇時のみWiFi再接続で回復を試みる
+        if (attempted > 0 && !wifi_lost) {
+            size_t mb_between = ESP.getMaxAllocHeap();
+            size_t heap_between = ESP.getFreeHeap();
+            Serial.printf("URL %d: pre-check heap=%d maxBlock=%d psram=%dKB\n",
+                          i + 1, heap_between, mb_between, ESP.getFreePsram() / 1024);
+            if (heap_between < 40000) {
+                // 内部ヒープ自体が40KB未満 → WiFi再接続で回復試行
+                Serial.printf("URL %d: heap %d < 40KB - WiFi restart to recover...\n",
+                              i + 1, heap_between);
+                WiFi.disconnect(true);
+                delay(200);
+                if (!connectWiFi()) {
+                    Serial.println("WiFi reconnect failed");
+                    wifi_lost = true;
+                } else {
                     Serial.printf("After WiFi restart: heap=%d maxBlock=%d\n",
                                   ESP.getFreeHeap(), ESP.getMaxAllocHeap());
                 }
             }
+        }
 
-            Serial.printf("=== Fetching URL %d/%d: %.60s... ===\n", url_count, total_urls, token);
-            dumpHeapTag("loop:before_doFetchURL");
-            int result = doFetchURL(token);
-            // [LEAK] ここは WiFiClientSecure destructor 実行後の状態
-            dumpHeapTag("loop:after_doFetchURL+dtor");
-            if (result >= 0) {
-                if (url_count - 1 < MAX_FETCH_URLS) fetch_url_status[url_count - 1] = 1;
-                if (result > 0) {
-                    total_added += result;
-                    Serial.printf("URL %d: +%d events (total: %d)\n", url_count, result, event_count);
-                } else {
-                    Serial.printf("URL %d: 0 events added\n", url_count);
-                }
-            } else {
-                fail_count++;
-                if (url_count - 1 < MAX_FETCH_URLS) fetch_url_status[url_count - 1] = 2;
-                Serial.printf("URL %d: fetch failed\n", url_count);
-            }
+        if (wifi_lost) {
+            // 残りの取得対象はスキップ — 旧セグメントを保持
+            skip_count++;
+            source_state[i].status = 2;
+            source_state[i].last_attempt = time(nullptr);
+            int carried = url_changed ? 0 : carrySegment(prev_buf, prev_count, i);
+            Serial.printf("URL %d: skipped, kept %d old events\n", i + 1, carried);
+            continue;
+        }
+
+        // TLS接続・ヘッダー待ちは割り込めない → 終わる前にアラームが来る・鳴動中なら見送る
+        //   受信中に割り込み点でアラームが鳴った場合も、残りのソースはここで止まる
+        if (midi_playing || !alarmAllowsBlocking(FETCH_URL_BLOCK_MS, "ICS source")) {
+            held_count++;
+            int carried = url_changed ? 0 : carrySegment(prev_buf, prev_count, i);
+            Serial.printf("URL %d: held for alarm, kept %d old events\n", i + 1, carried);
+            continue;
+        }
+
+        attempted++;
+        Serial.printf("=== Fetching URL %d/%d: %.60s... ===\n", i + 1, total_urls, urls[i]);
+        dumpHeapTag("loop:before_doFetchURL");
+        fetch_cur_source = (uint8_t)i;
+        fetch_io_bytes = 0;
+        int result = doFetchURL(urls[i]);
+        // [LEAK] ここは WiFiClientSecure destructor 実行後の状態
+        dumpHeapTag("loop:after_doFetchURL+dtor");
+        time_t done_at = time(nullptr);
+        source_state[i].last_attempt = done_at;
+        spendPollBudget(i, result >= 0);
+        if (result >= 0) {
+            source_state[i].status = 1;
+            source_state[i].last_success = source_state[i].last_attempt;
+            total_added += result;
+            Serial.printf("URL %d: +%d events (total: %d)\n", i + 1, result, fetch_count);
+            noteSegmentChange(i, seg_start, fetch_count);
+            planSourcePoll(i, done_at, sourceAlarmIn(fetch_buf, seg_start, fetch_count, i, done_at), true);
+        } else {
+            // このソースのセグメントだけ旧データに戻す（他ソースの更新は採用）
+            fetch_count = seg_start;
+            searchIndexTruncate(seg_start);
+            fail_count++;
+            source_state[i].status = 2;
+            int carried = url_changed ? 0 : carrySegment(prev_buf, prev_count, i);
+            Serial.printf("URL %d: fetch failed, kept %d old events\n", i + 1, carried);
+            // 失敗では間隔を伸縮しない（連続失敗のバックオフは下の fetch_fail_count 側）
+            planSourcePoll(i, done_at, sourceAlarmIn(prev_buf, 0, prev_count, i, done_at), false);
         }
-        token = strtok_r(nullptr, ",", &saveptr);
     }
 
-    Serial.printf("All URLs done: %d/%d fetched, %d failed, %d skipped, %d events\n",
-                  url_count - fail_count, total_urls, fail_count, skip_count, event_count);
+    int ok_count = due_count - fail_count - skip_count - held_count;
+    Serial.printf("All URLs done: %d/%d due fetched, %d failed, %d skipped, %d held, %d events\n",
+                  ok_count, due_count, fail_count, skip_count, held_count, fetch_count);
+
+    // ── アラームで見送っただけ → 失敗扱いにせず、旧データのまま鳴り終わってから取り直す ──
+    if (ok_count == 0 && fail_count == 0 && skip_count == 0) {
+        Serial.printf("Fetch held for alarm - keeping previous %d events\n", prev_count);
+        fetch_buf = nullptr;
+        fetch_count = 0;
+        fetch_prev_buf = nullptr;
+        fetch_prev_count = 0;
+        return false;
+    }
 
-    // ── URL失敗/スキップあり → 部分データ採用（ゼロ件のときだけ旧データ復帰） ──
-    // 旧仕様: event_count < prev_count なら一律旧データへ復帰
-    //   → 1本のURLが失敗し続けると起動時スナップショットから永久に更新されない
-    //     (新規追加した予定が再起動まで見えないバグ v036 で修正)
-    // 新仕様: 部分成功した新データを採用。次サイクルで失敗URLは再取得される。
-    bool incomplete_fetch = (fail_count > 0 || skip_count > 0);
-    if (incomplete_fetch && event_count == 0) {
-        Serial.printf("All fetches failed/skipped - restoring previous %d events\n", prev_count);
-        events = prev_buf;
-        event_count = prev_count;
+    // ── 取得対象ソースが全滅 → 新バッファは旧セグメントの写しにすぎないので公開しない ──
+    // 一部ソースだけ失敗した場合はそのソースのセグメントのみ旧データを保持し、
+    // 成功したソースの更新は採用する（全体を捨てる/採るの二択にはしない）
+    if (ok_count == 0) {
+        Serial.printf("All due fetches failed/skipped - keeping previous %d events\n", prev_count);
+        fetch_buf = nullptr;
+        fetch_count = 0;
+        fetch_prev_buf = nullptr;
+        fetch_prev_count = 0;
         fetch_fail_count++;
+        last_fetch = time(nullptr);
         size_t mb = ESP.getMaxAllocHeap();
 
         if (mb < 20000 && fetch_fail_count >= 3) {
@@ -1008,8 +1334,7 @@ bool fetchAndUpdate() {
             safeReboot();
         } else if (fetch_fail_count >= 3) {
             int backoff_min = min((int)(fetch_fail_count - 2) * 5, 30);
-            int poll_sec = (event_count == 0) ? 30 : (config.ics_poll_min * 60);
-            last_fetch = time(nullptr) + (backoff_min * 60) - poll_sec;
+            fetch_backoff_until = time(nullptr) + backoff_min * 60;
             Serial.printf("=== Server unreachable (heap OK: maxBlock=%d) - backoff %d min ===\n",
                           mb, backoff_min);
             return false;
@@ -1024,71 +1349,63 @@ bool fetchAndUpdate() {
                 safeReboot();
             }
         }
-
-        last_fetch = time(nullptr);
         return false;
     }
-    if (incomplete_fetch) {
+    if (fail_count > 0 || skip_count > 0) {
+        // 一部ソースの失敗（404・ホスト停止など）では再起動しない。成功分を公開・保存し、
+        //   失敗ソースは旧セグメントのまま次の周期で取り直す。再起動するのはヒープ不足
+        //   （TLS バッファが確保できない）ときだけで、判定は保存の後の maxBlock で行う
         Serial.printf("*** Partial fetch (fail:%d skip:%d) — accepting %d events (prev:%d) ***\n",
-                      fail_count, skip_count, event_count, prev_count);
-        // v038: ~35KB/cycle の heap leak があり、数サイクル後に URL2/3 の SSL connect が
-        //       落ちる（= fch2X fch3X が常時表示される）。WiFi が生きているなら原因は
-        //       heap とみなしてサイレント再起動で heap を再生する。WiFi 切断中は
-        //       ネットワーク障害の可能性があるので reboot loop 防止のため見送る。
-        //       e-paper は残像保持なので pushCanvas せずに restart しても画面は前の
-        //       状態を維持し、再起動後の fetch で自然に更新される。
-        if (WiFi.status() == WL_CONNECTED) {
-            Serial.println("=== Partial fetch with WiFi up — suspect heap leak, silent reboot ===");
-            safeReboot();
-        }
+                      fail_count, skip_count, fetch_count, prev_count);
     }
 
-    // ── 全URLフェッチ完了後にソート＆トリム ──
-    sortEvents();
-    trimEventsAroundToday(config.max_events);
+    // ── 全ソースのセグメントをマージ（ソート＆トリム） ──
+    sortAndTrimEvents(config.max_events);
+    reapplyFiredAlarms(time(nullptr));
+    publishEvents(fetch_buf, fetch_count);  // ここで初めて読み手に見える（epoch +1）
+    rebuildEventIndex();                // 公開バッファのホット索引（内部DRAM）を再構築
+    searchIndexFinalize();              // 検索索引（PSRAM）をバイグラム順に
+
+    for (int i = 0; i < MAX_FETCH_URLS; i++) source_state[i].event_count = 0;
+    for (int i = 0; i < event_count; i++) {
+        if (events[i].source < MAX_FETCH_URLS) source_state[events[i].source].event_count++;
+    }
 
     fetch_fail_count = 0;
+    fetch_backoff_until = 0;
     heap_skip_count = 0;
     size_t mb = ESP.getMaxAllocHeap();
-    Serial.printf("Fetched %d events from %d URLs (heap:%d maxBlock:%d next:%dmin)\n",
-                  event_count, url_count, ESP.getFreeHeap(), mb,
-                  debug_fetch ? 0 : config.ics_poll_min);
-
-    // ★ アラーム状態サマリー（データ更新確認用）
-    {
-        int alarm_count = 0;
-        for (int i = 0; i < event_count; i++) {
-            if (events[i].has_alarm) {
-                alarm_count++;
-                struct tm st; localtime_r(&events[i].start, &st);
-                char offBuf[96]; offBuf[0] = '\0';
-                int op = 0;
-                for (int k = 0; k < events[i].alarm_count && op < (int)sizeof(offBuf) - 12; k++) {
-                    op += snprintf(offBuf + op, sizeof(offBuf) - op,
-                                   k == 0 ? "%d%s" : ",%d%s",
-                                   events[i].offset_min[k],
-                                   events[i].triggered[k] ? "*" : "");
-                }
-                Serial.printf("  ALARM[%d]: %02d/%02d %02d:%02d '%s' off=[%s]min\n",
-                              i, st.tm_mon+1, st.tm_mday, st.tm_hour, st.tm_min,
-                              events[i].summary(), offBuf);
-            }
-        }
-        Serial.printf("  Total alarms: %d / %d events\n", alarm_count, event_count);
-    }
+    Serial.printf("Fetched %d events (+%d new) from %d/%d URLs (heap:%d maxBlock:%d)\n",
+                  event_count, total_added, ok_count, total_urls, ESP.getFreeHeap(), mb);
+    Serial.printf("Text pool: %uKB / %uKB (avg %d B/event, %u strings, %uKB shared, "
+                  "%d desc packed -%uKB)\n",
+                  (unsigned)(fetch_pool->used / 1024), (unsigned)(fetch_pool->size / 1024),
+                  event_count > 0 ? (int)(fetch_pool->used / event_count) : 0,
+                  (unsigned)fetch_pool->intern_count, (unsigned)(fetch_pool->intern_saved / 1024),
+                  desc_packed_count, (unsigned)(desc_packed_saved / 1024));
+
+    // ★ 旧バッファとの差分（追加/削除/移動/変更）— 全アラームのダンプに代えて要約のみ出力
+    diffEvents(prev_buf, prev_count, events, event_count);
+
+    // ★ 再描画の要否は fetch_diff で判断する（refreshListAfterFetch）
+    //    text_hash は本文とアラーム属性を含むため「!」追加等も「変更」として検出される
+    Serial.printf("Fetch complete (%d->%d items)\n", prev_count, event_count);
+    last_fetch = time(nullptr);
+    initial_fetch_done = true;          // 以降の fetch は「通常fetch」扱い
+    fetch_buf = nullptr;
+    fetch_count = 0;
+    fetch_prev_buf = nullptr;
+    fetch_prev_count = 0;
+    saveEventSnapshot();                // 次回起動時の即時表示用
+    compactAlarmJournal(last_fetch);
+    saveTimeToRTC();
 
+    // ヒープ起因の再起動は公開・保存の後（再起動後はスナップショットから今回の結果で復帰する）
+    //   v038: ~35KB/cycle の heap leak で数サイクル後に SSL connect が落ちるため、
+    //   maxBlock が TLS バッファを確保できない水準まで下がったら先回りして再生する
     if (mb < 38000) {
         Serial.printf("=== maxBlock %d < 38KB - proactive restart requested ===\n", mb);
         safeReboot();
     }
-
-    // ★ フェッチ成功時は常に再描画する（変更検出は不正確で「!」追加等を見逃すため）
-    //    定期fetchは数分に1回なのでGC16フラッシュ頻度は許容範囲
-    Serial.printf("Fetch complete (%d->%d items) - always redraw\n",
-                  prev_count, event_count);
-    last_fetch = time(nullptr);
-    initial_fetch_done = true;          // 以降の fetch は「通常fetch」扱い
-    fetch_prev_buf = nullptr;
-    fetch_prev_count = 0;
     return true;
 }
\ No newline at end of file
@@ -10,9 +10,9 @@ void checkSwitches() {
     bool sw_r = digitalRead(SW_R_PIN);
     bool sw_p = digitalRead(SW_P_PIN);
 
-    if (!sw_l && sw_l_prev) { Serial.println("SW_L pressed"); unsigned long t=millis(); last_interaction_ms = millis(); handleSwitch('L'); Serial.printf("SW_L handled in %lu ms\n", millis()-t); }
-    if (!sw_r && sw_r_prev) { Serial.println("SW_R pressed"); unsigned long t=millis(); last_interaction_ms = millis(); handleSwitch('R'); Serial.printf("SW_R handled in %lu ms\n", millis()-t); }
-    if (!sw_p && sw_p_prev) { Serial.println("SW_P pressed"); unsigned long t=millis(); last_interaction_ms = millis(); handleSwitch('P'); Serial.printf("SW_P handled in %lu ms\n", millis()-t); }
+    if (!sw_l && sw_l_prev) { Serial.println("SW_L pressed"); unsigned long t=millis(); noteInteraction(); handleSwitch('L'); Serial.printf("SW_L handled in %lu ms\n", millis()-t); }
+    if (!sw_r && sw_r_prev) { Serial.println("SW_R pressed"); unsigned long t=millis(); noteInteraction(); handleSwitch('R'); Serial.printf("SW_R handled in %lu ms\n", millis()-t); }
+    if (!sw_p && sw_p_prev) { Serial.println("SW_P pressed"); unsigned long t=millis(); noteInteraction(); handleSwitch('P'); Serial.printf("SW_P handled in %lu ms\n", millis()-t); }
 
     sw_l_prev = sw_l;
     sw_r_prev = sw_r;
@@ -65,6 +65,18 @@ void handleSwitch(char sw) {
             }
             break;
 
+        case UI_SEARCH:
+            if (sw == 'P') { ui_state = UI_LIST; waitEPDReady(); drawList(false, false, false, true); }
+            else if (sw == 'L') scrollSearch(-1);
+            else if (sw == 'R') scrollSearch(1);
+            break;
+
+        case UI_MONTH:
+            if (sw == 'P') { ui_state = UI_LIST; waitEPDReady(); drawList(false, false, false, true); }
+            else if (sw == 'L') { month_offset--; drawMonth(true); }
+            else if (sw == 'R') { month_offset++; drawMonth(true); }
+            break;
+
         case UI_DETAIL:
             if (sw == 'P') { ui_state = UI_LIST; waitEPDReady(); drawList(false, false, false, true); }
             else if (sw == 'L') { if (detail_scroll > 0) { detail_scroll--; drawDetail(selected_event, true); } }
@@ -129,7 +141,7 @@ void handleSwitch(char sw) {
 // タッチ処理
 //==============================================================================
 void handleTouch(int tx, int ty) {
-    last_interaction_ms = millis();
+    noteInteraction();
 
     // 左上タッチ → スクリーンショット
     if (tx < 80 && ty < 80) {
@@ -139,54 +151,39 @@ void handleTouch(int tx, int ty) {
 
     switch (ui_state) {
         case UI_LIST: {
+            // ヘッダーの日付 → 月表示
+            if (ty < 40 && tx < 250) {
+                ui_state = UI_MONTH; month_offset = 0; drawMonth();
+                return;
+            }
+            // フッターの件数表示 → 検索
+            if (ty >= 850 && ty < 895 && tx < 250) {
+                openSearch();
+                return;
+            }
             // ボタンチェック
             if (ty >= btn_prev.y0 && ty <= btn_prev.y1) {
                 if (tx >= btn_prev.x0 && tx <= btn_prev.x1) {
-                    // 前日
+                    // 前日（日バケットで前の日の先頭へ）
                     if (page_start > 0) {
-                        struct tm cur_tm; localtime_r(&events[page_start].start, &cur_tm);
-                        int cur_day = cur_tm.tm_mday + cur_tm.tm_mon * 100 + cur_tm.tm_year * 10000;
-                        int found = -1;
-                        for (int i = page_start - 1; i >= 0; i--) {
-                            struct tm t; localtime_r(&events[i].start, &t);
-                            int day = t.tm_mday + t.tm_mon * 100 + t.tm_year * 10000;
-                            if (day < cur_day) {
-                                found = i;
-                                for (int j = i - 1; j >= 0; j--) {
-                                    struct tm t2; localtime_r(&events[j].start, &t2);
-                                    int day2 = t2.tm_mday + t2.tm_mon * 100 + t2.tm_year * 10000;
-                                    if (day2 == day) found = j; else break;
-                                }
-                                break;
-                            }
-                        }
-                        if (found >= 0) { page_start = found; selected_event = found; }
-                        else { page_start = 0; selected_event = 0; }
+                        int found = firstEventOfPrevDay(page_start);
+                        page_start = found >= 0 ? found : 0;
+                        selected_event = page_start;
                         drawList();
                     }
                     return;
                 } else if (tx >= btn_next.x0 && tx <= btn_next.x1) {
                     // 翌日
                     if (page_start < event_count - 1) {
-                        struct tm cur_tm; localtime_r(&events[page_start].start, &cur_tm);
-                        int cur_day = cur_tm.tm_mday + cur_tm.tm_mon * 100 + cur_tm.tm_year * 10000;
-                        for (int i = page_start + 1; i < event_count; i++) {
-                            struct tm t; localtime_r(&events[i].start, &t);
-                            int day = t.tm_mday + t.tm_mon * 100 + t.tm_year * 10000;
-                            if (day > cur_day) { page_start = i; selected_event = i; break; }
-                        }
+                        int found = firstEventOfNextDay(page_start);
+                        if (found >= 0) { page_start = found; selected_event = found; }
                         drawList();
                     }
                     return;
                 } else if (tx >= btn_today.x0 && tx <= btn_today.x1) {
                     // 今日
-                    time_t now = time(nullptr); struct tm now_tm; localtime_r(&now, &now_tm);
-                    int today = now_tm.tm_mday + now_tm.tm_mon * 100 + now_tm.tm_year * 10000;
-                    for (int i = 0; i < event_count; i++) {
-                        struct tm t; localtime_r(&events[i].start, &t);
-                        int day = t.tm_mday + t.tm_mon * 100 + t.tm_year * 10000;
-                        if (day >= today) { page_start = i; selected_event = i; break; }
-                    }
+                    int found = firstEventOnOrAfterDay(dayKeyOf(time(nullptr)));
+                    if (found < event_count) { page_start = found; selected_event = found; }
                     drawList();
                     return;
                 } else if (tx >= btn_detail.x0 && tx <= btn_detail.x1) {
@@ -218,6 +215,43 @@ void handleTouch(int tx, int ty) {
         case UI_DETAIL:
             ui_state = UI_LIST; waitEPDReady(); drawList(false, false, false, true); break;
 
+        case UI_SEARCH: {
+            if (ty >= 900 && ty < 950) {
+                if (tx >= 5 && tx < 125)   { scrollSearch(-1); return; }
+                if (tx >= 130 && tx < 255) { scrollSearch(1); return; }
+                if (tx >= 260 && tx < 385) { openSearch(); return; }
+                if (tx >= 390 && tx < 535) { ui_state = UI_LIST; waitEPDReady(); drawList(false, false, false, true); return; }
+                return;
+            }
+            // 結果行タップ → 詳細（戻ると一覧のその位置）
+            int evt = searchHitAt(tx, ty);
+            if (evt < 0) return;
+            selected_event = evt;
+            page_start = evt;
+            ui_state = UI_DETAIL; detail_scroll = 0;
+            drawDetail(selected_event);
+            break;
+        }
+
+        case UI_MONTH: {
+            if (ty >= 900 && ty < 950) {
+                if (tx >= 5 && tx < 125)   { month_offset--; drawMonth(true); return; }
+                if (tx >= 130 && tx < 255) { month_offset++; drawMonth(true); return; }
+                if (tx >= 260 && tx < 385) { month_offset = 0; drawMonth(true); return; }
+                if (tx >= 390 && tx < 535) { ui_state = UI_LIST; waitEPDReady(); drawList(false, false, false, true); return; }
+                return;
+            }
+            // 日付タップ → その日（予定がなければ次に予定のある日）の一覧へ
+            uint16_t day = monthDayAt(tx, ty);
+            if (day == 0) return;
+            int first = firstEventOnOrAfterDay(day);
+            if (first < event_count) { page_start = first; selected_event = first; }
+            ui_state = UI_LIST;
+            waitEPDReady();
+            drawList(false, false, false, true);
+            break;
+        }
+
         case UI_PLAYING:
             finishAlarm(); break;
 
@@ -259,106 +293,139 @@ void handleTouch(int tx, int ty) {
 //==============================================================================
 // アラームチェック
 //==============================================================================
-void checkAlarms() {
-    if (midi_playing) return;
-
+// 毎分のデバッグ出力（ALARM CHECK）。loop() のタイマーから（サウンドテスト中は呼ばない）
+void reportAlarmCheck() {
     time_t now = time(nullptr);
+    struct tm lt; localtime_r(&now, &lt);
+    Serial.printf("\n=== ALARM CHECK [%02d/%02d %02d:%02d:%02d] ver.%s heap:%d sd:%s ===\n",
+                  lt.tm_mon + 1, lt.tm_mday, lt.tm_hour, lt.tm_min, lt.tm_sec,
+                  BUILD_VERSION, ESP.getFreeHeap(), sd_healthy ? "OK" : "NG");
 
-    // 毎分デバッグ出力
-    if (now - last_alarm_debug >= 60) {
-        last_alarm_debug = now;
-        struct tm lt; localtime_r(&now, &lt);
-        Serial.printf("\n=== ALARM CHECK [%02d/%02d %02d:%02d:%02d] ver.%s heap:%d sd:%s ===\n",
-                      lt.tm_mon + 1, lt.tm_mday, lt.tm_hour, lt.tm_min, lt.tm_sec,
-                      BUILD_VERSION, ESP.getFreeHeap(), sd_healthy ? "OK" : "NG");
-
-        int pending = 0;
-        for (int i = 0; i < event_count; i++) {
-            if (!events[i].has_alarm) continue;
-            bool anyPending = false;
-            for (int k = 0; k < events[i].alarm_count; k++) {
-                if (!events[i].triggered[k]) { anyPending = true; break; }
-            }
-            if (!anyPending) continue;
-            pending++;
-            struct tm st; localtime_r(&events[i].start, &st);
-            Serial.printf("  [%d] %s  event:%02d/%02d %02d:%02d\n",
-                          i, events[i].summary(),
-                          st.tm_mon+1, st.tm_mday, st.tm_hour, st.tm_min);
-            for (int k = 0; k < events[i].alarm_count; k++) {
-                if (events[i].triggered[k]) continue;
-                struct tm at; localtime_r(&events[i].alarm_time[k], &at);
-                long remain = (long)(events[i].alarm_time[k] - now);
-                Serial.printf("      AL%d: %02d/%02d %02d:%02d  off:%dmin  remain:%lds\n",
-                              k, at.tm_mon+1, at.tm_mday, at.tm_hour, at.tm_min,
-                              events[i].offset_min[k], remain);
-            }
-            if (strlen(events[i].midi_file) > 0)
-                Serial.printf("      midi:%s (%s)\n", events[i].midi_file, events[i].midi_is_url ? "URL" : "SD");
-        }
-        if (pending == 0) Serial.println("  (no pending alarms)");
-        Serial.printf("=== events:%d, pending:%d, heap:%d, maxBlock:%d, WiFi:%d, fails:%d ===\n\n",
-                      event_count, pending, ESP.getFreeHeap(), ESP.getMaxAllocHeap(),
-                      WiFi.RSSI(), fetch_fail_count);
-    }
-
-    // アラーム発火チェック
+    int pending = 0;
     for (int i = 0; i < event_count; i++) {
         if (!events[i].has_alarm) continue;
-        int fireSlot = -1;
+        bool anyPending = false;
         for (int k = 0; k < events[i].alarm_count; k++) {
-            if (!events[i].triggered[k] && events[i].alarm_time[k] <= now) {
-                fireSlot = k;
-                break;
-            }
+            if (!events[i].triggered[k]) { anyPending = true; break; }
+        }
+        if (!anyPending) continue;
+        pending++;
+        struct tm st; localtime_r(&events[i].start, &st);
+        Serial.printf("  [%d] %s  event:%02d/%02d %02d:%02d\n",
+                      i, events[i].summary(),
+                      st.tm_mon+1, st.tm_mday, st.tm_hour, st.tm_min);
+        for (int k = 0; k < events[i].alarm_count; k++) {
+            if (events[i].triggered[k]) continue;
+            struct tm at; localtime_r(&events[i].alarm_time[k], &at);
+            long remain = (long)(events[i].alarm_time[k] - now);
+            Serial.printf("      AL%d: %02d/%02d %02d:%02d  off:%dmin  remain:%lds\n",
+                          k, at.tm_mon+1, at.tm_mday, at.tm_hour, at.tm_min,
+                          events[i].offset_min[k], remain);
         }
-        if (fireSlot < 0) continue;
+        if (strlen(events[i].midi_file) > 0)
+            Serial.printf("      midi:%s (%s)\n", events[i].midi_file, events[i].midi_is_url ? "URL" : "SD");
+    }
+    if (pending == 0) Serial.println("  (no pending alarms)");
+    reportEventIndexTiming(now);
+    reportAlarmLatency();
+    reportAlarmTiming();
+    reportMidiPrearm();
+    reportMidiOut();
+    reportNtfy();
+    reportPower();
+    reportTimers();
+    reportPoll();
+    Serial.printf("=== events:%d, pending:%d, heap:%d, maxBlock:%d, WiFi:%d, fails:%d ===\n\n",
+                  event_count, pending, ESP.getFreeHeap(), ESP.getMaxAllocHeap(),
+                  WiFi.RSSI(), fetch_fail_count);
+}
 
-        Serial.printf("\n*** ALARM FIRING! *** (slot %d, off=%dmin)\n",
-                      fireSlot, events[i].offset_min[fireSlot]);
-        Serial.printf("  Event: %s\n", events[i].summary());
+void checkAlarms() {
+    // 別のアラームが鳴動中なら、期限が来たアラームはその鳴動グループに加える
+    //   （サウンドテストは割り込んで止める）
+    if (midi_playing && playing_event >= 0) {
+        ringGroupJoin(time(nullptr));
+        return;
+    }
 
-        // ntfy通知
-        {
-            struct tm st; localtime_r(&events[i].start, &st);
-            char notifyMsg[200];
-            int off = events[i].offset_min[fireSlot];
-            const char* suffix = "";
-            char offBuf[32]; offBuf[0] = '\0';
-            if (off > 0)      snprintf(offBuf, sizeof(offBuf), " (%d分前)", off);
-            else if (off < 0) snprintf(offBuf, sizeof(offBuf), " (%d分後)", -off);
-            (void)suffix;
-            snprintf(notifyMsg, sizeof(notifyMsg), "%02d:%02d %s%s",
-                     st.tm_hour, st.tm_min, events[i].summary(), offBuf);
-            sendNtfyNotification("M5Paper Alarm", notifyMsg);
+    time_t now = time(nullptr);
+
+    // アラーム発火チェック（内部DRAMのホット索引を走査）— どの画面からでも
+    //   同時刻のアラームはまとめて1つの鳴動グループにする（alarm_service.cpp）
+    int due_ev[ALARM_GROUP_MAX];
+    uint8_t due_slot[ALARM_GROUP_MAX];
+    int n = findDueAlarms(now, due_ev, due_slot, ALARM_GROUP_MAX);
+    if (n > 0) {
+        int i = due_ev[0], fireSlot = due_slot[0];
+        if (!beginAlarmFire(events[i].alarm_time[fireSlot])) return;
+
+        Serial.printf("\n*** ALARM FIRING! *** (slot %d, off=%dmin%s)\n",
+                      fireSlot, events[i].offset_min[fireSlot],
+                      n > 1 ? (String(", +") + (n - 1) + " at the same time").c_str() : "");
+        ringGroupBegin(due_ev, due_slot, n);
+
+        // 先読み済みなら RAM 上のイメージで時計を始めるだけ。なければ従来どおり SD から
+        markAlarmFire();
+        if (!startAlarmRing(i, fireSlot, ringGroupBudgetMs()) && !ringGroupAdvance()) {
+            returnFromAlarm(ui_state == UI_PLAYING);    // 止めたサウンドテストの画面だけ戻す
         }
 
-        playing_event = i;
-        playing_alarm_idx = fireSlot;
+        // ntfy通知（キューに積むだけ。同時に積んだ分はワーカーが1リクエストにまとめる）
+        for (int k = 0; k < n; k++) {
+            char notifyMsg[200];
+            formatAlarmNotice(due_ev[k], due_slot[k], notifyMsg, sizeof(notifyMsg));
+            enqueueNtfy("M5Paper Alarm", notifyMsg);
+        }
+    }
+}
 
-        int dur = events[i].play_duration_sec;
-        if (dur < 0) dur = config.play_duration;
-        play_duration_ms = dur * 1000;
+// 1件のアラームを鳴らし始める（checkAlarms・順番モードの次のアラーム）
+//   limit_ms > 0 なら鳴動時間をそこで打ち切る（グループの合計の上限）。
+//   鳴らせなければ発火済みにして false（画面の後始末は呼び出し側）
+bool startAlarmRing(int i, int slot, uint32_t limit_ms) {
+    Serial.printf("  Event: %s\n", events[i].summary());
+
+    int dur = events[i].play_duration_sec;
+    if (dur < 0) dur = config.play_duration;
+    play_duration_ms = dur * 1000;
+    if (limit_ms > 0 && (play_duration_ms == 0 || (uint32_t)play_duration_ms > limit_ms)) {
+        play_duration_ms = limit_ms;
+    }
 
-        int rep = events[i].play_repeat;
-        if (rep < 0) rep = config.play_repeat;
-        if (rep < 1) rep = 1;
-        play_repeat_remaining = rep;
+    int rep = events[i].play_repeat;
+    if (rep < 0) rep = config.play_repeat;
+    if (rep < 1) rep = 1;
+    play_repeat_remaining = rep;
 
-        Serial.printf("  Duration: %s, Repeat: %d\n",
-                      dur == 0 ? "1song" : (String(dur) + "sec").c_str(), play_repeat_remaining);
+    Serial.printf("  Duration: %s, Repeat: %d\n",
+                  play_duration_ms == 0 ? "1song" : (String(play_duration_ms / 1000) + "sec").c_str(),
+                  play_repeat_remaining);
 
-        String midiPath = getMidiPath(i);
+    play_start_ms = millis();
+    bool started = startArmedPlayback(i);
+    if (!started) {
+        String midiPath = getMidiPath(i, !alarmInPreempt());   // 割り込み点（fetch 受信中）では取りに行かない
         waitEPDReady();
-        Serial.printf("  MIDI: %s (exists:%s)\n", midiPath.c_str(), SD.exists(midiPath.c_str()) ? "Y" : "N");
-
+        Serial.printf("  MIDI: %s (exists:%s, not pre-armed)\n", midiPath.c_str(), SD.exists(midiPath.c_str()) ? "Y" : "N");
         play_start_ms = millis();
-        if (startMidiPlayback(midiPath.c_str())) {
-            ui_state = UI_PLAYING;
-            drawPlaying(i);
-        } else {
-            events[i].triggered[fireSlot] = true;
-        }
-        break;
+        started = startMidiPlayback(midiPath.c_str());
     }
+    if (started) {
+        holdPlayingEvent(i, slot);
+        ui_state = UI_PLAYING;
+        drawPlaying(i);
+    } else {
+        setAlarmTriggered(i, slot);
+    }
+    return started;
+}
+
+// ntfy 本文: "HH:MM 予定名 (N分前)"
+void formatAlarmNotice(int i, int slot, char* out, int size) {
+    struct tm st; localtime_r(&events[i].start, &st);
+    int off = events[i].offset_min[slot];
+    char offBuf[32]; offBuf[0] = '\0';
+    if (off > 0)      snprintf(offBuf, sizeof(offBuf), " (%d分前)", off);
+    else if (off < 0) snprintf(offBuf, sizeof(offBuf), " (%d分後)", -off);
+    snprintf(out, size, "%02d:%02d %s%s", st.tm_hour, st.tm_min, events[i].summary(), offBuf);
 }
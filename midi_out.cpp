@@ -0,0 +1,141 @@
+#include "globals.h"
+#include "midi_ring.h"
+
+//==============================================================================
+// MIDI 出力タスク
+//   以前は loopTask の midi.update() が壁時計を見てその場で Serial2 に書いていたため、
+//   鳴動画面の pushCanvas・waitEPDReady・SD チェック・タッチ処理で loop() が止まると
+//   音が伸び、戻ったところで溜まった分（1回100件まで）がまとめて出ていた。
+//
+//   今は loopTask のパーサーが再生位置の MIDI_AHEAD_MS 先までを
+//   midi_ring.h のリングに「曲の先頭からの µs + メッセージ」で積み、このタスク
+//   （優先度 loopTask・監視タスクより上）が時刻どおりに取り出して Serial2 に書く。
+//   loop() が MIDI_AHEAD_MS より長く止まらない限り、出音のタイミングは UI・I/O と無関係。
+//     - 次の時刻まで 1ms 以上あれば通知待ちで眠る（積まれた・止められたら起きる）
+//     - 1ms 未満は delayMicroseconds で合わせる
+//   Serial2 に書くのは再生中このタスクだけ。止めるとき（stopAllNotes）は midiOutReset() で
+//   リングを捨てさせ、タスクが手を離してから loopTask が All Notes Off を送る。
+//   最初のバイト・最初の音の時刻はここで記録し、ログと集計は loopTask 側で行う。
+//==============================================================================
+
+#define MIDI_OUT_STACK          2048
+#define MIDI_OUT_PRIORITY       5       // 監視タスク(3)・loopTask(1) より上
+#define MIDI_OUT_IDLE_MS        1000    // 空のときの待ち（通知で起きる）
+#define MIDI_OUT_LATE_US        5000    // これ以上遅れて出したら late に数える
+
+static MidiRing          ring;                      // 内部 DRAM（static）
+static TaskHandle_t      out_task = nullptr;
+static volatile uint32_t out_start_us = 0;          // 曲の先頭の micros()
+static volatile bool     out_reset_req = false;
+static volatile uint32_t out_first_byte_us = 0;     // 0=まだ 1=loopTask が取り出し済み それ以外=時刻
+static volatile uint32_t out_first_note_us = 0;
+
+// 集計（タスクが書き、ALARM CHECK が読む）
+static volatile uint32_t out_sent = 0;
+static volatile uint32_t out_late = 0;
+static volatile uint32_t out_worst_late_us = 0;
+
+static void midiOutTaskMain(void*) {
+    static uint8_t msg[MIDI_RING_MSG_MAX];
+    for (;;) {
+        if (out_reset_req) {
+            ring.clear();
+            out_reset_req = false;
+            continue;
+        }
+        uint32_t at;
+        uint16_t len;
+        if (!ring.peek(&at, &len)) {
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(MIDI_OUT_IDLE_MS));
+            continue;
+        }
+        int32_t wait = (int32_t)(out_start_us + at - micros());
+        if (wait >= 1000) {
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(wait / 1000));
+            continue;
+        }
+        if (wait > 0) delayMicroseconds(wait);
+
+        len = ring.pop(msg);
+        if (len > 0) Serial2.write(msg, len);
+        uint32_t now = micros();
+        if (out_first_byte_us == 0) out_first_byte_us = now | 1;
+        if (out_first_note_us == 0 && len >= 3 && (msg[0] & 0xF0) == 0x90 && msg[2] > 0) {
+            out_first_note_us = now | 1;
+        }
+        out_sent++;
+        uint32_t late = (uint32_t)(now - (out_start_us + at));
+        if ((int32_t)late > MIDI_OUT_LATE_US) {
+            out_late++;
+            if (late > out_worst_late_us) out_worst_late_us = late;
+        }
+    }
+}
+
+void startMidiOutTask() {
+    if (out_task) return;
+    BaseType_t ok = xTaskCreatePinnedToCore(midiOutTaskMain, "midiout", MIDI_OUT_STACK, nullptr,
+                                            MIDI_OUT_PRIORITY, &out_task, 1);
+    Serial.printf("MIDI output task %s (ring %dB, lookahead %dms)\n",
+                  ok == pdPASS ? "started" : "FAILED", MIDI_RING_BYTES, MIDI_AHEAD_MS);
+}
+
+// 再生開始: 曲の先頭（時刻0）の micros()。リングが空のときに呼ぶ
+void midiOutStart(uint32_t start_us) {
+    out_start_us = start_us;
+    out_first_byte_us = 0;
+    out_first_note_us = 0;
+}
+
+// 1メッセージを積む（at_us は曲の先頭から）。入らなければ false
+bool midiOutPush(uint32_t at_us, const uint8_t* data, uint16_t len) {
+    bool was_empty = ring.empty();
+    if (!ring.push(at_us, data, len)) return false;
+    if (was_empty && out_task) xTaskNotifyGive(out_task);
+    return true;
+}
+
+// 最大のメッセージ（SysEx）がまだ入るか
+bool midiOutRoom() {
+    return ring.room() >= MIDI_RING_RECORD_MAX;
+}
+
+// 積んだ分を出し終えたか
+bool midiOutIdle() {
+    return ring.empty();
+}
+
+// 積んだ分を捨て、タスクが Serial2 から手を離すまで待つ（loopTask から）
+void midiOutReset() {
+    if (!out_task) return;
+    out_reset_req = true;
+    xTaskNotifyGive(out_task);
+    unsigned long t0 = millis();
+    while (out_reset_req && millis() - t0 < 50) delay(1);
+    if (out_reset_req) Serial.println("MIDI OUT: reset not acknowledged");
+}
+
+// 最初のバイト・最初の音を出した時刻（micros()）を取り出す。まだなら false
+bool midiOutTakeFirstByte(uint32_t* us) {
+    uint32_t v = out_first_byte_us;
+    if (v == 0 || v == 1) return false;
+    out_first_byte_us = 1;      // 取り出し済み（この曲ではもう記録しない）
+    *us = v;
+    return true;
+}
+
+bool midiOutTakeFirstNote(uint32_t* us) {
+    uint32_t v = out_first_note_us;
+    if (v == 0 || v == 1) return false;
+    out_first_note_us = 1;
+    *us = v;
+    return true;
+}
+
+// 毎分の ALARM CHECK から
+void reportMidiOut() {
+    if (out_sent == 0) return;
+    Serial.printf("  midi out: %lu msgs, late>%dms %lu (worst %lums), ring peak %lu/%dB\n",
+                  (unsigned long)out_sent, MIDI_OUT_LATE_US / 1000, (unsigned long)out_late,
+                  (unsigned long)(out_worst_late_us / 1000), (unsigned long)ring.peak, MIDI_RING_BYTES);
+}
@@ -1,15 +1,49 @@
 #include "globals.h"
+#include "alarm_sched.h"
 #include <SD.h>
 
+// 発火 → 最初の音の計測（アラーム発火時のみ）
+static uint32_t fire_us = 0;
+static uint32_t clock_start_us = 0;
+static bool     first_note_pending = false;
+static bool     playing_from_ram = false;
+static AlarmLatencyStats first_note_armed = {};
+static AlarmLatencyStats first_note_cold = {};
+
+static void noteFirstNote(uint32_t note_us) {
+    first_note_pending = false;
+    uint32_t ms = (note_us - fire_us) / 1000;
+    (playing_from_ram ? first_note_armed : first_note_cold).add(ms);
+    Serial.printf("ALARM: first note %lums after fire (clock start +%luus, %s)\n",
+                  (unsigned long)ms, (unsigned long)(clock_start_us - fire_us),
+                  playing_from_ram ? "pre-armed" : "cold SD");
+}
+
 //==============================================================================
 // MIDI コールバック (ファイルスコープ)
+//   パーサー（midi.renderNext）が渡すメッセージを、曲の先頭からの時刻付きで
+//   出力リングに積むだけ。Serial2 に書くのは midi_out.cpp の出力タスク
 //==============================================================================
 static void midiSendCallback(uint8_t* data, uint16_t len) {
-    if (len > 0) Serial2.write(data, len);
+    if (len > 0) midiOutPush(midi.eventTimeUs(), data, len);
 }
 
 static void sysexCallback(uint8_t* data, uint32_t len) {
-    if (len > 0) Serial2.write(data, len);
+    if (len > 0) midiOutPush(midi.eventTimeUs(), data, (uint16_t)len);
+}
+
+// 再生位置の MIDI_AHEAD_MS 先までを出力リングに積む（loopTask から毎周）
+//   リングが最大メッセージ分空いている間だけ進める（積めなかった分は次の周で）
+static void fillMidiAhead() {
+    uint32_t until = (micros() - clock_start_us) + MIDI_AHEAD_MS * 1000UL;
+    while (midiOutRoom() && midi.renderNext(until)) {}
+}
+
+// 出力タスクが記録した最初のバイト・最初の音の時刻を、発火タイミングの集計へ
+static void collectOutputTiming() {
+    uint32_t us;
+    if (midiOutTakeFirstByte(&us)) alarmTimingUartByte(us);
+    if (first_note_pending && midiOutTakeFirstNote(&us)) noteFirstNote(us);
 }
 
 static void sendCC(uint8_t ch, uint8_t cc, uint8_t val) {
@@ -22,6 +56,7 @@ static void sendCC(uint8_t ch, uint8_t cc, uint8_t val) {
 //==============================================================================
 void stopAllNotes() {
     Serial.println("MIDI: Stopping all notes...");
+    midiOutReset();     // 積んだ分を捨て、出力タスクが Serial2 から手を離してから送る
     for (int ch = 0; ch < 16; ch++) {
         sendCC(ch, 120, 0);  // All Sound Off
         sendCC(ch, 123, 0);  // All Notes Off
@@ -38,8 +73,10 @@ void stopAllNotes() {
 
 //==============================================================================
 // MIDIファイルパス取得
+//   allow_download = false: URL 指定でも取りに行かない（割り込み点から。fetch の TLS 接続中）。
+//   ダウンロード済みならそれを、なければ config.midi_file を使い、取得は次の preArmMidi に任せる
 //==============================================================================
-String getMidiPath(int eventIdx) {
+String getMidiPath(int eventIdx, bool allow_download) {
     if (eventIdx < 0 || eventIdx >= event_count) {
         return config.midi_file;
     }
@@ -52,6 +89,13 @@ String getMidiPath(int eventIdx) {
 
     if (e.midi_is_url) {
         String localPath;
+        if (!allow_download) {
+            localPath = String(MIDI_DL_DIR) + "/" + e.midi_file;
+            waitEPDReady();
+            if (sd_healthy && SD.exists(localPath.c_str())) return localPath;
+            Serial.printf("MIDI: %s not downloaded - default (no download at preempt point)\n", e.midi_file);
+            return config.midi_file;
+        }
         if (downloadMidi(e.midi_file, localPath)) {
             return localPath;
         }
@@ -87,11 +131,165 @@ bool startMidiPlayback(const char* filename) {
     midi.setSysExCallback(sysexCallback);
     midi.play();
     midi_playing = true;
+    playing_from_ram = false;
+    clock_start_us = micros();
+    midiOutStart(clock_start_us);
+    alarmTimingLoaded();
+    fillMidiAhead();
 
     Serial.printf("MIDI playback started: %s\n", filename);
     return true;
 }
 
+//==============================================================================
+// アラーム前の先読み（pre-arm）
+//   発火時に getMidiPath（URL 指定ならダウンロード）→ SD.exists → open →
+//   トラックヘッダー解析を順に行うと、音が出るまで数秒かかることがある。
+//   次の未発火アラームが MIDI_PREARM_SEC 以内に来たら、パス解決・ダウンロード・
+//   SD からの読み込みを済ませて PSRAM に置き、解析できることも確かめておく。
+//   発火時は RAM 上のイメージにカーソルを張り直して時計を始めるだけ（SD も
+//   EPD 待ちも通らない）。繰り返し再生も同じイメージから。
+//   先読みは1件（次のアラーム）だけ。対象が変わったら差し替える。
+//==============================================================================
+struct ArmedMidi {
+    uint8_t* data;
+    uint32_t len;
+    uint32_t uid_hash;          // 対象イベント（uid_hash + 開始時刻 + MIDI 指定）
+    time_t   start;
+    char     midi[64];
+    char     path[96];
+};
+static ArmedMidi armed = {};
+static SimpleMIDIPlayer probe;  // 先読み時の解析確認用（再生中の midi には触らない）
+
+static void disarmMidi() {
+    if (armed.data) free(armed.data);
+    armed = {};
+}
+
+static bool armedFor(const EventItem& e) {
+    return armed.data && armed.uid_hash == e.uid_hash && armed.start == e.start &&
+           strncmp(armed.midi, e.midi_file, sizeof(armed.midi) - 1) == 0;
+}
+
+// イベントの MIDI の SD 上のパス。URL 指定で未ダウンロードなら、割り込めない通信を
+// 始めてよいときだけ取りに行く（失敗・見送りは既定の MIDI）
+static String resolveArmPath(const EventItem& e) {
+    if (e.midi_file[0] == '\0') return config.midi_file;
+    if (!e.midi_is_url) return String(MIDI_DIR "/") + e.midi_file;
+    String local = String(MIDI_DL_DIR "/") + e.midi_file;
+    waitEPDReady();
+    if (SD.exists(local.c_str())) return local;
+    if (WiFi.status() == WL_CONNECTED && alarmAllowsBlocking(FETCH_URL_BLOCK_MS, "MIDI pre-arm download") &&
+        downloadMidi(e.midi_file, local)) {
+        return local;
+    }
+    return config.midi_file;
+}
+
+static bool armMidi(const EventItem& e) {
+    uint32_t t0 = millis();
+    String path = resolveArmPath(e);
+    waitEPDReady();
+    File f = SD.open(path.c_str(), FILE_READ);
+    if (!f) {
+        Serial.printf("PRE-ARM: %s not found\n", path.c_str());
+        return false;
+    }
+    uint32_t len = f.size();
+    if (len > MIDI_ARM_MAX_BYTES) {
+        Serial.printf("PRE-ARM: %s too large (%lu bytes) - will stream from SD\n", path.c_str(), (unsigned long)len);
+        f.close();
+        return false;
+    }
+    disarmMidi();
+    uint8_t* buf = (uint8_t*)ps_malloc(len);
+    if (!buf) {
+        f.close();
+        Serial.printf("PRE-ARM: ps_malloc(%lu) failed\n", (unsigned long)len);
+        return false;
+    }
+    uint32_t got = f.read(buf, len);
+    f.close();
+    if (got != len || !probe.loadFromMemory(buf, len)) {
+        probe.close();
+        free(buf);
+        Serial.printf("PRE-ARM: %s unreadable (%lu/%lu bytes)\n", path.c_str(), (unsigned long)got, (unsigned long)len);
+        return false;
+    }
+    probe.close();
+    armed.data = buf;
+    armed.len = len;
+    armed.uid_hash = e.uid_hash;
+    armed.start = e.start;
+    strncpy(armed.midi, e.midi_file, sizeof(armed.midi) - 1);
+    strncpy(armed.path, path.c_str(), sizeof(armed.path) - 1);
+    Serial.printf("PRE-ARM: %s (%lu bytes) ready for \"%s\" (%lums)\n",
+                  armed.path, (unsigned long)len, e.summary(), (unsigned long)(millis() - t0));
+    return true;
+}
+
+// メインループから毎周（1秒に1回だけ判定）
+void preArmMidi() {
+    static time_t last_check = 0;
+    static uint32_t failed_uid = 0;
+    static time_t failed_at = 0;
+    time_t now = time(nullptr);
+    if (now == last_check || now < 1700000000) return;
+    last_check = now;
+    if (midi_playing) return;       // 鳴動中・サウンドテスト中は触らない
+
+    int evt = -1;
+    time_t at = nextPendingAlarm(now, &evt);
+    if (evt < 0 || at - now > MIDI_PREARM_SEC) return;
+    const EventItem& e = events[evt];
+    if (armedFor(e)) return;
+    // 失敗したら同じ対象は1分おきにだけ再試行
+    if (failed_uid == e.uid_hash && now - failed_at < 60) return;
+    if (!armMidi(e)) {
+        failed_uid = e.uid_hash;
+        failed_at = now;
+    }
+}
+
+// 発火時: 先読み済みならイメージに張り直して時計を始めるだけ（false なら従来の SD 再生へ）
+bool startArmedPlayback(int evt) {
+    if (evt < 0 || evt >= event_count || !armedFor(events[evt])) return false;
+    if (!midi.loadFromMemory(armed.data, armed.len)) return false;
+    midi.setMidiCallback(midiSendCallback);
+    midi.setSysExCallback(sysexCallback);
+    midi.play();
+    midi_playing = true;
+    playing_from_ram = true;
+    clock_start_us = micros();
+    midiOutStart(clock_start_us);
+    alarmTimingLoaded();
+    fillMidiAhead();    // 先頭の MIDI_AHEAD_MS 分は鳴動画面の描画より先に積む
+    if (first_note_pending) {
+        Serial.printf("MIDI playback started from RAM: %s (+%luus from fire)\n",
+                      armed.path, (unsigned long)(clock_start_us - fire_us));
+    } else {
+        Serial.printf("MIDI playback restarted from RAM: %s\n", armed.path);
+    }
+    return true;
+}
+
+// checkAlarms から: 発火の瞬間（最初の音までの計測開始）
+void markAlarmFire() {
+    fire_us = micros();
+    first_note_pending = true;
+}
+
+void reportMidiPrearm() {
+    if (armed.data) Serial.printf("  midi pre-arm: %s (%luKB)\n", armed.path, (unsigned long)(armed.len / 1024));
+    if (first_note_armed.count + first_note_cold.count == 0) return;
+    Serial.printf("  first note after fire: pre-armed avg %lums worst %lums (n=%lu) | cold avg %lums worst %lums (n=%lu)\n",
+                  (unsigned long)first_note_armed.avg(), (unsigned long)first_note_armed.worst_ms,
+                  (unsigned long)first_note_armed.count,
+                  (unsigned long)first_note_cold.avg(), (unsigned long)first_note_cold.worst_ms,
+                  (unsigned long)first_note_cold.count);
+}
+
 void stopMidiPlayback() {
     Serial.printf("stopMidiPlayback called, midi_playing=%d\n", midi_playing);
     if (midi_playing) {
@@ -103,25 +301,43 @@ void stopMidiPlayback() {
     }
 }
 
+// 鳴動中のイベントを保持: 版をまたぐ参照 + 面のピン
+//   鳴動中に fetch・日付ロールで公開版が変わっても、終了時は uid_hash + 開始時刻で
+//   引き直した index に発火済みを付ける。ピン中の面は書き手が再利用しないため、
+//   鳴動画面が参照している本文も鳴り終わるまで有効
+static EventSnapshot playing_view = { nullptr, 0, 0, 0 };
+
+void holdPlayingEvent(int evt, int slot) {
+    unpinEvents(playing_view);
+    playing_view = pinEvents();
+    playing_event = evt;
+    playing_alarm_idx = slot;
+    playing_ref = makeEventRef(evt);
+}
+
 void finishAlarm() {
     stopMidiPlayback();
+    if (playing_event >= 0) playing_event = resolveEventRef(playing_ref);
+    unpinEvents(playing_view);
     if (playing_event >= 0 && playing_event < event_count) {
         if (playing_alarm_idx >= 0 && playing_alarm_idx < events[playing_event].alarm_count) {
-            events[playing_event].triggered[playing_alarm_idx] = true;
+            setAlarmTriggered(playing_event, playing_alarm_idx);
         } else {
             // フォールバック: スロット不明なら全アラームを既発火扱い
             for (int k = 0; k < events[playing_event].alarm_count; k++) {
-                events[playing_event].triggered[k] = true;
+                setAlarmTriggered(playing_event, k);
             }
         }
     }
     playing_event = -1;
+    first_note_pending = false;     // 音符なしで終わった（無音ファイル・再生失敗）
+    playing_ref.epoch = 0;
     playing_alarm_idx = -1;
     play_repeat_remaining = 0;
     play_duration_ms = 0;
-    ui_state = UI_LIST;
-    scrollToToday();
-    drawList();
+    if (config.alarm_merge) ringGroupAckAll();      // 一緒に鳴らした分も発火済みに
+    if (ringGroupAdvance()) return;                 // 順番モード: 一覧へ戻らずに次のアラーム
+    returnFromAlarm();      // 鳴動前の画面へ（一覧なら今日へスクロール）
 
     // アラーム/MIDI待ちで延期されたリブートを実行
     if (reboot_pending) {
@@ -143,7 +359,11 @@ void updateMidiPlayback() {
         return;
     }
 
-    if (!midi.update()) {
+    fillMidiAhead();
+    collectOutputTiming();
+
+    // 曲の終わり = パーサーが最後まで進み、出力タスクが積んだ分を出し終えた
+    if (midi.isEOF() && midiOutIdle()) {
         play_repeat_remaining--;
         Serial.printf("Play finished, remaining: %d\n", play_repeat_remaining);
 
@@ -153,7 +373,9 @@ void updateMidiPlayback() {
                 return;
             }
             stopMidiPlayback();
-            String midiPath = getMidiPath(playing_event);
+            if (playing_event >= 0) playing_event = resolveEventRef(playing_ref);
+            if (playing_from_ram && startArmedPlayback(playing_event)) return;
+            String midiPath = getMidiPath(playing_event, !alarmInPreempt());
             if (!startMidiPlayback(midiPath.c_str())) {
                 finishAlarm();
             }
@@ -0,0 +1,91 @@
+#ifndef MIDI_RING_H
+#define MIDI_RING_H
+
+//==============================================================================
+// MIDI 出力リング（1書き手・1読み手、ロックなし、プラットフォーム非依存・ヘッダオンリー）
+//   書き手（loopTask のパーサー）が「曲の先頭からの µs + メッセージ」を先に積み、
+//   読み手（MIDI 出力タスク）が時刻どおりに取り出して UART に書く。
+//   レコード: [時刻 u32][長さ u16][バイト列]。バッファの端では折り返して詰める。
+//   head は書き手だけ、tail は読み手だけが進める（どちらも通算バイト数、__atomic で公開）。
+//   clear() は読み手側の操作（書き手が止まっている間に呼ぶこと）。
+//
+//   ホスト側テスト tools/midiring（2スレッド・仮想時計）からも同じコードを使う。
+//==============================================================================
+#include <stdint.h>
+#include <string.h>
+
+#define MIDI_RING_BYTES     8192    // 2の冪
+#define MIDI_RING_HDR       6
+#define MIDI_RING_MSG_MAX   512     // SimpleMIDIPlayer の SysEx 上限
+#define MIDI_RING_RECORD_MAX (MIDI_RING_HDR + MIDI_RING_MSG_MAX)
+
+struct MidiRing {
+    uint8_t  buf[MIDI_RING_BYTES];
+    uint32_t head;      // 書いた通算バイト数（書き手）
+    uint32_t tail;      // 読んだ通算バイト数（読み手）
+    uint32_t peak;      // 使用量の最大（書き手）
+
+    uint32_t used() const {
+        return __atomic_load_n(&head, __ATOMIC_ACQUIRE) - __atomic_load_n(&tail, __ATOMIC_ACQUIRE);
+    }
+    uint32_t room() const { return MIDI_RING_BYTES - used(); }
+    bool     empty() const { return used() == 0; }
+
+    // 書き手: 1レコード積む。入らなければ false（何も書かない）
+    bool push(uint32_t at_us, const uint8_t* data, uint16_t len) {
+        if (len > MIDI_RING_MSG_MAX) return false;
+        uint32_t h = head;
+        uint32_t t = __atomic_load_n(&tail, __ATOMIC_ACQUIRE);
+        uint32_t need = MIDI_RING_HDR + len;
+        if (MIDI_RING_BYTES - (h - t) < need) return false;
+        uint8_t hdr[MIDI_RING_HDR] = { (uint8_t)at_us, (uint8_t)(at_us >> 8), (uint8_t)(at_us >> 16),
+                                       (uint8_t)(at_us >> 24), (uint8_t)len, (uint8_t)(len >> 8) };
+        copyIn(h, hdr, MIDI_RING_HDR);
+        copyIn(h + MIDI_RING_HDR, data, len);
+        __atomic_store_n(&head, h + need, __ATOMIC_RELEASE);
+        if (h + need - t > peak) peak = h + need - t;
+        return true;
+    }
+
+    // 読み手: 先頭レコードの時刻と長さ（空なら false）
+    bool peek(uint32_t* at_us, uint16_t* len) const {
+        uint32_t t = tail;
+        if (__atomic_load_n(&head, __ATOMIC_ACQUIRE) == t) return false;
+        uint8_t hdr[MIDI_RING_HDR];
+        copyOut(t, hdr, MIDI_RING_HDR);
+        *at_us = (uint32_t)hdr[0] | ((uint32_t)hdr[1] << 8) | ((uint32_t)hdr[2] << 16) | ((uint32_t)hdr[3] << 24);
+        *len = (uint16_t)(hdr[4] | (hdr[5] << 8));
+        return true;
+    }
+
+    // 読み手: 先頭レコードを dst に取り出して捨てる（peek で長さを確かめてから）
+    uint16_t pop(uint8_t* dst) {
+        uint32_t at;
+        uint16_t len;
+        if (!peek(&at, &len)) return 0;
+        copyOut(tail + MIDI_RING_HDR, dst, len);
+        __atomic_store_n(&tail, tail + MIDI_RING_HDR + len, __ATOMIC_RELEASE);
+        return len;
+    }
+
+    // 読み手: 残りを全部捨てる
+    void clear() {
+        __atomic_store_n(&tail, __atomic_load_n(&head, __ATOMIC_ACQUIRE), __ATOMIC_RELEASE);
+    }
+
+private:
+    void copyIn(uint32_t pos, const uint8_t* src, uint32_t n) {
+        uint32_t off = pos & (MIDI_RING_BYTES - 1);
+        uint32_t first = n < MIDI_RING_BYTES - off ? n : MIDI_RING_BYTES - off;
+        memcpy(buf + off, src, first);
+        if (n > first) memcpy(buf, src + first, n - first);
+    }
+    void copyOut(uint32_t pos, uint8_t* dst, uint32_t n) const {
+        uint32_t off = pos & (MIDI_RING_BYTES - 1);
+        uint32_t first = n < MIDI_RING_BYTES - off ? n : MIDI_RING_BYTES - off;
+        memcpy(dst, buf + off, first);
+        if (n > first) memcpy(dst + first, buf, n - first);
+    }
+};
+
+#endif // MIDI_RING_H
@@ -1,9 +1,12 @@
 #include "globals.h"
+#include "ntfy_queue.h"
 #include <WiFiClientSecure.h>
 #include <WiFi.h>
 #include <SD.h>
 #include <esp_task_wdt.h>
 #include <esp_wifi.h>
+#include <time.h>
+#include <sys/time.h>
 
 // ★ HTTPClient完全排除 — 全HTTP通信をWiFiClient/WiFiClientSecure直接操作
 //    HTTPClient内部のString操作がSSLバッファと交互にDRAM mallocされ
@@ -40,6 +43,12 @@ bool connectWiFi() {
         if (WiFi.status() == WL_CONNECTED) {
             Serial.printf("WiFi connected: %s (heap: %d)\n",
                           WiFi.localIP().toString().c_str(), ESP.getFreeHeap());
+            // ★ SNTP はネットワーク初期化後に開始（高速起動時は setup ではなく loop からの初回接続で）
+            static bool ntp_started = false;
+            if (!ntp_started) {
+                configTzTime(TZ_JST, "pool.ntp.org", "time.google.com", "ntp.nict.jp");
+                ntp_started = true;
+            }
             return true;
         }
         Serial.printf("WiFi attempt %d failed (status: %d)\n", attempt, WiFi.status());
@@ -48,6 +57,55 @@ bool connectWiFi() {
     return false;
 }
 
+//==============================================================================
+// 内蔵RTC (BM8563) ⇔ システム時刻
+//   RTC はローカル時刻(JST)で保持。電源投入直後、NTP 同期前の時刻源として使う
+//==============================================================================
+bool restoreTimeFromRTC() {
+    setenv("TZ", TZ_JST, 1);
+    tzset();
+    rtc_date_t d;
+    rtc_time_t t;
+    M5.RTC.getDate(&d);
+    M5.RTC.getTime(&t);
+    struct tm tm = {};
+    tm.tm_year = d.year - 1900;
+    tm.tm_mon = d.mon - 1;
+    tm.tm_mday = d.day;
+    tm.tm_hour = t.hour;
+    tm.tm_min = t.min;
+    tm.tm_sec = t.sec;
+    tm.tm_isdst = -1;
+    time_t v = mktime(&tm);
+    if (d.year < 2024 || v < 1700000000) {
+        Serial.printf("RTC: invalid (%04d-%02d-%02d) - wait for NTP\n", d.year, d.mon, d.day);
+        return false;
+    }
+    struct timeval tv = { v, 0 };
+    settimeofday(&tv, nullptr);
+    Serial.printf("RTC: %04d-%02d-%02d %02d:%02d:%02d -> system time\n",
+                  d.year, d.mon, d.day, t.hour, t.min, t.sec);
+    return true;
+}
+
+void saveTimeToRTC() {
+    time_t now = time(nullptr);
+    if (now < 1700000000) return;
+    struct tm lt;
+    localtime_r(&now, &lt);
+    rtc_date_t d;
+    rtc_time_t t;
+    d.year = lt.tm_year + 1900;
+    d.mon = lt.tm_mon + 1;
+    d.day = lt.tm_mday;
+    d.week = lt.tm_wday;
+    t.hour = lt.tm_hour;
+    t.min = lt.tm_min;
+    t.sec = lt.tm_sec;
+    M5.RTC.setDate(&d);
+    M5.RTC.setTime(&t);
+}
+
 // HTTPレスポンスのヘッダーを1行読む (スタック上、malloc ゼロ)
 static int readHttpLine(WiFiClient* c, char* buf, int maxLen, unsigned long timeoutMs = 10000) {
     int i = 0;
@@ -64,61 +122,173 @@ static int readHttpLine(WiFiClient* c, char* buf, int maxLen, unsigned long time
     return i;
 }
 
-void sendNtfyNotification(const String& title, const String& message) {
-    if (strlen(config.ntfy_topic) == 0) {
-        Serial.println("NTFY: topic not configured, skipping");
-        return;
+//==============================================================================
+// ntfy 通知（非同期キュー — ntfy_queue.h）
+//   発火側は enqueueNtfy() で積むだけで、鳴動開始を待たせない。送信はワーカータスク
+//   （コア0、loopTask と同じ優先度）が行う: 近接した通知をまとめ、失敗は指数
+//   バックオフで再送、TLS 接続は keep-alive で使い回す（NTFY_IDLE_CLOSE_MS で閉じる）。
+//   ワーカーはネットワークだけを触り、SD・EPD には触れない
+//==============================================================================
+static NtfyQueue         ntfy_q;
+static NtfyBackoff       ntfy_backoff;
+static SemaphoreHandle_t ntfy_lock = nullptr;
+static TaskHandle_t      ntfy_task = nullptr;
+static volatile int      ntfy_last_code = 0;    // 直近の送信結果（HTTP ステータス, -1=通信失敗）
+static volatile bool     ntfy_busy = false;
+static uint32_t ntfy_requests = 0, ntfy_delivered = 0, ntfy_failures = 0, ntfy_connects = 0;
+
+// ntfyExchange 用の接続アダプタ
+struct NtfyConn {
+    WiFiClientSecure* c;
+    int write(const uint8_t* p, int n) { return (int)c->write(p, n); }
+    int readLine(char* buf, int size) { return readHttpLine(c, buf, size); }
+    bool skip(int n) {
+        unsigned long t0 = millis();
+        while (n > 0 && millis() - t0 < 10000) {
+            if (c->available()) { if (c->read() >= 0) n--; }
+            else if (!c->connected()) return false;
+            else delay(1);
+        }
+        return n == 0;
     }
-    if (WiFi.status() != WL_CONNECTED) {
-        Serial.println("NTFY: WiFi not connected, skipping");
-        return;
+};
+
+// 1リクエスト送信。使い回した接続がサーバー側で閉じていたら、新しい接続で1回だけやり直す
+static int ntfyPost(WiFiClientSecure& client, const char* title, const char* body) {
+    for (int attempt = 0; attempt < 2; attempt++) {
+        bool reused = client.connected();
+        if (!reused) {
+            client.setInsecure();
+            client.setTimeout(10);
+            if (!client.connect(NTFY_HOST, 443)) {
+                Serial.println("NTFY: SSL connect failed");
+                return -1;
+            }
+            ntfy_connects++;
+        }
+        NtfyConn conn = { &client };
+        bool keep = false;
+        int code = ntfyExchange(conn, NTFY_HOST, config.ntfy_topic, title, body, keep);
+        if (code < 0 && reused) { client.stop(); continue; }
+        if (!keep) client.stop();
+        return code;
     }
+    return -1;
+}
 
-    Serial.printf("NTFY: Sending to ntfy.sh/%s (heap:%d)\n",
-                  config.ntfy_topic, ESP.getFreeHeap());
+static void ntfyWorkerMain(void*) {
+    static WiFiClientSecure client;
+    static char title[NTFY_TITLE_MAX + 8];
+    static char body[NTFY_BATCH_BODY_MAX];
+    uint32_t last_used = 0;
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(250));
+        uint32_t now = millis();
+        if (last_used != 0 && now - last_used > NTFY_IDLE_CLOSE_MS) {
+            if (client.connected()) Serial.println("NTFY: idle connection closed");
+            client.stop();
+            last_used = 0;
+        }
 
-    WiFiClientSecure client;
-    client.setInsecure();
-    client.setTimeout(10);
+        int n = 0;
+        xSemaphoreTake(ntfy_lock, portMAX_DELAY);
+        if (ntfy_q.batchReady(now) && ntfy_backoff.ready(now)) {
+            n = ntfy_q.takeBatch(title, sizeof(title), body, sizeof(body));
+        }
+        xSemaphoreGive(ntfy_lock);
+        if (n == 0) continue;
+
+        ntfy_busy = true;
+        int code = -1;
+        if (WiFi.status() == WL_CONNECTED && strlen(config.ntfy_topic) > 0) {
+            uint32_t t0 = millis();
+            bool warm = client.connected();
+            ntfy_requests++;
+            code = ntfyPost(client, title, body);
+            last_used = millis();
+            Serial.printf("NTFY: HTTP %d, %d notification(s) in 1 request (%s connection, %lums, heap:%d)\n",
+                          code, n, warm ? "warm" : "new", (unsigned long)(millis() - t0), ESP.getFreeHeap());
+        } else {
+            Serial.println("NTFY: WiFi not connected - will retry");
+        }
 
-    if (!client.connect("ntfy.sh", 443)) {
-        Serial.println("NTFY: SSL connect failed");
-        return;
+        xSemaphoreTake(ntfy_lock, portMAX_DELAY);
+        if (code >= 200 && code < 300) {
+            ntfy_q.pop(n);
+            ntfy_backoff.ok();
+            ntfy_delivered += n;
+        } else {
+            ntfy_failures++;
+            if (ntfy_backoff.fail(millis())) {
+                ntfy_q.pop(n);
+                ntfy_q.dropped += n;
+                Serial.printf("NTFY: giving up on %d notification(s) after %d attempts\n", n, NTFY_MAX_ATTEMPTS);
+            } else {
+                ntfy_q.release();
+                Serial.printf("NTFY: attempt %d failed - retry in %lums\n", ntfy_backoff.attempts,
+                              (unsigned long)(ntfy_backoff.next_ms - millis()));
+            }
+        }
+        xSemaphoreGive(ntfy_lock);
+        ntfy_last_code = code;
+        ntfy_busy = false;
     }
+}
 
-    // POSTリクエスト構築 (スタック上)
-    char request[1024];
-    int bodyLen = message.length();
-    int reqLen = snprintf(request, sizeof(request),
-        "POST /%s HTTP/1.1\r\n"
-        "Host: ntfy.sh\r\n"
-        "Title: %s\r\n"
-        "Priority: high\r\n"
-        "Tags: alarm_clock\r\n"
-        "Content-Length: %d\r\n"
-        "Connection: close\r\n"
-        "\r\n",
-        config.ntfy_topic, title.c_str(), bodyLen);
+void startNtfyWorker() {
+    if (ntfy_task) return;
+    ntfy_q.init();
+    ntfy_backoff.init();
+    ntfy_lock = xSemaphoreCreateMutex();
+    BaseType_t ok = xTaskCreatePinnedToCore(ntfyWorkerMain, "ntfy", 8192, nullptr, 1, &ntfy_task, 0);
+    Serial.printf("NTFY worker %s (queue %d, coalesce %dms)\n",
+                  ok == pdPASS ? "started" : "FAILED", NTFY_QUEUE_LEN, NTFY_COALESCE_MS);
+}
 
-    client.write((uint8_t*)request, reqLen);
-    client.write((uint8_t*)message.c_str(), bodyLen);
+// 通知を積む（ネットワークを待たない）
+void enqueueNtfy(const char* title, const char* message) {
+    if (strlen(config.ntfy_topic) == 0) {
+        Serial.println("NTFY: topic not configured, skipping");
+        return;
+    }
+    if (!ntfy_lock) return;
+    xSemaphoreTake(ntfy_lock, portMAX_DELAY);
+    bool queued = ntfy_q.push(title, message, millis());
+    int waiting = ntfy_q.count;
+    xSemaphoreGive(ntfy_lock);
+    xTaskNotifyGive(ntfy_task);
+    if (queued) Serial.printf("NTFY: queued \"%s\" (%d waiting)\n", title, waiting);
+    else        Serial.printf("NTFY: queue full of in-flight notifications - dropped \"%s\"\n", title);
+}
 
-    // レスポンス確認
-    char statusLine[128];
-    int sl = readHttpLine(&client, statusLine, sizeof(statusLine));
-    int httpCode = 0;
-    if (sl > 0) {
-        const char* sp = strchr(statusLine, ' ');
-        if (sp) httpCode = atoi(sp + 1);
+// キューが空になるまで待つ（設定画面の通知テスト用、割り込み点つき）。直近の HTTP ステータスを返す
+int ntfyFlush(uint32_t timeout_ms) {
+    unsigned long t0 = millis();
+    while (millis() - t0 < timeout_ms && ui_state != UI_PLAYING) {
+        xSemaphoreTake(ntfy_lock, portMAX_DELAY);
+        bool empty = ntfy_q.count == 0;
+        xSemaphoreGive(ntfy_lock);
+        if (empty && !ntfy_busy) return ntfy_last_code;
+        alarmPreemptPoint();
+        delay(20);
     }
+    return -1;
+}
 
-    client.stop();
+// 送信待ちも送信中もない（省電力スリープで WiFi を切ってよいか）
+bool ntfyIdle() {
+    if (!ntfy_lock) return true;
+    xSemaphoreTake(ntfy_lock, portMAX_DELAY);
+    bool empty = ntfy_q.count == 0;
+    xSemaphoreGive(ntfy_lock);
+    return empty && !ntfy_busy;
+}
 
-    if (httpCode >= 200 && httpCode < 300) {
-        Serial.printf("NTFY: HTTP %d (heap:%d)\n", httpCode, ESP.getFreeHeap());
-    } else {
-        Serial.printf("NTFY: HTTP error %d (heap:%d)\n", httpCode, ESP.getFreeHeap());
-    }
+void reportNtfy() {
+    if (ntfy_requests == 0 && ntfy_q.count == 0) return;
+    Serial.printf("  ntfy: %lu delivered in %lu requests (%lu connects), %lu failed, %lu dropped, %d waiting\n",
+                  (unsigned long)ntfy_delivered, (unsigned long)ntfy_requests, (unsigned long)ntfy_connects,
+                  (unsigned long)ntfy_failures, (unsigned long)ntfy_q.dropped, ntfy_q.count);
 }
 
 bool downloadMidi(const String& filename, String& localPath) {
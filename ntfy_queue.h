@@ -0,0 +1,177 @@
+#ifndef NTFY_QUEUE_H
+#define NTFY_QUEUE_H
+
+//==============================================================================
+// ntfy 通知キュー（プラットフォーム非依存・ヘッダオンリー）
+//   アラーム発火側は NtfyQueue::push() で積むだけ（ネットワークを待たない）。
+//   送信はワーカー（端末では FreeRTOS タスク）が行う:
+//     - 先頭が NTFY_COALESCE_MS 経過するまで待ち、同じタイトルで続く通知を
+//       1件のリクエストにまとめる（本文は改行区切り、タイトルに件数）
+//     - 失敗したら捨てずに残し、指数バックオフで再送。NTFY_MAX_ATTEMPTS 回で諦める
+//     - HTTP/1.1 keep-alive で接続を使い回す（ntfyExchange は応答本文まで読み切る）
+//   キューが満杯なら送信中でない最古を捨てる（全件送信中なら新しい方を捨てる）。
+//   ロックは呼び出し側で取る。
+//
+//   ホスト側テスト tools/ntfyq（ローカルの HTTP スタンドインに送信）からも同じコードを使う。
+//==============================================================================
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <strings.h>
+
+#define NTFY_QUEUE_LEN          8
+#define NTFY_TITLE_MAX          48
+#define NTFY_BODY_MAX           200
+#define NTFY_BATCH_BODY_MAX     1024    // まとめた本文の上限
+#define NTFY_COALESCE_MS        1500    // 先頭を積んでから送るまでの待ち（近接アラームをまとめる）
+#define NTFY_BACKOFF_BASE_MS    2000
+#define NTFY_BACKOFF_MAX_MS     120000
+#define NTFY_MAX_ATTEMPTS       6
+#define NTFY_IDLE_CLOSE_MS      60000   // 使わない接続を閉じるまで
+
+struct NtfyItem {
+    char     title[NTFY_TITLE_MAX];
+    char     body[NTFY_BODY_MAX];
+    uint32_t queued_ms;
+};
+
+struct NtfyQueue {
+    NtfyItem items[NTFY_QUEUE_LEN];
+    int      head;
+    int      count;
+    int      inflight;      // 先頭からこの件数は送信中（takeBatch で付け、pop / release で外す）
+    uint32_t dropped;       // 満杯で捨てた件数 + 再送を諦めた件数
+    uint32_t coalesce_ms;
+
+    void init() {
+        head = count = inflight = 0;
+        dropped = 0;
+        coalesce_ms = NTFY_COALESCE_MS;
+    }
+
+    NtfyItem& at(int i) { return items[(head + i) % NTFY_QUEUE_LEN]; }
+
+    // 満杯なら送信中でない最古を詰めて捨てる。全件送信中なら積まずに false
+    //   （送信中の分を捨てると、送り終えた後の pop(n) が未送信の分を消してしまう）
+    bool push(const char* title, const char* body, uint32_t now_ms) {
+        if (count == NTFY_QUEUE_LEN) {
+            dropped++;
+            if (inflight >= count) return false;
+            for (int i = inflight; i < count - 1; i++) at(i) = at(i + 1);
+            count--;
+        }
+        NtfyItem& it = items[(head + count) % NTFY_QUEUE_LEN];
+        snprintf(it.title, sizeof(it.title), "%s", title);
+        snprintf(it.body, sizeof(it.body), "%s", body);
+        it.queued_ms = now_ms;
+        count++;
+        return true;
+    }
+
+    // 送ってよいか（先頭がまとめ待ちを過ぎた / 満杯）
+    bool batchReady(uint32_t now_ms) {
+        if (count == 0) return false;
+        return count == NTFY_QUEUE_LEN || now_ms - at(0).queued_ms >= coalesce_ms;
+    }
+
+    // 先頭から同じタイトルが続く分を1件にまとめ、送信中の印を付ける。まとめた件数を返す
+    //   （pop はしない。送れたら pop(n)、再送するなら release()）
+    int takeBatch(char* title, int title_size, char* body, int body_size) {
+        if (count == 0) return 0;
+        int n = 0, len = 0;
+        body[0] = '\0';
+        while (n < count && strcmp(at(n).title, at(0).title) == 0) {
+            int add = (int)strlen(at(n).body) + (n > 0 ? 1 : 0);
+            if (n > 0 && len + add >= body_size) break;
+            len += snprintf(body + len, body_size - len, "%s%s", n > 0 ? "\n" : "", at(n).body);
+            if (len >= body_size) len = body_size - 1;
+            n++;
+        }
+        if (n > 1) snprintf(title, title_size, "%s (%d)", at(0).title, n);    // ヘッダーは ASCII のまま
+        else       snprintf(title, title_size, "%s", at(0).title);
+        inflight = n;
+        return n;
+    }
+
+    void pop(int n) {
+        if (n > count) n = count;
+        head = (head + n) % NTFY_QUEUE_LEN;
+        count -= n;
+        inflight = inflight > n ? inflight - n : 0;
+    }
+
+    // 送れなかったバッチを再送待ちに戻す（次の takeBatch でまとめ直す）
+    void release() { inflight = 0; }
+};
+
+struct NtfyBackoff {
+    uint8_t  attempts;
+    uint32_t next_ms;
+    uint32_t base_ms;
+
+    void init() { attempts = 0; next_ms = 0; base_ms = NTFY_BACKOFF_BASE_MS; }
+    bool ready(uint32_t now_ms) const { return attempts == 0 || (int32_t)(now_ms - next_ms) >= 0; }
+    void ok() { attempts = 0; }
+    // 失敗を記録。諦める回数に達したら true（呼び出し側でバッチを捨てる）
+    bool fail(uint32_t now_ms) {
+        attempts++;
+        uint32_t wait = base_ms << (attempts - 1 < 16 ? attempts - 1 : 16);
+        if (wait > NTFY_BACKOFF_MAX_MS) wait = NTFY_BACKOFF_MAX_MS;
+        next_ms = now_ms + wait;
+        if (attempts < NTFY_MAX_ATTEMPTS) return false;
+        attempts = 0;
+        return true;
+    }
+};
+
+// POST リクエスト（ヘッダーのみ。本文は続けて送る）
+inline int ntfyBuildRequest(char* out, int size, const char* host, const char* topic,
+                            const char* title, int body_len) {
+    return snprintf(out, size,
+        "POST /%s HTTP/1.1\r\n"
+        "Host: %s\r\n"
+        "Title: %s\r\n"
+        "Priority: high\r\n"
+        "Tags: alarm_clock\r\n"
+        "Content-Length: %d\r\n"
+        "Connection: keep-alive\r\n"
+        "\r\n",
+        topic, host, title, body_len);
+}
+
+// 1往復: リクエスト送信 → ステータス行 → ヘッダー → 本文（Content-Length 分）を読み切る
+//   Conn: write(const uint8_t*, int) -> int / readLine(char*, int) -> int（-1=切断）/ skip(int) -> bool
+//   戻り値: HTTP ステータス（通信失敗は -1）。keep_alive に接続を使い回せるかを返す
+template <class Conn>
+int ntfyExchange(Conn& c, const char* host, const char* topic, const char* title,
+                 const char* body, bool& keep_alive) {
+    char req[512];
+    int body_len = (int)strlen(body);
+    int req_len = ntfyBuildRequest(req, sizeof(req), host, topic, title, body_len);
+    keep_alive = false;
+    if (req_len <= 0 || req_len >= (int)sizeof(req)) return -1;
+    if (c.write((const uint8_t*)req, req_len) != req_len) return -1;
+    if (c.write((const uint8_t*)body, body_len) != body_len) return -1;
+
+    char line[128];
+    if (c.readLine(line, sizeof(line)) <= 0) return -1;
+    const char* sp = strchr(line, ' ');
+    int code = sp ? atoi(sp + 1) : 0;
+    if (code <= 0) return -1;
+    bool http11 = strncmp(line, "HTTP/1.1", 8) == 0;
+    int content_len = -1;
+    bool close_hdr = false;
+    for (;;) {
+        int n = c.readLine(line, sizeof(line));
+        if (n < 0) return -1;
+        if (n == 0) break;
+        if (strncasecmp(line, "Content-Length:", 15) == 0) content_len = atoi(line + 15);
+        else if (strncasecmp(line, "Connection:", 11) == 0 && strstr(line + 11, "close")) close_hdr = true;
+    }
+    if (content_len > 0 && !c.skip(content_len)) return -1;
+    keep_alive = http11 && !close_hdr && content_len >= 0;
+    return code;
+}
+
+#endif // NTFY_QUEUE_H
@@ -0,0 +1,134 @@
+#ifndef POLL_POLICY_H
+#define POLL_POLICY_H
+
+//==============================================================================
+// ICS 取得間隔の適応制御（プラットフォーム非依存・ヘッダオンリー）
+//   ソース(URL)ごとに、取得のたびに次の取得までの間隔を決める。起点は設定の間隔
+//   （ics_poll_each / ics_poll_min）で、そこから:
+//     quiet  … 内容が変わらない取得が POLL_QUIET_STEP 回続くごとに倍（最大4倍・2時間まで）
+//     alarm  … そのソースに POLL_NEAR_ALARM_SEC 以内の未発火アラームがあれば 5分まで詰める
+//     guard  … 次のアラームの POLL_ALARM_GUARD_SEC 前に1回取る（直前の編集を鳴る前に拾う）
+//     budget … 1日の取得回数・バイト数の上限を、残り時間で均等に割った間隔より詰めない
+//              （guard の1回だけは均等割りより優先。上限そのものは越えない）
+//     exhausted … 上限に達したら翌日（ローカル時刻の0時）まで取らない
+//   失敗時の間隔は変えない（連続失敗のバックオフは従来どおり fetch_fail_count 側）。
+//
+//   ホスト側シミュレーション tools/pollsim からも同じコードを使う。
+//==============================================================================
+#include <stdint.h>
+
+#define POLL_MIN_SEC            120     // どんなに詰めてもこれだけは空ける
+#define POLL_MAX_SEC            7200    // quiet で伸ばすときの上限
+#define POLL_QUIET_STEP         3       // 変化なしがこの回数続くごとに倍
+#define POLL_QUIET_MAX_SHIFT    2       // 最大 2^2 = 4倍
+#define POLL_NEAR_ALARM_SEC     3600    // アラームのこれだけ前から詰める
+#define POLL_NEAR_INTERVAL_SEC  300     // 詰めたときの間隔
+#define POLL_ALARM_GUARD_SEC    120     // 直前の取得（アラームのこれだけ前）
+#define POLL_TLS_OVERHEAD_BYTES 6000    // 1回の取得で本文以外にかかる概算（TLS ハンドシェイク等）
+
+enum PollReason { POLL_BASE, POLL_QUIET, POLL_ALARM, POLL_GUARD, POLL_BUDGET, POLL_EXHAUSTED, POLL_REASON_COUNT };
+
+static const char* const poll_reason_names[POLL_REASON_COUNT] = {
+    "base", "quiet", "alarm", "guard", "budget", "exhausted"
+};
+
+// 1日の予算（全ソース共通。0 = 無制限）
+struct PollBudget {
+    uint32_t max_fetches;
+    uint32_t max_bytes;
+    uint32_t fetches;
+    uint64_t bytes;
+    uint16_t day;
+
+    // 日付が変わったら使用量を戻す
+    void roll(uint16_t today) {
+        if (today != day) { day = today; fetches = 0; bytes = 0; }
+    }
+    void spend(uint32_t b) { fetches++; bytes += b; }
+    bool exhausted() const {
+        return (max_fetches && fetches >= max_fetches) || (max_bytes && bytes >= max_bytes);
+    }
+};
+
+struct PollInputs {
+    int32_t  base_sec;          // 設定の間隔
+    uint8_t  unchanged;         // 変化なしの連続回数
+    int64_t  alarm_in_sec;      // このソースの次の未発火アラームまで（< 0 = なし）
+    uint32_t avg_bytes;         // このソースの1回あたりの推定バイト数（0 = 未計測）
+    int32_t  sec_to_midnight;   // 予算の区切り（ローカル時刻の0時）まで
+    int      sources;           // 予算を分け合うソース数
+    bool     adaptive;          // false = 設定の間隔のまま（予算だけ守る）
+};
+
+struct PollDecision {
+    int32_t    sec;
+    PollReason reason;
+};
+
+inline PollDecision pollNext(const PollInputs& in, const PollBudget& b) {
+    PollDecision d = { in.base_sec, POLL_BASE };
+    if (b.exhausted()) {
+        d.sec = in.sec_to_midnight + 60;
+        d.reason = POLL_EXHAUSTED;
+        return d;
+    }
+    int64_t guard = -1;         // アラーム直前の1回まで（なければ -1）
+    if (in.adaptive) {
+        int shift = in.unchanged / POLL_QUIET_STEP;
+        if (shift > POLL_QUIET_MAX_SHIFT) shift = POLL_QUIET_MAX_SHIFT;
+        if (shift > 0) {
+            int32_t quiet = in.base_sec << shift;
+            if (quiet > POLL_MAX_SEC) quiet = POLL_MAX_SEC;
+            if (quiet > d.sec) { d.sec = quiet; d.reason = POLL_QUIET; }
+        }
+        if (in.alarm_in_sec >= 0) {
+            if (in.alarm_in_sec <= POLL_NEAR_ALARM_SEC && d.sec > POLL_NEAR_INTERVAL_SEC) {
+                d.sec = POLL_NEAR_INTERVAL_SEC;
+                d.reason = POLL_ALARM;
+            }
+            if (in.alarm_in_sec - POLL_ALARM_GUARD_SEC >= POLL_MIN_SEC) guard = in.alarm_in_sec - POLL_ALARM_GUARD_SEC;
+            if (guard >= 0 && guard < d.sec) {
+                d.sec = (int32_t)guard;
+                d.reason = POLL_GUARD;
+            }
+        }
+        if (d.sec < POLL_MIN_SEC) d.sec = POLL_MIN_SEC;
+    }
+
+    // 残りの予算を残り時間に均等に配る（全ソースで分け合う）。均等割りで間が空くときも
+    //   アラーム直前の1回は取る（その分は残りの配分が減って後の間隔が伸びる）
+    int64_t pace = 0;
+    int sources = in.sources > 0 ? in.sources : 1;
+    if (b.max_fetches) {
+        pace = (int64_t)in.sec_to_midnight * sources / (b.max_fetches - b.fetches);
+    }
+    if (b.max_bytes && in.avg_bytes) {
+        int64_t p = (int64_t)in.sec_to_midnight * sources * in.avg_bytes / (int64_t)(b.max_bytes - b.bytes);
+        if (p > pace) pace = p;
+    }
+    if (pace > d.sec) {
+        if (pace > in.sec_to_midnight + 60) pace = in.sec_to_midnight + 60;
+        if (guard >= 0 && guard < pace) {
+            d.sec = (int32_t)guard;
+            d.reason = POLL_GUARD;
+        } else {
+            d.sec = (int32_t)pace;
+            d.reason = POLL_BUDGET;
+        }
+    }
+    return d;
+}
+
+// 1回の取得のバイト数の移動平均（1/4 ずつ寄せる）
+inline uint32_t pollAvgBytes(uint32_t avg, uint32_t sample) {
+    return avg ? (uint32_t)(((uint64_t)avg * 3 + sample) / 4) : sample;
+}
+
+// 取得内容の署名（イベントの順序によらない）。開始時刻・UID・内容ハッシュから
+inline uint32_t pollSignatureAdd(uint32_t sig, uint32_t uid_hash, int64_t start, uint32_t text_hash) {
+    uint32_t h = uid_hash ^ (text_hash * 0x9E3779B1u) ^ (uint32_t)start ^ (uint32_t)(start >> 32) * 0x85EBCA77u;
+    h ^= h >> 15; h *= 0x2C1B3C6Du; h ^= h >> 12;
+    return sig + h;
+}
+
+#endif // POLL_POLICY_H
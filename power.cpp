@@ -0,0 +1,185 @@
+#include "globals.h"
+#include "sleep_sched.h"
+#include <esp_sleep.h>
+#include <driver/gpio.h>
+#include <sys/time.h>
+
+//==============================================================================
+// 省電力スリープ（締め切り駆動）
+//   loop() の最後で次の締め切り（アラーム・MIDI 先読み・分の切り替わり・自動復帰と、
+//   timers.cpp のホイールで最早の定期処理）を集め、sleep_sched.h の sleepDecide で
+//   眠り方を決める。従来の delay(1) で回し続けるのをやめ、何もない間は眠る。
+//     SLEEP_IDLE  … delay() で CPU を明け渡す（タッチは M5EPD の割り込みが拾う）
+//     SLEEP_LIGHT … 一覧画面のみ。タイマー + スイッチ（LOW）/ タッチ INT（LOW）で起床
+//   ライトスリープ中は WiFi を保てないので、次に WiFi が要るまで十分空くときだけ
+//   電波を切って眠る。要る時刻の WIFI_WAKE_LEAD_MS 前に powerService() が繋ぎ直す。
+//   WiFi 接続中はモデムスリープ（WiFi.setSleep(true)）、fetch の間だけ外す。
+//
+//   タッチで起きた場合、起こした1回目のタッチは拾えないことがある（GT911 の INT を
+//   起床に使い、起床後に立ち下がり割り込みへ戻すため）。スイッチは起床後も押したまま
+//   なので取りこぼさない。
+//==============================================================================
+
+#define TP_INT_PIN      36      // GT911 INT（M5EPD がタッチ割り込みに使う）
+
+static SleepStats stats;
+static bool wifi_off_by_power = false;          // 省電力で電波を切っている
+static unsigned long wifi_off_at = 0;
+static unsigned long last_input_wake_ms = 0;    // スイッチ・タッチで起きた時刻
+static unsigned long awake_since = 0;
+
+static int64_t wallMs() {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return (int64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+}
+
+// 壁時計の時刻 t（UNIX秒）まで、今から何 ms
+static int64_t msUntil(time_t t) {
+    return (int64_t)t * 1000 - wallMs();
+}
+
+// 次に WiFi が要るまで（fetch・アラームの MIDI 先読み）。時刻未確定なら -1
+static int64_t wifiNeedInMs(time_t now) {
+    if (now < 1700000000) return -1;
+    int64_t need = msUntil(nextFetchTime(now));
+    uint32_t head = alarmHeadTime();
+    if (head != 0) {
+        int64_t prearm = msUntil((time_t)head - MIDI_PREARM_SEC);
+        if (prearm < need) need = prearm;
+    }
+    return need < 0 ? 0 : need;
+}
+
+static void buildPlan(SleepPlan& p, time_t now, int64_t wifi_need) {
+    p.begin();
+    if (now >= 1700000000) {
+        int64_t wall = wallMs();
+        p.at(WAKE_MINUTE, 60000 - wall % 60000);
+        uint32_t head = alarmHeadTime();
+        // 取りこぼした過去のアラーム（鳴らさず残ったもの）で眠れなくならないよう、1分以上前は見ない
+        if (head != 0 && (int64_t)head * 1000 > wall - 60000) {
+            p.at(WAKE_ALARM, (int64_t)head * 1000 - wall);
+            int64_t prearm = ((int64_t)head - MIDI_PREARM_SEC) * 1000 - wall;
+            if (prearm > 0) p.at(WAKE_PREARM, prearm);
+        }
+    }
+    // loop() の定期処理（fetch・SD チェック・ハートビート・ALARM CHECK・自動復帰など）
+    uint8_t reason = WAKE_MAX;
+    int64_t timer_in = timerNextIn(&reason);
+    if (timer_in >= 0) p.at((WakeReason)reason, timer_in);
+    sleepPlanWifi(p, !wifi_off_by_power, wifi_need);
+}
+
+static bool switchHeld() {
+    return digitalRead(SW_L_PIN) == LOW || digitalRead(SW_R_PIN) == LOW ||
+           digitalRead(SW_P_PIN) == LOW;
+}
+
+static void lightSleep(const SleepDecision& d) {
+    if (d.wifi_off && !wifi_off_by_power) {
+        Serial.println("POWER: WiFi off until next fetch/alarm");
+        WiFi.disconnect(true);
+        WiFi.mode(WIFI_OFF);
+        wifi_off_by_power = true;
+        wifi_off_at = millis();
+    }
+    Serial.flush();
+
+    const gpio_num_t pins[] = { (gpio_num_t)SW_L_PIN, (gpio_num_t)SW_R_PIN,
+                                (gpio_num_t)SW_P_PIN, (gpio_num_t)TP_INT_PIN };
+    for (gpio_num_t pin : pins) gpio_wakeup_enable(pin, GPIO_INTR_LOW_LEVEL);
+    esp_sleep_enable_gpio_wakeup();
+    esp_sleep_enable_timer_wakeup((uint64_t)d.ms * 1000);
+    esp_light_sleep_start();
+    for (gpio_num_t pin : pins) gpio_wakeup_disable(pin);
+    gpio_set_intr_type((gpio_num_t)TP_INT_PIN, GPIO_INTR_NEGEDGE);   // M5EPD のタッチ割り込みに戻す
+
+    // スイッチの読み取りは期限切れのまま残っているので、起きた直後の dispatchTimers() で読む
+    if (esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_GPIO) last_input_wake_ms = millis();
+}
+
+// loop() の最後（従来の delay(1) の代わり）
+void powerIdle() {
+    unsigned long t0 = millis();
+    if (awake_since == 0) awake_since = t0;
+    stats.awake_ms += t0 - awake_since;
+
+    time_t now = time(nullptr);
+    int64_t wifi_need = wifiNeedInMs(now);
+    SleepPlan plan;
+    buildPlan(plan, now, wifi_need);
+
+    unsigned long last_input = last_interaction_ms;
+    if ((long)(last_input_wake_ms - last_input) > 0) last_input = last_input_wake_ms;
+
+    SleepInputs in;
+    in.busy = midi_playing || ui_state == UI_PLAYING || switchHeld();
+    in.network_busy = !ntfyIdle();
+    in.light_ok = ui_state == UI_LIST;
+    in.wifi_on = !wifi_off_by_power;
+    in.wifi_need_in_ms = wifi_need;
+    in.since_input_ms = t0 - last_input;
+    SleepDecision d = sleepDecide(plan, in);
+
+    switch (d.mode) {
+    case SLEEP_NONE:
+        delay(1);
+        break;
+    case SLEEP_IDLE:
+        delay(d.ms);
+        stats.idle_ms += millis() - t0;
+        break;
+    case SLEEP_LIGHT:
+        lightSleep(d);
+        stats.light_ms += millis() - t0;
+        stats.light_count++;
+        stats.wakes[d.reason]++;
+        break;
+    }
+    awake_since = millis();
+}
+
+// loop() から: 切った WiFi を要る前に繋ぎ直す
+void powerService() {
+    if (!wifi_off_by_power) return;
+    if (WiFi.status() == WL_CONNECTED) {        // fetch 側などが先に繋いだ
+        stats.wifi_off_ms += millis() - wifi_off_at;
+        wifi_off_by_power = false;
+        return;
+    }
+    if (midi_playing) return;                   // 接続待ちで MIDI を止めない
+    time_t now = time(nullptr);
+    int64_t need = wifiNeedInMs(now);
+    bool wanted = (need >= 0 && need <= WIFI_WAKE_LEAD_MS) || !ntfyIdle() || ui_state != UI_LIST;
+    if (!wanted || !alarmAllowsBlocking(FETCH_BLOCK_MS, "WiFi wake")) return;
+
+    stats.wifi_off_ms += millis() - wifi_off_at;
+    wifi_off_by_power = false;
+    Serial.printf("POWER: WiFi on (off %lus)\n", (unsigned long)((millis() - wifi_off_at) / 1000));
+    if (connectWiFi()) {
+        WiFi.setSleep(true);
+    } else {
+        Serial.println("POWER: WiFi reconnect failed - periodic fetch will retry");
+    }
+}
+
+// 省電力で WiFi を切っている間は true（ヘッダーの !W はこの間出さない）
+bool powerWifiOff() {
+    return wifi_off_by_power;
+}
+
+// 毎分の ALARM CHECK から
+void reportPower() {
+    uint64_t off = stats.wifi_off_ms + (wifi_off_by_power ? millis() - wifi_off_at : 0);
+    Serial.printf("  power: awake %lu%% idle %lu%% light %lu%% (%lu sleeps), wifi off %lus%s\n",
+                  (unsigned long)stats.pct(stats.awake_ms), (unsigned long)stats.pct(stats.idle_ms),
+                  (unsigned long)stats.pct(stats.light_ms), (unsigned long)stats.light_count,
+                  (unsigned long)(off / 1000), wifi_off_by_power ? " (now off)" : "");
+    if (stats.light_count == 0) return;
+    Serial.print("    wakes:");
+    for (int r = 0; r < WAKE_REASON_COUNT; r++) {
+        if (stats.wakes[r]) Serial.printf(" %s=%lu", wake_reason_names[r], (unsigned long)stats.wakes[r]);
+    }
+    Serial.println();
+}
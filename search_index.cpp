@@ -0,0 +1,292 @@
+#include "globals.h"
+#include <algorithm>
+#include <time.h>
+
+//==============================================================================
+// 全文検索（文字バイグラム索引）
+//   日本語は分かち書きできないため、正規化した連続2文字（バイグラム）を単位に
+//   「バイグラム → イベント」の転置リストを PSRAM に持つ。
+//
+//   構築は取り込みと同時: commitEvent が1件ごとに searchIndexAdd() で
+//   (バイグラム, index, 欄) を末尾に追記し、carrySegment は旧面の転置リストを
+//   index だけ付け替えて写す（searchIndexCarry、圧縮された説明文を展開しない）。
+//   sortAndTrimEvents の並べ替え結果で index を付け替え（searchIndexRemap）、
+//   公開時に1回だけバイグラム順にソートする（searchIndexFinalize）。
+//   events_buf_a/b ごとに1面ずつ持ち、fetch 失敗で旧面に戻っても索引はそのまま使える。
+//
+//   index はバッファ先頭からの位置で持つため、rollEventWindow で events の先頭が
+//   進んでも作り直し不要（検索時に切り離し分を差し引く）。
+//
+//   基本多言語面の2文字は (c1<<16)|c2 で衝突なく表せるので、照合の確認は不要。
+//==============================================================================
+
+#define SEARCH_MAX_POSTINGS     65536   // 1面あたりの転置リスト要素数（8byte × 65536 = 512KB）
+#define SEARCH_GRAMS_PER_FIELD  256     // 1欄（summary / description）あたりのバイグラム上限
+#define SEARCH_DESC_CHARS       240     // description は先頭この文字数だけ索引する
+#define SEARCH_FIELD_SUMMARY    0x01
+#define SEARCH_FIELD_DESC       0x02
+
+struct SearchPosting {
+    uint32_t gram;      // (c1 << 16) | c2
+    uint16_t idx;       // バッファ先頭からのイベント位置
+    uint8_t  field;     // SEARCH_FIELD_*
+    uint8_t  reserved;
+};
+
+struct SearchFace {
+    SearchPosting* post;
+    int      count;
+    bool     full;          // 上限に達して以降の description を捨てた
+    bool     sorted;
+    uint32_t ingest_us;     // 取り込み中の累計（searchIndexAdd）
+};
+
+static SearchFace face_a = {};
+static SearchFace face_b = {};
+static SearchFace* build_face = &face_a;     // 取り込み中の面
+
+// 検索時の作業域（PSRAM、MAX_EVENTS 要素）
+struct SearchCand {
+    uint16_t idx;
+    uint8_t  grams;     // 一致したクエリバイグラム数
+    uint8_t  in_sum;    // うち summary で一致した数
+    int32_t  start;
+};
+static uint8_t*    hit_grams = nullptr;
+static uint8_t*    hit_sum = nullptr;
+static SearchCand* cands = nullptr;
+
+static SearchFace& faceFor(const EventItem* buf) {
+    return inEventsBufB(buf) ? face_b : face_a;
+}
+
+static bool ensureFace(SearchFace& f) {
+    if (!f.post) f.post = (SearchPosting*)ps_malloc(SEARCH_MAX_POSTINGS * sizeof(SearchPosting));
+    return f.post != nullptr;
+}
+
+//==============================================================================
+// 正規化・バイグラム抽出（取り込みとクエリで共通）
+//==============================================================================
+
+// UTF-8 を1文字読み、検索用に正規化したコードポイントを返す（0=区切り）
+//   英字は小文字、全角英数は半角に寄せ、空白・記号・句読点・括弧は区切りにする
+static uint32_t nextSearchCp(const uint8_t*& p, const uint8_t* end) {
+    uint32_t c = *p++;
+    if (c >= 0x80) {
+        int extra = (c >= 0xF0) ? 3 : (c >= 0xE0) ? 2 : (c >= 0xC0) ? 1 : -1;
+        if (extra < 0) return 0;                    // 孤立した継続バイト
+        c &= (extra == 3) ? 0x07 : (extra == 2) ? 0x0F : 0x1F;
+        while (extra-- > 0 && p < end && (*p & 0xC0) == 0x80) c = (c << 6) | (*p++ & 0x3F);
+    }
+    if (c >= 0xFF01 && c <= 0xFF5E) c -= 0xFEE0;   // 全角英数記号 → ASCII
+    if (c < 0x80) {
+        if (c >= 'A' && c <= 'Z') return c + 32;
+        if ((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9')) return c;
+        if (c == '\\' && p < end) p++;             // ICS エスケープ（\n \, \;）は2文字で1区切り
+        return 0;
+    }
+    if (c == 0x3000 || c == 0x3001 || c == 0x3002 || c == 0x30FB) return 0;  // 全角空白、。・
+    if (c >= 0x3008 && c <= 0x3011) return 0;      // 〈〉《》「」『』【】
+    return c;
+}
+
+// s[0..len) の先頭 max_cp 文字から重複なしのバイグラムを out に（昇順）
+static int collectGrams(const char* s, int len, int max_cp, uint32_t* out, int max_out) {
+    const uint8_t* p = (const uint8_t*)s;
+    const uint8_t* end = p + len;
+    uint32_t prev = 0;
+    int n = 0;
+    for (int cps = 0; p < end && cps < max_cp && n < max_out; cps++) {
+        uint32_t c = nextSearchCp(p, end);
+        if (c && prev) out[n++] = ((prev & 0xFFFF) << 16) | (c & 0xFFFF);
+        prev = c;
+    }
+    std::sort(out, out + n);
+    return (int)(std::unique(out, out + n) - out);
+}
+
+static void addField(SearchFace& f, int idx, const char* s, int len, int max_cp, uint8_t field) {
+    if (!s || len <= 0) return;
+    static uint32_t grams[SEARCH_GRAMS_PER_FIELD];
+    int n = collectGrams(s, len, max_cp, grams, SEARCH_GRAMS_PER_FIELD);
+    if (f.count + n > SEARCH_MAX_POSTINGS) {
+        f.full = true;
+        n = SEARCH_MAX_POSTINGS - f.count;
+    }
+    for (int i = 0; i < n; i++) f.post[f.count++] = { grams[i], (uint16_t)idx, field, 0 };
+}
+
+//==============================================================================
+// 構築
+//==============================================================================
+
+// fetch で書き込み面を切り替えたとき（その面の索引を空にする）
+void searchIndexBegin(const EventItem* buf) {
+    build_face = &faceFor(buf);
+    build_face->count = 0;
+    build_face->full = false;
+    build_face->sorted = false;
+    build_face->ingest_us = 0;
+}
+
+// 1件分を追記（idx は書き込み面の先頭からの位置。desc は圧縮前の本文）
+void searchIndexAdd(int idx, const char* sum, int sumLen, const char* desc, int descLen) {
+    SearchFace& f = *build_face;
+    if (!ensureFace(f)) return;
+    uint32_t t0 = micros();
+    addField(f, idx, sum, sumLen, SEARCH_GRAMS_PER_FIELD + 1, SEARCH_FIELD_SUMMARY);
+    if (!f.full) addField(f, idx, desc, descLen, SEARCH_DESC_CHARS, SEARCH_FIELD_DESC);
+    f.ingest_us += micros() - t0;
+}
+
+// 旧面から引き継いだイベントの分を旧面の索引から写す（本文を読み直さない）
+//   map[from からの位置] = 書き込み面の index（0xFFFF = 引き継がない）、n は map の長さ。
+//   旧面の索引ができていなければ false（呼び出し側が本文から索引する）
+bool searchIndexCarry(const EventItem* from, const uint16_t* map, int n) {
+    SearchFace& src = faceFor(from);
+    SearchFace& f = *build_face;
+    if (&src == &f || !src.post || !src.sorted || !ensureFace(f)) return false;
+    uint32_t t0 = micros();
+    EventItem* base = inEventsBufB(from) ? events_buf_b : events_buf_a;
+    int off = (int)(from - base);
+    for (int i = 0; i < src.count; i++) {
+        int p = (int)src.post[i].idx - off;
+        if (p < 0 || p >= n || map[p] == 0xFFFF) continue;
+        if (f.count >= SEARCH_MAX_POSTINGS) { f.full = true; break; }
+        f.post[f.count] = src.post[i];
+        f.post[f.count++].idx = map[p];
+    }
+    if (src.full) f.full = true;    // 旧面で捨てた description はこちらにも無い
+    f.ingest_us += micros() - t0;
+    return true;
+}
+
+// 取得失敗したソースのセグメントを捨てたとき（idx >= n の要素は末尾に固まっている）
+void searchIndexTruncate(int n) {
+    SearchFace& f = *build_face;
+    while (f.count > 0 && f.post[f.count - 1].idx >= n) f.count--;
+}
+
+// sortAndTrimEvents の結果で付け替え（pos[旧index] = 新index、0xFFFF=トリムで削除）
+void searchIndexRemap(const uint16_t* pos) {
+    SearchFace& f = *build_face;
+    int out = 0;
+    for (int i = 0; i < f.count; i++) {
+        uint16_t np = pos[f.post[i].idx];
+        if (np == 0xFFFF) continue;
+        f.post[out] = f.post[i];
+        f.post[out++].idx = np;
+    }
+    f.count = out;
+}
+
+// 公開前にバイグラム順へ（検索は二分探索）
+void searchIndexFinalize() {
+    SearchFace& f = *build_face;
+    if (!f.post) return;
+    uint32_t t0 = micros();
+    std::sort(f.post, f.post + f.count, [](const SearchPosting& a, const SearchPosting& b) {
+        return (a.gram != b.gram) ? (a.gram < b.gram) : (a.idx < b.idx);
+    });
+    int grams = 0;
+    for (int i = 0; i < f.count; i++) {
+        if (i == 0 || f.post[i].gram != f.post[i - 1].gram) grams++;
+    }
+    f.sorted = true;
+    Serial.printf("SEARCH INDEX: %d events, %d postings (%dKB), %d bigrams, ingest %luus + sort %luus%s\n",
+                  event_count, f.count, (int)(f.count * sizeof(SearchPosting) / 1024), grams,
+                  (unsigned long)f.ingest_us, (unsigned long)(micros() - t0),
+                  f.full ? " [FULL - descriptions truncated]" : "");
+}
+
+// 公開中のイベントから作り直す（SD スナップショット復元後）
+void searchIndexRebuild() {
+    EventItem* base = inEventsBufB(events) ? events_buf_b : events_buf_a;
+    searchIndexBegin(events);
+    int off = (int)(events - base);
+    for (int i = 0; i < event_count; i++) {
+        const char* s = events[i].summary();
+        const char* d = events[i].description();
+        searchIndexAdd(off + i, s, strlen(s), d, strlen(d));
+    }
+    searchIndexFinalize();
+}
+
+//==============================================================================
+// 検索
+//   クエリのバイグラムごとに転置リストを二分探索し、イベントごとに一致数を数える。
+//   順位: 一致バイグラム数 → summary での一致数 → これからの予定（近い順）→ 過去（新しい順）
+//   全バイグラムに一致したものを返し、1件もなければ半数以上の一致まで広げる。
+//   1文字のクエリは summary を走査
+//==============================================================================
+int searchEvents(const char* query, int* out, int max_out) {
+    uint32_t t0 = micros();
+    SearchFace& f = faceFor(events);
+    EventItem* base = inEventsBufB(events) ? events_buf_b : events_buf_a;
+    int off = (int)(events - base);
+    if (!hit_grams) {
+        hit_grams = (uint8_t*)ps_malloc(MAX_EVENTS);
+        hit_sum = (uint8_t*)ps_malloc(MAX_EVENTS);
+        cands = (SearchCand*)ps_malloc(MAX_EVENTS * sizeof(SearchCand));
+    }
+    if (!hit_grams || !hit_sum || !cands) return 0;
+    memset(hit_grams, 0, MAX_EVENTS);
+    memset(hit_sum, 0, MAX_EVENTS);
+
+    uint32_t q[32];
+    int qlen = strlen(query);
+    int qn = collectGrams(query, qlen, 64, q, 32);
+
+    if (qn == 0) {
+        // 1文字: summary に同じ正規化文字があるか
+        const uint8_t* p = (const uint8_t*)query;
+        uint32_t qc = 0;
+        while (p < (const uint8_t*)query + qlen && !qc) qc = nextSearchCp(p, (const uint8_t*)query + qlen);
+        if (!qc) return 0;
+        for (int i = 0; i < event_count; i++) {
+            const char* s = events[i].summary();
+            const uint8_t* sp = (const uint8_t*)s;
+            const uint8_t* se = sp + strlen(s);
+            while (sp < se) {
+                if (nextSearchCp(sp, se) == qc) { hit_grams[off + i] = 1; hit_sum[off + i] = 1; break; }
+            }
+        }
+        qn = 1;
+    } else if (f.post && f.sorted) {
+        for (int k = 0; k < qn; k++) {
+            const SearchPosting* lo = std::lower_bound(f.post, f.post + f.count, q[k],
+                [](const SearchPosting& a, uint32_t g) { return a.gram < g; });
+            int last = -1;
+            for (const SearchPosting* e = lo; e < f.post + f.count && e->gram == q[k]; e++) {
+                if (e->idx != last) { hit_grams[e->idx]++; last = e->idx; }
+                if (e->field & SEARCH_FIELD_SUMMARY) hit_sum[e->idx]++;
+            }
+        }
+    }
+
+    // 全バイグラム一致があればそれだけ、なければ半数以上の一致を候補に
+    int need = (qn + 1) / 2;
+    for (int i = 0; i < event_count; i++) {
+        if (hit_grams[off + i] >= qn) { need = qn; break; }
+    }
+    int nc = 0;
+    for (int i = 0; i < event_count; i++) {
+        int b = off + i;
+        if (hit_grams[b] == 0 || hit_grams[b] < need) continue;
+        cands[nc++] = { (uint16_t)i, hit_grams[b], hit_sum[b], (int32_t)events[i].start };
+    }
+    int32_t now = (int32_t)time(nullptr);
+    std::sort(cands, cands + nc, [now](const SearchCand& a, const SearchCand& b) {
+        if (a.grams != b.grams) return a.grams > b.grams;
+        if (a.in_sum != b.in_sum) return a.in_sum > b.in_sum;
+        bool fa = a.start >= now, fb = b.start >= now;
+        if (fa != fb) return fa;
+        return fa ? a.start < b.start : a.start > b.start;
+    });
+    int n = min(nc, max_out);
+    for (int i = 0; i < n; i++) out[i] = cands[i].idx;
+    Serial.printf("SEARCH: '%s' %d bigrams -> %d hits (%luus, %d postings)\n",
+                  query, qn, nc, (unsigned long)(micros() - t0), f.count);
+    return n;
+}
@@ -0,0 +1,108 @@
+#ifndef SLEEP_SCHED_H
+#define SLEEP_SCHED_H
+
+//==============================================================================
+// 締め切り駆動のスリープ判断（プラットフォーム非依存・ヘッダオンリー）
+//   loop() の終わりに「次に何かをしなければならない時刻」（締め切り）を集め、
+//   最早の締め切りまで眠る。締め切りは今からの ms で渡す（壁時計の予定は呼び出し側で換算）。
+//     SLEEP_NONE  … 眠らない（MIDI 再生中・操作直後・締め切りが目前）
+//     SLEEP_IDLE  … タスク待ちで CPU を明け渡す（入力の取りこぼしを防ぐため刻みは短く）
+//     SLEEP_LIGHT … ライトスリープ（タイマー + スイッチ/タッチの GPIO で起床）
+//   ライトスリープ中は WiFi を維持できないため、次に WiFi が要る時刻（fetch・MIDI の
+//   先読み）まで WIFI_OFF_MIN_MS 以上空くときだけ電波を切って眠り、要る時刻の
+//   WIFI_WAKE_LEAD_MS 前に WAKE_WIFI で起きて繋ぎ直す。それ以外は SLEEP_IDLE まで。
+//
+//   ホスト側シミュレーション tools/sleepsim（仮想時計）からも同じコードを使う。
+//==============================================================================
+#include <stdint.h>
+
+#define SLEEP_MIN_MS            20      // これより短い待ちは眠らない（従来どおり回す）
+#define SLEEP_IDLE_SLICE_MS     50      // SLEEP_IDLE の1回の上限（スイッチ・タッチの応答）
+#define SLEEP_LIGHT_MIN_MS      300     // ライトスリープに入る最短の待ち
+#define SLEEP_MAX_MS            60000   // 1回の上限（タスク WDT 120s より十分短く）
+#define SLEEP_INPUT_HOLD_MS     3000    // 操作・起床入力の後はしばらく眠らない
+#define WIFI_OFF_MIN_MS         600000  // 次に WiFi が要るまでこれ以上空くなら電波を切る
+#define WIFI_WAKE_LEAD_MS       30000   // WiFi が要る時刻のこれだけ前に繋ぎ直す
+
+enum WakeReason {
+    WAKE_MAX,           // 締め切りなし（SLEEP_MAX_MS で起きる）
+    WAKE_ALARM,         // 次のアラーム時刻
+    WAKE_PREARM,        // MIDI 先読みの開始
+    WAKE_MINUTE,        // 分の切り替わり（時刻表示・自動リフレッシュ・ALARM CHECK・日付）
+    WAKE_FETCH,         // 次の ICS 取得
+    WAKE_WIFI,          // 切った WiFi を繋ぎ直す
+    WAKE_SD_CHECK,      // SD 健全性チェック
+    WAKE_HEARTBEAT,     // ハートビート明滅
+    WAKE_BROWSE,        // 詳細・月表示・検索の自動復帰
+    WAKE_REASON_COUNT
+};
+
+static const char* const wake_reason_names[WAKE_REASON_COUNT] = {
+    "max", "alarm", "prearm", "minute", "fetch", "wifi", "sd", "heartbeat", "browse"
+};
+
+enum SleepMode { SLEEP_NONE, SLEEP_IDLE, SLEEP_LIGHT };
+
+// 締め切りの集計（最早のものと理由）
+struct SleepPlan {
+    uint32_t   wait_ms;
+    WakeReason reason;
+
+    void begin() { wait_ms = SLEEP_MAX_MS; reason = WAKE_MAX; }
+    // in_ms 後の締め切り（0 以下 = 期限切れ → 眠らない）
+    void at(WakeReason r, int64_t in_ms) {
+        if (in_ms < 0) in_ms = 0;
+        if (in_ms < (int64_t)wait_ms) { wait_ms = (uint32_t)in_ms; reason = r; }
+    }
+};
+
+struct SleepInputs {
+    bool     busy;              // MIDI 再生中・スイッチ押下中・鳴動画面など
+    bool     network_busy;      // 通知の送信待ちなど（ライトスリープ不可、待ちは可）
+    bool     light_ok;          // ライトスリープしてよい画面か
+    bool     wifi_on;
+    int64_t  wifi_need_in_ms;   // 次に WiFi が要るまで（< 0 = 予定なし）
+    uint32_t since_input_ms;    // 最後の操作・入力起床から
+};
+
+struct SleepDecision {
+    SleepMode  mode;
+    uint32_t   ms;
+    WakeReason reason;
+    bool       wifi_off;        // 眠る前に電波を切る
+};
+
+inline SleepDecision sleepDecide(const SleepPlan& p, const SleepInputs& in) {
+    SleepDecision d = { SLEEP_NONE, 0, p.reason, false };
+    if (in.busy || in.since_input_ms < SLEEP_INPUT_HOLD_MS) return d;
+    if (p.wait_ms < SLEEP_MIN_MS) return d;
+    d.mode = SLEEP_IDLE;
+    d.ms = p.wait_ms < SLEEP_IDLE_SLICE_MS ? p.wait_ms : SLEEP_IDLE_SLICE_MS;
+    if (!in.light_ok || in.network_busy || p.wait_ms < SLEEP_LIGHT_MIN_MS) return d;
+    if (in.wifi_on) {
+        if (in.wifi_need_in_ms >= 0 && in.wifi_need_in_ms < WIFI_OFF_MIN_MS) return d;
+        d.wifi_off = true;
+    }
+    d.mode = SLEEP_LIGHT;
+    d.ms = p.wait_ms;
+    return d;
+}
+
+// WiFi を切っている間の起床: 要る時刻の WIFI_WAKE_LEAD_MS 前
+inline void sleepPlanWifi(SleepPlan& p, bool wifi_on, int64_t wifi_need_in_ms) {
+    if (!wifi_on && wifi_need_in_ms >= 0) p.at(WAKE_WIFI, wifi_need_in_ms - WIFI_WAKE_LEAD_MS);
+}
+
+// 滞在時間の集計（ALARM CHECK / シミュレーション共通）
+struct SleepStats {
+    uint64_t awake_ms, idle_ms, light_ms, wifi_off_ms;
+    uint32_t light_count;
+    uint32_t wakes[WAKE_REASON_COUNT];
+
+    uint32_t pct(uint64_t part) const {
+        uint64_t total = awake_ms + idle_ms + light_ms;
+        return total ? (uint32_t)(part * 100 / total) : 0;
+    }
+};
+
+#endif // SLEEP_SCHED_H
@@ -0,0 +1,124 @@
+#include "text_codec.h"
+#include <string.h>
+
+static inline uint32_t read32(const uint8_t* p) {
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+static inline uint32_t lzHash(uint32_t v) {
+    return (v * 2654435761u) >> (32 - LZ_HASH_BITS);
+}
+
+// 15 以上の長さは 255 区切りで追記
+static inline uint8_t* putLength(uint8_t* op, const uint8_t* oend, size_t len) {
+    while (len >= 255) {
+        if (op >= oend) return nullptr;
+        *op++ = 255;
+        len -= 255;
+    }
+    if (op >= oend) return nullptr;
+    *op++ = (uint8_t)len;
+    return op;
+}
+
+// シーケンス1つ（リテラル + 任意の一致）を書き出す。match_len==0 は最終シーケンス
+static uint8_t* putSequence(uint8_t* op, const uint8_t* oend,
+                            const uint8_t* lit, size_t lit_len,
+                            size_t offset, size_t match_len) {
+    if (op >= oend) return nullptr;
+    uint8_t* token = op++;
+    uint8_t t = (uint8_t)((lit_len >= 15 ? 15 : lit_len) << 4);
+    if (lit_len >= 15 && !(op = putLength(op, oend, lit_len - 15))) return nullptr;
+    if (op + lit_len > oend) return nullptr;
+    memcpy(op, lit, lit_len);
+    op += lit_len;
+    if (match_len) {
+        size_t ml = match_len - LZ_MIN_MATCH;
+        t |= (uint8_t)(ml >= 15 ? 15 : ml);
+        if (op + 2 > oend) return nullptr;
+        *op++ = (uint8_t)(offset & 0xFF);
+        *op++ = (uint8_t)(offset >> 8);
+        if (ml >= 15 && !(op = putLength(op, oend, ml - 15))) return nullptr;
+    }
+    *token = t;
+    return op;
+}
+
+size_t lzCompress(const uint8_t* src, size_t n, uint8_t* dst, size_t dst_cap, uint16_t* table) {
+    if (n == 0 || n > 0xFFFF) return 0;
+    uint8_t* op = dst;
+    const uint8_t* oend = dst + dst_cap;
+    const uint8_t* anchor = src;        // 未出力リテラルの先頭
+    size_t i = 0;
+    memset(table, 0, LZ_HASH_SIZE * sizeof(uint16_t));
+
+    while (n >= LZ_MIN_MATCH && i + LZ_MIN_MATCH <= n) {
+        uint32_t h = lzHash(read32(src + i));
+        size_t cand = table[h];
+        table[h] = (uint16_t)i;
+        // cand==0 は空き扱い（先頭位置への一致は諦める）
+        if (cand == 0 || cand >= i || read32(src + cand) != read32(src + i)) {
+            i++;
+            continue;
+        }
+        size_t len = LZ_MIN_MATCH;
+        while (i + len < n && src[cand + len] == src[i + len]) len++;
+        op = putSequence(op, oend, anchor, (src + i) - anchor, i - cand, len);
+        if (!op) return 0;
+        i += len;
+        anchor = src + i;
+    }
+    op = putSequence(op, oend, anchor, (src + n) - anchor, 0, 0);
+    if (!op) return 0;
+    return (size_t)(op - dst);
+}
+
+size_t lzDecompress(const uint8_t* src, size_t n, uint8_t* dst, size_t dst_cap) {
+    const uint8_t* ip = src;
+    const uint8_t* iend = src + n;
+    uint8_t* op = dst;
+    uint8_t* oend = dst + dst_cap;
+
+    while (ip < iend) {
+        uint8_t t = *ip++;
+        size_t lit = t >> 4;
+        if (lit == 15) {
+            uint8_t b;
+            do {
+                if (ip >= iend) return 0;
+                b = *ip++;
+                lit += b;
+            } while (b == 255);
+        }
+        if (ip + lit > iend || op + lit > oend) return 0;
+        memcpy(op, ip, lit);
+        ip += lit;
+        op += lit;
+        if (ip >= iend) break;              // 最終シーケンス
+
+        if (ip + 2 > iend) return 0;
+        size_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        size_t len = (t & 15);
+        if (len == 15) {
+            uint8_t b;
+            do {
+                if (ip >= iend) return 0;
+                b = *ip++;
+                len += b;
+            } while (b == 255);
+        }
+        len += LZ_MIN_MATCH;
+        if (offset == 0 || offset > (size_t)(op - dst) || op + len > oend) return 0;
+        const uint8_t* m = op - offset;
+        if (offset >= len) {
+            memcpy(op, m, len);
+            op += len;
+        } else {
+            while (len--) *op++ = *m++;     // 重なりあり（繰り返しパターン）
+        }
+    }
+    return (size_t)(op - dst);
+}
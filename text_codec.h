@@ -0,0 +1,30 @@
+#ifndef TEXT_CODEC_H
+#define TEXT_CODEC_H
+
+//==============================================================================
+// 本文圧縮コーデック（プラットフォーム非依存、LZ4 系のバイト単位 LZ77）
+//   長い DESCRIPTION を取り込み時に圧縮して本文プールに置き、詳細/再生画面で
+//   必要になった時だけ展開する。展開はリテラルコピーと重なりありコピーのみで、
+//   ESP32 でも数KBを数百µsで処理できる。ホスト側ベンチマーク tools/descbench と共用。
+//
+//   ストリーム: シーケンスの連続
+//     token(1) : 上位4bit=リテラル長, 下位4bit=一致長-LZ_MIN_MATCH（15 は 255 区切りの追加バイトで延長）
+//     literals : リテラル長バイト
+//     offset(2): 一致位置までの距離（LE、1..65535）。最後のシーケンスには無い
+//==============================================================================
+#include <stdint.h>
+#include <stddef.h>
+
+#define LZ_MIN_MATCH    4
+#define LZ_HASH_BITS    12
+#define LZ_HASH_SIZE    (1 << LZ_HASH_BITS)     // 圧縮用ハッシュ表の要素数（uint16_t）
+
+// src[0..n) を圧縮して dst に書く。n < 65536。
+//   table は LZ_HASH_SIZE 個の作業域（呼び出し側で確保、内容は不問）。
+//   戻り値は圧縮後バイト数。dst_cap に収まらなければ 0（＝圧縮しない）
+size_t lzCompress(const uint8_t* src, size_t n, uint8_t* dst, size_t dst_cap, uint16_t* table);
+
+// 展開。戻り値は展開後バイト数（壊れたストリーム・dst_cap 超過は 0）
+size_t lzDecompress(const uint8_t* src, size_t n, uint8_t* dst, size_t dst_cap);
+
+#endif // TEXT_CODEC_H
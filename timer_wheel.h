@@ -0,0 +1,252 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+//==============================================================================
+// 階層タイマーホイール（プラットフォーム非依存・ヘッダオンリー）
+//   loop() の定期処理（スイッチ・SD チェック・自動リフレッシュ・ハートビート・
+//   ALARM CHECK・fetch）を登録し、期限が来たものだけを dispatch() で呼ぶ。
+//   各処理が毎周「前回から N ms 経ったか」を見て回る形をやめるためのもの。
+//
+//   1 tick = TW_TICK_MS。64 スロット × 3 段:
+//     段0  1 tick 刻み   … 640ms 先まで
+//     段1  64 tick 刻み  … 約41秒先まで
+//     段2  4096 tick 刻み … 約44分先まで（それより先は段2の最後に置き、降ろすときに入れ直す）
+//   上の段のスロットは、下の段が一周するたびに1つずつ下へ降ろす（カスケード）。
+//
+//   周期ジョブは「予定時刻 + 周期」で次を決めるので、呼ぶのが遅れても位相がずれない。
+//   何周期も遅れた（眠っていた・処理が詰まった）分は飛ばして skipped に数える。
+//   ジョブが false を返したら「今はできない」（画面が違う・再生中など）。予定時刻は
+//   そのままに retry_ms 後にもう一度呼ぶ。ジョブの中で runIn / cancel を呼んだら
+//   自動の張り直しはしない（一度きりのジョブを次の時刻で張り直すのに使う）。
+//   wake = false のジョブ（スイッチの読み取り）は眠りの締め切りに数えない。
+//
+//   ジョブごとに実行回数・合計/最大の所要時間・最大の遅れを数える（clock_us で測る）。
+//   ホスト側テスト tools/timerwheel（仮想時計）からも同じコードを使う。
+//==============================================================================
+#include <stdint.h>
+
+#define TW_TICK_MS      10
+#define TW_SLOT_BITS    6
+#define TW_SLOTS        (1 << TW_SLOT_BITS)
+#define TW_LEVELS       3
+#define TW_MAX_JOBS     16
+
+typedef bool (*TimerFn)();      // false = 今は実行できない（retry_ms 後に再試行）
+
+struct TimerJob {
+    const char* name;
+    TimerFn     fn;
+    uint32_t    period_ms;      // 0 = 一度きり
+    uint32_t    retry_ms;
+    uint64_t    due_ms;         // 予定時刻（周期の基準）
+    uint64_t    expire_tick;    // 実際に呼ぶ tick（再試行中は due より後）
+    int8_t      next, prev;     // スロット内の双方向リスト
+    int8_t      level;          // -1 = 未登録
+    uint8_t     slot;
+    uint8_t     tag;            // 呼び出し側の分類（起床理由）
+    bool        wake;
+    bool        armed;
+    bool        rearmed;        // 実行中に runIn / cancel された
+
+    // 計測
+    uint32_t    runs, deferred, skipped;
+    uint64_t    total_us;
+    uint32_t    max_us;
+    uint32_t    worst_late_ms;
+};
+
+struct TimerWheel {
+    TimerJob  jobs[TW_MAX_JOBS];
+    int       count;
+    int8_t    slots[TW_LEVELS][TW_SLOTS];
+    uint64_t  tick;             // 処理済み（または処理中）の tick
+    uint64_t  open_tick;        // まだ呼んでいない最初の tick（ここより前には置かない）
+    uint64_t  now_ms;           // 最後に dispatch した時刻
+    int       running;          // 実行中のジョブ（-1 = なし）
+    uint64_t  (*clock_us)();
+
+    void init(uint64_t now, uint64_t (*clk)()) {
+        count = 0;
+        tick = now / TW_TICK_MS;
+        open_tick = tick + 1;
+        now_ms = now;
+        running = -1;
+        clock_us = clk;
+        for (int l = 0; l < TW_LEVELS; l++)
+            for (int s = 0; s < TW_SLOTS; s++) slots[l][s] = -1;
+    }
+
+    // 周期ジョブ（first_in_ms 後に初回）。戻り値はジョブ番号（満杯なら -1）
+    int add(const char* name, TimerFn fn, uint32_t period_ms, uint32_t first_in_ms,
+            uint8_t tag, bool wake = true) {
+        if (count >= TW_MAX_JOBS) return -1;
+        int id = count++;
+        TimerJob& j = jobs[id];
+        j = TimerJob();
+        j.name = name;
+        j.fn = fn;
+        j.period_ms = period_ms;
+        j.retry_ms = period_ms && period_ms < 1000 ? period_ms : 1000;
+        j.level = -1;
+        j.tag = tag;
+        j.wake = wake;
+        arm(id, now_ms + first_in_ms, now_ms + first_in_ms);
+        return id;
+    }
+
+    // 一度きりのジョブ
+    int once(const char* name, TimerFn fn, uint32_t in_ms, uint8_t tag, bool wake = true) {
+        return add(name, fn, 0, in_ms, tag, wake);
+    }
+
+    // 予定を今から in_ms 後に置き直す（周期ジョブは以後そこが基準）
+    void runIn(int id, uint32_t in_ms) {
+        if (id < 0 || id >= count) return;
+        if (id == running) jobs[id].rearmed = true;
+        arm(id, now_ms + in_ms, now_ms + in_ms);
+    }
+
+    void cancel(int id) {
+        if (id < 0 || id >= count) return;
+        if (id == running) jobs[id].rearmed = true;
+        unlink(id);
+        jobs[id].armed = false;
+    }
+
+    // now までに期限の来たジョブを呼ぶ。呼んだ数を返す
+    int dispatch(uint64_t now) {
+        if (now < now_ms) now = now_ms;
+        now_ms = now;
+        uint64_t target = now / TW_TICK_MS;
+        int ran = 0;
+        while (tick < target) {
+            tick++;
+            open_tick = tick;           // 降ろしたジョブはこの tick のスロットに入りうる
+            int idx0 = (int)(tick & (TW_SLOTS - 1));
+            if (idx0 == 0) {
+                int idx1 = (int)((tick >> TW_SLOT_BITS) & (TW_SLOTS - 1));
+                if (idx1 == 0) cascade(2, (int)((tick >> (2 * TW_SLOT_BITS)) & (TW_SLOTS - 1)));
+                cascade(1, idx1);
+            }
+            // このスロットを全部切り離してから呼ぶ（ジョブの中で他のジョブを張り直しても崩れない）
+            int batch[TW_MAX_JOBS], n = 0;
+            for (int id = slots[0][idx0]; id >= 0; id = jobs[id].next) {
+                jobs[id].level = -1;
+                batch[n++] = id;
+            }
+            slots[0][idx0] = -1;
+            open_tick = tick + 1;
+            for (int k = 0; k < n; k++) {
+                int id = batch[k];
+                if (jobs[id].level >= 0 || !jobs[id].armed) continue;     // 先に呼んだジョブが張り直した・止めた
+                if (jobs[id].expire_tick <= tick) { fire(id); ran++; }
+                else place(id);
+            }
+        }
+        return ran;
+    }
+
+    // now から次に呼ぶジョブまでの ms（wake のものだけ）。なければ -1。
+    //   ジョブは十数件なので表から直接引く
+    int64_t nextIn(uint64_t now, uint8_t* tag = nullptr) const {
+        int64_t best = -1;
+        for (int i = 0; i < count; i++) {
+            const TimerJob& j = jobs[i];
+            if (!j.armed || !j.wake) continue;
+            int64_t in = (int64_t)(j.expire_tick * TW_TICK_MS) - (int64_t)now;
+            if (in < 0) in = 0;
+            if (best < 0 || in < best) {
+                best = in;
+                if (tag) *tag = j.tag;
+            }
+        }
+        return best;
+    }
+
+private:
+    void arm(int id, uint64_t due, uint64_t run_at) {
+        TimerJob& j = jobs[id];
+        unlink(id);
+        j.due_ms = due;
+        j.expire_tick = (run_at + TW_TICK_MS - 1) / TW_TICK_MS;     // 早く呼ばないよう切り上げ
+        j.armed = true;
+        place(id);
+    }
+
+    void place(int id) {
+        TimerJob& j = jobs[id];
+        uint64_t exp = j.expire_tick;
+        if (exp < open_tick) exp = open_tick;       // 期限切れはまだ呼んでいない最初の tick で
+        uint64_t delta = exp - tick;
+        int level, slot;
+        if (delta < TW_SLOTS) {
+            level = 0; slot = (int)(exp & (TW_SLOTS - 1));
+        } else if (delta < (1ULL << (2 * TW_SLOT_BITS))) {
+            level = 1; slot = (int)((exp >> TW_SLOT_BITS) & (TW_SLOTS - 1));
+        } else if (delta < (1ULL << (3 * TW_SLOT_BITS))) {
+            level = 2; slot = (int)((exp >> (2 * TW_SLOT_BITS)) & (TW_SLOTS - 1));
+        } else {
+            level = 2; slot = (int)(((tick >> (2 * TW_SLOT_BITS)) + TW_SLOTS - 1) & (TW_SLOTS - 1));
+        }
+        j.level = (int8_t)level;
+        j.slot = (uint8_t)slot;
+        j.prev = -1;
+        j.next = slots[level][slot];
+        if (j.next >= 0) jobs[j.next].prev = (int8_t)id;
+        slots[level][slot] = (int8_t)id;
+    }
+
+    void unlink(int id) {
+        TimerJob& j = jobs[id];
+        if (j.level < 0) return;
+        if (j.prev >= 0) jobs[j.prev].next = j.next;
+        else slots[j.level][j.slot] = j.next;
+        if (j.next >= 0) jobs[j.next].prev = j.prev;
+        j.level = -1;
+    }
+
+    void cascade(int level, int slot) {
+        int id = slots[level][slot];
+        slots[level][slot] = -1;
+        while (id >= 0) {
+            int next = jobs[id].next;
+            jobs[id].level = -1;
+            place(id);
+            id = next;
+        }
+    }
+
+    void fire(int id) {
+        TimerJob& j = jobs[id];
+        j.armed = false;
+        j.rearmed = false;
+        running = id;
+        uint64_t t0 = clock_us ? clock_us() : 0;
+        bool done = j.fn();
+        uint32_t us = clock_us ? (uint32_t)(clock_us() - t0) : 0;
+        running = -1;
+
+        if (!done) {
+            j.deferred++;
+            if (!j.rearmed) arm(id, j.due_ms, now_ms + j.retry_ms);    // 予定時刻は据え置き
+            return;
+        }
+        j.runs++;
+        j.total_us += us;
+        if (us > j.max_us) j.max_us = us;
+        uint64_t late = now_ms > j.due_ms ? now_ms - j.due_ms : 0;
+        if (late > j.worst_late_ms) j.worst_late_ms = (uint32_t)late;
+        if (j.rearmed || j.period_ms == 0) return;
+
+        // 予定時刻 + 周期（過ぎた周期は飛ばす）
+        uint64_t next = j.due_ms + j.period_ms;
+        if (next <= now_ms) {
+            uint64_t missed = (now_ms - next) / j.period_ms + 1;
+            j.skipped += (uint32_t)missed;
+            next += missed * j.period_ms;
+        }
+        arm(id, next, next);
+    }
+};
+
+#endif // TIMER_WHEEL_H
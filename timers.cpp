@@ -0,0 +1,62 @@
+#include "globals.h"
+#include "timer_wheel.h"
+#include <esp_timer.h>
+
+//==============================================================================
+// loop() の定期処理（timer_wheel.h のホイール1つ、loopTask 専用）
+//   ジョブの登録は setup() の最後、呼び出しは loop() の dispatchTimers() から。
+//   時刻は esp_timer（起動からの µs、ライトスリープ中も進む）。millis() は
+//   49日で一周するので使わない。
+//==============================================================================
+
+static TimerWheel wheel;
+
+static uint64_t timerClockUs() {
+    return (uint64_t)esp_timer_get_time();
+}
+
+static uint64_t timerNowMs() {
+    return timerClockUs() / 1000;
+}
+
+void initTimers() {
+    wheel.init(timerNowMs(), timerClockUs);
+}
+
+int timerAdd(const char* name, bool (*fn)(), uint32_t period_ms, uint32_t first_in_ms,
+             uint8_t wake_reason, bool wake) {
+    int id = wheel.add(name, fn, period_ms, first_in_ms, wake_reason, wake);
+    if (id < 0) Serial.printf("TIMER: no room for '%s' (max %d)\n", name, TW_MAX_JOBS);
+    return id;
+}
+
+void timerRunIn(int id, uint32_t in_ms) {
+    wheel.runIn(id, in_ms);
+}
+
+void timerSetRetry(int id, uint32_t retry_ms) {
+    if (id >= 0 && id < wheel.count) wheel.jobs[id].retry_ms = retry_ms;
+}
+
+void dispatchTimers() {
+    wheel.dispatch(timerNowMs());
+}
+
+// 次に起こすべきジョブまでの ms（なければ -1）。wake_reason にその起床理由
+int64_t timerNextIn(uint8_t* wake_reason) {
+    return wheel.nextIn(timerNowMs(), wake_reason);
+}
+
+// 毎分の ALARM CHECK から
+void reportTimers() {
+    Serial.print("  timers:");
+    for (int i = 0; i < wheel.count; i++) {
+        const TimerJob& j = wheel.jobs[i];
+        Serial.printf(" %s %lu/%luus/max%luus", j.name, (unsigned long)j.runs,
+                      (unsigned long)(j.runs ? j.total_us / j.runs : 0), (unsigned long)j.max_us);
+        if (j.worst_late_ms >= 100) Serial.printf("/late%lums", (unsigned long)j.worst_late_ms);
+        if (j.deferred) Serial.printf("/defer%lu", (unsigned long)j.deferred);
+        if (j.skipped) Serial.printf("/skip%lu", (unsigned long)j.skipped);
+    }
+    Serial.println();
+}
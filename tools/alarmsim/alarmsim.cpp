@@ -0,0 +1,240 @@
+//==============================================================================
+// alarmsim — アラーム発火遅延のホスト側シミュレーション
+//
+//   メインループを「画面ごとの処理（EPD 描画・SD・fetch など）の所要時間」で
+//   模擬し、全 UiState を順に巡りながらアラームを鳴らして、期限到来から
+//   MIDI 再生開始までの遅延を画面別に集計する。判定は alarm_sched.h を
+//   そのまま使う（alarmActionFor / alarmGuardAllows / AlarmLatencyStats）。
+//
+//   old: 従来の動作（checkAlarms は UI_LIST のみ、割り込み点なし、
+//        ntfy 送信の後に MIDI 開始、fetch の見送りなし）
+//   new: 全画面でループ先頭判定 + 割り込み点（fetch 受信・メッセージ待ち）+
+//        監視タスク（100ms 周期）+ 割り込めない処理の見送り
+//
+//   new の全画面で最大遅延が ALARM_LATENCY_BUDGET_MS 未満でなければ終了コード 1。
+//
+// ビルド（リポジトリのルートで）:
+//   g++ -std=c++17 -O2 -I. tools/alarmsim/alarmsim.cpp -o alarmsim
+//==============================================================================
+#include "alarm_sched.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <vector>
+#include <random>
+
+// types.h / alarm_service.cpp と同じ値
+#define ALARM_TASK_PERIOD_MS    100
+#define FETCH_BLOCK_MS          10000
+#define FETCH_URL_BLOCK_MS      6000
+
+enum SimState {
+    S_LIST, S_DETAIL, S_PLAYING, S_SETTINGS, S_KEYBOARD,
+    S_MIDI_SELECT, S_BAUD_SELECT, S_PORT_SELECT, S_MONTH, S_SEARCH, S_COUNT
+};
+static const char* state_names[S_COUNT] = {
+    "LIST", "DETAIL", "PLAYING(test)", "SETTINGS", "KEYBOARD",
+    "MIDI_SELECT", "BAUD_SELECT", "PORT_SELECT", "MONTH", "SEARCH"
+};
+
+static const uint64_t DWELL_MS   = 2ULL * 3600 * 1000;     // 1画面あたりの滞在
+static const uint64_t PLAY_MS    = 20000;                  // アラーム鳴動時間
+static const int      SOURCES    = 3;                      // ICS ソース数
+
+struct Sim {
+    bool     new_policy;
+    uint64_t t = 0;
+    std::mt19937 rng;
+    std::vector<uint64_t> alarms;   // 期限（ms, 秒境界）
+    size_t   next = 0;
+    uint32_t task_phase;            // 監視タスクの周期の位相
+
+    int      state = S_LIST;
+    int      return_state = S_LIST;
+    bool     alarm_playing = false;
+    uint64_t play_end = 0;
+    bool     test_playing = false;
+    uint64_t test_end = 0;
+
+    uint64_t next_touch = 0, next_heartbeat = 0, next_refresh = 0, next_fetch = 0, next_msg = 0;
+    AlarmLatencyStats lat[S_COUNT] = {};
+    AlarmHistogram    hist = {};       // 全画面（端末の ALARM CHECK と同じバケット）
+    uint32_t queued = 0;
+    uint32_t fetch_held = 0;
+    int      fetch_src_left = SOURCES;
+
+    Sim(bool np, uint32_t seed) : new_policy(np), rng(seed) {
+        task_phase = rng() % ALARM_TASK_PERIOD_MS;
+        uint64_t at = 60000;
+        while (at < DWELL_MS * S_COUNT) {
+            alarms.push_back(at);
+            at += 1000ULL * (45 + rng() % 120);     // 45〜165 秒おき（秒境界）
+        }
+    }
+
+    uint32_t rnd(uint32_t lo, uint32_t hi) { return lo + rng() % (hi - lo + 1); }
+    bool     due() const { return next < alarms.size() && alarms[next] <= t; }
+    uint64_t head() const { return next < alarms.size() ? alarms[next] : 0; }
+
+    // 監視タスクが期限到来を検知済みか（期限後の最初の周期で検知）
+    bool taskFlag() const {
+        if (!due()) return false;
+        uint64_t d = alarms[next];
+        uint64_t k = (d + ALARM_TASK_PERIOD_MS - task_phase - 1) / ALARM_TASK_PERIOD_MS;
+        return t >= k * ALARM_TASK_PERIOD_MS + task_phase;
+    }
+
+    bool midiPlaying() const { return alarm_playing || test_playing; }
+
+    void finishAlarm() {
+        alarm_playing = false;
+        state = return_state;
+        t += 600;       // 鳴動前の画面を描き直す（GC16）
+    }
+
+    // checkAlarms 相当
+    void service() {
+        AlarmAction act = alarmActionFor(due(), midiPlaying(), alarm_playing);
+        if (act == ALARM_NONE) return;
+        if (act == ALARM_QUEUE) { queued++; return; }
+        if (!new_policy && midiPlaying()) return;       // 従来: 再生中は見ない
+        if (act == ALARM_PREEMPT_TEST) {
+            test_playing = false;
+            t += 10;
+            return_state = S_SETTINGS;
+        } else {
+            return_state = state;
+        }
+        if (!new_policy) t += rnd(800, 3000);           // 従来: ntfy 送信が先
+        t += rnd(50, 150);                              // SD から MIDI 読み込み → 再生開始
+        uint64_t d = alarms[next++];
+        lat[(d / DWELL_MS) % S_COUNT].add((uint32_t)(t - d));     // 期限到来時に置かれていた画面で集計
+        hist.add((uint32_t)(t - d));
+        alarm_playing = true;
+        play_end = t + PLAY_MS;
+        state = S_PLAYING;
+        t += 600;                                       // drawPlaying
+    }
+
+    // 割り込み点（alarmPreemptPoint）
+    void preemptPoint() {
+        if (alarm_playing && t >= play_end) finishAlarm();
+        if (test_playing && t >= test_end) { test_playing = false; state = S_LIST; t += 600; }
+        if (taskFlag()) service();
+    }
+
+    // 割り込めない処理
+    void block(uint32_t ms) { t += ms; }
+
+    // 割り込み点つきの処理（new のみ gran ごとに割り込み点）。鳴動画面に変わったら stop_on_fire で打ち切り
+    void work(uint32_t ms, uint32_t gran, bool stop_on_fire) {
+        if (!new_policy) { t += ms; return; }
+        uint64_t end = t + ms;
+        while (t < end) {
+            t += (end - t < gran) ? (end - t) : gran;
+            preemptPoint();
+            if (stop_on_fire && state == S_PLAYING) return;
+        }
+    }
+
+    bool guard(uint32_t block_ms) {
+        if (!new_policy) return true;
+        if (alarmGuardAllows(t, head(), block_ms)) return true;
+        fetch_held++;
+        return false;
+    }
+
+    // 定期 fetch。ソースごとに TLS 接続前で判定し、見送ったソースは期限切れのまま残る
+    void fetch() {
+        if (!guard(FETCH_BLOCK_MS)) return;                     // 次のループで再判定
+        if (rnd(0, 1)) block(rnd(2000, 7000));                  // WiFi 再接続
+        while (fetch_src_left > 0) {
+            if (new_policy && (midiPlaying() || !guard(FETCH_URL_BLOCK_MS))) return;
+            block(rnd(1500, 5000));                             // TLS 接続 + ヘッダー
+            work(rnd(2000, 8000), 30, false);                   // 本文受信（行ごと / 受信待ち）
+            fetch_src_left--;
+        }
+        block(30);                                              // ソート・公開
+        block(250);                                             // SD スナップショット
+        fetch_src_left = SOURCES;
+        next_fetch = t + 300000;
+    }
+
+    // 画面ごとの1ループ分の処理（割り込めない EPD 描画の見込み: GC16 全画面 600ms
+    //   = 転送 + 次の SPI アクセス前のリフレッシュ待ち、DU4 部分更新 280ms）
+    void screenWork() {
+        bool touch = t >= next_touch;
+        switch (state) {
+        case S_LIST:
+            if (t >= next_heartbeat) { block(40); next_heartbeat = t + 5000; }
+            if (t >= next_refresh)   { block(350); next_refresh = t + 60000; }
+            if (t >= next_fetch)     fetch();
+            break;
+        case S_PLAYING:
+            if (!test_playing && !alarm_playing) {              // サウンドテスト開始（設定画面から）
+                block(rnd(50, 150) + 600);
+                test_playing = true;
+                test_end = t + 30000;
+            }
+            break;
+        case S_SETTINGS:
+            if (touch) { block(650); next_touch = t + 8000; }
+            if (t >= next_msg) { work(rnd(2000, 3000), 20, true); next_msg = t + 60000; }   // 結果メッセージ待ち
+            break;
+        case S_KEYBOARD:    if (touch) { block(280); next_touch = t + 1500; } break;
+        case S_MIDI_SELECT: if (touch) { block(100 + 600); next_touch = t + 10000; } break;   // SD 一覧 + 描画
+        case S_BAUD_SELECT:
+        case S_PORT_SELECT: if (touch) { block(600); next_touch = t + 10000; } break;
+        case S_DETAIL:      if (touch) { block(500); next_touch = t + 6000; } break;
+        case S_MONTH:       if (touch) { block(700); next_touch = t + 6000; } break;
+        case S_SEARCH:      if (touch) { block(40 + 650); next_touch = t + 8000; } break;
+        }
+    }
+
+    void run() {
+        uint64_t end = DWELL_MS * S_COUNT;
+        while (t < end) {
+            // 滞在時間ごとに次の画面へ（鳴動中・サウンドテスト中は切り替えない）
+            int want = (int)(t / DWELL_MS) % S_COUNT;
+            if (!midiPlaying() && state != want) state = want;
+            t += rnd(1, 3);                                     // スイッチ・タッチ確認
+            if (alarm_playing && t >= play_end) finishAlarm();
+            if (test_playing && t >= test_end) { test_playing = false; state = S_LIST; t += 600; }
+            if (new_policy || state == S_LIST) service();       // ループ先頭の checkAlarms
+            if (!alarm_playing) screenWork();
+        }
+    }
+};
+
+int main(int argc, char** argv) {
+    uint32_t seed = argc > 1 ? (uint32_t)atoi(argv[1]) : 1;
+    Sim old_sim(false, seed), new_sim(true, seed);
+    old_sim.run();
+    new_sim.run();
+
+    printf("alarm latency by screen (due -> MIDI start), %d alarms, budget %dms\n\n",
+           (int)new_sim.alarms.size(), ALARM_LATENCY_BUDGET_MS);
+    printf("%-14s | %6s %9s %9s | %6s %9s %9s %5s\n",
+           "screen", "old n", "avg ms", "worst ms", "new n", "avg ms", "worst ms", "over");
+    bool ok = true;
+    for (int s = 0; s < S_COUNT; s++) {
+        const AlarmLatencyStats& o = old_sim.lat[s];
+        const AlarmLatencyStats& n = new_sim.lat[s];
+        printf("%-14s | %6u %9u %9u | %6u %9u %9u %5u\n", state_names[s],
+               o.count, o.avg(), o.worst_ms, n.count, n.avg(), n.worst_ms, n.over_budget);
+        if (n.count == 0 || n.worst_ms >= ALARM_LATENCY_BUDGET_MS) ok = false;
+    }
+    printf("\nold: %d alarms never fired before the run ended (left on a non-list screen)\n",
+           (int)(old_sim.alarms.size() - old_sim.next));
+    for (const Sim* s : { &old_sim, &new_sim }) {
+        const AlarmHistogram& h = s->hist;
+        printf("%s: all screens p50<=%u p95<=%u p99<=%u max %u sd %u |", s->new_policy ? "new" : "old",
+               h.percentile(50), h.percentile(95), h.percentile(99), h.worst_ms, h.stddev());
+        for (int b = 0; b < ALARM_HIST_BUCKETS; b++) printf(" %u", h.bucket[b]);
+        printf("\n");
+    }
+    printf("new: fetch held for alarm on %u loop checks, queued behind a playing alarm %u times\n",
+           new_sim.fetch_held, new_sim.queued);
+    printf("%s\n", ok ? "PASS: every screen under budget" : "FAIL: budget exceeded or screen not covered");
+    return ok ? 0 : 1;
+}
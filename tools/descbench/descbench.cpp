@@ -0,0 +1,144 @@
+//==============================================================================
+// descbench — 説明文圧縮（text_codec）のホスト側ベンチマーク
+//
+//   ICS ファイルを渡すと端末と同じ ics_core.cpp の行パーサーで DESCRIPTION を取り出し、
+//   省略時は会議招待風の合成データを使う。DESC_PACK_MIN 以上の説明文について
+//   往復一致・圧縮率・展開時間を測り、本文プール消費（summary 平均込み）の変化から
+//   同じプールに入るイベント数の倍率を出す。
+//
+// ビルド（リポジトリのルートで）:
+//   g++ -std=c++17 -O2 -I. tools/descbench/descbench.cpp text_codec.cpp ics_core.cpp -o descbench
+//
+// 使い方:
+//   descbench [calendar.ics ...]
+//==============================================================================
+#include "ics_core.h"
+#include "text_codec.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+static const int DESC_PACK_MIN  = 256;      // types.h と同値
+static const int MAX_DESC_BYTES = 3500;     // config.max_desc_bytes 既定値
+
+static double nowUs() {
+    using namespace std::chrono;
+    return duration<double, std::micro>(steady_clock::now().time_since_epoch()).count();
+}
+
+// RFC 5545 unfold 付きで VEVENT を読み、DESCRIPTION / SUMMARY を集める
+static void loadIcs(const char* path, std::vector<std::string>& descs, std::vector<std::string>& sums) {
+    FILE* fp = fopen(path, "rb");
+    if (!fp) { perror(path); return; }
+    static char summary[ICS_SUMMARY_BUF];
+    static char desc[ICS_DESC_BUF];
+    IcsVEvent ev;
+    icsVEventInit(ev, summary, sizeof(summary), desc, sizeof(desc));
+    std::string line, cur;
+    int c;
+    auto flush = [&]() {
+        if (cur.empty()) return;
+        std::vector<char> buf(ICS_LINE_BUF);
+        safeCopy(buf.data(), cur.c_str(), ICS_LINE_BUF);
+        if (icsFeedLine(ev, buf.data()) == ICS_LINE_END_EVENT) {
+            descs.push_back(ev.desc);
+            sums.push_back(ev.summary);
+        }
+    };
+    while ((c = fgetc(fp)) != EOF) {
+        if (c == '\r') continue;
+        if (c != '\n') { line.push_back((char)c); continue; }
+        if (!line.empty() && (line[0] == ' ' || line[0] == '\t')) cur.append(line, 1, std::string::npos);
+        else { flush(); cur = line; }
+        line.clear();
+    }
+    if (!line.empty()) { flush(); cur = line; }
+    flush();
+    fclose(fp);
+}
+
+// 会議招待風の合成説明文（URL・定型文・箇条書き・日本語混在）
+static void synth(std::vector<std::string>& descs, std::vector<std::string>& sums, int n) {
+    const char* topics[] = { "週次定例", "設計レビュー", "1on1", "Sprint Planning", "顧客打合せ" };
+    const char* items[] = { "進捗共有", "課題の洗い出し", "リリース判定", "次回までのアクション",
+                            "Budget review", "Open questions", "デモ", "議事録担当の確認" };
+    srand(7);
+    for (int i = 0; i < n; i++) {
+        std::string d;
+        char buf[256];
+        snprintf(buf, sizeof(buf), "%s へようこそ。\n参加URL: https://zoom.us/j/%09d?pwd=%08x\n"
+                 "ミーティングID: %03d %04d %04d\nパスコード: %06d\n\n",
+                 topics[i % 5], rand() % 1000000000, rand(), rand() % 1000, rand() % 10000,
+                 rand() % 10000, rand() % 1000000);
+        d += buf;
+        d += "■ アジェンダ\n";
+        int k = 3 + rand() % 6;
+        for (int j = 0; j < k; j++) {
+            snprintf(buf, sizeof(buf), "  %d. %s（%d分）\n", j + 1, items[rand() % 8], 5 + rand() % 20);
+            d += buf;
+        }
+        d += "\n資料: https://docs.example.com/drive/folders/shared/team-weekly/\n"
+             "ワンタップモバイル: +81524564439,,0000000000# 日本\n"
+             "お近くの電話番号を検索: https://zoom.us/u/abcdefg\n"
+             "-::~:~::~:~:~:~:~:~:~:~:~:~:~:~:~:~:~:~:~:~:~:~:~:~:~:~:~:~:~:~::~:~::-\n"
+             "Google Meet で参加するには、このリンクをクリックしてください。\n"
+             "このイベントに関するご質問は主催者までお問い合わせください。\n";
+        if ((int)d.size() > MAX_DESC_BYTES) d.resize(MAX_DESC_BYTES);
+        descs.push_back(d);
+        sums.push_back(topics[i % 5]);
+    }
+}
+
+int main(int argc, char** argv) {
+    std::vector<std::string> descs, sums;
+    for (int i = 1; i < argc; i++) loadIcs(argv[i], descs, sums);
+    bool synthetic = descs.empty();
+    if (synthetic) synth(descs, sums, 500);
+
+    std::vector<uint16_t> table(LZ_HASH_SIZE);
+    std::vector<uint8_t> packed(MAX_DESC_BYTES + 16), out(MAX_DESC_BYTES + 16);
+    size_t raw_total = 0, stored_total = 0, sum_total = 0, packed_n = 0, packable = 0;
+    double comp_us = 0, dec_us = 0, dec_max = 0;
+    int mismatch = 0;
+
+    for (size_t i = 0; i < descs.size(); i++) {
+        const std::string& d = descs[i];
+        size_t len = d.size();
+        sum_total += sums[i].size() + 1;
+        raw_total += len + 1;
+        if ((int)len < DESC_PACK_MIN) { stored_total += len + 1; continue; }
+        packable++;
+        size_t cap = len - len / 8;
+        double t0 = nowUs();
+        size_t n = lzCompress((const uint8_t*)d.data(), len, packed.data(), cap - 2, table.data());
+        comp_us += nowUs() - t0;
+        if (n == 0) { stored_total += len + 1; continue; }
+        packed_n++;
+        stored_total += n + 2 + 1;
+
+        t0 = nowUs();
+        size_t m = lzDecompress(packed.data(), n, out.data(), out.size());
+        double dt = nowUs() - t0;
+        dec_us += dt;
+        if (dt > dec_max) dec_max = dt;
+        if (m != len || memcmp(out.data(), d.data(), len) != 0) mismatch++;
+    }
+
+    printf("%s: %zu descriptions, %zu >= %d bytes, %zu packed, %d round-trip mismatches\n",
+           synthetic ? "synthetic" : "ics", descs.size(), packable, DESC_PACK_MIN, packed_n, mismatch);
+    printf("description bytes: raw %zu -> stored %zu (%.1f%%)\n",
+           raw_total, stored_total, raw_total ? 100.0 * stored_total / raw_total : 0.0);
+    if (packed_n) {
+        printf("compress: avg %.1f us   decompress: avg %.1f us, max %.1f us (host)\n",
+               comp_us / packable, dec_us / packed_n, dec_max);
+    }
+    // 1イベントの本文プール消費 = summary + description + midi(空=1byte)
+    double before = (double)(raw_total + sum_total + descs.size()) / descs.size();
+    double after = (double)(stored_total + sum_total + descs.size()) / descs.size();
+    printf("text pool per event: %.0f -> %.0f bytes  (x%.2f events per pool)\n",
+           before, after, before / after);
+    return mismatch ? 1 : 0;
+}
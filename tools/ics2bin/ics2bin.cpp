@@ -0,0 +1,631 @@
+//==============================================================================
+// ics2bin — ICS → M5EV バイナリイベントフィード変換ツール（Linux / macOS）
+//
+//   端末と同じ ics_core.cpp（行パーサー・parseDT・parseAlarmMarker・HTML 整形）で解析し、
+//   端末では重い処理をここで済ませる:
+//     - RRULE の展開（FREQ=DAILY/WEEKLY/MONTHLY/YEARLY、INTERVAL・COUNT・UNTIL、
+//       BYDAY（MONTHLY は 2TU / -1FR も可）・BYMONTHDAY（MONTHLY）・BYMONTH（YEARLY））。
+//       EXDATE の回は除き、RECURRENCE-ID で上書きされた回は上書き側の VEVENT を使う。
+//       それ以外の BY* を含む規則は展開せず DTSTART の1回だけ出力する（件数を表示）
+//     - TZID 付きの日時をそのタイムゾーン（/usr/share/zoneinfo）で解釈する。
+//       未知の TZID（Windows 名など）は端末と同じく JST とみなす
+//     - summary / description の HTML を整形（端末の詳細画面と同じ規則）。
+//       レコードに M5EV_FLAG_PLAIN_TEXT を付け、端末は表示時の整形を省く
+//   表示ウィンドウ [now-7日, now+30日) に絞り込んで start 昇順で書き出す。
+//   レコード＋プールが端末の上限（M5EV_MAX_BODY）を超える場合は先の予定から削って収める。
+//   出力を Content-Type: application/x-m5ev で配信すると、端末は ICS 解析を
+//   省略してレコードをそのまま取り込む。
+//
+// ビルド（リポジトリのルートで）:
+//   g++ -std=c++17 -O2 -I. tools/ics2bin/ics2bin.cpp ics_core.cpp -o ics2bin
+//
+// 使い方:
+//   ics2bin [-n UNIX秒] input.ics output.m5ev
+//     -n : ウィンドウ基準時刻（省略時は現在時刻）
+//==============================================================================
+#include "ics_core.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <vector>
+#include <string>
+#include <set>
+#include <utility>
+#include <algorithm>
+
+static const int PAST_WINDOW_SEC   = 7 * 86400;     // commitEvent と同じ
+static const int FUTURE_WINDOW_SEC = 30 * 86400;
+static const int MAX_DESC_BYTES    = 3500;          // config.max_desc_bytes 既定値
+static const int RRULE_MAX_PERIODS = 200000;        // 展開の打ち切り（壊れた規則で回り続けない）
+
+struct Event {
+    time_t start;
+    uint32_t uid_hash;
+    bool is_allday;
+    bool has_alarm;
+    bool midi_is_url;
+    bool expanded;          // RRULE から作った回（RECURRENCE-ID の上書き対象）
+    int duration_sec, repeat_count;
+    int offsets[M5EV_MAX_ALARMS];
+    int off_n;
+    std::string summary, desc, midi;
+};
+
+// ics_core が読まない VEVENT のプロパティ（ここでだけ使う）
+struct Extra {
+    std::string dt_tzid;
+    std::string rrule;
+    std::vector<std::pair<std::string, std::string>> exdates;   // (TZID, 値)
+    std::string rid_tzid, rid;                                  // RECURRENCE-ID
+    void clear() { dt_tzid.clear(); rrule.clear(); exdates.clear(); rid_tzid.clear(); rid.clear(); }
+};
+
+struct Stats {
+    int rrule_expanded = 0;     // 展開した VEVENT
+    int rrule_unsupported = 0;  // 展開できず DTSTART のみ
+    int instances = 0;          // 展開で作った回（ウィンドウ内）
+    int exdates = 0;
+    int overridden = 0;
+    int tz_unknown = 0;
+};
+static Stats stats;
+
+//------------------------------------------------------------------------------
+// RFC 5545 unfold: 次行が空白/タブで始まる場合は結合して論理行を返す
+//------------------------------------------------------------------------------
+struct LineReader {
+    FILE* fp = nullptr;
+    std::string pending = {};
+    bool has_pending = false;
+
+    bool readRaw(std::string& out) {
+        out.clear();
+        int c;
+        bool any = false;
+        while ((c = fgetc(fp)) != EOF) {
+            any = true;
+            if (c == '\r') continue;
+            if (c == '\n') return true;
+            out.push_back((char)c);
+        }
+        return any;
+    }
+
+    bool next(std::string& line) {
+        if (has_pending) { line = pending; has_pending = false; }
+        else if (!readRaw(line)) return false;
+
+        std::string nx;
+        while (readRaw(nx)) {
+            if (!nx.empty() && (nx[0] == ' ' || nx[0] == '\t')) {
+                line.append(nx, 1, std::string::npos);
+            } else {
+                pending = nx; has_pending = true;
+                break;
+            }
+        }
+        return true;
+    }
+};
+
+// UTF-8境界で max バイト以下に切り詰め（端末側 commitEvent と同じ規則）
+static void cutUtf8(std::string& s, size_t max) {
+    if (s.size() <= max) return;
+    size_t cut = max;
+    while (cut > 0 && ((uint8_t)s[cut] & 0xC0) == 0x80) cut--;
+    s.resize(cut);
+}
+
+static std::string htmlToText(const char* s) {
+    int len = (int)strlen(s);
+    std::vector<char> out(len + 1);
+    int n = icsSimplifyHtml(s, len, out.data());
+    return std::string(out.data(), n);
+}
+
+//------------------------------------------------------------------------------
+// プロパティ行 "NAME;PARAM=V;TZID=X:VALUE" の分解
+//------------------------------------------------------------------------------
+static bool propSplit(const std::string& line, const char* name, std::string& tzid, std::string& value) {
+    size_t nl = strlen(name);
+    if (line.compare(0, nl, name) != 0 || line.size() <= nl || (line[nl] != ':' && line[nl] != ';')) return false;
+    // 値の始まり: 引用符の外の最初の ':'
+    bool quoted = false;
+    size_t colon = std::string::npos;
+    for (size_t i = nl; i < line.size(); i++) {
+        if (line[i] == '"') quoted = !quoted;
+        else if (line[i] == ':' && !quoted) { colon = i; break; }
+    }
+    if (colon == std::string::npos) return false;
+    value = line.substr(colon + 1);
+    while (!value.empty() && (value.back() == ' ' || value.back() == '\t')) value.pop_back();
+    tzid.clear();
+    size_t p = line.find(";TZID=", nl);
+    if (p != std::string::npos && p < colon) {
+        size_t b = p + 6, e = b;
+        if (b < colon && line[b] == '"') { b++; e = line.find('"', b); if (e == std::string::npos || e > colon) e = colon; }
+        else { while (e < colon && line[e] != ';') e++; }
+        tzid = line.substr(b, e - b);
+    }
+    return true;
+}
+
+static void captureExtra(Extra& x, const std::string& line) {
+    std::string tz, v;
+    if (propSplit(line, "DTSTART", tz, v)) {
+        x.dt_tzid = tz;
+    } else if (propSplit(line, "RRULE", tz, v)) {
+        x.rrule = v;
+    } else if (propSplit(line, "EXDATE", tz, v)) {
+        size_t b = 0;
+        while (b <= v.size()) {
+            size_t e = v.find(',', b);
+            if (e == std::string::npos) e = v.size();
+            if (e > b) x.exdates.push_back({ tz, v.substr(b, e - b) });
+            b = e + 1;
+        }
+    } else if (propSplit(line, "RECURRENCE-ID", tz, v)) {
+        x.rid_tzid = tz;
+        x.rid = v;
+    }
+}
+
+//------------------------------------------------------------------------------
+// タイムゾーン（空 = 端末と同じ TZ_JST）
+//------------------------------------------------------------------------------
+static bool zoneKnown(const std::string& tzid) {
+    if (tzid.empty() || tzid.find("..") != std::string::npos || tzid[0] == '/') return false;
+    return access(("/usr/share/zoneinfo/" + tzid).c_str(), R_OK) == 0;
+}
+
+// TZID を使えるタイムゾーン名に（未知なら空 = JST とみなす）
+static std::string resolveZone(const std::string& tzid) {
+    if (tzid.empty()) return "";
+    if (zoneKnown(tzid)) return tzid;
+    static std::set<std::string> warned;
+    if (warned.insert(tzid).second) {
+        fprintf(stderr, "warning: unknown TZID \"%s\" - treated as local (JST)\n", tzid.c_str());
+        stats.tz_unknown++;
+    }
+    return "";
+}
+
+static void useZone(const std::string& zone) {
+    setenv("TZ", zone.empty() ? TZ_JST : zone.c_str(), 1);
+    tzset();
+}
+
+static time_t mkLocal(int y, int mo, int d, int h, int mi, int se, const std::string& zone) {
+    struct tm t = {};
+    t.tm_year = y - 1900; t.tm_mon = mo - 1; t.tm_mday = d;
+    t.tm_hour = h; t.tm_min = mi; t.tm_sec = se;
+    t.tm_isdst = -1;            // 夏時間はその日付で判定
+    useZone(zone);
+    time_t r = mktime(&t);
+    useZone("");
+    return r;
+}
+
+// 日時の値を zone で解釈（末尾 Z は UTC、日付のみ・zone 空は端末と同じく JST）
+//   parseDT は夏時間のない JST 前提（tm_isdst=0）なので、zone 付きは UTC で数字だけ読み、
+//   その壁時計を zone で引き直す
+static bool parseIn(const std::string& value, const std::string& zone, time_t& out, bool& allday) {
+    bool utc = !value.empty() && value.back() == 'Z';
+    if (utc || zone.empty() || value.size() == 8) return parseDT(value.c_str(), out, allday);
+    time_t wall;
+    if (!parseDT((value + "Z").c_str(), wall, allday)) return false;
+    struct tm f;
+    gmtime_r(&wall, &f);
+    out = mkLocal(f.tm_year + 1900, f.tm_mon + 1, f.tm_mday, f.tm_hour, f.tm_min, f.tm_sec, zone);
+    return out != (time_t)-1;
+}
+
+static struct tm tmLocal(time_t t, const std::string& zone) {
+    struct tm r;
+    useZone(zone);
+    localtime_r(&t, &r);
+    useZone("");
+    return r;
+}
+
+//------------------------------------------------------------------------------
+// RRULE
+//------------------------------------------------------------------------------
+static int64_t daysFromCivil(int y, int m, int d) {
+    y -= m <= 2;
+    int64_t era = (y >= 0 ? y : y - 399) / 400;
+    int64_t yoe = y - era * 400;
+    int64_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+static void civilFromDays(int64_t z, int& y, int& m, int& d) {
+    z += 719468;
+    int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    int64_t doe = z - era * 146097;
+    int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    int64_t mp = (5 * doy + 2) / 153;
+    d = (int)(doy - (153 * mp + 2) / 5 + 1);
+    m = (int)(mp < 10 ? mp + 3 : mp - 9);
+    y = (int)(yoe + era * 400 + (m <= 2));
+}
+
+static int weekdayOf(int64_t days) { return (int)(((days + 4) % 7 + 7) % 7); }    // 0=日曜
+
+static int daysInMonth(int y, int m) {
+    static const int dim[12] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    bool leap = (y % 4 == 0 && y % 100 != 0) || y % 400 == 0;
+    return (m == 2 && leap) ? 29 : dim[m - 1];
+}
+
+enum Freq { FREQ_NONE, FREQ_DAILY, FREQ_WEEKLY, FREQ_MONTHLY, FREQ_YEARLY };
+
+struct Rule {
+    Freq freq = FREQ_NONE;
+    int interval = 1;
+    int count = -1;
+    bool has_until = false;
+    time_t until = 0;
+    std::vector<std::pair<int, int>> byday;     // (序数 0=毎週, 曜日 0=日曜)
+    std::vector<int> bymonthday;
+    std::vector<int> bymonth;
+};
+
+static bool parseRule(const std::string& s, const std::string& zone, Rule& r) {
+    static const char* const wd_names[7] = { "SU", "MO", "TU", "WE", "TH", "FR", "SA" };
+    size_t b = 0;
+    while (b < s.size()) {
+        size_t e = s.find(';', b);
+        if (e == std::string::npos) e = s.size();
+        std::string part = s.substr(b, e - b);
+        b = e + 1;
+        size_t eq = part.find('=');
+        if (eq == std::string::npos) continue;
+        std::string k = part.substr(0, eq), v = part.substr(eq + 1);
+        if (k == "FREQ") {
+            r.freq = v == "DAILY" ? FREQ_DAILY : v == "WEEKLY" ? FREQ_WEEKLY :
+                     v == "MONTHLY" ? FREQ_MONTHLY : v == "YEARLY" ? FREQ_YEARLY : FREQ_NONE;
+            if (r.freq == FREQ_NONE) return false;
+        } else if (k == "INTERVAL") {
+            r.interval = atoi(v.c_str());
+            if (r.interval < 1) return false;
+        } else if (k == "COUNT") {
+            r.count = atoi(v.c_str());
+        } else if (k == "UNTIL") {
+            bool allday;
+            if (!parseIn(v, zone, r.until, allday)) return false;
+            if (v.size() == 8) r.until += 86400 - 1;    // 日付のみ = その日の終わりまで
+            r.has_until = true;
+        } else if (k == "BYDAY" || k == "BYMONTHDAY" || k == "BYMONTH") {
+            size_t p = 0;
+            while (p < v.size()) {
+                size_t q = v.find(',', p);
+                if (q == std::string::npos) q = v.size();
+                std::string item = v.substr(p, q - p);
+                p = q + 1;
+                if (k == "BYDAY") {
+                    if (item.size() < 2) return false;
+                    std::string wd = item.substr(item.size() - 2);
+                    int w = -1;
+                    for (int i = 0; i < 7; i++) if (wd == wd_names[i]) w = i;
+                    if (w < 0) return false;
+                    int ord = item.size() > 2 ? atoi(item.substr(0, item.size() - 2).c_str()) : 0;
+                    r.byday.push_back({ ord, w });
+                } else if (k == "BYMONTHDAY") {
+                    r.bymonthday.push_back(atoi(item.c_str()));
+                } else {
+                    r.bymonth.push_back(atoi(item.c_str()));
+                }
+            }
+        } else if (k == "WKST") {
+            // 週の始まりは MO 固定で扱う
+        } else {
+            return false;       // BYSETPOS・BYHOUR・BYWEEKNO・BYYEARDAY 等は未対応
+        }
+    }
+    if (r.freq == FREQ_NONE) return false;
+    bool ordinal = false;
+    for (auto& d : r.byday) if (d.first != 0) ordinal = true;
+    switch (r.freq) {
+    case FREQ_DAILY:
+    case FREQ_WEEKLY:  return !ordinal && r.bymonthday.empty() && r.bymonth.empty();
+    case FREQ_MONTHLY: return r.bymonth.empty() && (r.byday.empty() || r.bymonthday.empty());
+    case FREQ_YEARLY:  return r.byday.empty() && r.bymonthday.empty();
+    default:           return false;
+    }
+}
+
+// 期間 k（DTSTART の期間から INTERVAL 刻み）の候補日（日数、昇順）
+static void periodDays(const Rule& r, int64_t base_days, int by, int bm, int bd, int k, std::vector<int64_t>& out) {
+    out.clear();
+    switch (r.freq) {
+    case FREQ_DAILY: {
+        int64_t d = base_days + (int64_t)k * r.interval;
+        bool ok = r.byday.empty();
+        for (auto& w : r.byday) if (w.second == weekdayOf(d)) ok = true;
+        if (ok) out.push_back(d);
+        break;
+    }
+    case FREQ_WEEKLY: {
+        int64_t monday = base_days - (weekdayOf(base_days) + 6) % 7 + (int64_t)k * 7 * r.interval;
+        if (r.byday.empty()) out.push_back(monday + (weekdayOf(base_days) + 6) % 7);
+        for (auto& w : r.byday) out.push_back(monday + (w.second + 6) % 7);
+        break;
+    }
+    case FREQ_MONTHLY: {
+        int mi = (by * 12 + bm - 1) + k * r.interval;
+        int y = mi / 12, m = mi % 12 + 1;
+        int dim = daysInMonth(y, m);
+        int64_t first = daysFromCivil(y, m, 1);
+        if (!r.bymonthday.empty()) {
+            for (int v : r.bymonthday) {
+                int d = v > 0 ? v : dim + 1 + v;
+                if (d >= 1 && d <= dim) out.push_back(first + d - 1);
+            }
+        } else if (!r.byday.empty()) {
+            for (auto& w : r.byday) {
+                int d1 = 1 + (w.second - weekdayOf(first) + 7) % 7;     // その曜日の初回
+                if (w.first == 0) {
+                    for (int d = d1; d <= dim; d += 7) out.push_back(first + d - 1);
+                } else if (w.first > 0) {
+                    int d = d1 + 7 * (w.first - 1);
+                    if (d <= dim) out.push_back(first + d - 1);
+                } else {
+                    int last = d1 + 7 * ((dim - d1) / 7);
+                    int d = last + 7 * (w.first + 1);
+                    if (d >= 1) out.push_back(first + d - 1);
+                }
+            }
+        } else if (bd <= dim) {
+            out.push_back(first + bd - 1);
+        }
+        break;
+    }
+    case FREQ_YEARLY: {
+        int y = by + k * r.interval;
+        std::vector<int> months = r.bymonth.empty() ? std::vector<int>{ bm } : r.bymonth;
+        for (int m : months) {
+            if (m >= 1 && m <= 12 && bd <= daysInMonth(y, m)) out.push_back(daysFromCivil(y, m, bd));
+        }
+        break;
+    }
+    default:
+        break;
+    }
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+}
+
+// DTSTART を1回目として、(lo, hi) に入る回の開始時刻を返す。展開できない規則なら false
+static bool expandRule(const std::string& rrule, time_t dtstart, const std::string& zone,
+                       time_t lo, time_t hi, std::vector<time_t>& out) {
+    Rule r;
+    if (!parseRule(rrule, zone, r)) return false;
+    struct tm b = tmLocal(dtstart, zone);
+    int by = b.tm_year + 1900, bm = b.tm_mon + 1, bd = b.tm_mday;
+    int64_t base_days = daysFromCivil(by, bm, bd);
+
+    int n = 1;                                  // DTSTART が1回目
+    if (dtstart > lo && dtstart < hi) out.push_back(dtstart);
+    std::vector<int64_t> days;
+    for (int k = 0; k < RRULE_MAX_PERIODS; k++) {
+        periodDays(r, base_days, by, bm, bd, k, days);
+        for (int64_t d : days) {
+            int y, m, dd;
+            civilFromDays(d, y, m, dd);
+            time_t t = mkLocal(y, m, dd, b.tm_hour, b.tm_min, b.tm_sec, zone);
+            if (t <= dtstart) continue;
+            if ((r.count >= 0 && n >= r.count) || (r.has_until && t > r.until) || t >= hi) return true;
+            n++;
+            if (t > lo) out.push_back(t);
+        }
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------
+// VEVENT → Event（RRULE なら回ごと）
+//------------------------------------------------------------------------------
+static void buildEvents(const IcsVEvent& ev, const Extra& x, time_t now, std::vector<Event>& out,
+                        std::set<std::pair<uint32_t, time_t>>& overrides) {
+    Event base;
+    std::string zone = resolveZone(x.dt_tzid);
+    if (!parseIn(ev.dtstart_raw, zone, base.start, base.is_allday)) return;
+    if (base.is_allday) zone = "";          // 終日は浮動日付（端末のローカル日付）
+    base.uid_hash = ev.uid_hash;
+    base.expanded = false;
+
+    if (!x.rid.empty()) {
+        time_t rid;
+        bool allday;
+        std::string rz = x.rid_tzid.empty() ? zone : resolveZone(x.rid_tzid);
+        if (parseIn(x.rid, rz, rid, allday)) overrides.insert({ ev.uid_hash, rid });
+    }
+
+    char midi[ICS_MIDI_FILE_BUF];
+    midi[0] = '\0';
+    base.midi_is_url = false;
+    base.duration_sec = -1;
+    base.repeat_count = -1;
+    base.off_n = 0;
+    base.has_alarm = false;
+    // オフセット未指定は M5EV_OFFSET_DEFAULT のまま出力 → 端末の alarm_offset を適用
+    //   マーカーは整形前の本文から読む（端末の ICS 取り込みと同じ）
+    parseAlarmMarker(ev.summary, true, base.offsets, base.off_n, M5EV_MAX_ALARMS,
+                     base.has_alarm, midi, sizeof(midi), base.midi_is_url,
+                     base.duration_sec, base.repeat_count, M5EV_OFFSET_DEFAULT);
+    if (!base.has_alarm && ev.desc[0] != '\0') {
+        parseAlarmMarker(ev.desc, false, base.offsets, base.off_n, M5EV_MAX_ALARMS,
+                         base.has_alarm, midi, sizeof(midi), base.midi_is_url,
+                         base.duration_sec, base.repeat_count, M5EV_OFFSET_DEFAULT);
+    }
+    base.summary = htmlToText(ev.summary);
+    base.desc = htmlToText(ev.desc);
+    base.midi = midi;
+    cutUtf8(base.summary, ICS_SUMMARY_BUF - 1);
+    cutUtf8(base.desc, MAX_DESC_BYTES);
+
+    time_t lo = now - PAST_WINDOW_SEC, hi = now + FUTURE_WINDOW_SEC;
+    std::vector<time_t> starts;
+    if (!x.rrule.empty() && expandRule(x.rrule, base.start, zone, lo, hi, starts)) {
+        stats.rrule_expanded++;
+        base.expanded = true;
+    } else {
+        if (!x.rrule.empty()) stats.rrule_unsupported++;
+        if (base.start > lo && base.start < hi) starts.push_back(base.start);
+    }
+
+    std::vector<time_t> ex;
+    for (auto& e : x.exdates) {
+        time_t t;
+        bool allday;
+        std::string ez = e.first.empty() ? zone : resolveZone(e.first);
+        if (parseIn(e.second, ez, t, allday)) ex.push_back(t);
+    }
+    for (time_t t : starts) {
+        if (std::find(ex.begin(), ex.end(), t) != ex.end()) { stats.exdates++; continue; }
+        Event e = base;
+        e.start = t;
+        out.push_back(e);
+        if (base.expanded) stats.instances++;
+    }
+}
+
+static uint32_t poolAdd(std::string& pool, const std::string& s) {
+    uint32_t off = (uint32_t)pool.size();
+    pool += s;
+    return off;
+}
+
+static size_t recordBytes(const Event& e) {
+    return sizeof(M5evRecord) + e.summary.size() + e.desc.size() + e.midi.size();
+}
+
+int main(int argc, char** argv) {
+    time_t now = time(nullptr);
+    int argi = 1;
+    if (argi + 1 < argc && strcmp(argv[argi], "-n") == 0) {
+        now = (time_t)strtoll(argv[argi + 1], nullptr, 10);
+        argi += 2;
+    }
+    if (argc - argi != 2) {
+        fprintf(stderr, "usage: %s [-n unix_time] input.ics output.m5ev\n", argv[0]);
+        return 2;
+    }
+
+    // 端末と同じローカルタイムゾーンで DTSTART（浮動時刻）を解釈する
+    useZone("");
+
+    FILE* in = fopen(argv[argi], "rb");
+    if (!in) { perror(argv[argi]); return 1; }
+
+    static char summary[ICS_SUMMARY_BUF];
+    static char desc[ICS_DESC_BUF];
+    IcsVEvent ev;
+    icsVEventInit(ev, summary, sizeof(summary), desc, sizeof(desc));
+
+    std::vector<Event> events;
+    std::set<std::pair<uint32_t, time_t>> overrides;    // RECURRENCE-ID で上書きされた回
+    Extra extra;
+    LineReader reader;
+    reader.fp = in;
+    std::string raw;
+    std::vector<char> line(ICS_LINE_BUF);
+    int parsed = 0;
+    while (reader.next(raw)) {
+        if (raw == "BEGIN:VEVENT") extra.clear();
+        else if (ev.in_event) captureExtra(extra, raw);
+        // 端末の readUnfoldedLine と同じく LINE_BUF で切り詰め
+        safeCopy(line.data(), raw.c_str(), ICS_LINE_BUF);
+        if (icsFeedLine(ev, line.data()) != ICS_LINE_END_EVENT) continue;
+        parsed++;
+        buildEvents(ev, extra, now, events, overrides);
+    }
+    fclose(in);
+
+    if (!overrides.empty()) {
+        size_t before = events.size();
+        events.erase(std::remove_if(events.begin(), events.end(), [&](const Event& e) {
+            return e.expanded && overrides.count({ e.uid_hash, e.start });
+        }), events.end());
+        stats.overridden = (int)(before - events.size());
+        stats.instances -= stats.overridden;
+    }
+
+    std::stable_sort(events.begin(), events.end(),
+                     [](const Event& a, const Event& b) { return a.start < b.start; });
+    if (events.size() > 0xFFFF) events.resize(0xFFFF);
+
+    // 端末の上限に収まるまで先の予定から削る（上限を超えたフィードは端末が丸ごと捨てる）
+    size_t body = 0;
+    for (const Event& e : events) body += recordBytes(e);
+    size_t dropped = 0;
+    while (body > M5EV_MAX_BODY && !events.empty()) {
+        body -= recordBytes(events.back());
+        events.pop_back();
+        dropped++;
+    }
+    if (dropped > 0) {
+        char until[32] = "-";
+        if (!events.empty()) {
+            struct tm lt;
+            localtime_r(&events.back().start, &lt);
+            strftime(until, sizeof(until), "%Y-%m-%d %H:%M", &lt);
+        }
+        fprintf(stderr, "warning: body exceeded device limit %d bytes - dropped the last %zu events (kept until %s)\n",
+                M5EV_MAX_BODY, dropped, until);
+    }
+
+    std::string pool;
+    std::vector<M5evRecord> recs;
+    int alarms = 0;
+    for (const Event& e : events) {
+        M5evRecord r;
+        memset(&r, 0, sizeof(r));
+        r.start = (int64_t)e.start;
+        r.summary_off = poolAdd(pool, e.summary);
+        r.summary_len = (uint16_t)e.summary.size();
+        r.desc_off = poolAdd(pool, e.desc);
+        r.desc_len = (uint16_t)e.desc.size();
+        r.midi_off = poolAdd(pool, e.midi);
+        r.midi_len = (uint8_t)e.midi.size();
+        r.flags = (e.is_allday ? M5EV_FLAG_ALLDAY : 0) |
+                  (e.has_alarm ? M5EV_FLAG_ALARM : 0) |
+                  (e.midi_is_url ? M5EV_FLAG_MIDI_URL : 0) |
+                  M5EV_FLAG_PLAIN_TEXT;
+        r.alarm_count = (uint8_t)e.off_n;
+        r.play_duration_sec = (int16_t)e.duration_sec;
+        r.play_repeat = (int16_t)e.repeat_count;
+        for (int k = 0; k < e.off_n; k++) r.offset_min[k] = (int16_t)e.offsets[k];
+        r.uid_hash = e.uid_hash;
+        if (e.has_alarm) alarms++;
+        recs.push_back(r);
+    }
+
+    M5evHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, M5EV_MAGIC, 4);
+    h.version = M5EV_VERSION;
+    h.header_size = sizeof(M5evHeader);
+    h.record_size = sizeof(M5evRecord);
+    h.count = (uint16_t)recs.size();
+    h.pool_size = (uint32_t)pool.size();
+    h.generated = (int64_t)time(nullptr);
+
+    FILE* out = fopen(argv[argi + 1], "wb");
+    if (!out) { perror(argv[argi + 1]); return 1; }
+    fwrite(&h, sizeof(h), 1, out);
+    if (!recs.empty()) fwrite(recs.data(), sizeof(M5evRecord), recs.size(), out);
+    fwrite(pool.data(), 1, pool.size(), out);
+    fclose(out);
+
+    printf("%d VEVENTs parsed, %zu in window (%d with alarm), %zu bytes written\n",
+           parsed, recs.size(), alarms, sizeof(h) + body);
+    printf("RRULE: %d expanded into %d instances (%d EXDATE, %d overridden), %d unsupported (first only)%s\n",
+           stats.rrule_expanded, stats.instances, stats.exdates, stats.overridden, stats.rrule_unsupported,
+           stats.tz_unknown ? ", unknown TZIDs treated as JST" : "");
+    return 0;
+}
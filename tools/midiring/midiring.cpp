@@ -0,0 +1,223 @@
+//==============================================================================
+// midiring — MIDI 出力リングのホスト側テスト
+//
+//   midi_ring.h をそのまま使って確かめる:
+//     spsc    書き手・読み手を別スレッドで回し、長さ1〜512バイトのレコードを
+//             折り返しをまたいで20万件流す。順序・時刻・中身が崩れないこと
+//     clear   読み手の clear() の後は、その後に積んだ分だけが読めること
+//     timing  仮想時計で60秒の曲を鳴らす。loop() は時々止まる（鳴動画面の pushCanvas・
+//             タッチ・ボタンの描き直し）。従来（loop() の中で期限の来た分を最大100件送る）と、
+//             MIDI_AHEAD_MS 先までリングに積んで出力タスクが時刻どおりに送る今の形の
+//             遅れを比べる。止まる時間（重なった分の合計）が先読みより短ければ
+//             遅れが 1ms 以下であること。先読みより長く止まる場合は比較だけ
+//   どれか破れば終了コード 1。
+//
+// ビルド（リポジトリのルートで）:
+//   g++ -std=c++17 -O2 -I. -pthread tools/midiring/midiring.cpp -o midiring
+//==============================================================================
+#include "midi_ring.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <vector>
+#include <random>
+#include <thread>
+#include <algorithm>
+
+#define MIDI_AHEAD_MS   500         // types.h と同じ値
+
+static MidiRing ring;
+
+static uint8_t patternByte(uint32_t seq, uint32_t i) {
+    return (uint8_t)(seq * 31 + i * 7 + (seq >> 8));
+}
+
+static bool testSpsc() {
+    const uint32_t N = 200000;
+    ring = MidiRing();
+    bool ok = true;
+    std::thread producer([] {
+        std::mt19937 rng(1);
+        uint8_t msg[MIDI_RING_MSG_MAX];
+        for (uint32_t seq = 0; seq < N; ) {
+            uint16_t len = (rng() % 8 == 0) ? (uint16_t)(1 + rng() % MIDI_RING_MSG_MAX) : (uint16_t)(1 + rng() % 3);
+            for (uint32_t i = 0; i < len; i++) msg[i] = patternByte(seq, i);
+            while (!ring.push(seq, msg, len)) std::this_thread::yield();
+            seq++;
+        }
+    });
+    uint8_t got[MIDI_RING_MSG_MAX];
+    for (uint32_t seq = 0; seq < N && ok; ) {
+        uint32_t at;
+        uint16_t len;
+        if (!ring.peek(&at, &len)) { std::this_thread::yield(); continue; }
+        if (at != seq || len == 0 || len > MIDI_RING_MSG_MAX) {
+            printf("  spsc: record %u has at=%u len=%u\n", seq, at, len);
+            ok = false;
+            break;
+        }
+        if (ring.pop(got) != len) { printf("  spsc: pop length mismatch at %u\n", seq); ok = false; break; }
+        for (uint32_t i = 0; i < len; i++) {
+            if (got[i] != patternByte(seq, i)) {
+                printf("  spsc: record %u byte %u corrupted\n", seq, i);
+                ok = false;
+                break;
+            }
+        }
+        seq++;
+    }
+    producer.join();
+    if (ok && !ring.empty()) { printf("  spsc: ring not empty at the end\n"); ok = false; }
+    printf("spsc: %s (%u records, peak %u/%uB)\n", ok ? "ok" : "FAIL", N, ring.peak, MIDI_RING_BYTES);
+    return ok;
+}
+
+static bool testClear() {
+    ring = MidiRing();
+    uint8_t msg[3] = { 0x90, 60, 100 };
+    for (uint32_t i = 0; i < 100; i++) ring.push(i, msg, 3);
+    ring.clear();
+    bool ok = ring.empty() && ring.room() == MIDI_RING_BYTES;
+    ring.push(777, msg, 3);
+    uint32_t at = 0;
+    uint16_t len = 0;
+    ok = ok && ring.peek(&at, &len) && at == 777 && len == 3;
+    printf("clear: %s\n", ok ? "ok" : "FAIL");
+    return ok;
+}
+
+//------------------------------------------------------------------------------
+// timing: 仮想時計（µs）
+//------------------------------------------------------------------------------
+struct Ev {
+    uint32_t at_us;     // 曲の先頭から
+    uint16_t len;
+};
+
+struct Stall {
+    const char* name;
+    uint32_t period_ms;
+    uint32_t len_ms;
+};
+
+struct LateStats {
+    uint32_t worst_us = 0;
+    uint32_t over5ms = 0;
+    void add(uint32_t late) {
+        if (late > worst_us) worst_us = late;
+        if (late > 5000) over5ms++;
+    }
+};
+
+static std::vector<Ev> makeSong(uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::vector<Ev> song;
+    song.push_back({ 0, 6 });               // 先頭の GM Reset（SysEx）
+    for (uint32_t t = 0; t < 60000000; ) {
+        int chord = 1 + rng() % 4;          // 和音はまとめて同じ時刻
+        for (int k = 0; k < chord; k++) song.push_back({ t, 3 });
+        t += 5000 + rng() % 120000;
+    }
+    return song;
+}
+
+// loop() 1周の長さ（止まる処理が来ればその分）
+static uint32_t loopStepUs(uint64_t now_us, const std::vector<Stall>& stalls, uint64_t* next_due) {
+    uint32_t step = 2000;
+    for (size_t i = 0; i < stalls.size(); i++) {
+        if (now_us >= next_due[i]) {
+            step += stalls[i].len_ms * 1000;
+            next_due[i] += (uint64_t)stalls[i].period_ms * 1000;
+        }
+    }
+    return step;
+}
+
+// 従来: loop() のたびに期限の来たものを最大100件その場で送る
+static LateStats runDirect(const std::vector<Ev>& song, const std::vector<Stall>& stalls) {
+    LateStats st;
+    std::vector<uint64_t> next_due(stalls.size());
+    for (size_t i = 0; i < stalls.size(); i++) next_due[i] = (uint64_t)stalls[i].period_ms * 1000 / 2;
+    size_t next = 0;
+    uint64_t now = 0;
+    while (next < song.size()) {
+        for (int n = 0; n < 100 && next < song.size() && song[next].at_us <= now; n++, next++) {
+            st.add((uint32_t)(now - song[next].at_us));
+        }
+        now += loopStepUs(now, stalls, next_due.data());
+    }
+    return st;
+}
+
+// 今: loop() のたびに MIDI_AHEAD_MS 先までリングに積み、出力タスクは時刻どおりに送る
+//   （出力タスクは優先度が高いので、積まれていれば時刻ちょうどに動けるものとする）
+static LateStats runRing(const std::vector<Ev>& song, const std::vector<Stall>& stalls) {
+    LateStats st;
+    ring = MidiRing();
+    std::vector<uint64_t> next_due(stalls.size());
+    for (size_t i = 0; i < stalls.size(); i++) next_due[i] = (uint64_t)stalls[i].period_ms * 1000 / 2;
+    std::vector<uint64_t> pushed_at(song.size());
+    uint8_t msg[MIDI_RING_MSG_MAX] = {};
+    uint8_t got[MIDI_RING_MSG_MAX];
+    size_t next = 0, sent = 0;
+    uint64_t now = 0;
+    while (sent < song.size()) {
+        // loopTask: 積む
+        uint64_t until = now + MIDI_AHEAD_MS * 1000ULL;
+        while (next < song.size() && song[next].at_us <= until && ring.room() >= MIDI_RING_RECORD_MAX) {
+            msg[0] = (uint8_t)next; msg[1] = (uint8_t)(next >> 8); msg[2] = (uint8_t)(next >> 16);
+            ring.push(song[next].at_us, msg, song[next].len);
+            pushed_at[next] = now;
+            next++;
+        }
+        uint64_t step = loopStepUs(now, stalls, next_due.data());
+        // 出力タスク: この loop() 1周（止まっている間を含む）の間に期限が来る分を送る
+        uint32_t at;
+        uint16_t len;
+        while (ring.peek(&at, &len) && at <= now + step) {
+            ring.pop(got);
+            uint64_t out = std::max<uint64_t>(at, pushed_at[sent]);
+            st.add((uint32_t)(out - at));
+            sent++;
+        }
+        now += step;
+    }
+    return st;
+}
+
+static bool testTiming() {
+    bool ok = true;
+    std::vector<Ev> song = makeSong(7);
+    struct Case { const char* name; std::vector<Stall> stalls; bool within_lookahead; };
+    std::vector<Case> cases = {
+        { "quiet loop", {}, true },
+        { "playing screen", { { "pushCanvas", 1000, 300 }, { "touch", 700, 40 } }, true },
+        { "+ button redraw", { { "pushCanvas", 1000, 300 }, { "touch", 700, 40 }, { "redraw", 3300, 150 } }, true },
+        { "stall > lookahead", { { "GC16", 10000, 800 } }, false },
+    };
+    printf("timing: %zu messages over 60s, lookahead %dms\n", song.size(), MIDI_AHEAD_MS);
+    for (const Case& c : cases) {
+        LateStats direct = runDirect(song, c.stalls);
+        LateStats ahead = runRing(song, c.stalls);
+        printf("  %-18s direct: worst %6.1fms, >5ms %5u | ring: worst %6.1fms, >5ms %5u\n", c.name,
+               direct.worst_us / 1000.0, direct.over5ms, ahead.worst_us / 1000.0, ahead.over5ms);
+        if (c.within_lookahead && ahead.worst_us > 1000) {
+            printf("  FAIL: %s - ring output late by %.1fms\n", c.name, ahead.worst_us / 1000.0);
+            ok = false;
+        }
+        if (ahead.worst_us > direct.worst_us) {
+            printf("  FAIL: %s - ring output later than direct\n", c.name);
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+int main() {
+    bool ok = true;
+    ok &= testSpsc();
+    ok &= testClear();
+    ok &= testTiming();
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
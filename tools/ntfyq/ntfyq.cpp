@@ -0,0 +1,375 @@
+//==============================================================================
+// ntfyq — ntfy 通知キューのホスト側テスト（Linux）
+//
+//   ntfy_queue.h をそのまま使い、端末の ntfy ワーカー（network.cpp）と同じ手順の
+//   ワーカースレッドから 127.0.0.1 の HTTP スタンドインへ送信する。
+//   スタンドインは同じプロセス内のスレッドで、最初の FAIL_FIRST 件に 503 を返し、
+//   以降は HTTP/1.1 keep-alive で 200 を返す（1応答ごとに RESP_DELAY_MS 待つ）。
+//
+//   確認すること
+//     - enqueue（アラーム発火側）がネットワークを待たない
+//     - 近接した 3 件のアラームが 1 リクエストにまとまる
+//     - 503 の後もバックオフで再送して届く
+//     - 接続を使い回す（接続数 < リクエスト数）
+//     - 送信中に満杯になっても送信中の分は捨てず、送り終えた pop で未送信の分が消えない
+//   どれかが満たされなければ終了コード 1。
+//
+//   --port N を付けると内蔵スタンドインを使わず 127.0.0.1:N に送る（件数の検証はしない）。
+//
+// ビルド（リポジトリのルートで）:
+//   g++ -std=c++17 -O2 -pthread -I. tools/ntfyq/ntfyq.cpp -o ntfyq
+//==============================================================================
+#include "ntfy_queue.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <condition_variable>
+#include <unistd.h>
+#include <poll.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+#define FAIL_FIRST      2
+#define RESP_DELAY_MS   150
+#define TEST_COALESCE_MS 300    // 端末は NTFY_COALESCE_MS。テストを短くするため縮める
+#define TEST_BACKOFF_MS 100     // 同上（NTFY_BACKOFF_BASE_MS）
+
+static uint32_t millis() {
+    using namespace std::chrono;
+    static const steady_clock::time_point t0 = steady_clock::now();
+    return (uint32_t)duration_cast<milliseconds>(steady_clock::now() - t0).count();
+}
+
+//------------------------------------------------------------------------------
+// 接続アダプタ（端末の NtfyConn と同じインターフェース）
+//------------------------------------------------------------------------------
+struct SockConn {
+    int fd = -1;
+
+    bool connect(int port) {
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in a = {};
+        a.sin_family = AF_INET;
+        a.sin_port = htons(port);
+        a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (::connect(fd, (sockaddr*)&a, sizeof(a)) != 0) { stop(); return false; }
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        return true;
+    }
+    // 相手が閉じていないか（端末の WiFiClient::connected() 相当）
+    bool connected() {
+        if (fd < 0) return false;
+        pollfd p = { fd, POLLIN, 0 };
+        if (poll(&p, 1, 0) > 0) {
+            char c;
+            if (recv(fd, &c, 1, MSG_PEEK | MSG_DONTWAIT) <= 0) return false;
+        }
+        return true;
+    }
+    void stop() { if (fd >= 0) close(fd); fd = -1; }
+
+    int write(const uint8_t* p, int n) { return (int)send(fd, p, n, MSG_NOSIGNAL); }
+    int readByte(int timeout_ms) {
+        pollfd p = { fd, POLLIN, 0 };
+        if (poll(&p, 1, timeout_ms) <= 0) return -2;
+        uint8_t c;
+        return recv(fd, &c, 1, 0) == 1 ? c : -1;
+    }
+    int readLine(char* buf, int size) {
+        int len = 0;
+        for (;;) {
+            int c = readByte(10000);
+            if (c < 0) return len > 0 ? len : -1;
+            if (c == '\n') break;
+            if (c != '\r' && len < size - 1) buf[len++] = (char)c;
+        }
+        buf[len] = '\0';
+        return len;
+    }
+    bool skip(int n) {
+        while (n > 0) { if (readByte(10000) < 0) return false; n--; }
+        return true;
+    }
+};
+
+//------------------------------------------------------------------------------
+// HTTP スタンドイン（1接続ずつ処理、keep-alive 対応）
+//------------------------------------------------------------------------------
+struct StandIn {
+    int listen_fd = -1;
+    int port = 0;
+    std::atomic<int> connections{0}, requests{0};
+    std::mutex mu;
+    std::vector<std::string> titles, bodies;   // 200 を返したものだけ
+    std::atomic<bool> quit{false};
+    std::thread th;
+
+    bool start() {
+        listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+        int one = 1;
+        setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in a = {};
+        a.sin_family = AF_INET;
+        a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (bind(listen_fd, (sockaddr*)&a, sizeof(a)) != 0 || listen(listen_fd, 4) != 0) return false;
+        socklen_t al = sizeof(a);
+        getsockname(listen_fd, (sockaddr*)&a, &al);
+        port = ntohs(a.sin_port);
+        th = std::thread([this] { run(); });
+        return true;
+    }
+    void stop() { quit = true; shutdown(listen_fd, SHUT_RDWR); close(listen_fd); th.join(); }
+
+    void run() {
+        while (!quit) {
+            pollfd p = { listen_fd, POLLIN, 0 };
+            if (poll(&p, 1, 100) <= 0) continue;
+            int fd = accept(listen_fd, nullptr, nullptr);
+            if (fd < 0) continue;
+            connections++;
+            serve(fd);
+            close(fd);
+        }
+    }
+
+    void serve(int fd) {
+        SockConn c;
+        c.fd = fd;
+        char line[256];
+        for (;;) {
+            if (c.readLine(line, sizeof(line)) <= 0) return;        // クライアントが閉じた
+            std::string title;
+            int content_len = 0;
+            for (;;) {
+                int n = c.readLine(line, sizeof(line));
+                if (n < 0) return;
+                if (n == 0) break;
+                if (strncasecmp(line, "Title:", 6) == 0) title = line + 7;
+                else if (strncasecmp(line, "Content-Length:", 15) == 0) content_len = atoi(line + 15);
+            }
+            std::string body(content_len, '\0');
+            for (int i = 0; i < content_len; i++) {
+                int b = c.readByte(10000);
+                if (b < 0) return;
+                body[i] = (char)b;
+            }
+            int idx = requests++;
+            usleep(RESP_DELAY_MS * 1000);
+            if (idx < FAIL_FIRST) {
+                const char* r = "HTTP/1.1 503 Service Unavailable\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+                c.write((const uint8_t*)r, (int)strlen(r));
+                return;
+            }
+            {
+                std::lock_guard<std::mutex> g(mu);
+                titles.push_back(title);
+                bodies.push_back(body);
+            }
+            const char* ok = "{\"id\":\"standin\",\"event\":\"message\"}";
+            char r[256];
+            int n = snprintf(r, sizeof(r), "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n"
+                             "Content-Length: %d\r\n\r\n%s", (int)strlen(ok), ok);
+            c.write((const uint8_t*)r, n);
+        }
+    }
+};
+
+//------------------------------------------------------------------------------
+// ワーカー（network.cpp の ntfyWorkerMain と同じ手順）
+//------------------------------------------------------------------------------
+struct Worker {
+    NtfyQueue   q;
+    NtfyBackoff backoff;
+    std::mutex  mu;
+    std::condition_variable cv;
+    std::atomic<bool> quit{false}, busy{false};
+    int port = 0;
+    SockConn client;
+    uint32_t requests = 0, delivered = 0, failures = 0, connects = 0;
+    std::thread th;
+
+    void start(int p) {
+        port = p;
+        q.init();
+        q.coalesce_ms = TEST_COALESCE_MS;
+        backoff.init();
+        backoff.base_ms = TEST_BACKOFF_MS;
+        th = std::thread([this] { run(); });
+    }
+    void stop() { quit = true; cv.notify_one(); th.join(); client.stop(); }
+
+    void enqueue(const char* title, const char* body) {
+        { std::lock_guard<std::mutex> g(mu); q.push(title, body, millis()); }
+        cv.notify_one();
+    }
+    bool idle() { std::lock_guard<std::mutex> g(mu); return q.count == 0 && !busy; }
+
+    int post(const char* title, const char* body) {
+        for (int attempt = 0; attempt < 2; attempt++) {
+            bool reused = client.connected();
+            if (!reused) {
+                client.stop();
+                if (!client.connect(port)) return -1;
+                connects++;
+            }
+            bool keep = false;
+            int code = ntfyExchange(client, "127.0.0.1", "m5paper-test", title, body, keep);
+            if (code < 0 && reused) { client.stop(); continue; }
+            if (!keep) client.stop();
+            return code;
+        }
+        return -1;
+    }
+
+    void run() {
+        char title[NTFY_TITLE_MAX + 8];
+        char body[NTFY_BATCH_BODY_MAX];
+        while (!quit) {
+            int n = 0;
+            {
+                std::unique_lock<std::mutex> g(mu);
+                cv.wait_for(g, std::chrono::milliseconds(50));
+                uint32_t now = millis();
+                if (q.batchReady(now) && backoff.ready(now)) {
+                    n = q.takeBatch(title, sizeof(title), body, sizeof(body));
+                    busy = n > 0;
+                }
+            }
+            if (n == 0) continue;
+            requests++;
+            int code = post(title, body);
+            printf("  worker: HTTP %d, %d notification(s) in 1 request \"%s\"\n", code, n, title);
+            std::lock_guard<std::mutex> g(mu);
+            if (code >= 200 && code < 300) {
+                q.pop(n);
+                backoff.ok();
+                delivered += n;
+            } else {
+                failures++;
+                if (backoff.fail(millis())) { q.pop(n); q.dropped += n; }
+                else q.release();
+            }
+            busy = false;
+        }
+    }
+};
+
+// 送信中（takeBatch 後・pop 前）にキューが満杯になった場合
+static bool testOverflowInFlight() {
+    NtfyQueue q;
+    q.init();
+    char title[NTFY_TITLE_MAX + 8], body[NTFY_BATCH_BODY_MAX], b[16];
+    for (int i = 0; i < 3; i++) { snprintf(b, sizeof(b), "sent%d", i); q.push("A", b, 0); }
+    for (int i = 0; i < NTFY_QUEUE_LEN - 3; i++) { snprintf(b, sizeof(b), "wait%d", i); q.push("B", b, 0); }
+    int n = q.takeBatch(title, sizeof(title), body, sizeof(body));
+    bool pushed = q.push("C", "new0", 0) && q.push("C", "new1", 0);    // wait0, wait1 が捨てられる
+    q.pop(n);
+    bool ok = n == 3 && pushed && q.dropped == 2 && q.count == NTFY_QUEUE_LEN - 3 && q.inflight == 0
+           && strcmp(q.at(0).body, "wait2") == 0 && strcmp(q.at(q.count - 1).body, "new1") == 0;
+
+    // 全件が送信中なら新しい方を捨てる
+    q.init();
+    for (int i = 0; i < NTFY_QUEUE_LEN; i++) { snprintf(b, sizeof(b), "all%d", i); q.push("A", b, 0); }
+    n = q.takeBatch(title, sizeof(title), body, sizeof(body));
+    bool rejected = !q.push("A", "late", 0);
+    q.pop(n);
+    ok = ok && n == NTFY_QUEUE_LEN && rejected && q.count == 0 && q.dropped == 1;
+    printf("overflow while in flight: %s\n", ok ? "ok" : "FAIL");
+    return ok;
+}
+
+static bool waitIdle(Worker& w, uint32_t timeout_ms) {
+    uint32_t t0 = millis();
+    while (millis() - t0 < timeout_ms) {
+        if (w.idle()) return true;
+        usleep(10000);
+    }
+    return false;
+}
+
+int main(int argc, char** argv) {
+    int ext_port = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--port") == 0 && i + 1 < argc) ext_port = atoi(argv[++i]);
+    }
+
+    StandIn srv;
+    if (!ext_port && !srv.start()) { fprintf(stderr, "stand-in: bind failed\n"); return 1; }
+    int port = ext_port ? ext_port : srv.port;
+    printf("ntfy queue test -> 127.0.0.1:%d%s\n", port, ext_port ? " (external)" : " (stand-in)");
+
+    // 従来方式の参考値: 発火側で接続 + 1往復を待つ
+    uint32_t sync_ms = 0;
+    if (!ext_port) {
+        SockConn c;
+        uint32_t t0 = millis();
+        if (c.connect(port)) {
+            bool keep;
+            ntfyExchange(c, "127.0.0.1", "m5paper-test", "sync", "sync", keep);
+            c.stop();
+        }
+        sync_ms = millis() - t0;
+        srv.requests = 0;
+        srv.connections = 0;
+        srv.titles.clear();
+        srv.bodies.clear();
+    }
+
+    bool overflow_ok = testOverflowInFlight();
+
+    Worker w;
+    w.start(port);
+
+    // 1) 近接した 3 件のアラーム（100ms おき）。発火側の待ち時間を測る
+    uint32_t worst_us = 0;
+    const char* msgs[3] = { "09:00 定例", "09:00 定例 (5分前)", "09:00 朝会" };
+    for (int i = 0; i < 3; i++) {
+        auto t0 = std::chrono::steady_clock::now();
+        w.enqueue("M5Paper Alarm", msgs[i]);
+        uint32_t us = (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - t0).count();
+        if (us > worst_us) worst_us = us;
+        usleep(100000);
+    }
+    bool burst_ok = waitIdle(w, 10000);
+
+    // 2) 少し空けて単発のアラーム（接続を使い回すはず）
+    usleep(200000);
+    w.enqueue("M5Paper Alarm", "10:30 打ち合わせ");
+    bool single_ok = waitIdle(w, 5000);
+    w.stop();
+
+    printf("\nenqueue (alarm side): worst %uus", worst_us);
+    if (!ext_port) printf("   vs. synchronous send: %ums", sync_ms);
+    printf("\nworker: %u delivered in %u requests, %u failed attempts, %u connects, %u dropped\n",
+           w.delivered, w.requests, w.failures, w.connects, w.q.dropped);
+
+    bool ok = overflow_ok && burst_ok && single_ok && worst_us < 1000 && w.delivered == 4 && w.q.dropped == 0;
+    if (!ext_port) {
+        srv.stop();
+        printf("stand-in: %d requests over %d connections, %d accepted\n",
+               srv.requests.load(), srv.connections.load(), (int)srv.titles.size());
+        for (size_t i = 0; i < srv.titles.size(); i++) {
+            printf("  [%zu] %s: %s\n", i, srv.titles[i].c_str(), srv.bodies[i].c_str());
+        }
+        bool coalesced = srv.titles.size() == 2 && srv.titles[0] == "M5Paper Alarm (3)"
+                      && srv.bodies[0] == "09:00 定例\n09:00 定例 (5分前)\n09:00 朝会";
+        bool retried = srv.requests.load() == FAIL_FIRST + 2 && w.failures == FAIL_FIRST;
+        bool reused = srv.connections.load() < srv.requests.load();
+        printf("coalesced 3 alarms into 1 request: %s\n", coalesced ? "yes" : "NO");
+        printf("retried after %d x 503: %s\n", FAIL_FIRST, retried ? "yes" : "NO");
+        printf("connection reused: %s\n", reused ? "yes" : "NO");
+        ok = ok && coalesced && retried && reused;
+    }
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
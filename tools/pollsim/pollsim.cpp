@@ -0,0 +1,245 @@
+//==============================================================================
+// pollsim — ICS 取得間隔の適応制御のホスト側シミュレーション（仮想時計）
+//
+//   1週間分のカレンダー2本（会議の多い仕事用・ほとんど変わらない祝日用）を
+//   仮想時計で回し、ics_parser.cpp と同じ手順で取得のたびに poll_policy.h の
+//   pollNext で次の取得時刻を決める。カレンダーは時々編集され、会議の一部は
+//   アラームの直前1時間以内に編集される（時刻変更・場所変更など）。
+//
+//   検証（1つでも破れば終了コード 1）:
+//     - 予算なし: 各アラームの前 POLL_NEAR_INTERVAL_SEC + POLL_ALARM_GUARD_SEC 以内に1回取得している
+//     - 予算なし: 取得回数が固定間隔より少ない。直前の編集を鳴る前に拾えた数が
+//       全シードの合計で固定間隔以上（1分前の編集などはどちらも運しだい）
+//     - 予算あり: 1日の取得回数が上限以下、通信量が上限 + 1回分以下
+//   固定間隔（ics_poll_each どおり）との取得回数・通信量・直前の編集の取りこぼしを並べて出す。
+//
+// ビルド（リポジトリのルートで）:
+//   g++ -std=c++17 -O2 -I. tools/pollsim/pollsim.cpp -o pollsim
+//==============================================================================
+#include "poll_policy.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <vector>
+#include <random>
+#include <algorithm>
+
+static const int64_t DAY   = 86400;
+static const int     DAYS  = 7;
+static const int64_t FETCH_SEC = 3;         // 取得1回（TLS + 受信）
+
+struct Source {
+    const char* name;
+    int32_t  base_sec;
+    uint32_t body_bytes;
+    std::vector<int64_t> edits;     // 編集時刻（昇順）
+    std::vector<int64_t> alarms;    // アラーム時刻（昇順）
+};
+
+struct LateEdit {
+    int     src;
+    int64_t at;
+    int64_t alarm;
+};
+
+struct Calendar {
+    std::vector<Source>   src;
+    std::vector<LateEdit> late;     // アラーム直前1時間以内の編集
+};
+
+static Calendar makeCalendar(uint32_t seed) {
+    std::mt19937 rng(seed);
+    Calendar cal;
+    Source work = { "work", 10 * 60, 60000, {}, {} };
+    Source hol  = { "holiday", 30 * 60, 8000, {}, {} };
+
+    for (int d = 0; d < DAYS; d++) {
+        int64_t day0 = d * DAY;
+        bool weekday = d < 5;
+        // 日中の普通の編集（平日は90分に1回くらい、週末はまれ）
+        std::exponential_distribution<double> gap(1.0 / (weekday ? 5400.0 : 6 * 3600.0));
+        for (double t = 8 * 3600 + gap(rng); t < 20 * 3600; t += gap(rng)) {
+            work.edits.push_back(day0 + (int64_t)t);
+        }
+        if (!weekday) continue;
+        // 会議6件（9〜18時）、10分前アラーム。4割はアラーム前1時間以内に編集される
+        for (int m = 0; m < 6; m++) {
+            int64_t start = day0 + 9 * 3600 + m * 5400 + (rng() % 1800);
+            int64_t alarm = start - 600;
+            work.alarms.push_back(alarm);
+            if (rng() % 10 < 4) {
+                int64_t at = alarm - 60 - (int64_t)(rng() % 3540);
+                work.edits.push_back(at);
+                cal.late.push_back({ 0, at, alarm });
+            }
+        }
+    }
+    hol.edits.push_back(2 * DAY + 13 * 3600);
+    std::sort(work.edits.begin(), work.edits.end());
+    std::sort(work.alarms.begin(), work.alarms.end());
+    cal.src.push_back(work);
+    cal.src.push_back(hol);
+    return cal;
+}
+
+// t 時点の版（それまでの編集回数）
+static int versionAt(const Source& s, int64_t t) {
+    return (int)(std::upper_bound(s.edits.begin(), s.edits.end(), t) - s.edits.begin());
+}
+
+static int64_t alarmIn(const Source& s, int64_t t) {
+    auto it = std::upper_bound(s.alarms.begin(), s.alarms.end(), t);
+    return it == s.alarms.end() ? -1 : *it - t;
+}
+
+struct Result {
+    std::vector<std::vector<int64_t>> fetches;     // ソースごとの取得時刻
+    uint32_t day_fetches[DAYS];
+    uint64_t day_bytes[DAYS];
+    uint32_t max_fetch_bytes;
+};
+
+static Result run(const Calendar& cal, bool adaptive, uint32_t max_fetches, uint32_t max_bytes) {
+    Result r = {};
+    r.fetches.resize(cal.src.size());
+    PollBudget budget = {};
+    budget.max_fetches = max_fetches;
+    budget.max_bytes = max_bytes;
+
+    struct State { int64_t next; int version; uint8_t unchanged; uint32_t avg; bool fetched; };
+    std::vector<State> st(cal.src.size(), State{ 0, -1, 0, 0, false });
+
+    for (;;) {
+        // 次に取得するソース（同時刻は番号順）
+        int s = -1;
+        for (int i = 0; i < (int)st.size(); i++) {
+            if (s < 0 || st[i].next < st[s].next) s = i;
+        }
+        int64_t now = st[s].next;
+        if (now >= DAYS * DAY) break;
+        int day = (int)(now / DAY);
+        budget.roll((uint16_t)(day + 1));
+
+        const Source& src = cal.src[s];
+        State& x = st[s];
+        int64_t done = now + FETCH_SEC;
+        uint32_t bytes = src.body_bytes + POLL_TLS_OVERHEAD_BYTES;
+        budget.spend(bytes);
+        r.day_fetches[day]++;
+        r.day_bytes[day] += bytes;
+        if (bytes > r.max_fetch_bytes) r.max_fetch_bytes = bytes;
+        r.fetches[s].push_back(now);
+        x.avg = pollAvgBytes(x.avg, bytes);
+
+        int v = versionAt(src, now);
+        if (x.fetched && v == x.version) { if (x.unchanged < 255) x.unchanged++; }
+        else x.unchanged = 0;
+        x.version = v;
+        x.fetched = true;
+
+        PollInputs in;
+        in.base_sec = src.base_sec;
+        in.unchanged = x.unchanged;
+        in.alarm_in_sec = alarmIn(src, done);
+        in.avg_bytes = x.avg;
+        in.sec_to_midnight = (int32_t)(DAY - done % DAY);
+        in.sources = (int)cal.src.size();
+        in.adaptive = adaptive;
+        PollDecision d = pollNext(in, budget);
+        x.next = done + d.sec;
+    }
+    return r;
+}
+
+// 直前の編集を鳴る前に拾えた数
+static int caughtLate(const Calendar& cal, const Result& r) {
+    int caught = 0;
+    for (const LateEdit& e : cal.late) {
+        const std::vector<int64_t>& f = r.fetches[e.src];
+        auto it = std::lower_bound(f.begin(), f.end(), e.at + 1);
+        if (it != f.end() && *it < e.alarm) caught++;
+    }
+    return caught;
+}
+
+// 各アラームの直前 window 秒以内に取得していなかった数
+static int unguardedAlarms(const Calendar& cal, const Result& r, int64_t window) {
+    int miss = 0;
+    for (size_t s = 0; s < cal.src.size(); s++) {
+        const std::vector<int64_t>& f = r.fetches[s];
+        for (int64_t a : cal.src[s].alarms) {
+            auto it = std::lower_bound(f.begin(), f.end(), a);
+            if (it == f.begin() || a - *(it - 1) > window) miss++;
+        }
+    }
+    return miss;
+}
+
+static uint32_t totalFetches(const Result& r) {
+    uint32_t n = 0;
+    for (int d = 0; d < DAYS; d++) n += r.day_fetches[d];
+    return n;
+}
+
+static uint64_t totalBytes(const Result& r) {
+    uint64_t n = 0;
+    for (int d = 0; d < DAYS; d++) n += r.day_bytes[d];
+    return n;
+}
+
+static void print(const char* label, const Calendar& cal, const Result& r) {
+    printf("  %-22s fetches %4u (%5.1f/day)  %6.1f MB  late edits caught %d/%d  unguarded alarms %d\n",
+           label, totalFetches(r), totalFetches(r) / (double)DAYS, totalBytes(r) / 1e6,
+           caughtLate(cal, r), (int)cal.late.size(),
+           unguardedAlarms(cal, r, POLL_NEAR_INTERVAL_SEC + POLL_ALARM_GUARD_SEC));
+}
+
+int main() {
+    bool ok = true;
+    int caught_fixed = 0, caught_adapt = 0;
+    const uint32_t BUDGET_FETCHES = 60;
+    const uint32_t BUDGET_BYTES = 3000000;
+
+    for (uint32_t seed = 1; seed <= 5; seed++) {
+        Calendar cal = makeCalendar(seed);
+        printf("seed %u: %d alarms, %d edits (%d within 1h before an alarm)\n", seed,
+               (int)cal.src[0].alarms.size(), (int)(cal.src[0].edits.size() + cal.src[1].edits.size()),
+               (int)cal.late.size());
+
+        Result fixed = run(cal, false, 0, 0);
+        Result adapt = run(cal, true, 0, 0);
+        Result tight = run(cal, true, BUDGET_FETCHES, BUDGET_BYTES);
+        print("fixed (poll_each)", cal, fixed);
+        print("adaptive", cal, adapt);
+        char label[64];
+        snprintf(label, sizeof(label), "adaptive %u/%uKB", BUDGET_FETCHES, BUDGET_BYTES / 1000);
+        print(label, cal, tight);
+
+        int unguarded = unguardedAlarms(cal, adapt, POLL_NEAR_INTERVAL_SEC + POLL_ALARM_GUARD_SEC);
+        if (unguarded) {
+            printf("  FAIL: %d alarms without a fetch just before them\n", unguarded);
+            ok = false;
+        }
+        caught_fixed += caughtLate(cal, fixed);
+        caught_adapt += caughtLate(cal, adapt);
+        if (totalFetches(adapt) >= totalFetches(fixed)) {
+            printf("  FAIL: adaptive fetched as often as fixed\n");
+            ok = false;
+        }
+        for (int d = 0; d < DAYS; d++) {
+            if (tight.day_fetches[d] > BUDGET_FETCHES ||
+                tight.day_bytes[d] > BUDGET_BYTES + tight.max_fetch_bytes) {
+                printf("  FAIL: day %d over budget (%u fetches, %llu bytes)\n", d,
+                       tight.day_fetches[d], (unsigned long long)tight.day_bytes[d]);
+                ok = false;
+            }
+        }
+    }
+    printf("late edits caught: fixed %d, adaptive %d\n", caught_fixed, caught_adapt);
+    if (caught_adapt < caught_fixed) {
+        printf("FAIL: adaptive caught fewer last-minute edits than fixed\n");
+        ok = false;
+    }
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,223 @@
+//==============================================================================
+// sleepsim — 締め切り駆動スリープのホスト側シミュレーション（仮想時計）
+//
+//   一覧画面に置きっぱなしの1日を仮想時計で回し、loop() の各処理
+//   （分の切り替わり・ハートビート・SD チェック・fetch・MIDI 先読み・アラーム）と
+//   時々の操作（スイッチ）を模擬する。loop() の最後は power.cpp と同じ手順で
+//   締め切りを集め、sleep_sched.h の sleepDecide で眠り方を決める。
+//
+//   検証（1つでも破れば終了コード 1）:
+//     - 眠っている間に来た定期処理の締め切りに SLACK_MS 以上遅れて起きない
+//     - 眠っている間に来たアラームに SLACK_MS 以上遅れて起きない
+//     - fetch と MIDI 先読みの時点で WiFi が繋がっている（繋ぎ直しの待ちは含めない）
+//     - 更新間隔 5分では WiFi を切らない（ライトスリープに入らない）
+//   従来（delay(1) で回し続ける）とのループ回数・眠っていた割合を並べて出す。
+//
+// ビルド（リポジトリのルートで）:
+//   g++ -std=c++17 -O2 -I. tools/sleepsim/sleepsim.cpp -o sleepsim
+//==============================================================================
+#include "sleep_sched.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <vector>
+#include <random>
+#include <algorithm>
+
+// types.h / M5PaperSchedAL.ino と同じ値
+#define MIDI_PREARM_SEC         300
+#define SD_CHECK_INTERVAL_MS    300000
+#define HEARTBEAT_MS            5000
+
+static const int64_t DAY_MS   = 24LL * 3600 * 1000;
+static const int64_t SLACK_MS = 60;         // ループ1回分の処理 + IDLE の刻み
+static const int64_t LOOP_MS  = 2;          // 何もしないループ1回
+static const int64_t FETCH_MS = 3000;       // fetch 1回（TLS + 受信）
+static const int64_t WIFI_CONNECT_MS = 2500;
+static const int64_t PREARM_MS = 400;       // SD → PSRAM 読み込み
+static const int64_t RING_MS = 30000;       // 鳴動（この間は眠らない）
+
+struct Scenario {
+    const char* name;
+    int64_t     fetch_ms;       // 更新間隔
+    int         alarms;         // 1日のアラーム数
+    int         touches;        // 1日の操作回数
+    bool        expect_wifi_off;
+};
+
+struct Result {
+    uint64_t loops;
+    int64_t  worst_job_late, worst_alarm_late;
+    int      wifi_missing;      // fetch・先読みの時点で WiFi が切れていた
+    int      fetches, prearms, alarms_rung;
+    SleepStats st;
+};
+
+static bool run(const Scenario& sc, uint32_t seed, Result& r) {
+    std::mt19937 rng(seed);
+    std::vector<int64_t> alarm_at, touch_at;
+    for (int i = 0; i < sc.alarms; i++) alarm_at.push_back(600000 + (int64_t)(rng() % (uint32_t)(DAY_MS - 1200000)));
+    for (int i = 0; i < sc.touches; i++) touch_at.push_back((int64_t)(rng() % (uint32_t)DAY_MS));
+    std::sort(alarm_at.begin(), alarm_at.end());
+    std::sort(touch_at.begin(), touch_at.end());
+    // 同じ時刻に重ならないよう鳴動分ずらす
+    for (size_t i = 1; i < alarm_at.size(); i++) {
+        if (alarm_at[i] < alarm_at[i - 1] + RING_MS + 1000) alarm_at[i] = alarm_at[i - 1] + RING_MS + 1000;
+    }
+
+    r = Result();
+    int64_t t = 0;
+    int64_t next_minute = 60000, next_heartbeat = HEARTBEAT_MS, next_sd = SD_CHECK_INTERVAL_MS;
+    int64_t next_fetch = sc.fetch_ms;
+    size_t  alarm_i = 0, touch_i = 0;
+    int64_t armed_for = -1;
+    int64_t ring_until = -1;
+    int64_t last_input = -SLEEP_INPUT_HOLD_MS;
+    bool    wifi_on = true;
+    int64_t wifi_off_at = 0;
+
+    // 眠っている間に来た締め切りについて、起きてループが始まるまでの遅れ
+    //   （前のループの処理が長引いて遅れた分はスリープのせいではないので数えない）
+    int64_t sleep_from = 0, t0 = 0;
+    auto late = [&](int64_t due, int64_t& worst) {
+        if (due >= sleep_from && t0 - due > worst) worst = t0 - due;
+    };
+
+    while (t < DAY_MS) {
+        t0 = t;
+        r.loops++;
+        t += LOOP_MS;
+
+        // 操作（スイッチ）: GPIO 起床または IDLE 中の入力
+        while (touch_i < touch_at.size() && touch_at[touch_i] <= t) { last_input = t; touch_i++; }
+
+        bool ringing = t < ring_until;
+        if (alarm_i < alarm_at.size() && alarm_at[alarm_i] <= t) {
+            late(alarm_at[alarm_i], r.worst_alarm_late);
+            ring_until = t + RING_MS;
+            r.alarms_rung++;
+            alarm_i++;
+            ringing = true;
+        }
+        int64_t head = alarm_i < alarm_at.size() ? alarm_at[alarm_i] : -1;
+        if (!ringing && head >= 0 && head - t <= MIDI_PREARM_SEC * 1000LL && armed_for != head) {
+            if (!wifi_on) r.wifi_missing++;
+            armed_for = head;
+            r.prearms++;
+            t += PREARM_MS;
+        }
+
+        // powerService: 要る時刻の WIFI_WAKE_LEAD_MS 前に繋ぎ直す
+        int64_t need = next_fetch - t;
+        if (head >= 0 && head - MIDI_PREARM_SEC * 1000LL - t < need) need = head - MIDI_PREARM_SEC * 1000LL - t;
+        if (need < 0) need = 0;
+        if (!wifi_on && need <= WIFI_WAKE_LEAD_MS) {
+            r.st.wifi_off_ms += t - wifi_off_at;
+            wifi_on = true;
+            t += WIFI_CONNECT_MS;
+        }
+
+        if (t >= next_sd)        { late(next_sd, r.worst_job_late); next_sd = t + SD_CHECK_INTERVAL_MS; t += 20; }
+        if (t >= next_minute)    { late(next_minute, r.worst_job_late); next_minute += 60000; t += 30; }
+        if (t >= next_fetch) {
+            late(next_fetch, r.worst_job_late);
+            if (!wifi_on) { r.wifi_missing++; wifi_on = true; t += WIFI_CONNECT_MS; }
+            next_fetch = t + sc.fetch_ms;
+            r.fetches++;
+            t += FETCH_MS;
+        }
+        if (t >= next_heartbeat) { late(next_heartbeat, r.worst_job_late); next_heartbeat = t + HEARTBEAT_MS; t += 5; }
+        r.st.awake_ms += t - t0;
+
+        // ── powerIdle() と同じ手順 ──
+        head = alarm_i < alarm_at.size() ? alarm_at[alarm_i] : -1;
+        need = next_fetch - t;
+        if (head >= 0 && head - MIDI_PREARM_SEC * 1000LL - t < need) need = head - MIDI_PREARM_SEC * 1000LL - t;
+        if (need < 0) need = 0;
+        SleepPlan p;
+        p.begin();
+        p.at(WAKE_MINUTE, next_minute - t);
+        if (head >= 0) {
+            p.at(WAKE_ALARM, head - t);
+            int64_t prearm = head - MIDI_PREARM_SEC * 1000LL - t;
+            if (prearm > 0) p.at(WAKE_PREARM, prearm);
+        }
+        p.at(WAKE_FETCH, next_fetch - t);
+        p.at(WAKE_SD_CHECK, next_sd - t);
+        p.at(WAKE_HEARTBEAT, next_heartbeat - t);
+        sleepPlanWifi(p, wifi_on, need);
+
+        SleepInputs in;
+        in.busy = t < ring_until;
+        in.network_busy = false;
+        in.light_ok = true;
+        in.wifi_on = wifi_on;
+        in.wifi_need_in_ms = need;
+        in.since_input_ms = (uint32_t)(t - last_input);
+        SleepDecision d = sleepDecide(p, in);
+
+        // 眠っている間に来た操作はそこで起こす（GPIO 起床）
+        int64_t wake = t + (d.mode == SLEEP_NONE ? 1 : d.ms);
+        bool gpio_wake = false;
+        if (d.mode == SLEEP_LIGHT && touch_i < touch_at.size() && touch_at[touch_i] < wake) {
+            wake = touch_at[touch_i];
+            gpio_wake = true;
+        }
+        int64_t slept = wake - t;
+        sleep_from = t;
+        switch (d.mode) {
+        case SLEEP_NONE:  r.st.awake_ms += slept; break;
+        case SLEEP_IDLE:  r.st.idle_ms += slept; break;
+        case SLEEP_LIGHT:
+            if (d.wifi_off && wifi_on) { wifi_on = false; wifi_off_at = t; }
+            r.st.light_ms += slept;
+            r.st.light_count++;
+            r.st.wakes[d.reason]++;
+            break;
+        }
+        t = wake;
+        if (gpio_wake) last_input = t;
+    }
+    if (!wifi_on) r.st.wifi_off_ms += t - wifi_off_at;
+    return true;
+}
+
+int main() {
+    const Scenario scenarios[] = {
+        { "poll 30min, 12 alarms", 30 * 60000LL, 12, 40, true  },
+        { "poll 60min, 3 alarms",  60 * 60000LL,  3, 10, true  },
+        { "poll 5min, 12 alarms",   5 * 60000LL, 12, 40, false },
+    };
+    bool pass = true;
+    printf("%-24s %10s %9s %6s %6s %6s %8s %9s %8s %8s\n",
+           "scenario", "loops", "vs old", "awake", "idle", "light", "sleeps", "wifi off", "job late", "al late");
+    for (const Scenario& sc : scenarios) {
+        for (uint32_t seed = 1; seed <= 5; seed++) {
+            Result r;
+            run(sc, seed, r);
+            uint64_t old_loops = (uint64_t)(DAY_MS / (LOOP_MS + 1));
+            bool ok = r.worst_job_late < SLACK_MS && r.worst_alarm_late < SLACK_MS &&
+                      r.wifi_missing == 0 && r.alarms_rung == sc.alarms &&
+                      (sc.expect_wifi_off ? r.st.wifi_off_ms > 0 : r.st.light_count == 0);
+            if (seed == 1 || !ok) {
+                printf("%-24s %10llu %8.2f%% %5u%% %5u%% %5u%% %8u %8llus %6lldms %6lldms%s\n",
+                       sc.name, (unsigned long long)r.loops, 100.0 * r.loops / old_loops,
+                       r.st.pct(r.st.awake_ms), r.st.pct(r.st.idle_ms), r.st.pct(r.st.light_ms),
+                       r.st.light_count, (unsigned long long)(r.st.wifi_off_ms / 1000),
+                       (long long)r.worst_job_late, (long long)r.worst_alarm_late,
+                       ok ? "" : "  FAIL");
+                if (seed == 1) {
+                    printf("    wakes:");
+                    for (int w = 0; w < WAKE_REASON_COUNT; w++) {
+                        if (r.st.wakes[w]) printf(" %s=%u", wake_reason_names[w], r.st.wakes[w]);
+                    }
+                    printf("  (fetch %d, prearm %d, alarms %d/%d, wifi missing %d)\n",
+                           r.fetches, r.prearms, r.alarms_rung, sc.alarms, r.wifi_missing);
+                }
+            }
+            if (!ok) pass = false;
+        }
+    }
+    printf("%s\n", pass ? "PASS" : "FAIL");
+    return pass ? 0 : 1;
+}
@@ -0,0 +1,172 @@
+//==============================================================================
+// sortbench — イベント並べ替えのホスト側ベンチマーク
+//
+//   従来の O(n²) 交換ソート + 1件ずつ詰めるトリムと、event_sort.h の
+//   キー置換ソート（ラン k-way マージ / 日バケット）+ base オフセットトリムを比較する。
+//   データは fetch 直後のバッファを模擬: ソース0 は ICS 順（未整列）、
+//   ソース1,2 は前回から引き継いだ整列済みセグメント。
+//
+// ビルド（リポジトリのルートで）:
+//   g++ -std=c++17 -O2 -I. tools/sortbench/sortbench.cpp -o sortbench
+//==============================================================================
+#include "event_sort.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <chrono>
+#include <vector>
+
+// 現行 EventItem 相当（固定長ヘッダー ~112byte）
+struct HeaderItem {
+    int64_t start;
+    const char* text;
+    const char* midi_file;
+    uint16_t text_len;
+    uint8_t source;
+    uint8_t flags[3];
+    int play_duration_sec, play_repeat, alarm_count;
+    int offset_min[6];
+    int64_t alarm_time[6];
+    bool triggered[6];
+};
+
+// 旧 EventItem 相当（text[4000] 埋め込み ~4.2KB）
+struct LegacyItem {
+    int64_t start;
+    char text[4000];
+    char midi_file[64];
+    uint8_t source;
+    int rest[20];
+    int64_t alarm_time[6];
+};
+
+static double nowMs() {
+    using namespace std::chrono;
+    return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+}
+
+template <typename T>
+static void makeEvents(std::vector<T>& ev, int n, uint32_t base_time) {
+    ev.assign(n, T());
+    srand(12345);
+    int seg[3] = { n / 2, n / 4, n - n / 2 - n / 4 };
+    int i = 0;
+    for (int s = 0; s < 3; s++) {
+        uint32_t t = base_time - 7 * 86400;
+        for (int k = 0; k < seg[s]; k++, i++) {
+            ev[i].source = (uint8_t)s;
+            if (s == 0) {
+                ev[i].start = base_time - 7 * 86400 + rand() % (37 * 86400);
+            } else {
+                t += rand() % 1800;
+                ev[i].start = t;
+            }
+        }
+    }
+}
+
+// 従来版: O(n²) 交換ソート + 先頭から1件ずつ詰めるトリム
+template <typename T>
+static int legacySortTrim(T* ev, int n, int maxEvents, uint32_t now) {
+    for (int i = 0; i < n; i++) {
+        for (int j = i + 1; j < n; j++) {
+            if (ev[j].start < ev[i].start) { T tmp = ev[i]; ev[i] = ev[j]; ev[j] = tmp; }
+        }
+    }
+    if (n <= maxEvents) return n;
+    int today_idx = n;
+    for (int i = 0; i < n; i++) if (ev[i].start >= (int64_t)now - 86400) { today_idx = i; break; }
+    int future_count = n - today_idx;
+    int keep_past = std::min(today_idx, std::min(10, maxEvents - future_count));
+    if (keep_past < 0) keep_past = 0;
+    int start_idx = today_idx - keep_past;
+    if (start_idx > 0) {
+        for (int i = 0; i < n - start_idx; i++) ev[i] = ev[i + start_idx];
+        n -= start_idx;
+    }
+    return std::min(n, maxEvents);
+}
+
+// 新版: ics_parser.cpp sortAndTrimEvents と同じ手順
+template <typename T>
+static int keySortTrim(T* ev, int n, int maxEvents, uint32_t now,
+                       SortKey* keys, SortKey* tmp, uint16_t* src, bool by_day) {
+    int run_start[SORT_MAX_RUNS + 1];
+    int run_count = 0;
+    for (int i = 0; i < n; i++) {
+        if (i == 0 || ev[i].source != ev[i - 1].source) {
+            if (run_count <= SORT_MAX_RUNS) run_start[run_count] = i;
+            run_count++;
+        }
+        keys[i].start = (uint32_t)ev[i].start;
+        keys[i].idx = (uint16_t)i;
+        keys[i].run = (uint16_t)(run_count - 1);
+    }
+    if (!by_day || !sortKeysByDay(keys, tmp, n)) sortKeysByRuns(keys, tmp, n, run_start, run_count);
+    int base = 0, keep = n;
+    if (n > maxEvents) {
+        int today_idx = lowerBoundStart(keys, n, now - 86400);
+        int future_count = n - today_idx;
+        int keep_past = std::min(today_idx, std::min(10, maxEvents - future_count));
+        if (keep_past < 0) keep_past = 0;
+        base = today_idx - keep_past;
+        keep = std::min(n - base, maxEvents);
+    }
+    for (int j = 0; j < n; j++) src[j] = keys[(base + j) % n].idx;
+    applyPermutation(ev, src, n);
+    return keep;
+}
+
+template <typename T>
+static bool sameResult(const std::vector<T>& a, int na, const std::vector<T>& b, int nb) {
+    if (na != nb) return false;
+    for (int i = 0; i < na; i++) if (a[i].start != b[i].start) return false;
+    for (int i = 1; i < na; i++) if (b[i].start < b[i - 1].start) return false;
+    return true;
+}
+
+template <typename T>
+static void bench(const char* label, int n, bool run_legacy) {
+    const uint32_t now = 1790000000u;
+    const int maxEvents = (n * 3) / 4;      // トリムも発生させる
+    std::vector<T> a, b, c;
+    makeEvents(a, n, now);
+    b = a;
+    c = a;
+    std::vector<SortKey> keys(n), tmp(n);
+    std::vector<uint16_t> src(n);
+
+    double t_leg = -1;
+    int na = 0;
+    if (run_legacy) {
+        double t0 = nowMs();
+        na = legacySortTrim(a.data(), n, maxEvents, now);
+        t_leg = nowMs() - t0;
+    }
+    double t0 = nowMs();
+    int nb = keySortTrim(b.data(), n, maxEvents, now, keys.data(), tmp.data(), src.data(), false);
+    double t_new = nowMs() - t0;
+    t0 = nowMs();
+    int nc = keySortTrim(c.data(), n, maxEvents, now, keys.data(), tmp.data(), src.data(), true);
+    double t_day = nowMs() - t0;
+    const char* day_ok = sameResult(b, nb, c, nc) ? "OK" : "MISMATCH";
+
+    if (run_legacy) {
+        printf("%-8s n=%5d  legacy %10.3f ms   key-sort %8.3f ms   x%-8.1f %s   day-bucket %8.3f ms %s\n",
+               label, n, t_leg, t_new, t_leg / (t_new > 0 ? t_new : 1e-6),
+               sameResult(a, na, b, nb) ? "OK" : "MISMATCH", t_day, day_ok);
+    } else {
+        printf("%-8s n=%5d  legacy    (skipped)   key-sort %8.3f ms   day-bucket %8.3f ms %s\n",
+               label, n, t_new, t_day, day_ok);
+    }
+}
+
+int main() {
+    printf("sizeof: header %zu B, legacy %zu B\n", sizeof(HeaderItem), sizeof(LegacyItem));
+    const int sizes[] = { 300, 1000, 5000 };
+    for (int n : sizes) bench<HeaderItem>("header", n, true);
+    // 旧 4KB 構造体の O(n²) は 5000 件だと数十GBのコピーになるため 1000 件まで
+    for (int n : sizes) bench<LegacyItem>("legacy4K", n, n <= 1000);
+    return 0;
+}
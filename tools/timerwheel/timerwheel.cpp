@@ -0,0 +1,309 @@
+//==============================================================================
+// timerwheel — タイマーホイールのホスト側テスト（仮想時計）
+//
+//   timer_wheel.h をそのまま使い、仮想時計で dispatch() を回して確かめる:
+//     drift    周期ジョブを揺らぎのある間隔で1日回し、予定時刻が「初回 + n × 周期」から
+//              ずれないこと・早く呼ばれないこと
+//     gap      60秒ずつ眠ったとき、過ぎた周期を飛ばして1回だけ呼ぶこと（skipped）
+//     rearm    一度きりのジョブを自分の中で張り直す（fetch の形）。3時間先（段2より先）も
+//     defer    false を返したら retry_ms ごとに再試行し、予定時刻（位相）は据え置くこと
+//     cancel   同じスロットにいる他のジョブを、先に呼ばれたジョブが止める・張り直す
+//     random   16件の周期/一度きりのジョブをランダムな間隔で回し、単純な参照実装と
+//              呼ばれる dispatch・回数・nextIn を突き合わせる
+//     account  ジョブの所要時間（仮想 µs）が runs / total_us / max_us に入ること
+//   どれか破れば終了コード 1。
+//
+// ビルド（リポジトリのルートで）:
+//   g++ -std=c++17 -O2 -I. tools/timerwheel/timerwheel.cpp -o timerwheel
+//==============================================================================
+#include "timer_wheel.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <vector>
+#include <random>
+#include <utility>
+
+static uint64_t vclock_us = 0;              // 仮想時計（µs）
+static uint64_t clockUs() { return vclock_us; }
+static uint64_t nowMs() { return vclock_us / 1000; }
+static void advance(uint64_t ms) { vclock_us += ms * 1000; }
+
+static TimerWheel wheel;
+static int failures = 0;
+
+#define CHECK(cond, ...) do { if (!(cond)) { failures++; printf("  FAIL: " __VA_ARGS__); printf("\n"); } } while (0)
+
+static uint64_t ceilTick(uint64_t ms) { return (ms + TW_TICK_MS - 1) / TW_TICK_MS * TW_TICK_MS; }
+
+//------------------------------------------------------------------------------
+static int drift_id;
+static std::vector<uint64_t> drift_due, drift_at;
+static bool driftJob() {
+    drift_due.push_back(wheel.jobs[drift_id].due_ms);
+    drift_at.push_back(nowMs());
+    return true;
+}
+
+static void testDrift() {
+    printf("drift: 5s period, 1-400ms loop jitter, 24h\n");
+    std::mt19937 rng(1);
+    vclock_us = 123456789;
+    wheel.init(nowMs(), clockUs);
+    drift_due.clear(); drift_at.clear();
+    uint64_t start = nowMs();
+    drift_id = wheel.add("drift", driftJob, 5000, 5000, 0);
+    while (nowMs() - start < 24ULL * 3600 * 1000) {
+        advance(1 + rng() % 400);
+        wheel.dispatch(nowMs());
+    }
+    uint64_t worst = 0;
+    for (size_t k = 0; k < drift_due.size(); k++) {
+        CHECK(drift_due[k] == start + 5000 * (k + 1), "run %zu due %llu expected %llu", k,
+              (unsigned long long)drift_due[k], (unsigned long long)(start + 5000 * (k + 1)));
+        CHECK(drift_at[k] >= drift_due[k], "run %zu early", k);
+        if (drift_at[k] - drift_due[k] > worst) worst = drift_at[k] - drift_due[k];
+    }
+    CHECK(drift_due.size() == 24 * 720 - 1 || drift_due.size() == 24 * 720, "runs %zu", drift_due.size());
+    CHECK(wheel.jobs[drift_id].skipped == 0, "skipped %u", wheel.jobs[drift_id].skipped);
+    printf("  %zu runs, last due = start + %llums, worst late %llums\n", drift_due.size(),
+           (unsigned long long)(drift_due.back() - start), (unsigned long long)worst);
+}
+
+//------------------------------------------------------------------------------
+static int gap_runs = 0;
+static bool gapJob() { gap_runs++; return true; }
+
+static void testGap() {
+    printf("gap: 5s period, 60s sleeps\n");
+    vclock_us = 0;
+    wheel.init(0, clockUs);
+    gap_runs = 0;
+    int id = wheel.add("gap", gapJob, 5000, 5000, 0);
+    for (int k = 0; k < 60; k++) {
+        advance(60000);
+        wheel.dispatch(nowMs());
+    }
+    CHECK(gap_runs == 60, "runs %d (expected once per wake)", gap_runs);
+    CHECK(wheel.jobs[id].skipped == 60 * 11, "skipped %u", wheel.jobs[id].skipped);
+    CHECK(wheel.jobs[id].due_ms % 5000 == 0, "phase lost: due %llu", (unsigned long long)wheel.jobs[id].due_ms);
+    printf("  %d runs, %u skipped periods, next due %llums\n", gap_runs, wheel.jobs[id].skipped,
+           (unsigned long long)wheel.jobs[id].due_ms);
+}
+
+//------------------------------------------------------------------------------
+static int rearm_id, rearm_k;
+static uint64_t rearm_expect;
+static const uint32_t rearm_in[] = { 30000, 1800000, 60000, 10800000, 250, 7200000, 1000, 2700000 };
+static bool rearmJob() {
+    CHECK(nowMs() >= rearm_expect && nowMs() < ceilTick(rearm_expect) + 50,
+          "rearm %d at %llu expected %llu", rearm_k, (unsigned long long)nowMs(), (unsigned long long)rearm_expect);
+    rearm_k++;
+    if (rearm_k < (int)(sizeof(rearm_in) / sizeof(rearm_in[0]))) {
+        wheel.runIn(rearm_id, rearm_in[rearm_k]);
+        rearm_expect = nowMs() + rearm_in[rearm_k];
+    }
+    return true;
+}
+
+static void testRearm() {
+    printf("rearm: one-shot re-armed from inside the job (250ms .. 3h)\n");
+    vclock_us = 5;
+    wheel.init(nowMs(), clockUs);
+    rearm_k = 0;
+    rearm_id = wheel.once("rearm", rearmJob, rearm_in[0], 0);
+    rearm_expect = nowMs() + rearm_in[0];
+    while (rearm_k < 8 && nowMs() < 30ULL * 3600 * 1000) {
+        advance(50);
+        wheel.dispatch(nowMs());
+    }
+    CHECK(rearm_k == 8, "fired %d of 8", rearm_k);
+    CHECK(!wheel.jobs[rearm_id].armed, "one-shot still armed");
+    printf("  fired %d/8\n", rearm_k);
+}
+
+//------------------------------------------------------------------------------
+static bool defer_ready = false;
+static std::vector<uint64_t> defer_calls;
+static bool deferJob() { defer_calls.push_back(nowMs()); return defer_ready; }
+
+static void testDefer() {
+    printf("defer: job refuses for 7.5s, retry every 1s, period phase kept\n");
+    vclock_us = 0;
+    wheel.init(0, clockUs);
+    defer_ready = false;
+    defer_calls.clear();
+    int id = wheel.add("defer", deferJob, 60000, 60000, 0);
+    while (nowMs() < 60000 + 7500) { advance(10); wheel.dispatch(nowMs()); }
+    defer_ready = true;
+    while (nowMs() < 60000 * 3 + 100) { advance(10); wheel.dispatch(nowMs()); }
+    // 60000, 61000, ..., 67000 で断られ 68000 で実行、以後 120000, 180000
+    CHECK(wheel.jobs[id].deferred == 8, "deferred %u", wheel.jobs[id].deferred);
+    CHECK(wheel.jobs[id].runs == 3, "runs %u", wheel.jobs[id].runs);
+    CHECK(defer_calls.size() == 11 && defer_calls[8] == 68000 && defer_calls[9] == 120000 &&
+          defer_calls[10] == 180000, "calls %zu (%llu %llu)", defer_calls.size(),
+          defer_calls.size() > 9 ? (unsigned long long)defer_calls[8] : 0ULL,
+          defer_calls.size() > 9 ? (unsigned long long)defer_calls[9] : 0ULL);
+    CHECK(wheel.jobs[id].worst_late_ms == 8000, "worst late %u", wheel.jobs[id].worst_late_ms);
+    printf("  %zu calls, %u deferred, %u runs\n", defer_calls.size(), wheel.jobs[id].deferred, wheel.jobs[id].runs);
+}
+
+//------------------------------------------------------------------------------
+static int cancel_b, cancel_c;
+static int b_runs, c_runs, cancelled, moved;
+static uint64_t c_moved_to;
+static bool cancelA() {
+    if (b_runs == 0) { wheel.cancel(cancel_b); cancelled++; }
+    if (c_runs == 0) { wheel.runIn(cancel_c, 5000); c_moved_to = nowMs() + 5000; moved++; }
+    return true;
+}
+static bool cancelB() { b_runs++; return true; }
+static bool cancelC() {
+    c_runs++;
+    CHECK(c_moved_to == 0 || nowMs() >= c_moved_to, "moved job ran early");
+    return true;
+}
+
+static void testCancel() {
+    printf("cancel: a job cancels / moves jobs due in the same tick (all 6 orders)\n");
+    const int orders[6][3] = { {0,1,2}, {0,2,1}, {1,0,2}, {1,2,0}, {2,0,1}, {2,1,0} };
+    cancelled = moved = 0;
+    for (const auto& o : orders) {
+        vclock_us = 0;
+        wheel.init(0, clockUs);
+        b_runs = c_runs = 0;
+        c_moved_to = 0;
+        int before_cancel = cancelled, before_move = moved;
+        for (int k = 0; k < 3; k++) {
+            if (o[k] == 0) wheel.once("a", cancelA, 1000, 0);
+            if (o[k] == 1) cancel_b = wheel.once("b", cancelB, 1000, 0);
+            if (o[k] == 2) cancel_c = wheel.once("c", cancelC, 1000, 0);
+        }
+        for (int k = 0; k < 1000; k++) { advance(10); wheel.dispatch(nowMs()); }
+        CHECK(b_runs == (cancelled > before_cancel ? 0 : 1), "b ran %d times", b_runs);
+        CHECK(c_runs == 1, "c ran %d times%s", c_runs, moved > before_move ? " (moved)" : "");
+    }
+    CHECK(cancelled > 0 && moved > 0, "cancel/move path never exercised");
+    printf("  cancelled before running in %d/6, moved in %d/6\n", cancelled, moved);
+}
+
+//------------------------------------------------------------------------------
+// 参照実装: 各ジョブの「次に呼ぶ時刻」を表で持ち、dispatch ごとに期限切れを全部呼ぶ
+struct RefJob { uint32_t period; uint64_t due; bool armed; bool wake; };
+static RefJob ref[TW_MAX_JOBS];
+static int    fired[TW_MAX_JOBS];
+static bool   (*rand_fns[TW_MAX_JOBS])();
+static uint64_t job_cost_us[TW_MAX_JOBS];
+
+template <int N> static bool randJob() {
+    fired[N]++;
+    vclock_us += job_cost_us[N];
+    return true;
+}
+
+template <int... Ns> static void fillFns(std::integer_sequence<int, Ns...>) {
+    bool (*tbl[])() = { randJob<Ns>... };
+    for (int i = 0; i < (int)sizeof...(Ns); i++) rand_fns[i] = tbl[i];
+}
+
+static void testRandom() {
+    printf("random: 16 jobs (10ms .. 3h), dispatch steps 1ms .. 70s, 3 days\n");
+    std::mt19937 rng(7);
+    fillFns(std::make_integer_sequence<int, TW_MAX_JOBS>());
+    vclock_us = 1000ULL * 987654;
+    wheel.init(nowMs(), clockUs);
+    const uint32_t periods[] = { 10, 50, 120, 640, 650, 1000, 5000, 40960, 41000, 60000,
+                                 300000, 2621440, 2700000, 10800000, 0, 0 };
+    for (int i = 0; i < TW_MAX_JOBS; i++) {
+        uint32_t first = 1 + rng() % (periods[i] ? periods[i] : 5000000);
+        bool wake = i % 5 != 0;
+        job_cost_us[i] = 0;
+        int id = wheel.add("r", rand_fns[i], periods[i], first, (uint8_t)i, wake);
+        CHECK(id == i, "id %d", id);
+        ref[i] = { periods[i], nowMs() + first, true, wake };
+        fired[i] = 0;
+    }
+    int mismatches = 0;
+    uint64_t end = nowMs() + 3ULL * 24 * 3600 * 1000;
+    long dispatches = 0;
+    while (nowMs() < end) {
+        uint32_t r = rng() % 100;
+        advance(r < 70 ? 1 + rng() % 50 : r < 95 ? 1 + rng() % 2000 : 1 + rng() % 70000);
+        uint64_t now = nowMs();
+        int before[TW_MAX_JOBS];
+        for (int i = 0; i < TW_MAX_JOBS; i++) before[i] = fired[i];
+        wheel.dispatch(now);
+        dispatches++;
+        for (int i = 0; i < TW_MAX_JOBS; i++) {
+            int expect = ref[i].armed && ceilTick(ref[i].due) <= now ? 1 : 0;
+            if (fired[i] - before[i] != expect) {
+                if (mismatches++ < 5)
+                    printf("  FAIL: job %d at %llu fired %d expected %d (due %llu)\n", i,
+                           (unsigned long long)now, fired[i] - before[i], expect, (unsigned long long)ref[i].due);
+            }
+            if (expect) {
+                if (ref[i].period == 0) {
+                    ref[i].armed = false;
+                } else {
+                    uint64_t next = ref[i].due + ref[i].period;
+                    if (next <= now) next += ((now - next) / ref[i].period + 1) * ref[i].period;
+                    ref[i].due = next;
+                }
+            }
+            // 一度きりのジョブは時々張り直す
+            if (ref[i].period == 0 && !ref[i].armed && rng() % 50 == 0) {
+                uint32_t in = rng() % 20000000;
+                wheel.runIn(i, in);
+                ref[i].due = now + in;
+                ref[i].armed = true;
+            }
+        }
+        // nextIn: wake ジョブのうち最早
+        int64_t want = -1;
+        for (int i = 0; i < TW_MAX_JOBS; i++) {
+            if (!ref[i].armed || !ref[i].wake) continue;
+            int64_t in = (int64_t)ceilTick(ref[i].due) - (int64_t)now;
+            if (in < 0) in = 0;
+            if (want < 0 || in < want) want = in;
+        }
+        if (wheel.nextIn(now) != want && mismatches++ < 5)
+            printf("  FAIL: nextIn %lld expected %lld\n", (long long)wheel.nextIn(now), (long long)want);
+    }
+    failures += mismatches;
+    long total = 0;
+    for (int i = 0; i < TW_MAX_JOBS; i++) total += fired[i];
+    printf("  %ld dispatches, %ld calls, %d mismatches\n", dispatches, total, mismatches);
+}
+
+//------------------------------------------------------------------------------
+static void testAccount() {
+    printf("account: job run time from clock_us\n");
+    fillFns(std::make_integer_sequence<int, TW_MAX_JOBS>());
+    vclock_us = 0;
+    wheel.init(0, clockUs);
+    job_cost_us[0] = 1500;
+    job_cost_us[1] = 0;
+    fired[0] = fired[1] = 0;
+    int a = wheel.add("slow", rand_fns[0], 100, 100, 0);
+    int b = wheel.add("fast", rand_fns[1], 100, 100, 0);
+    for (int k = 0; k < 1000; k++) { advance(10); wheel.dispatch(nowMs()); }
+    const TimerJob& ja = wheel.jobs[a];
+    const TimerJob& jb = wheel.jobs[b];
+    CHECK(ja.runs > 0 && ja.total_us == (uint64_t)ja.runs * 1500 && ja.max_us == 1500,
+          "slow: runs %u total %llu max %u", ja.runs, (unsigned long long)ja.total_us, ja.max_us);
+    CHECK(jb.total_us == 0, "fast: total %llu", (unsigned long long)jb.total_us);
+    printf("  slow %u runs avg %lluus max %uus, fast %u runs\n", ja.runs,
+           (unsigned long long)(ja.runs ? ja.total_us / ja.runs : 0), ja.max_us, jb.runs);
+}
+
+int main() {
+    testDrift();
+    testGap();
+    testRearm();
+    testDefer();
+    testCancel();
+    testRandom();
+    testAccount();
+    printf("%s (%d failures)\n", failures == 0 ? "PASS" : "FAIL", failures);
+    return failures == 0 ? 0 : 1;
+}
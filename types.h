@@ -6,7 +6,7 @@
 //==============================================================================
 // ビルドバージョン (※コード更新時はここを変更)
 //==============================================================================
-#define BUILD_VERSION "039"
+#define BUILD_VERSION "064"
 
 //==============================================================================
 // ピン定義
@@ -24,14 +24,27 @@
 #define CONFIG_FILE             "/config.json"
 #define MIDI_DIR                "/midi"
 #define MIDI_DL_DIR             "/midi-dl"
+#define MIDI_PREARM_SEC         300     // アラームの何秒前に MIDI を先読みするか
+#define MIDI_AHEAD_MS           500     // パーサーが出力リングに積んでおく先の時間（loop() がこれ以上止まると遅れる）
+#define MIDI_ARM_MAX_BYTES      (512 * 1024)    // 先読みする MIDI の上限(byte, PSRAM)。超えると従来どおり SD から再生
 #define FONT_PATH               "/fonts/ipaexg.ttf"
 #define TZ_JST                  "JST-9"
 
-#define MAX_EVENTS              300
+#define MAX_EVENTS              2000    // イベントヘッダー数（本文は TextPool 側）
+#define TEXT_POOL_SIZE          (768 * 1024)    // バッファごとの本文プール(byte, PSRAM)
+#define MAX_DISPLAY_ROWS        20      // 一覧画面の最大表示行数
 #define MAX_ALARMS_PER_EVENT    6       // 1イベントあたりの最大アラーム数
 #define ITEMS_PER_PAGE          12
 #define SD_CHECK_INTERVAL_MS    300000  // 5分
+#define BROWSE_TIMEOUT_MS       30000   // 詳細・月表示・検索の無操作 → 一覧へ自動復帰
 #define MIN_HEAP_FOR_FETCH      20000   // ICSフェッチ前の最低ヒープ(byte) ※String排除後は低くてOK
+#define MAX_FETCH_URLS          8       // ics_url にカンマ区切りで指定できるURL(=ソース)数の上限
+#define FETCH_BLOCK_MS          10000   // WiFi再接続の見込み最大(ms) — 直前にアラームがあれば fetch を見送る
+#define FETCH_URL_BLOCK_MS      6000    // 1ソースの TLS接続+ヘッダー待ちの見込み最大(ms)
+#define NTFY_HOST               "ntfy.sh"
+#define ALARM_GROUP_MAX         8       // まとめて扱うアラーム数の上限（同時刻 + 鳴動中に来た分）
+#define ALARM_GROUP_MAX_MS      300000  // 2件以上のグループの鳴動時間の合計の上限(ms)
+#define ALARM_JOIN_MIN_MS       10000   // まとめモードで後から加わったアラームに残す最低鳴動時間(ms)
 
 #define BAUD_OPTION_COUNT       3
 #define PORT_COUNT              3
@@ -54,23 +67,68 @@ struct Config {
     bool time_24h;
     bool text_wrap;
     int ics_poll_min;
+    int ics_poll_each[MAX_FETCH_URLS];  // URL(ソース)ごとの更新間隔(分) 0=ics_poll_min を使用
+    bool ics_poll_adaptive;     // 取得間隔をアラーム・変化の有無で伸縮（poll_policy.h）
+    int poll_budget_fetches;    // 1日の取得回数の上限 0=無制限
+    int poll_budget_kb;         // 1日の通信量の上限(KB) 0=無制限
     int play_duration;          // デフォルト鳴動時間(秒) 0=1曲
     int play_repeat;
+    bool alarm_merge;           // 重なったアラーム: true=まとめて1回鳴らす, false=順番に鳴らす
     int max_events;
     int max_desc_bytes;
     int min_free_heap;          // ヒープ残量下限(KB)
 };
 
+// イベント本文用バンプアロケータ（ダブルバッファの各面に1つ、fetchごとにリセット）
+//   EventItem は固定長ヘッダーのみとし、本文は実サイズ分だけここに詰める。
+//   summary / description / midi_file は内容ハッシュでインターンし、繰り返し予定や
+//   同名の予定（"Standup" 等）は1つの文字列を共有する → 同一面内の等価判定はポインタ比較
+#define INTERN_SLOTS            8192    // インターン表のスロット数（2の冪、使用率 3/4 まで）
+#define DESC_PACK_MIN           256     // これ以上の説明文は取り込み時に圧縮（text_codec）
+#define DESC_MAX_BYTES          16000   // config.max_desc_bytes の上限（展開用スクラッチの大きさ）
+
+struct InternSlot {
+    uint32_t hash;
+    uint32_t len;               // バイト数（圧縮ブロックは NUL を含みうるため長さで比較）
+    const char* str;            // nullptr=空き
+};
+
+struct TextPool {
+    char* base;
+    uint32_t size;
+    uint32_t used;
+    InternSlot* intern;         // PSRAM, INTERN_SLOTS 個
+    uint32_t intern_count;      // 登録済み文字列数
+    uint32_t intern_saved;      // 共有により節約したバイト数
+};
+
+struct EventItem;
+const char* unpackDescription(const EventItem& e);     // ics_parser.cpp（共有スクラッチへ展開）
+
 struct EventItem {
     time_t start;
-    char text[4000];            // summary \0 description \0
-    char midi_file[64];
+    const char* summary_text;   // TextPool 内のインターン済み文字列（NUL終端）
+    const char* desc_text;      // 同上。desc_packed>0 なら圧縮ブロック（unpackDescription で展開）
+    const char* midi_file;      // 同上（空文字=なし）
+    const char* row_text;       // 一覧表示用の summary（removeUnsupportedChars 済み、同じプール内。多くは summary_text と共有）
+    uint16_t desc_packed;       // 0=平文、>0=圧縮ブロックのバイト数（[元の長さ u16][LZ]）
+    uint8_t source;             // 取得元URLのインデックス (0..MAX_FETCH_URLS-1)
+    uint32_t uid_hash;          // 同一性キー: ソース番号 + UID（UIDなしは summary）のハッシュ
+    uint32_t text_hash;         // 表示・アラーム内容のハッシュ（差分検出用）
     bool midi_is_url;
     bool has_alarm;
     bool is_allday;
+    bool text_plain;            // summary/desc は配信側（ics2bin）で HTML 整形済み（表示時に simplifyHtml しない）
     int play_duration_sec;      // 0=1曲 -1=設定値使用
     int play_repeat;            // -1=設定値使用
 
+    // ── 一覧の行表示（取り込み時に prepareRowText で計算、描画は切り出して描くだけ） ──
+    char time_text[10];         // "09:30" / " 9:30AM"（config.time_24h）、終日は "[終日]"（タイトル空なら ""）
+    uint16_t row_len;           // row_text のバイト数
+    uint16_t row_l1;            // 折り返しなし: 1行目に収まるバイト数（超過分は ".." を付ける）
+    uint16_t row_w1;            // 折り返しあり: 1行目のバイト数
+    uint16_t row_w2;            // 折り返しあり: 2行目の終端バイト位置
+
     // ── 複数アラーム対応 ──
     //   !-25,-15,-5! のように 1 イベントに最大 MAX_ALARMS_PER_EVENT 個指定可能
     int alarm_count;                            // 有効なアラーム数 (0..MAX_ALARMS_PER_EVENT)
@@ -78,10 +136,54 @@ struct EventItem {
     time_t alarm_time[MAX_ALARMS_PER_EVENT];    // 各アラームの絶対時刻
     bool triggered[MAX_ALARMS_PER_EVENT];       // 発火済みフラグ
 
-    // summary = text先頭（最初の\0まで）
-    const char* summary() const { return text; }
-    // description = summary\0の次から
-    const char* description() const { return text + strlen(text) + 1; }
+    const char* summary() const { return summary_text; }
+    const char* description() const { return desc_packed ? unpackDescription(*this) : desc_text; }
+};
+
+// ICSソース(URL)ごとの取得状態
+//   イベントバッファはソース単位のセグメントに分かれており、
+//   更新が必要なソースのセグメントだけを再取得して他ソースと再マージする
+struct SourceState {
+    time_t last_attempt;        // 最後に取得を試みた時刻（更新間隔の基準）
+    time_t last_success;        // 最後に取得に成功した時刻 (0=未成功)
+    uint8_t status;             // 0=unknown/未試行, 1=OK, 2=FAIL
+    int event_count;            // 直近マージ後にこのソースが占めるイベント数
+    // ── 取得間隔の適応制御（poll_policy.h） ──
+    int32_t poll_sec;           // 次の取得までの間隔（取得のたびに決める。0=未計画）
+    uint8_t poll_reason;        // PollReason
+    uint8_t unchanged;          // 内容が変わらなかった取得の連続回数
+    uint32_t content_sig;       // 直近に取得した内容の署名（0=未取得）
+    uint32_t avg_bytes;         // 1回の取得の推定バイト数（移動平均）
+};
+
+// fetch 差分（旧バッファ → 新バッファ、event_diff.cpp）
+#define DIFF_ADDED      0x01    // 新規（旧に同一UIDなし）
+#define DIFF_MOVED      0x02    // 開始時刻が変わった
+#define DIFF_CHANGED    0x04    // 本文・アラーム属性が変わった
+
+// dayStats() のフラグ（月表示用）
+#define DAY_ALARM       0x01    // アラーム付きイベントあり
+#define DAY_PENDING     0x02    // 未発火のアラームスロットあり
+
+// 公開中のイベント列の版（event_rcu.cpp）。公開後は不変で、読み手は pinEvents() で取り出す
+struct EventSnapshot {
+    EventItem* events;          // 先頭（rollEventWindow 後は面の途中）
+    int count;
+    uint32_t epoch;             // 公開ごとに +1
+    uint8_t face;               // 0=events_buf_a, 1=events_buf_b
+};
+
+// 版をまたいで持つイベント参照（index は版ごとに意味が変わるため同一性キーで引き直す）
+struct EventRef {
+    uint32_t uid_hash;
+    time_t start;
+    uint32_t epoch;             // idx が有効な版（0=無効）
+    int idx;
+};
+
+struct FetchDiff {
+    bool valid;                 // 直近の fetch で差分計算済み
+    int added, removed, moved, changed;
 };
 
 struct ButtonArea {
@@ -99,9 +201,13 @@ enum UiState {
     UI_KEYBOARD,
     UI_MIDI_SELECT,
     UI_BAUD_SELECT,
-    UI_PORT_SELECT
+    UI_PORT_SELECT,
+    UI_MONTH,
+    UI_SEARCH
 };
 
+#define KB_TARGET_SEARCH    (-2)    // keyboard_target: 検索クエリ入力（設定項目以外）
+
 enum SettingsItem {
     SET_ICS_UPDATE,
     SET_DEBUG_FETCH,
@@ -120,6 +226,7 @@ enum SettingsItem {
     SET_ICS_POLL,
     SET_PLAY_DURATION,
     SET_PLAY_REPEAT,
+    SET_ALARM_MERGE,
     SET_NTFY_TOPIC,
     SET_NTFY_TEST,
     SET_SOUND_TEST,
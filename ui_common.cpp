@@ -66,6 +66,44 @@ String formatTime(int hour, int minute) {
 }
 
 
+// 詳細・月表示・検索（30秒無操作で一覧に自動復帰する画面）
+bool browsingScreen() {
+    return ui_state == UI_DETAIL || ui_state == UI_MONTH || ui_state == UI_SEARCH ||
+           (ui_state == UI_KEYBOARD && keyboard_target == KB_TARGET_SEARCH);
+}
+
+// ヘッダー右の状態表示（drawList / partialRefreshHeader 共通）
+//   "22:31>22:45 fch1X fch3X !W !S" … 最終更新 > 次の取得予定（poll_policy.h が決めた時刻）、
+//   続けて失敗要素だけ追記（省電力で WiFi を切っている間は !W を出さない）
+void formatHeaderStatus(char* statusBuf, int size) {
+    int spos = 0;
+    if (last_fetch > 1000000000) {
+        struct tm ft; localtime_r(&last_fetch, &ft);
+        spos += snprintf(statusBuf + spos, size - spos,
+                         "%02d:%02d", ft.tm_hour, ft.tm_min);
+    } else {
+        spos += snprintf(statusBuf + spos, size - spos, "--:--");
+    }
+    time_t now = time(nullptr);
+    if (fetch_url_count > 0 && now >= 1700000000) {
+        time_t next = nextFetchTime(now);
+        struct tm nt; localtime_r(&next, &nt);
+        spos += snprintf(statusBuf + spos, size - spos, ">%02d:%02d", nt.tm_hour, nt.tm_min);
+    }
+    for (int i = 0; i < fetch_url_count && spos < size - 8; i++) {
+        if (source_state[i].status == 2) {
+            spos += snprintf(statusBuf + spos, size - spos,
+                             " fch%dX", i + 1);
+        }
+    }
+    if (WiFi.status() != WL_CONNECTED && !powerWifiOff()) {
+        spos += snprintf(statusBuf + spos, size - spos, " !W");
+    }
+    if (!sd_healthy) {
+        spos += snprintf(statusBuf + spos, size - spos, " !S");
+    }
+}
+
 //==============================================================================
 // 部分更新: ヘッダー時刻のみ（メインcanvas上で再描画 → 該当領域だけEPDにプッシュ）
 //==============================================================================
@@ -88,26 +126,7 @@ void partialRefreshHeader() {
     // 最終更新時刻 + URL毎のfetch状態 + WiFi/SD (drawListと揃える)
     canvas.setTextSize(22);
     char statusBuf[96];
-    int spos = 0;
-    if (last_fetch > 1000000000) {
-        struct tm ft; localtime_r(&last_fetch, &ft);
-        spos += snprintf(statusBuf + spos, sizeof(statusBuf) - spos,
-                         "%02d:%02d", ft.tm_hour, ft.tm_min);
-    } else {
-        spos += snprintf(statusBuf + spos, sizeof(statusBuf) - spos, "--:--");
-    }
-    for (int i = 0; i < fetch_url_count && spos < (int)sizeof(statusBuf) - 8; i++) {
-        if (fetch_url_status[i] == 2) {
-            spos += snprintf(statusBuf + spos, sizeof(statusBuf) - spos,
-                             " fch%dX", i + 1);
-        }
-    }
-    if (WiFi.status() != WL_CONNECTED) {
-        spos += snprintf(statusBuf + spos, sizeof(statusBuf) - spos, " !W");
-    }
-    if (!sd_healthy) {
-        spos += snprintf(statusBuf + spos, sizeof(statusBuf) - spos, " !S");
-    }
+    formatHeaderStatus(statusBuf, sizeof(statusBuf));
     canvas.setTextColor(COL_HEADER_TEXT);
     canvas.drawString(statusBuf, 260, 10);
 
@@ -131,14 +150,7 @@ void partialRefreshNextLine() {
     time_t now = time(nullptr);
 
     // 現在の「次のイベント」を計算
-    int newNextIdx = -1;
-    time_t nextTime = 0x7FFFFFFF;
-    for (int i = 0; i < event_count; i++) {
-        if (!events[i].is_allday && events[i].start > now && events[i].start < nextTime) {
-            nextTime = events[i].start;
-            newNextIdx = i;
-        }
-    }
+    int newNextIdx = findNextEventIdx(now);
 
     if (newNextIdx == displayed_next_event_idx) return;  // 変化なし
 
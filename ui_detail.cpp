@@ -162,7 +162,7 @@ void drawDetail(int idx, bool fast) {
     canvas.setTextSize(30);
     int summaryLineH = 38;
     int summaryLineW = 32;  // 全角16文字相当（30px × 16 ≈ 480px）
-    String summary = removeUnsupportedChars(simplifyHtml(e.summary()));
+    String summary = displayText(e, e.summary());
     while (summary.length() > 0 && y < 300) {
         // SUMMARY に "\n" が含まれる場合も改行として扱う
         int nlPos = findLiteralNewline(summary);
@@ -203,7 +203,7 @@ void drawDetail(int idx, bool fast) {
     const int maxY = 890;
     int skipLines = detail_scroll;
 
-    String desc = removeUnsupportedChars(simplifyHtml(e.description()));
+    String desc = displayText(e, e.description());
     bool hasMore = drawWrappedText(desc, DESC_LINE_W, DESC_LINE_H,
                                    10, maxY, skipLines, y, 3);
 
@@ -235,7 +235,7 @@ void drawPlaying(int idx) {
     drawTextBold("ALARM!", 270, 60, 3);
 
     canvas.setTextSize(34);
-    String summary = removeUnsupportedChars(simplifyHtml(e.summary()));
+    String summary = displayText(e, e.summary());
     String line1 = utf8Substring(summary, 28);
     drawTextBold(line1, 270, 140, 2);
     if (summary.length() > line1.length()) {
@@ -257,11 +257,32 @@ void drawPlaying(int idx) {
     info += " x" + String(play_repeat_remaining) + "回";
     drawTextBold(info, 270, 330, 2);
 
-    // DESCRIPTION（\nリテラル改行対応）
+    // 鳴動グループの他のアラーム（まとめモード: 一緒に鳴っている分 / 順番モード: この後の分）
     canvas.setTextDatum(TL_DATUM);
     canvas.setTextSize(26);
-    String desc = removeUnsupportedChars(simplifyHtml(e.description()));
     int y = 380;
+    int others[ALARM_GROUP_MAX];
+    int n_others = ringGroupOthers(others, ALARM_GROUP_MAX);
+    if (n_others > 0) {
+        char head[48];
+        snprintf(head, sizeof(head), config.alarm_merge ? "同時のアラーム %d件" : "この後に鳴らす %d件", n_others);
+        drawTextBold(head, 20, y, 1);
+        y += 36;
+        for (int k = 0; k < n_others && k < 4; k++) {
+            EventItem& o = events[others[k]];
+            struct tm ot;
+            localtime_r(&o.start, &ot);
+            String line = formatTime(ot.tm_hour, ot.tm_min) + " " +
+                          utf8Substring(displayText(o, o.summary()), 24);
+            drawTextBold(line, 34, y, 1);
+            y += 34;
+        }
+        canvas.drawLine(20, y + 4, 520, y + 4, 10);
+        y += 16;
+    }
+
+    // DESCRIPTION（\nリテラル改行対応）
+    String desc = displayText(e, e.description());
     const int maxY = 880;
     int skipLines = 0;
     drawWrappedText(desc, 34, 34, 20, maxY, skipLines, y, 3);
@@ -36,7 +36,9 @@ void drawKeyboard() {
     static const char* field_names[] = {
         "WiFi SSID", "WiFi Pass", "ICS URL", "ICS User", "ICS Pass", "", "MIDI URL"
     };
-    if (keyboard_target >= 0 && keyboard_target <= SET_MIDI_URL) {
+    if (keyboard_target == KB_TARGET_SEARCH) {
+        drawText("検索（タイトル・説明文）", 10, 10);
+    } else if (keyboard_target >= 0 && keyboard_target <= SET_MIDI_URL) {
         drawText(String("編集: ") + field_names[keyboard_target], 10, 10);
     }
 
@@ -126,7 +128,8 @@ void drawKeyboard() {
     canvas.drawString("ESC", bx + 16, btnY + 14);
 
     canvas.setTextSize(20);
-    drawText("タップで入力 / OK:保存 / ESC:キャンセル", 10, 925);
+    drawText(keyboard_target == KB_TARGET_SEARCH ? "タップで入力 / OK:検索 / ESC:一覧へ"
+                                                 : "タップで入力 / OK:保存 / ESC:キャンセル", 10, 925);
     canvas.pushCanvas(0, 0, UPDATE_MODE_GC16);
 }
 
@@ -183,6 +186,14 @@ void processKeyboardHit(int hit) {
     } else if (hit == -3) {
         keyboard_buffer = "";
     } else if (hit == -4) {
+        if (keyboard_target == KB_TARGET_SEARCH) {
+            keyboard_symbol_mode = false;
+            keyboard_caps = false;
+            runSearch(keyboard_buffer);
+            ui_state = UI_SEARCH;
+            drawSearch();
+            return;
+        }
         // OK — 保存して戻る
         switch (keyboard_target) {
             case SET_WIFI_SSID: strlcpy(config.wifi_ssid, keyboard_buffer.c_str(), sizeof(config.wifi_ssid)); break;
@@ -202,6 +213,11 @@ void processKeyboardHit(int hit) {
         // ESC
         keyboard_symbol_mode = false;
         keyboard_caps = false;
+        if (keyboard_target == KB_TARGET_SEARCH) {
+            ui_state = UI_LIST;
+            drawList(false, false, false, true);
+            return;
+        }
         ui_state = UI_SETTINGS;
         drawSettings();
         return;
@@ -6,22 +6,22 @@ void scrollToToday() {
     time_t now_t = time(nullptr);
     struct tm now_tm;
     localtime_r(&now_t, &now_tm);
-    int today = now_tm.tm_mday + now_tm.tm_mon * 100 + now_tm.tm_year * 10000;
+    uint16_t today = dayKeyOf(now_t);
 
     Serial.printf("[SCROLL] today=%d/%d (%d), events=%d\n",
                   now_tm.tm_mon + 1, now_tm.tm_mday, today, event_count);
 
+    // 今日以降の最初のイベント（ホット索引の日バケット）
+    int first = firstEventOnOrAfterDay(today);
+
     // 今日の予定があるか確認（デバッグ用）
     int today_count = 0;
-    for (int i = 0; i < event_count; i++) {
+    for (int i = first; i < event_count && eventDayKey(i) == today; i++) {
         struct tm t;
         localtime_r(&events[i].start, &t);
-        int day = t.tm_mday + t.tm_mon * 100 + t.tm_year * 10000;
-        if (day == today) {
-            today_count++;
-            Serial.printf("[SCROLL] today event[%d]: %02d:%02d %s\n",
-                          i, t.tm_hour, t.tm_min, events[i].summary());
-        }
+        today_count++;
+        Serial.printf("[SCROLL] today event[%d]: %02d:%02d %s\n",
+                      i, t.tm_hour, t.tm_min, events[i].summary());
     }
     if (today_count == 0) {
         Serial.println("[SCROLL] NO events for today");
@@ -35,16 +35,11 @@ void scrollToToday() {
         }
     }
 
-    for (int i = 0; i < event_count; i++) {
-        struct tm t;
-        localtime_r(&events[i].start, &t);
-        int day = t.tm_mday + t.tm_mon * 100 + t.tm_year * 10000;
-        if (day >= today) {
-            page_start = i;
-            selected_event = i;
-            Serial.printf("[SCROLL] page_start=%d (day=%d)\n", i, day);
-            return;
-        }
+    if (first < event_count) {
+        page_start = first;
+        selected_event = first;
+        Serial.printf("[SCROLL] page_start=%d (day=%d)\n", first, eventDayKey(first));
+        return;
     }
     page_start = 0;
     selected_event = 0;
@@ -53,70 +48,80 @@ void scrollToToday() {
 // 1行分のイベント描画（drawListとupdateListCursorから共通利用）
 static const int ROW_H = 46;
 
+// 一覧の行の表示幅（半角=1, 全角=2）
+#define ROW_WIDTH_SINGLE    28      // 折り返しなし
+#define ROW_WIDTH_WRAP1     24      // 折り返しあり 1行目
+#define ROW_WIDTH_WRAP2     30      // 折り返しあり 2行目
+
+// 行表示フィールドを計算（取り込み時・スナップショット復元時・時刻表記の切り替え時）
+//   row_text は取り込み時に removeUnsupportedChars 相当を済ませた summary。
+//   折り返しの有無どちらの設定でも描けるよう、両方の切り詰め位置をバイト位置で持つ
+void prepareRowText(EventItem& e) {
+    int len = strlen(e.row_text);
+    if (e.is_allday) {
+        // タイトルが空の終日予定は [終日] ラベルも出さない（幽霊行回避）
+        strlcpy(e.time_text, len > 0 ? "[終日]" : "", sizeof(e.time_text));
+    } else {
+        struct tm st;
+        localtime_r(&e.start, &st);
+        strlcpy(e.time_text, formatTime(st.tm_hour, st.tm_min).c_str(), sizeof(e.time_text));
+    }
+    e.row_len = (uint16_t)len;
+    e.row_l1 = (uint16_t)utf8FitBytes(e.row_text, len, ROW_WIDTH_SINGLE);
+    e.row_w1 = (uint16_t)utf8FitBytes(e.row_text, len, ROW_WIDTH_WRAP1);
+    e.row_w2 = (uint16_t)(e.row_w1 + utf8FitBytes(e.row_text + e.row_w1, len - e.row_w1, ROW_WIDTH_WRAP2));
+}
+
+// 公開中の全イベント（設定で時刻表記を切り替えたとき）
+void prepareAllRowText() {
+    for (int i = 0; i < event_count; i++) prepareRowText(events[i]);
+}
+
+// row_text[from, to) を描く（本文プールの文字列は NUL 終端が行末にないため作業バッファへ切り出す）
+static void drawRowSlice(const EventItem& e, int from, int to, const char* suffix, int x, int y) {
+    char line[ICS_SUMMARY_BUF + 4];
+    int n = to - from;
+    memcpy(line, e.row_text + from, n);
+    strcpy(line + n, suffix);
+    canvas.drawString(line, x, y);
+}
+
 static void drawEventRow(int evtIdx, int y, bool highlighted, int nextEventIdx) {
+    const EventItem& e = events[evtIdx];
     int rowH = ROW_H;
     canvas.setTextSize(28);
     canvas.setTextColor(COL_ROW_TEXT);
 
-    struct tm st;
-    localtime_r(&events[evtIdx].start, &st);
-
-    String summary = removeUnsupportedChars(events[evtIdx].summary());
-
-    String timeStr;
-    if (events[evtIdx].is_allday) {
-        // タイトルが空の終日予定は [終日] ラベルも出さない（幽霊行回避）
-        timeStr = summary.length() > 0 ? "[終日]" : "";
-    } else {
-        timeStr = formatTime(st.tm_hour, st.tm_min);
-    }
-
-    String alarmMark = "";
+    const char* alarmMark = nullptr;
     bool showAlarmMark = false;
-    if (events[evtIdx].has_alarm) {
-        bool anyPending = false;
-        for (int k = 0; k < events[evtIdx].alarm_count; k++) {
-            if (!events[evtIdx].triggered[k]) { anyPending = true; break; }
-        }
-        alarmMark = anyPending ? "♪" : "*";
-        showAlarmMark = anyPending;
+    if (e.has_alarm) {
+        showAlarmMark = eventHasPendingAlarm(evtIdx);
+        alarmMark = showAlarmMark ? "♪" : "*";
     }
 
-    int maxWidth = config.text_wrap ? 24 : 28;
-    String dispSummary = utf8Substring(summary, maxWidth);
-
     const int TIME_X = 10;
     const int MARK_X = 96;
     const int SUMMARY_X = 124;
 
-    if (config.text_wrap && summary.length() > dispSummary.length()) {
-        drawText(timeStr, TIME_X, y + 1);
-        if (showAlarmMark) {
-            canvas.fillRect(MARK_X - 2, y, 28, 28, COL_ALARM_BADGE_BG);
-            canvas.setTextColor(COL_ALARM_BADGE_FG);
-            drawText(alarmMark, MARK_X, y + 1);
-            canvas.setTextColor(COL_ROW_TEXT);
-        } else if (alarmMark.length() > 0) {
-            drawText(alarmMark, MARK_X, y + 1);
-        }
-        drawText(dispSummary, SUMMARY_X, y + 1);
+    bool wrap = config.text_wrap && e.row_len > e.row_w1;
+    int ty = wrap ? y + 1 : y + 9;
+    canvas.drawString(e.time_text, TIME_X, ty);
+    if (showAlarmMark) {
+        canvas.fillRect(MARK_X - 2, ty - 1, 28, 28, COL_ALARM_BADGE_BG);
+        canvas.setTextColor(COL_ALARM_BADGE_FG);
+        canvas.drawString(alarmMark, MARK_X, ty);
+        canvas.setTextColor(COL_ROW_TEXT);
+    } else if (alarmMark) {
+        canvas.drawString(alarmMark, MARK_X, ty);
+    }
+
+    if (wrap) {
+        drawRowSlice(e, 0, e.row_w1, "", SUMMARY_X, ty);
         canvas.setTextSize(24);
-        String rest = summary.substring(dispSummary.length());
-        String line2 = utf8Substring(rest, 30);
-        drawText(line2, 85, y + 25);
+        drawRowSlice(e, e.row_w1, e.row_w2, "", 85, y + 25);
     } else {
-        drawText(timeStr, TIME_X, y + 9);
-        if (showAlarmMark) {
-            canvas.fillRect(MARK_X - 2, y + 8, 28, 28, COL_ALARM_BADGE_BG);
-            canvas.setTextColor(COL_ALARM_BADGE_FG);
-            drawText(alarmMark, MARK_X, y + 9);
-            canvas.setTextColor(COL_ROW_TEXT);
-        } else if (alarmMark.length() > 0) {
-            drawText(alarmMark, MARK_X, y + 9);
-        }
-        String dispPart = dispSummary;
-        if (summary.length() > dispSummary.length()) dispPart += "..";
-        drawText(dispPart, SUMMARY_X, y + 9);
+        int l1 = config.text_wrap ? e.row_w1 : e.row_l1;
+        drawRowSlice(e, 0, l1, l1 < e.row_len ? ".." : "", SUMMARY_X, ty);
     }
 
     if (evtIdx == nextEventIdx) {
@@ -157,14 +162,7 @@ void updateListCursor(int old_sel, int new_sel) {
 
     // nextEventIdx を求める
     time_t now = time(nullptr);
-    int nextEventIdx = -1;
-    time_t nextEventTime = 0x7FFFFFFF;
-    for (int i = 0; i < event_count; i++) {
-        if (!events[i].is_allday && events[i].start > now && events[i].start < nextEventTime) {
-            nextEventTime = events[i].start;
-            nextEventIdx = i;
-        }
-    }
+    int nextEventIdx = findNextEventIdx(now);
 
     // 旧カーソル行: ハイライト除去
     canvas.fillRect(0, row_y0[old_d], 540, rowH, COL_BG);
@@ -205,30 +203,10 @@ void drawList(bool fast, bool skip_push, bool highlight_changes, bool clean_refr
     drawText(buf, 10, 8);
     drawText(buf, 11, 8);
 
-    // 最終更新時刻 + URL毎のfetch状態 + WiFi/SD
-    //   "22:31 fch1X fch3X !W !S"  のように失敗要素だけ追記
+    // 最終更新時刻 > 次の取得予定 + URL毎のfetch状態 + WiFi/SD
     canvas.setTextSize(22);
     char statusBuf[96];
-    int spos = 0;
-    if (last_fetch > 1000000000) {
-        struct tm ft; localtime_r(&last_fetch, &ft);
-        spos += snprintf(statusBuf + spos, sizeof(statusBuf) - spos,
-                         "%02d:%02d", ft.tm_hour, ft.tm_min);
-    } else {
-        spos += snprintf(statusBuf + spos, sizeof(statusBuf) - spos, "--:--");
-    }
-    for (int i = 0; i < fetch_url_count && spos < (int)sizeof(statusBuf) - 8; i++) {
-        if (fetch_url_status[i] == 2) {
-            spos += snprintf(statusBuf + spos, sizeof(statusBuf) - spos,
-                             " fch%dX", i + 1);
-        }
-    }
-    if (WiFi.status() != WL_CONNECTED) {
-        spos += snprintf(statusBuf + spos, sizeof(statusBuf) - spos, " !W");
-    }
-    if (!sd_healthy) {
-        spos += snprintf(statusBuf + spos, sizeof(statusBuf) - spos, " !S");
-    }
+    formatHeaderStatus(statusBuf, sizeof(statusBuf));
     canvas.setTextColor(COL_HEADER_TEXT);
     drawText(statusBuf, 260, 10);
 
@@ -245,16 +223,7 @@ void drawList(bool fast, bool skip_push, bool highlight_changes, bool clean_refr
     int listBottom = 850;
 
     // 「次の予定」を見つける
-    int nextEventIdx = -1;
-    time_t nextEventTime = 0x7FFFFFFF;
-    for (int i = 0; i < event_count; i++) {
-        if (!events[i].is_allday && events[i].start > now) {
-            if (events[i].start < nextEventTime) {
-                nextEventTime = events[i].start;
-                nextEventIdx = i;
-            }
-        }
-    }
+    int nextEventIdx = findNextEventIdx(now);
     displayed_next_event_idx = nextEventIdx;  // 部分更新用に記録
 
     if (event_count == 0) {
@@ -282,99 +251,48 @@ void drawList(bool fast, bool skip_push, bool highlight_changes, bool clean_refr
 
     // ★ 今日の日付が表示範囲に含まれない場合、空ヘッダーを挿入
     //    例: 今日2/15に予定なし → page_startが2/16のイベント → 2/15が見えない
-    {
-        struct tm now_tm;
-        localtime_r(&now, &now_tm);
-        int today = now_tm.tm_mday + now_tm.tm_mon * 100 + now_tm.tm_year * 10000;
-
-        // page_startの日付を取得
-        bool today_has_events = false;
-        if (page_start < event_count) {
-            struct tm ps_tm;
-            localtime_r(&events[page_start].start, &ps_tm);
-            int ps_day = ps_tm.tm_mday + ps_tm.tm_mon * 100 + ps_tm.tm_year * 10000;
-            today_has_events = (ps_day == today);
+    //    今日の予定数と「今日があるべき位置」は日バケットから引く（localtime_r 走査なし）
+    uint16_t today = dayKeyOf(now);
+    int today_first = 0;
+    if (event_count > 0 && eventsOnDay(today, &today_first) == 0 && page_start == today_first) {
+        // 今日の空ヘッダーを描画（薄めのスタイル）
+        canvas.fillRect(0, y, 540, 38, COL_DATE_EMPTY_BG);
+        canvas.setTextSize(28);
+        snprintf(buf, sizeof(buf), "── %d/%d (%s) ──",
+                 lt.tm_mon + 1, lt.tm_mday,
+                 (lt.tm_wday == 0) ? "日" : (lt.tm_wday == 1) ? "月" :
+                 (lt.tm_wday == 2) ? "火" : (lt.tm_wday == 3) ? "水" :
+                 (lt.tm_wday == 4) ? "木" : (lt.tm_wday == 5) ? "金" : "土");
+        canvas.setTextColor(COL_DATE_EMPTY_TEXT);
+        drawText(buf, 120, y + 5);
+        // 太字なし（通常は2回描画で太字化）
+        canvas.setTextColor(COL_TEXT);
+        if (date_header_count < 10) {
+            date_header_y0[date_header_count] = y;
+            date_header_y1[date_header_count] = y + 38;
+            date_header_count++;
         }
+        Serial.printf("[LIST] date header at y=%d: %s (today, no events)\n", y, buf);
+        y += 42;
 
-        // 今日のイベントが無く、page_startが今日以降を指している場合
-        if (!today_has_events && page_start > 0) {
-            // page_startの前のイベントが今日より前 = 今日は空
-            struct tm prev_tm;
-            localtime_r(&events[page_start - 1].start, &prev_tm);
-            int prev_day = prev_tm.tm_mday + prev_tm.tm_mon * 100 + prev_tm.tm_year * 10000;
-            if (prev_day < today) {
-                // 今日の空ヘッダーを描画（薄めのスタイル）
-                canvas.fillRect(0, y, 540, 38, COL_DATE_EMPTY_BG);
-                canvas.setTextSize(28);
-                snprintf(buf, sizeof(buf), "── %d/%d (%s) ──",
-                         now_tm.tm_mon + 1, now_tm.tm_mday,
-                         (now_tm.tm_wday == 0) ? "日" : (now_tm.tm_wday == 1) ? "月" :
-                         (now_tm.tm_wday == 2) ? "火" : (now_tm.tm_wday == 3) ? "水" :
-                         (now_tm.tm_wday == 4) ? "木" : (now_tm.tm_wday == 5) ? "金" : "土");
-                canvas.setTextColor(COL_DATE_EMPTY_TEXT);
-                drawText(buf, 120, y + 5);
-                // 太字なし（通常は2回描画で太字化）
-                canvas.setTextColor(COL_TEXT);
-                if (date_header_count < 10) {
-                    date_header_y0[date_header_count] = y;
-                    date_header_y1[date_header_count] = y + 38;
-                    date_header_count++;
-                }
-                Serial.printf("[LIST] date header at y=%d: %s (today, no events)\n", y, buf);
-                y += 42;
-
-                // 「予定なし」表示
-                canvas.setTextSize(24);
-                canvas.setTextColor(COL_NO_EVENT_TEXT);
-                drawText("予定なし", 200, y + 8);
-                canvas.setTextColor(COL_TEXT);
-                y += 42;
-                lastDay = today;
-            }
-        }
-        // page_start == 0 で今日のイベントがない場合（全イベントが今日より後）
-        else if (!today_has_events && page_start == 0 && event_count > 0) {
-            struct tm first_tm;
-            localtime_r(&events[0].start, &first_tm);
-            int first_day = first_tm.tm_mday + first_tm.tm_mon * 100 + first_tm.tm_year * 10000;
-            if (first_day > today) {
-                canvas.fillRect(0, y, 540, 38, COL_DATE_EMPTY_BG);
-                canvas.setTextSize(28);
-                snprintf(buf, sizeof(buf), "── %d/%d (%s) ──",
-                         now_tm.tm_mon + 1, now_tm.tm_mday,
-                         (now_tm.tm_wday == 0) ? "日" : (now_tm.tm_wday == 1) ? "月" :
-                         (now_tm.tm_wday == 2) ? "火" : (now_tm.tm_wday == 3) ? "水" :
-                         (now_tm.tm_wday == 4) ? "木" : (now_tm.tm_wday == 5) ? "金" : "土");
-                canvas.setTextColor(COL_DATE_EMPTY_TEXT);
-                drawText(buf, 120, y + 5);
-                canvas.setTextColor(COL_TEXT);
-                if (date_header_count < 10) {
-                    date_header_y0[date_header_count] = y;
-                    date_header_y1[date_header_count] = y + 38;
-                    date_header_count++;
-                }
-                Serial.printf("[LIST] date header at y=%d: %s (today, no events)\n", y, buf);
-                y += 42;
-
-                canvas.setTextSize(24);
-                canvas.setTextColor(COL_NO_EVENT_TEXT);
-                drawText("予定なし", 200, y + 8);
-                canvas.setTextColor(COL_TEXT);
-                y += 42;
-                lastDay = today;
-            }
-        }
+        // 「予定なし」表示
+        canvas.setTextSize(24);
+        canvas.setTextColor(COL_NO_EVENT_TEXT);
+        drawText("予定なし", 200, y + 8);
+        canvas.setTextColor(COL_TEXT);
+        y += 42;
+        lastDay = today;
     }
 
     for (int i = page_start; i < event_count && y < listBottom; i++) {
-        struct tm st;
-        localtime_r(&events[i].start, &st);
-
-        // 日付ヘッダー
-        int thisDay = st.tm_mday + st.tm_mon * 100 + st.tm_year * 10000;
+        // 日付ヘッダー（日番号はホット索引から。ヘッダーを描く行だけ localtime_r）
+        int thisDay = eventDayKey(i);
         if (thisDay != lastDay && date_header_count < 10) {
             if (y + 38 + rowH > listBottom) break;
 
+            struct tm st;
+            localtime_r(&events[i].start, &st);
+
             canvas.fillRect(0, y, 540, 38, COL_DATE_BG);
             canvas.setTextSize(28);
             snprintf(buf, sizeof(buf), "── %d/%d (%s) ──",
@@ -395,6 +313,7 @@ void drawList(bool fast, bool skip_push, bool highlight_changes, bool clean_refr
         }
 
         if (y + rowH > listBottom) break;
+        if (displayed >= MAX_DISPLAY_ROWS) break;   // 行テーブルは画面行数分のみ
 
         row_y0[displayed] = y;
         row_y1[displayed] = y + rowH;
@@ -410,12 +329,8 @@ void drawList(bool fast, bool skip_push, bool highlight_changes, bool clean_refr
 
         // デバッグ: 最初の3行 + 変更行を出力
         if (displayed < 3 || changed) {
-            struct tm dbg_st;
-            localtime_r(&events[i].start, &dbg_st);
-            String dbg_time = events[i].is_allday ? "[終日]" : formatTime(dbg_st.tm_hour, dbg_st.tm_min);
-            String dbg_sum = removeUnsupportedChars(events[i].summary());
             Serial.printf("[LIST] row %d: y=%d time='%s' sum='%s' (len=%d)%s\n",
-                          displayed, y, dbg_time.c_str(), dbg_sum.c_str(), dbg_sum.length(),
+                          displayed, y, events[i].time_text, events[i].row_text, events[i].row_len,
                           changed ? " [CHANGED]" : "");
         }
 
@@ -428,20 +343,8 @@ void drawList(bool fast, bool skip_push, bool highlight_changes, bool clean_refr
 
     // 次のアラーム表示（全イベント×全スロット中、now以降で最早のもの）
     canvas.setTextSize(26);
-    time_t nextAlarm = 0;
-    bool nextFound = false;
-    for (int i = 0; i < event_count; i++) {
-        if (!events[i].has_alarm) continue;
-        for (int k = 0; k < events[i].alarm_count; k++) {
-            if (events[i].triggered[k]) continue;
-            time_t at = events[i].alarm_time[k];
-            if (at <= now) continue;
-            if (!nextFound || at < nextAlarm) {
-                nextAlarm = at;
-                nextFound = true;
-            }
-        }
-    }
+    time_t nextAlarm = nextPendingAlarm(now);
+    bool nextFound = (nextAlarm != 0);
     if (nextFound) {
         struct tm al;
         localtime_r(&nextAlarm, &al);
@@ -488,3 +391,96 @@ void drawList(bool fast, bool skip_push, bool highlight_changes, bool clean_refr
     // 表示内容スナップショット保存（pushの有無に関わらず内部状態を同期）
     saveDisplaySnapshot();
 }
+
+//==============================================================================
+// fetch 後のリスト更新（fetch_diff に応じて更新範囲を絞る）
+//   差分なし          → ヘッダー（最終更新時刻）のみ部分更新
+//   表示範囲で並び変化 → 従来どおり今日へスクロールして全面 GLR16
+//   それ以外          → 旧 index を新 index に付け替えて再描画し、
+//                       レイアウトが同じなら表示文字列の変わった行とヘッダー・フッターだけ送る
+//==============================================================================
+void refreshListAfterFetch() {
+    if (!fetch_diff.valid || displayed_count == 0) {
+        scrollToToday();
+        partial_refresh_count = 0;
+        drawList(false, false, false, true);
+        return;
+    }
+    if (diffIsEmpty()) {
+        Serial.println("[LIST] fetch: no changes - header only");
+        partialRefreshHeader();
+        return;
+    }
+
+    // 旧画面が映していた時間帯: 直前のイベント（今日の空ヘッダー判定に使う）〜画面外の次イベント
+    time_t from = (page_start > 0) ? diffOldStart(page_start - 1) : 0;
+    time_t next_off = diffOldStart(row_event_idx[displayed_count - 1] + 1);
+    time_t to = next_off ? next_off : (time_t)0x7FFFFFFF;
+    int new_page = diffMapOldIndex(page_start);
+    int new_sel = diffMapOldIndex(selected_event);
+    if (diffStructuralInRange(from, to) || new_page < 0 || new_sel < 0) {
+        Serial.println("[LIST] fetch: visible rows added/removed/moved - full redraw");
+        scrollToToday();
+        partial_refresh_count = 0;
+        drawList(false, false, false, true);
+        return;
+    }
+
+    // 旧レイアウトと表示文字列を退避（drawList がスナップショットを上書きするため）
+    static DisplayRow* old_text = nullptr;
+    if (!old_text) old_text = (DisplayRow*)ps_malloc(sizeof(DisplayRow) * MAX_DISPLAY_ROWS);
+    int old_count = displayed_count;
+    int old_y0[MAX_DISPLAY_ROWS];
+    int old_hdr_y0[10];
+    int old_hdr_count = date_header_count;
+    memcpy(old_y0, row_y0, sizeof(old_y0));
+    memcpy(old_hdr_y0, date_header_y0, sizeof(old_hdr_y0));
+    int old_text_count = old_text ? last_pushed_count : 0;
+    if (old_text) memcpy(old_text, last_pushed, sizeof(DisplayRow) * old_text_count);
+
+    Serial.printf("[LIST] fetch: remap page %d->%d sel %d->%d\n",
+                  page_start, new_page, selected_event, new_sel);
+    page_start = new_page;
+    selected_event = new_sel;
+    drawList(false, true);      // canvas のみ更新
+
+    bool same_layout = (displayed_count == old_count) && (date_header_count == old_hdr_count) &&
+                       (old_text_count == last_pushed_count) &&
+                       memcmp(old_y0, row_y0, sizeof(int) * old_count) == 0 &&
+                       memcmp(old_hdr_y0, date_header_y0, sizeof(int) * old_hdr_count) == 0;
+    if (!same_layout) {
+        Serial.println("[LIST] fetch: layout changed - full push");
+        canvas.pushCanvas(0, 0, UPDATE_MODE_GLR16);
+        return;
+    }
+
+    uint8_t* buf_ptr = (uint8_t*)canvas.frameBuffer(1);
+    if (!buf_ptr) return;
+    int stride = 540 / 2;  // 270 bytes/row (4bit grayscale)
+    unsigned long t0 = millis();
+    int pushed = 0;
+    for (int d = 0; d < displayed_count; d++) {
+        if (strcmp(old_text[d].display_text, last_pushed[d].display_text) == 0) continue;
+        int y = row_y0[d];
+        M5.EPD.WritePartGram4bpp(0, y, 540, ROW_H, buf_ptr + y * stride);
+        M5.EPD.UpdateArea(0, y, 540, ROW_H, UPDATE_MODE_GL16);
+        pushed++;
+    }
+    // ヘッダー（最終更新時刻）とフッター（件数・次AL）
+    M5.EPD.WritePartGram4bpp(0, 0, 540, 40, buf_ptr);
+    M5.EPD.UpdateArea(0, 0, 540, 40, UPDATE_MODE_GL16);
+    M5.EPD.WritePartGram4bpp(0, 850, 540, 45, buf_ptr + 850 * stride);
+    M5.EPD.UpdateArea(0, 850, 540, 45, UPDATE_MODE_GL16);
+    Serial.printf("[LIST] fetch: partial push %d/%d rows (%lums)\n",
+                  pushed, displayed_count, millis() - t0);
+}
+
+// 日付の切り替わりで先頭 cut 件（過去ウィンドウ外の日）を切り離した後:
+//   画面上の index をずらして全面再描画（0時の GC16 を兼ねる）
+void refreshListAfterRoll(int cut) {
+    page_start = max(0, page_start - cut);
+    selected_event = max(0, selected_event - cut);
+    displayed_next_event_idx = -1;
+    partial_refresh_count = 0;
+    drawList();
+}
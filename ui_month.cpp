@@ -0,0 +1,128 @@
+#include "globals.h"
+#include "ui_colors.h"
+#include <time.h>
+
+//==============================================================================
+// 月表示画面
+//   日ごとの件数とアラーム有無をホット索引の日バケット（dayStats）から描く。
+//   events[] の本文・PSRAM には触れないため、月送りは描画時間だけで済む。
+//   日付タップでその日の一覧へ、ボタン/スイッチで前月・翌月・今月・一覧。
+//==============================================================================
+
+#define MONTH_GRID_X     1
+#define MONTH_GRID_Y     96
+#define MONTH_CELL_W     77
+#define MONTH_CELL_H     118
+#define MONTH_ROWS       6
+
+static uint16_t month_day1 = 0;     // 表示中の月の1日の日番号
+static int      month_wday1 = 0;    // 1日の曜日（0=日）
+static int      month_ndays = 0;
+
+static int daysInMonth(int year, int mon) {
+    static const int days[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    if (mon == 1 && ((year % 4 == 0 && year % 100 != 0) || year % 400 == 0)) return 29;
+    return days[mon];
+}
+
+void drawMonth(bool fast) {
+    unsigned long t0 = millis();
+    canvas.fillCanvas(COL_BG);
+    canvas.setTextColor(COL_TEXT);
+    canvas.setTextDatum(TL_DATUM);
+
+    time_t now = time(nullptr);
+    struct tm lt;
+    localtime_r(&now, &lt);
+    uint16_t today = dayKeyOf(now);
+
+    // 表示月（今月 + month_offset）
+    int year = lt.tm_year + 1900;
+    int mon = lt.tm_mon + month_offset;
+    while (mon < 0)   { mon += 12; year--; }
+    while (mon >= 12) { mon -= 12; year++; }
+    struct tm ft = {};
+    ft.tm_year = year - 1900;
+    ft.tm_mon = mon;
+    ft.tm_mday = 1;
+    ft.tm_hour = 12;
+    time_t first_t = mktime(&ft);           // tm_wday を埋める
+    month_day1 = dayKeyOf(first_t);
+    month_wday1 = ft.tm_wday;
+    month_ndays = daysInMonth(year, mon);
+
+    char buf[64];
+    canvas.setTextSize(32);
+    snprintf(buf, sizeof(buf), "%d年%d月", year, mon + 1);
+    drawTextBold(buf, 10, 8, 1);
+
+    // 曜日行
+    static const char* wdays[] = { "日", "月", "火", "水", "木", "金", "土" };
+    canvas.setTextSize(22);
+    for (int c = 0; c < 7; c++) {
+        drawText(wdays[c], MONTH_GRID_X + c * MONTH_CELL_W + 28, MONTH_GRID_Y - 30);
+    }
+
+    // 日セル
+    int month_events = 0, alarm_days = 0;
+    for (int d = 0; d < month_ndays; d++) {
+        int cell = month_wday1 + d;
+        int x = MONTH_GRID_X + (cell % 7) * MONTH_CELL_W;
+        int y = MONTH_GRID_Y + (cell / 7) * MONTH_CELL_H;
+        uint16_t day = month_day1 + d;
+        uint8_t flags = 0;
+        int n = dayStats(day, &flags);
+        month_events += n;
+        if (flags & DAY_ALARM) alarm_days++;
+
+        if (day == today) canvas.fillRect(x, y, MONTH_CELL_W, MONTH_CELL_H, COL_CURSOR_BG);
+        canvas.drawRect(x, y, MONTH_CELL_W, MONTH_CELL_H, COL_BTN_BORDER);
+
+        canvas.setTextSize(24);
+        snprintf(buf, sizeof(buf), "%d", d + 1);
+        if (day == today) drawTextBold(buf, x + 6, y + 6, 1);
+        else drawText(buf, x + 6, y + 6);
+
+        // アラーム: 未発火あり=● / 発火済みのみ=○
+        if (flags & DAY_PENDING) canvas.fillCircle(x + MONTH_CELL_W - 14, y + 16, 7, COL_TEXT);
+        else if (flags & DAY_ALARM) canvas.drawCircle(x + MONTH_CELL_W - 14, y + 16, 7, COL_TEXT);
+
+        if (n > 0) {
+            canvas.setTextSize(22);
+            snprintf(buf, sizeof(buf), "%d件", n);
+            drawText(buf, x + 10, y + 62);
+        }
+    }
+
+    canvas.setTextSize(24);
+    snprintf(buf, sizeof(buf), "%d件 / アラームのある日 %d日", month_events, alarm_days);
+    drawText(buf, 10, MONTH_GRID_Y + MONTH_ROWS * MONTH_CELL_H + 12);
+
+    // ボタン（一覧画面と同じ配置）
+    int btnY = 900;
+    int btnH = 50;
+    canvas.setTextSize(22);
+    canvas.drawRect(5, btnY, 120, btnH, COL_BTN_BORDER);
+    canvas.drawString("<前月", 30, btnY + 14);
+    canvas.drawRect(130, btnY, 125, btnH, COL_BTN_BORDER);
+    canvas.drawString("翌月>", 160, btnY + 14);
+    canvas.drawRect(260, btnY, 125, btnH, COL_BTN_BORDER);
+    canvas.drawString("今月", 295, btnY + 14);
+    canvas.drawRect(390, btnY, 145, btnH, COL_BTN_BORDER);
+    canvas.drawString("一覧", 435, btnY + 14);
+
+    canvas.pushCanvas(0, 0, fast ? UPDATE_MODE_DU4 : UPDATE_MODE_GC16);
+    Serial.printf("[MONTH] %d/%02d: %d events, %d alarm days (%lums)\n",
+                  year, mon + 1, month_events, alarm_days, millis() - t0);
+}
+
+// タップ位置の日番号（表示中の月の日でなければ 0）
+uint16_t monthDayAt(int tx, int ty) {
+    if (tx < MONTH_GRID_X || ty < MONTH_GRID_Y) return 0;
+    int c = (tx - MONTH_GRID_X) / MONTH_CELL_W;
+    int r = (ty - MONTH_GRID_Y) / MONTH_CELL_H;
+    if (c >= 7 || r >= MONTH_ROWS) return 0;
+    int d = r * 7 + c - month_wday1;
+    if (d < 0 || d >= month_ndays) return 0;
+    return month_day1 + d;
+}
@@ -0,0 +1,126 @@
+#include "globals.h"
+#include "ui_colors.h"
+#include <time.h>
+
+//==============================================================================
+// 検索画面
+//   一覧のフッター（件数表示）をタップ → キーボードでクエリ入力 → OK で検索。
+//   結果は searchEvents() の順位順。行タップで詳細、L/R でページ送り、P で一覧へ。
+//==============================================================================
+
+#define SEARCH_MAX_HITS     100
+#define SEARCH_LIST_Y       96
+#define SEARCH_ROW_H        50
+#define SEARCH_ROWS         15      // 96 + 15×50 = 846（フッター 850〜 の手前まで）
+
+static int    hits[SEARCH_MAX_HITS];
+static int    hit_count = 0;
+static int    hit_scroll = 0;
+static String query;
+static unsigned long query_us = 0;
+static uint32_t hits_epoch = 0;     // hits[] の index が有効な版（fetch・日付ロールで変わる）
+
+// キーボードを検索クエリ入力で開く（前回のクエリを初期値に）
+void openSearch() {
+    keyboard_target = KB_TARGET_SEARCH;
+    keyboard_buffer = query;
+    ui_state = UI_KEYBOARD;
+    drawKeyboard();
+}
+
+void runSearch(const String& q) {
+    query = q;
+    hit_scroll = 0;
+    uint32_t t0 = micros();
+    hit_count = q.length() > 0 ? searchEvents(q.c_str(), hits, SEARCH_MAX_HITS) : 0;
+    query_us = micros() - t0;
+    hits_epoch = eventEpoch();
+}
+
+void drawSearch(bool fast) {
+    // 検索後に新しい版が公開されていれば index が指す先が違うので引き直す
+    if (hit_count > 0 && hits_epoch != eventEpoch()) {
+        int old_scroll = hit_scroll;
+        runSearch(query);
+        hit_scroll = old_scroll < hit_count ? old_scroll : 0;
+    }
+    canvas.fillCanvas(COL_BG);
+    canvas.setTextColor(COL_TEXT);
+    canvas.setTextDatum(TL_DATUM);
+
+    canvas.setTextSize(28);
+    drawTextBold(String("検索: ") + query, 10, 8, 1);
+    canvas.setTextSize(22);
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%d件%s (%lu.%lums)", hit_count,
+             hit_count >= SEARCH_MAX_HITS ? "+" : "",
+             query_us / 1000, (query_us % 1000) / 100);
+    drawText(buf, 10, 50);
+    canvas.drawLine(0, SEARCH_LIST_Y - 6, 540, SEARCH_LIST_Y - 6, COL_BTN_BORDER);
+
+    if (hit_count == 0) {
+        canvas.setTextSize(26);
+        drawText("見つかりません", 170, 300);
+    }
+    static const char* wdays[] = { "日", "月", "火", "水", "木", "金", "土" };
+    for (int r = 0; r < SEARCH_ROWS && hit_scroll + r < hit_count; r++) {
+        int evt = hits[hit_scroll + r];
+        int y = SEARCH_LIST_Y + r * SEARCH_ROW_H;
+        struct tm st;
+        localtime_r(&events[evt].start, &st);
+        canvas.setTextSize(22);
+        if (events[evt].is_allday) {
+            snprintf(buf, sizeof(buf), "%d/%d(%s)", st.tm_mon + 1, st.tm_mday, wdays[st.tm_wday]);
+        } else {
+            snprintf(buf, sizeof(buf), "%d/%d(%s) %s", st.tm_mon + 1, st.tm_mday, wdays[st.tm_wday],
+                     events[evt].time_text);
+        }
+        drawText(buf, 8, y + 4);
+        if (eventHasPendingAlarm(evt)) drawText("♪", 8, y + 26);
+        canvas.setTextSize(26);
+        const EventItem& e = events[evt];
+        char line[ICS_SUMMARY_BUF];
+        int n = utf8FitBytes(e.row_text, e.row_len, 22);
+        memcpy(line, e.row_text, n);
+        line[n] = '\0';
+        canvas.drawString(line, 190, y + 10);
+        canvas.drawLine(0, y + SEARCH_ROW_H - 1, 540, y + SEARCH_ROW_H - 1, COL_DATE_BG);
+    }
+
+    if (hit_count > SEARCH_ROWS) {
+        canvas.setTextSize(22);
+        snprintf(buf, sizeof(buf), "%d-%d / %d", hit_scroll + 1,
+                 min(hit_scroll + SEARCH_ROWS, hit_count), hit_count);
+        drawText(buf, 10, 860);
+    }
+
+    // ボタン（一覧画面と同じ配置）
+    int btnY = 900;
+    int btnH = 50;
+    canvas.setTextSize(22);
+    canvas.drawRect(5, btnY, 120, btnH, COL_BTN_BORDER);
+    canvas.drawString("<前", 40, btnY + 14);
+    canvas.drawRect(130, btnY, 125, btnH, COL_BTN_BORDER);
+    canvas.drawString("次>", 170, btnY + 14);
+    canvas.drawRect(260, btnY, 125, btnH, COL_BTN_BORDER);
+    canvas.drawString("再検索", 285, btnY + 14);
+    canvas.drawRect(390, btnY, 145, btnH, COL_BTN_BORDER);
+    canvas.drawString("一覧", 435, btnY + 14);
+
+    canvas.pushCanvas(0, 0, fast ? UPDATE_MODE_DU4 : UPDATE_MODE_GC16);
+}
+
+void scrollSearch(int dir) {
+    int next = hit_scroll + dir * SEARCH_ROWS;
+    if (next < 0 || next >= hit_count) return;
+    hit_scroll = next;
+    drawSearch(true);
+}
+
+// タップ位置の結果行のイベント index（なければ -1）
+int searchHitAt(int tx, int ty) {
+    if (ty < SEARCH_LIST_Y) return -1;
+    int r = (ty - SEARCH_LIST_Y) / SEARCH_ROW_H;
+    if (r >= SEARCH_ROWS || hit_scroll + r >= hit_count) return -1;
+    return hits[hit_scroll + r];
+}
@@ -20,7 +20,7 @@ void drawSettings(bool fast) {
         "ICS URL", "ICS User", "ICS Pass",
         "MIDI File", "MIDI URL", "MIDI Baud", "Port", "Alarm Offset",
         "Time Format", "Text Display", "ICS Poll", "Play Duration",
-        "Play Repeat", "Notify Topic", "Notify Test",
+        "Play Repeat", "Alarm Overlap", "Notify Topic", "Notify Test",
         "Sound Test", "Save & Exit"
     };
 
@@ -63,6 +63,7 @@ void drawSettings(bool fast) {
                 break;
             }
             case SET_PLAY_REPEAT: val = String(config.play_repeat) + "回"; break;
+            case SET_ALARM_MERGE: val = config.alarm_merge ? "まとめて鳴らす" : "順番に鳴らす"; break;
             case SET_NTFY_TOPIC: val = strlen(config.ntfy_topic) > 0 ? config.ntfy_topic : "(empty)"; break;
             case SET_NTFY_TEST: val = "[実行]"; break;
             case SET_SOUND_TEST: val = "[実行]"; break;
@@ -150,6 +151,7 @@ void handleSettingsSelect() {
             drawSettings(); break;
         case SET_TIME_FORMAT:
             config.time_24h = !config.time_24h;
+            prepareAllRowText();        // 一覧の時刻文字列は取り込み時に作ってあるため作り直す
             drawSettings(); break;
         case SET_TEXT_WRAP:
             config.text_wrap = !config.text_wrap;
@@ -173,6 +175,9 @@ void handleSettingsSelect() {
         case SET_PLAY_REPEAT:
             config.play_repeat = (config.play_repeat % 5) + 1;
             drawSettings(); break;
+        case SET_ALARM_MERGE:
+            config.alarm_merge = !config.alarm_merge;
+            drawSettings(); break;
         case SET_NTFY_TOPIC:
             keyboard_target = SET_NTFY_TOPIC;
             keyboard_buffer = config.ntfy_topic;
@@ -185,34 +190,47 @@ void handleSettingsSelect() {
                 canvas.drawString("通知テスト失敗", 270, 400);
                 canvas.setTextSize(22);
                 canvas.drawString("Notify Topicが未設定です", 270, 450);
-                canvas.pushCanvas(0, 0, UPDATE_MODE_GC16); delay(2000);
+                canvas.pushCanvas(0, 0, UPDATE_MODE_GC16); alarmAwareDelay(2000);
             } else if (WiFi.status() != WL_CONNECTED) {
                 canvas.drawString("通知テスト失敗", 270, 400);
                 canvas.setTextSize(22);
                 canvas.drawString("WiFi未接続です", 270, 450);
-                canvas.pushCanvas(0, 0, UPDATE_MODE_GC16); delay(2000);
+                canvas.pushCanvas(0, 0, UPDATE_MODE_GC16); alarmAwareDelay(2000);
             } else {
                 canvas.drawString("通知送信中...", 270, 400);
                 canvas.pushCanvas(0, 0, UPDATE_MODE_GC16);
-                sendNtfyNotification("M5Paper Test", "通知テスト - This is a test notification");
-                canvas.fillCanvas(COL_SETTINGS_BG); canvas.setTextColor(COL_SETTINGS_TEXT);
-                canvas.setTextDatum(MC_DATUM); canvas.setTextSize(28);
-                canvas.drawString("通知送信完了", 270, 400);
-                canvas.setTextSize(22);
-                canvas.drawString(config.ntfy_topic, 270, 450);
-                canvas.pushCanvas(0, 0, UPDATE_MODE_GC16); delay(2000);
+                enqueueNtfy("M5Paper Test", "通知テスト - This is a test notification");
+                int code = ntfyFlush(20000);     // ワーカーの送信結果を待つ（初回失敗時は再送も含む）
+                if (ui_state == UI_SETTINGS) {
+                    canvas.fillCanvas(COL_SETTINGS_BG); canvas.setTextColor(COL_SETTINGS_TEXT);
+                    canvas.setTextDatum(MC_DATUM); canvas.setTextSize(28);
+                    canvas.drawString(code >= 200 && code < 300 ? "通知送信完了" : "通知送信失敗", 270, 400);
+                    canvas.setTextSize(22);
+                    if (code >= 200 && code < 300) {
+                        canvas.drawString(config.ntfy_topic, 270, 450);
+                    } else if (code > 0) {
+                        char msg[32];
+                        snprintf(msg, sizeof(msg), "HTTP %d", code);
+                        canvas.drawString(msg, 270, 450);
+                    } else {
+                        canvas.drawString("応答なし（再送を続けます）", 270, 450);
+                    }
+                    canvas.pushCanvas(0, 0, UPDATE_MODE_GC16); alarmAwareDelay(2000);
+                }
             }
-            drawSettings(); break;
+            if (ui_state == UI_SETTINGS) drawSettings();     // 待ち中にアラームが鳴ったら鳴動画面のまま
+            break;
         }
         case SET_ICS_UPDATE:
             canvas.fillCanvas(COL_SETTINGS_BG); canvas.setTextColor(COL_SETTINGS_TEXT);
             canvas.setTextDatum(MC_DATUM); canvas.setTextSize(28);
             drawTextBold("ICS取得中...", 270, 280, 1);
             canvas.pushCanvas(0, 0, UPDATE_MODE_GC16);
+            ui_state = UI_LIST;     // 取得中にアラームが鳴ったら、鳴り終わりは一覧へ戻る
             if (WiFi.status() != WL_CONNECTED) connectWiFi();
-            fetchAndUpdate();
-            ui_state = UI_LIST;
-            scrollToToday(); drawList(); break;
+            fetchAndUpdate(true);
+            if (ui_state == UI_LIST) { scrollToToday(); drawList(); }
+            break;
         case SET_SOUND_TEST: {
             Serial.println("\n*** SOUND TEST ***");
             Serial.printf("  MIDI: %s\n", config.midi_file);
@@ -226,8 +244,9 @@ void handleSettingsSelect() {
                 canvas.setTextSize(22);
                 canvas.drawString(config.midi_file, 270, 450);
                 canvas.drawString("ファイルを確認してください", 270, 490);
-                canvas.pushCanvas(0, 0, UPDATE_MODE_GC16); delay(3000);
-                drawSettings(); break;
+                canvas.pushCanvas(0, 0, UPDATE_MODE_GC16); alarmAwareDelay(3000);
+                if (ui_state == UI_SETTINGS) drawSettings();
+                break;
             }
             int dur = config.play_duration;
             play_duration_ms = dur * 1000;
@@ -253,8 +272,8 @@ void handleSettingsSelect() {
                 canvas.setTextDatum(MC_DATUM); canvas.setTextSize(28);
                 canvas.drawString("MIDI再生失敗", 270, 400);
                 canvas.setTextSize(22); canvas.drawString(config.midi_file, 270, 450);
-                canvas.pushCanvas(0, 0, UPDATE_MODE_GC16); delay(3000);
-                drawSettings();
+                canvas.pushCanvas(0, 0, UPDATE_MODE_GC16); alarmAwareDelay(3000);
+                if (ui_state == UI_SETTINGS) drawSettings();
             }
             break;
         }
@@ -35,6 +35,21 @@ String utf8Substring(const String& s, int maxWidth) {
     return result;
 }
 
+// s[0..len) の先頭から表示幅 maxWidth に収まるバイト数（utf8Substring と同じ数え方: ASCII=1, 他=2）
+//   取り込み時に一覧の行の切り詰め位置を決めるのに使う（String を作らない）
+int utf8FitBytes(const char* s, int len, int maxWidth) {
+    int width = 0;
+    int i = 0;
+    while (i < len) {
+        int bytes = utf8CharBytes((uint8_t)s[i]);
+        int charWidth = (bytes == 1) ? 1 : 2;
+        if (width + charWidth > maxWidth || i + bytes > len) break;
+        width += charWidth;
+        i += bytes;
+    }
+    return i;
+}
+
 // 全角ASCII文字（U+FF01〜U+FF5E）を半角（U+0021〜U+007E）に変換
 String normalizeFullWidth(const String& s) {
     String result;
@@ -60,93 +75,47 @@ String normalizeFullWidth(const String& s) {
     return result;
 }
 
-// HTML簡易デコード
-// - ブロック要素(<br>, <p>, <div>, <li>, <h1>-<h6>, <tr>) → "\n"リテラル改行
-// - 他のタグ(<b>, <span>, <a>...) → 除去（中身の文字列は残す）
-// - 主要エンティティ(&nbsp; &amp; &lt; &gt; &quot; &apos; &#NNN; &#xHH;) → 対応
-// - 未対応のエンティティは除去（表示を汚さないため）
+// HTML簡易デコード（本体は ics_core.cpp の icsSimplifyHtml。ics2bin と同じ規則）
 String simplifyHtml(const String& s) {
-    String result;
-    result.reserve(s.length());
+    int len = (int)s.length();
+    char* out = (char*)malloc(len + 1);
+    if (!out) return s;
+    icsSimplifyHtml(s.c_str(), len, out);
+    String result(out);
+    free(out);
+    return result;
+}
+
+// 詳細・再生画面に出す本文（M5EV で配信側が HTML 整形済みならそのまま）
+String displayText(const EventItem& e, const char* s) {
+    return removeUnsupportedChars(e.text_plain ? String(s) : simplifyHtml(s));
+}
+
+// removeUnsupportedChars の char 版（取り込み時用）。out は len+1 バイト以上、書き込んだバイト数を返す
+//   置換で長くなることはない（4バイト → '?' 1バイト）
+int sanitizeDisplayText(const char* s, int len, char* out) {
+    int n = 0;
+    bool lastWasEmojiPlaceholder = false;
     int i = 0;
-    int n = (int)s.length();
-    while (i < n) {
-        char c = s[i];
-        if (c == '<') {
-            int end = s.indexOf('>', i + 1);
-            if (end < 0) { result += s.substring(i); break; }
-            String tag = s.substring(i + 1, end);
-            tag.trim();
-            bool isClosing = false;
-            if (tag.length() > 0 && tag[0] == '/') {
-                isClosing = true;
-                tag = tag.substring(1);
-                tag.trim();
-            }
-            String name;
-            for (int k = 0; k < (int)tag.length(); k++) {
-                char ch = tag[k];
-                if (ch == ' ' || ch == '/' || ch == '\t') break;
-                if (ch >= 'A' && ch <= 'Z') ch = ch - 'A' + 'a';
-                name += ch;
-            }
-            bool isBlock = (name == "br" || name == "p" || name == "div" ||
-                            name == "li" || name == "tr" ||
-                            name == "h1" || name == "h2" || name == "h3" ||
-                            name == "h4" || name == "h5" || name == "h6");
-            if (isBlock && (name == "br" || name == "p" || name == "div" || isClosing)) {
-                result += "\\n";
-            }
-            i = end + 1;
+    while (i < len) {
+        uint8_t c = s[i];
+        int bytes = utf8CharBytes(c);
+        if (bytes == 4) {
+            if (!lastWasEmojiPlaceholder) out[n++] = '?';
+            lastWasEmojiPlaceholder = true;
+            i += bytes;
             continue;
         }
-        if (c == '&') {
-            int end = s.indexOf(';', i + 1);
-            if (end > 0 && end - i <= 10) {
-                String ent = s.substring(i + 1, end);
-                String entLower = ent;
-                entLower.toLowerCase();
-                bool handled = true;
-                if      (entLower == "nbsp") result += ' ';
-                else if (entLower == "amp")  result += '&';
-                else if (entLower == "lt")   result += '<';
-                else if (entLower == "gt")   result += '>';
-                else if (entLower == "quot") result += '"';
-                else if (entLower == "apos") result += '\'';
-                else if (ent.length() > 1 && ent[0] == '#') {
-                    int code = 0;
-                    bool valid = true;
-                    if (ent[1] == 'x' || ent[1] == 'X') {
-                        if (ent.length() < 3) valid = false;
-                        for (int k = 2; k < (int)ent.length() && valid; k++) {
-                            char ch = ent[k]; int d = -1;
-                            if (ch >= '0' && ch <= '9') d = ch - '0';
-                            else if (ch >= 'a' && ch <= 'f') d = ch - 'a' + 10;
-                            else if (ch >= 'A' && ch <= 'F') d = ch - 'A' + 10;
-                            else valid = false;
-                            if (valid) code = code * 16 + d;
-                        }
-                    } else {
-                        for (int k = 1; k < (int)ent.length() && valid; k++) {
-                            char ch = ent[k];
-                            if (ch < '0' || ch > '9') { valid = false; break; }
-                            code = code * 10 + (ch - '0');
-                        }
-                    }
-                    if (valid && code >= 0x20 && code < 0x7F) result += (char)code;
-                    // 非ASCII/未対応はスキップ
-                }
-                else handled = false;
-                if (handled) { i = end + 1; continue; }
-                // 未知のエンティティはまるごと除去
-                i = end + 1;
-                continue;
-            }
+        if (bytes == 1 && c < 0x20 && c != '\t') {
+            i++;
+            continue;
         }
-        result += c;
-        i++;
+        for (int j = 0; j < bytes && i + j < len; j++) out[n++] = s[i + j];
+        i += bytes;
+        lastWasEmojiPlaceholder = false;
     }
-    return result;
+    out[n] = '\0';
+    return n;
 }
 
 // 4バイト文字（絵文字）は '?' に置換、制御文字（0x00-0x1F、ただしタブ以外）は除去